@@ -27,6 +27,13 @@ extern boolean hasGenProj(DLAtom *head);
 extern boolean atomHasExprs(DLAtom *a);
 extern List *getEDBFDs(DLProgram *p);
 
+#define ENSURE_REL_TO_RULE_MAP(_s) \
+	do { \
+		if(!DL_HAS_PROP(_s,DL_MAP_RELNAME_TO_RULES)) \
+		{ \
+			createRelToRuleMap((Node *) _s);	\
+		} \
+	} while (0)
 #define ENSURE_REL_TO_REL_GRAPH(_s) \
 	do { \
 		if(!DL_HAS_PROP(_s,DL_REL_TO_REL_GRAPH)) \
@@ -28,4 +28,7 @@ extern List *findParameters (Node *qbModel);
 // of const nodes
 extern List *oracleBindToConsts (char *binds);
 
+// create a constant for a bind value infering its type from the string representation
+extern Constant *createBindConstant (char *value);
+
 #endif /* PARAMETER_H_ */
@@ -107,6 +107,15 @@ typedef (void *) gprom_long_t;
 #include <process.h>
 #endif
 
+/* thread local storage */
+#if defined(__GNUC__) || defined(__clang__)
+#define THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
 /* unistd handler */
 #if HAVE_UNISTD_H
 #include <unistd.h>
@@ -185,6 +194,11 @@ typedef (void *) gprom_long_t;
 #define HAVE_DUCKDB_BACKEND 1
 #endif
 
+// duckdb with function sets (needed for native provenance sketch functions)
+#if HAVE_DUCKDB_BACKEND && HAVE_DUCKDB_CREATE_SCALAR_FUNCTION_SET && HAVE_DUCKDB_CREATE_AGGREGATE_FUNCTION_SET
+#define HAVE_DUCKDB_SKETCH_FUNCTIONS 1
+#endif
+
 // monetdb
 #if HAVE_LIBMAPI && HAVE_MONETDB_MAPI_H
 #define HAVE_MONETDB_BACKEND 1
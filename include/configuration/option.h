@@ -26,11 +26,15 @@ NEW_ENUM_WITH_TO_STRING(
 #define OPTION_CONN_DB "connection.db"
 #define OPTION_CONN_PORT "connection.port"
 #define OPTION_CONN_HOST "connection.host"
+#define OPTION_CONN_POOL_SIZE "connection.pool_size"
 #define OPTION_ODBC_DRIVER "connection.odbcdriver"
 
 /* backend specific options */
 #define OPTION_ORACLE_AUDITTABLE "backendOpts.oracle.logtable"
 #define OPTION_ORACLE_USE_SERVICE "backendOpts.oracle.use_service"
+#define OPTION_SQLITE_STMT_CACHE_SIZE "backendOpts.sqlite.stmt_cache_size"
+#define OPTION_PREFETCH_CATALOG "backendOpts.prefetch_catalog"
+#define OPTION_DICT_ENCODE_RESULTS "backendOpts.dict_encode_results"
 
 /* test options */
 #define OPTION_TEST_NAME "test"
@@ -65,6 +69,7 @@ NEW_ENUM_WITH_TO_STRING(
 /* debug option methods */
 #define OPTION_TIMING "timing"
 #define OPTION_MEMMEASURE "memdebug"
+#define OPTION_BACKEND_INSTRUMENTATION "backend_instrumentation"
 #define OPTION_GRAPHVIZ "graphviz"
 #define OPTION_GRAPHVIZ_DETAILS "graphviz_details"
 #define OPTION_AGGRESSIVE_MODEL_CHECKING "aggressive_model_checking"
@@ -72,6 +77,9 @@ NEW_ENUM_WITH_TO_STRING(
 #define OPTION_TIME_QUERY_OUTPUT_FORMAT "time_query_format"
 #define OPTION_REPEAT_QUERY "repeat_query_count"
 #define OPTION_SHOW_QUERY_RESULT "show_query_result"
+#define OPTION_BATCH_MODE "batch_mode"
+#define OPTION_PROFILE_FORMAT "profile_format"
+#define OPTION_PROFILE_FILE "profile_file"
 
 /* provennace and some optimization options */
 #define OPTION_UPDATE_ONLY_USE_CONDS "only_updated_use_conditions"
@@ -88,6 +96,10 @@ NEW_ENUM_WITH_TO_STRING(
 #define OPTION_COST_BASED_SIMANN_COOLDOWN_RATE "cost_based_sim_ann_cooldown_rate"
 #define OPTION_COST_BASED_NUM_HEURISTIC_OPT_ITERATIONS "cost_based_num_heuristic_opt_iterations"
 #define OPTION_COST_BASED_CLOSE_OPTION_REMOVEDP_BY_SET "cost_based_close_option_removedp_by_set"
+#define OPTION_OPTIMIZER_THREADS "optimizer_threads"
+#define OPTION_OPTIMIZER_RULE_FIXPOINT "optimizer_rule_fixpoint"
+#define OPTION_PREPARED_REWRITE_USE_MODEL "prepared_rewrite_use_model"
+#define OPTION_MATERIALIZE_SHARED_VIEWS "materialize_shared_views"
 //#define OPTION_
 
 /* optimization options */
@@ -106,6 +118,8 @@ NEW_ENUM_WITH_TO_STRING(
 #define OPTIMIZATION_PULL_UP_DUPLICATE_REMOVE_OPERATORS "optimization.pull_up_deplicate_remove_operators"
 /* define optimization options for group by*/
 #define OPTIMIZATION_PUSH_DOWN_AGGREGATION_THROUGH_JOIN "optimization.push_down_aggregation_through_join"
+#define OPTIMIZATION_SHARE_COMMON_SUBPLANS "optimization.share_common_subplans"
+#define OPTIMIZATION_JOIN_REORDER "optimization.join_reorder"
 
 
 /* model checking options */
@@ -119,6 +133,7 @@ NEW_ENUM_WITH_TO_STRING(
 #define TEMPORAL_USE_COALSECE "temporal_use_coalesce"
 #define TEMPORAL_USE_NORMALIZATION "temporal_use_normalization"
 #define TEMPORAL_USE_NORMALIZATION_WINDOW "temporal_use_normalization_window"
+#define TEMPORAL_USE_COALESCE_WINDOW "temporal_use_coalesce_window"
 #define TEMPORAL_AGG_WITH_NORM "temporal_combine_agg_and_norm"
 
 /* lateral rewrite for nesting operator */
@@ -135,10 +150,16 @@ NEW_ENUM_WITH_TO_STRING(
 #define OPTION_PS_SETTINGS "ps_settings"
 #define OPTION_PS_SET_BITS "set_bits"
 #define OPTION_PS_USE_BRIN_OP "us_brin_op"
+#define OPTION_PS_USE_PREDICATE "ps_use_predicate"
+#define OPTION_PS_USE_MAX_RANGES "ps_use_max_ranges"
 #define OPTION_PS_ANALYZE "ps_analyze"
 #define OPTION_PS_USE_NEST "ps_use_nest"
 #define OPTION_PS_POST_TO_ORACLE "ps_post_to_oracle"
 #define OPTION_PS_STORE_TABLE "ps_store_table"
+#define OPTION_PS_MAINTAIN "ps_maintain"
+#define OPTION_PS_SAMPLE_HISTOGRAM "ps_sample_histogram"
+#define OPTION_PS_HISTOGRAM_SAMPLE_SIZE "ps_histogram_sample_size"
+#define OPTION_BUCKET_ASSIGNMENT "bucket_assignment"
 
 /* Uncertainty rewriter options */
 #define RANGE_OPTIMIZE_JOIN "range_optimize_join"
@@ -198,6 +219,7 @@ extern char *plugin_executor;
 // instrumentation options
 extern boolean opt_timing;
 extern boolean opt_memmeasure;
+extern boolean opt_backend_instrumentation;
 
 // rewrite options
 extern boolean opt_aggressive_model_checking;
@@ -232,6 +254,7 @@ extern boolean cost_based_close_option_removedp_by_set;
 extern boolean temporal_use_coalesce;
 extern boolean temporal_use_normalization;
 extern boolean temporal_use_normalization_window;
+extern boolean temporal_use_coalesce_window;
 
 // lateral rewrite for nesting operator
 extern boolean opt_lateral_rewrite;
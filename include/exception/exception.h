@@ -47,9 +47,11 @@ extern void deregisterSignalHandler(void);
 extern void processException(void);
 extern void storeExceptionInfo(ExceptionSeverity s, const char *message, const char *f, int l);
 extern char *currentExceptionToString(void);
+extern ExceptionSeverity currentExceptionSeverity(void);
 extern void setWipeContext(char *wContext);
 
-extern sigjmp_buf *exceptionBuf;
+// each thread has its own stack of try blocks
+extern THREAD_LOCAL sigjmp_buf *exceptionBuf;
 
 // macro try block implementation
 #define TRY \
@@ -80,6 +82,13 @@ extern sigjmp_buf *exceptionBuf;
 
 //            exceptionBuf = save_previous_jmpbuf;
 
+// end a try-on-exception block without calling the exception callback, e.g.,
+// in a worker thread that leaves the exception to the thread that started it
+#define END_ON_EXCEPTION_NO_PROCESSING \
+        } \
+		exceptionBuf = save_previous_jmpbuf; \
+    } while (0);
+
 #define PROCESS_EXCEPTION_AND_DIE() \
     do { \
          processException(); \
@@ -12,5 +12,7 @@
 #define INCLUDE_EXECUTION_EXE_RUN_QUERY_H_
 
 extern void exeRunQuery (void *code);
+extern void exeRunQueryBatchStmt (void *code);
+extern void exeRunQueryFinishBatch (void);
 
 #endif /* INCLUDE_EXECUTION_EXE_RUN_QUERY_H_ */
@@ -31,6 +31,11 @@ typedef struct ExecutorPlugin
 
     /* functional interface */
     void (*execute) (void *code);
+
+    /* batch mode: may return before the statement has finished, finishBatch
+     * waits for outstanding statements */
+    void (*executeBatchStmt) (void *code);
+    void (*finishBatch) (void);
 } ExecutorPlugin;
 
 // plugin management
@@ -38,5 +43,7 @@ extern void chooseExecutorPlugin(ExecutorPluginType type);
 extern void chooseExecutorPluginFromString(char *type);
 
 extern void execute (void *code);
+extern void executeBatchStatement (void *code);
+extern void finishBatchExecution (void);
 
 #endif /* INCLUDE_EXECUTION_EXECUTOR_H_ */
@@ -0,0 +1,48 @@
+/*-----------------------------------------------------------------------------
+ *
+ * backend_instrumentation.h
+ *		Accounting for calls to the metadata lookup plugin and the round trips
+ *		to the backend database they cause.
+ *
+ *		Each entry point of the metadata lookup interface (metadata_lookup.c)
+ *		records number of calls, latency (histogram with buckets for powers
+ *		of 10 microseconds), round trips to the backend and bytes
+ *		transferred. Round trips are reported by the plugins and are
+ *		attributed to the entry point that is currently running. Statistics
+ *		are kept for the whole session and for the current query.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDE_INSTRUMENTATION_BACKEND_INSTRUMENTATION_H_
+#define INCLUDE_INSTRUMENTATION_BACKEND_INSTRUMENTATION_H_
+
+#include "common.h"
+
+#define BACKEND_INSTRUMENTATION_CONTEXT_NAME "BackendInstrumentationContext"
+
+/* latency histogram buckets: < 10us, < 100us, ..., < 1s, >= 1s */
+#define BACKEND_LATENCY_BUCKETS 7
+
+extern boolean isBackendInstrumentationActive(void);
+extern void backendCallStart(const char *entryPoint);
+extern void backendCallEnd(const char *entryPoint, unsigned long bytes);
+extern void recordBackendRoundTrip(unsigned long bytes);
+extern void backendInstrumentationStartQuery(void);
+extern char *backendStatsToJSON(boolean currentQueryOnly);
+extern void outputBackendStats(void);
+extern void shutdownBackendInstrumentation(void);
+
+#define BACKEND_CALL_START() \
+	do { \
+		if (isBackendInstrumentationActive()) \
+			backendCallStart(__func__); \
+	} while (0)
+
+#define BACKEND_CALL_END(bytes) \
+	do { \
+		if (isBackendInstrumentationActive()) \
+			backendCallEnd(__func__, bytes); \
+	} while (0)
+
+#endif /* INCLUDE_INSTRUMENTATION_BACKEND_INSTRUMENTATION_H_ */
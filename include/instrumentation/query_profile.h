@@ -0,0 +1,46 @@
+/*-----------------------------------------------------------------------------
+ *
+ * query_profile.h
+ *		Per query profiles (phase tree with times and memory allocations).
+ *
+ *		A profile is started for each query processed by the rewriter. Timers
+ *		(START_TIMER / STOP_TIMER) that are started while a query is being
+ *		profiled become phases of the profile. Phases started while another
+ *		phase is running become its children. The profile can be exported as
+ *		JSON or as Chrome trace events (chrome://tracing, perfetto).
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDE_INSTRUMENTATION_QUERY_PROFILE_H_
+#define INCLUDE_INSTRUMENTATION_QUERY_PROFILE_H_
+
+#include "common.h"
+
+#define PROFILE_CONTEXT_NAME "QueryProfileContext"
+
+/* supported output formats */
+#define PROFILE_FORMAT_JSON "json"
+#define PROFILE_FORMAT_CHROME "chrome"
+
+/* counters recorded for each query */
+#define PROFILE_COUNTER_OPERATORS "operators"
+#define PROFILE_COUNTER_BACKEND_ROUND_TRIPS "backend_round_trips"
+
+extern void profileStartQuery(char *query);
+extern void profileEndQuery(void);
+extern boolean isProfilingQuery(void);
+extern void profileStartPhase(char *name);
+extern void profileEndPhase(char *name);
+extern void profileIncrCounter(char *name, long value);
+extern void profileAddContextAllocation(char *contextName, unsigned long bytes);
+extern char *getLastQueryProfile(void);
+extern void shutdownQueryProfiling(void);
+
+#define PROFILE_INCR_COUNTER(name,value) \
+	do { \
+		if (isProfilingQuery()) \
+			profileIncrCounter(name, value); \
+	} while (0)
+
+#endif /* INCLUDE_INSTRUMENTATION_QUERY_PROFILE_H_ */
@@ -58,6 +58,22 @@ extern GPROM_LIB_EXPORT void gprom_shutdown(void);
 extern GPROM_LIB_EXPORT const char *gprom_rewriteQuery(const char *query);
 extern GPROM_LIB_EXPORT const gprom_long_t gprom_costQuery(const char *query);
 
+// prepared rewrites: rewrite a query with parameters (e.g., :1) once and then
+// instantiate the rewritten query for binds (parameters are bound by position)
+extern GPROM_LIB_EXPORT boolean gprom_prepareRewrite(const char *name, const char *query);
+extern GPROM_LIB_EXPORT const char *gprom_rewritePrepared(const char *name, int numBinds, const char *binds[]);
+extern GPROM_LIB_EXPORT void gprom_dropPreparedRewrite(const char *name);
+
+// profile of the last rewritten query (format is determined by option
+// profile_format), NULL if profiling is not activated. The string is only
+// valid until the next query is rewritten.
+extern GPROM_LIB_EXPORT const char *gprom_getLastProfile(void);
+
+// calls, round trips, bytes and latency histogram for each metadata lookup
+// function as JSON (requires option backend_instrumentation). The string is
+// only valid until the next call.
+extern GPROM_LIB_EXPORT const char *gprom_getBackendStats(boolean lastQueryOnly);
+
 // callback interface for logger (application can process log messages)
 // takes message, c-file, line, loglevel
 typedef void (*GProMLoggerCallbackFunction) (const char *,const char *,int,int);
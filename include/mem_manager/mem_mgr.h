@@ -62,6 +62,7 @@ typedef struct MemContext
     char *curAllocPos;
     long unusedBytes;
     long freedUnusedBytes;
+    unsigned long allocatedBytes;
     boolean longLived;
 } MemContext;
 
@@ -77,6 +78,12 @@ extern void initMemManager(void);
  */
 extern void destroyMemManager(void);
 extern boolean memManagerUsable(void);
+/*
+ * Give a worker thread a context stack of its own with threadContext at the
+ * bottom and clear this stack once the thread is done.
+ */
+extern void initMemManagerThread(MemContext *threadContext);
+extern void shutdownMemManagerThread(void);
 extern void *malloc_(size_t bytes, const char *file, unsigned line);
 extern void *calloc_(size_t bytes, unsigned count, const char *file, unsigned line);
 extern void free_(void *mem, const char *file, unsigned line);
@@ -123,6 +130,7 @@ extern void freeCurMemContext(const char *file, unsigned line);
 extern char *contextStringDup(char *input);
 extern MemContext *freeMemContextAndChildren(char *contextName);
 extern MemContext *getDefaultMemContext(void);
+extern unsigned long getTotalAllocatedBytes(void);
 
 /*
  * Gets context size.
@@ -51,6 +51,8 @@ typedef struct CatalogCache
     Set *viewNames;             // set of existing view names
     Set *aggFuncNames;          // names of aggregate functions
     Set *winFuncNames;          // names of window functions
+    HashMap *histograms;        // hashmap tablename -> (attribute#partitions -> histogram)
+    HashMap *rowNums;           // hashmap tablename -> number of rows
     void *cacheHook;            // used to store
 //    void (*cleanAddCache) (CatalogCache *cache); // function to clean up additional cache
 } CatalogCache;
@@ -73,6 +75,8 @@ typedef struct MetadataLookupPlugin
     /* catalog lookup */
     boolean (*catalogTableExists) (char * tableName);
     boolean (*catalogViewExists) (char * viewName);
+    /* prefetch (optional): fill the cache for several tables and functions at once */
+    void (*prefetchCatalog) (List *tableNames, List *functionNames);
     boolean (*checkPostive) (char *tableName, char *colName);
     Constant * (*trasnferRawData) (char *data, char *dataType);
     HashMap * (*getMinAndMax) (char *tableName, char *colName);
@@ -103,7 +107,18 @@ typedef struct MetadataLookupPlugin
     Node * (*executeAsTransactionAndGetXID) (List *statements, IsolationLevel isoLevel);
     Relation * (*executeQuery) (char *query);       // returns a list of stringlist (tuples)
     void (*executeQueryIgnoreResult) (char *query);
+    /* asynchronous execution (optional): send a query and fetch its result later */
+    void (*sendQuery) (char *query);
+    Relation * (*getQueryResult) (boolean ignoreResult);
+    /* streaming execution (optional): read the result of a query one tuple at a time */
+    List * (*openResultStream) (char *query);       // returns the schema
+    Vector * (*nextStreamTuple) (void);             // returns NULL after the last tuple
+    void (*closeResultStream) (void);
     int (*getCostEstimation)(char *query);
+    /* connection pool (optional): additional connections to the same database */
+    void * (*openPooledConnection) (void);          // returns NULL if no connection can be opened
+    void (*closePooledConnection) (void *conn);
+    void * (*switchConnection) (void *conn);        // use conn for all methods, returns previous connection
 
     /* cache for catalog information */
     CatalogCache *cache;
@@ -116,6 +131,7 @@ typedef struct MetadataLookupPlugin
     HashMap *(*getProvenanceSketchTemplateFromTable) ();
     HashMap *(*getProvenanceSketchHistogramFromTable) ();
     void (*storePsInformation) (int tNo, char *paras, psInfoCell *psc);
+    void (*deletePsInformation) (int tNo, char *paras);
     void (*storePsTemplates) (KeyValue *kv);
     void (*storePsHistogram) (KeyValue *kv, int n);
     void (*createProvenanceSketchTemplateTable) ();
@@ -136,6 +152,7 @@ extern int shutdownMetadataLookupPlugins (void);
 extern void chooseMetadataLookupPluginFromString (char *plug);
 extern void chooseMetadataLookupPlugin (MetadataLookupPluginType plugin);
 extern void setMetadataLookupPlugin (MetadataLookupPlugin *p);
+extern void releasePluginLock (void);
 
 /* generic methods */
 extern int initMetadataLookupPlugin (void);
@@ -147,9 +164,11 @@ extern char *getConnectionDescription (void);
 
 extern boolean catalogTableExists(char * tableName);
 extern boolean catalogViewExists(char * viewName);
+extern void prefetchCatalog (List *tableNames, List *functionNames);
 extern List *getAttributes(char *tableName);
 extern List *getAttributeNames (char *tableName);
 extern List *getHist (char *tableName, char *attrName, int numPartitions);
+extern void invalidateHistograms (char *tableName);
 extern HashMap *getPS (char *sql, List *attrNames);
 extern HashMap *getPSInfoFromTable();
 extern HashMap *getPSTemplateFromTable();
@@ -160,6 +179,7 @@ extern void createPSInfoTable();
 extern void createPSHistTable();
 
 extern void storePsInfo (int tNo, char *paras, psInfoCell *psc);
+extern void deletePsInfo (int tNo, char *paras);
 extern void storePsTemplate (KeyValue *kv);
 extern void storePsHist (KeyValue *kv, int n);
 extern Node *getAttributeDefaultVal (char *schema, char *tableName, char *attrName);
@@ -178,6 +198,18 @@ extern void getTransactionSQLAndSCNs (char *xid, List **scns, List **sqls,
         List **sqlBinds, IsolationLevel *iso, Constant *commitScn);
 extern Relation *executeQuery (char *sql);
 extern void executeQueryIgnoreResult (char *sql);
+extern boolean supportsAsyncExecution (void);
+extern void sendQuery (char *sql);
+extern Relation *getQueryResult (boolean ignoreResult);
+extern boolean supportsResultStreaming (void);
+extern List *openResultStream (char *sql);
+extern Vector *nextStreamTuple (void);
+extern void closeResultStream (void);
+extern boolean supportsConnectionPool (void);
+extern void *checkoutConnection (void);
+extern void checkinConnection (void *conn);
+extern void *useConnection (void *conn);
+extern void closeConnectionPool (void);
 extern gprom_long_t getCommitScn (char *tableName, gprom_long_t maxScn, char *xid);
 extern Node *executeAsTransactionAndGetXID (List *statements, IsolationLevel isoLevel);
 extern int getCostEstimation(char *query);
@@ -32,6 +32,7 @@ extern PGconn *getPostgresConnection(void);
 
 extern boolean postgresCatalogTableExists (char * tableName);
 extern boolean postgresCatalogViewExists (char * viewName);
+extern void postgresPrefetchCatalog (List *tableNames, List *functionNames);
 extern List *postgresGetAttributes (char *tableName);
 extern List *postgresGetAttributeNames (char *tableName);
 extern List *postgresGetHist (char *tableName, char *attrName, int numPartitions);
@@ -41,6 +42,7 @@ extern HashMap *postgresGetPSInfoFromTable();
 extern HashMap *postgresGetPSTemplateFromTable();
 extern HashMap *postgresGetPSHistogramFromTable ();
 extern void postgresStorePsInfo (int tNo, char *paras, psInfoCell *psc);
+extern void postgresDeletePsInfo (int tNo, char *paras);
 extern void postgresStorePsTemplate(KeyValue *kv);
 extern void postgresStorePsHist(KeyValue *kv, int n);
 extern void postgresCreatePSTemplateTable();
@@ -65,5 +67,10 @@ extern void postgresGetTransactionSQLAndSCNs (char *xid, List **scns, List **sql
 extern Node *postgresExecuteAsTransactionAndGetXID (List *statements, IsolationLevel isoLevel);
 extern Relation *postgresExecuteQuery(char *query);
 extern void postgresExecuteQueryIgnoreResult (char *query);
+extern void postgresSendQuery (char *query);
+extern Relation *postgresGetQueryResult (boolean ignoreResult);
+extern List *postgresOpenResultStream (char *query);
+extern Vector *postgresNextStreamTuple (void);
+extern void postgresCloseResultStream (void);
 
 #endif /* METADATA_LOOKUP_POSTGRES_H_ */
@@ -45,6 +45,7 @@ extern HashMap *sqliteGetMinAndMax(char* tableName, char* colName);
 
 extern Relation *sqliteExecuteQuery(char *query);
 extern void sqliteExecuteQueryIgnoreResults(char *query);
+extern int sqliteGetNumCachedStmtsInUse (void);
 extern void sqliteGetTransactionSQLAndSCNs (char *xid, List **scns, List **sqls,
         List **sqlBinds, IsolationLevel *iso, Constant *commitScn);
 extern Node *sqliteExecuteAsTransactionAndGetXID (List *statements, IsolationLevel isoLevel);
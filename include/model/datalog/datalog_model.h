@@ -14,6 +14,7 @@
 #include "model/node/nodetype.h"
 #include "model/expression/expression.h"
 #include "model/set/hashmap.h"
+#include "model/bitset/bitset.h"
 
 // data types
 typedef struct DLNode
@@ -70,6 +71,16 @@ typedef struct DLProgram
     List *sumOpts;
 } DLProgram;
 
+// index of a list of arguments (e.g., the args of a rule head) to build bitsets over them
+typedef struct DLArgIndex
+{
+    List *universe;
+    int numArgs;
+    Node **args;
+    HashMap *varPos;
+    List *otherPos;
+} DLArgIndex;
+
 NEW_ENUM_WITH_TO_STRING(GPNodeType,
         GP_NODE_RULE,
         GP_NODE_GOAL,
@@ -138,6 +149,17 @@ extern void makeVarNamesUnique(List *nodes, boolean replaceOrigNames);
 extern DLVar *createUniqueVar(Node *n, DataType dt);
 extern char *getUnificationString(DLAtom *a);
 
+// bitset based sets of arguments (variables) over a fixed universe (e.g., the args of a rule head)
+extern DLArgIndex *createArgIndex(List *universe);
+extern BitSet *argIndexToBitSet(DLArgIndex *idx, List *args);
+extern List *argIndexMinus(DLArgIndex *idx, List *args);
+extern boolean argIndexOverlap(DLArgIndex *idx, List *args);
+extern BitSet *argsToBitSet(List *universe, List *args);
+extern List *bitSetToArgs(List *universe, BitSet *b);
+extern List *argsMinus(List *universe, List *args);
+extern List *argsIntersect(List *universe, List *args);
+extern boolean argsOverlap(List *universe, List *args);
+
 // rewrites by substituting rule bodies for rule heads
 extern DLProgram *mergeSubqueries(DLProgram *p, boolean allowRuleNumberIncrease);
 
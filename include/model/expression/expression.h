@@ -294,6 +294,10 @@ extern List *getDLVarsIgnoreProps(Node *node);
  * list of operators, these relation among these operators is AND */
 extern void getSelectionCondOperatorList(Node *expr, List **opList);
 
+/* append the conjuncts of a condition (without copying them) to a list, a
+ * NULL condition has no conjuncts */
+extern void splitConjuncts(Node *cond, List **conjuncts);
+
 /* combine a list operator to an AND operator */
 extern Node *changeListOpToAnOpNode(List *l1);
 
@@ -258,6 +258,12 @@ extern char *nodeToDot(void *obj);
 /* create a node tree from a string */
 extern void *stringToNode(char *str);
 
+/* compact binary representation of a node tree */
+#define NODE_BINARY_FORMAT_VERSION 1
+
+extern char *nodeToBinary(void *obj, size_t *len);
+extern void *binaryToNode(char *data, size_t len);
+
 /* deep copy a node */
 //#define COPY_OBJECT_TO_CONTEXT(obj, result, context)
 
@@ -35,6 +35,7 @@ typedef struct ParameterizedQuery
 	NodeTag type;
 	Node *q;
 	List *parameters;
+	List *sqlTemplate;
 } ParameterizedQuery;
 
 typedef struct PreparedQuery
@@ -1,10 +1,22 @@
 /*-----------------------------------------------------------------------------
  *
  * relation.h
- *		
+ *		Query results returned by metadata lookup plugins.
  *
  *		AUTHOR: lord_pretzel
  *
+ *		A relation stores its tuples in one of two formats:
+ *
+ *		- row format: tuples is a vector of tuples, each tuple is a vector of
+ *		  strings (NULL values are stored as the string "NULL")
+ *		- dictionary encoded: each column stores the distinct values that
+ *		  appear in the column once in an arena owned by the relation and
+ *		  for each tuple the position of the tuple's value in this dictionary
+ *		  plus a bit in a null bitmap
+ *
+ *		Code that reads relations should use the functions below that work
+ *		for both formats instead of accessing tuples directly.
+ *
  *-----------------------------------------------------------------------------
  */
 
@@ -14,10 +26,60 @@
 #include "model/list/list.h"
 #include "model/set/vector.h"
 
+/* dictionary encoded column */
+typedef struct RelationColumn
+{
+    char **dict;            // distinct values of the column
+    int dictLength;
+    int dictCapacity;
+    int *slots;             // hash table: value -> position in dict (-1 for empty slots)
+    int numSlots;
+    int *codes;             // position in dict of the value of each tuple
+    unsigned long *nulls;   // bitmap of tuples for which the column is NULL
+} RelationColumn;
+
+typedef struct RelationData
+{
+    int numColumns;
+    int numTuples;
+    int capacity;           // number of tuples codes and nulls have space for
+    RelationColumn *columns;
+    char *arena;            // current arena block used to store dictionary values
+    size_t arenaFree;
+    size_t arenaBlockSize;  // size of the next arena block
+} RelationData;
+
 typedef struct Relation {
     NodeTag type;
     List *schema;
-    Vector *tuples;
+    Vector *tuples;         // tuples in row format (NULL for dictionary encoded relations)
+    RelationData *data;     // dictionary encoded tuples (NULL for relations in row format)
 } Relation;
 
+/* iterate over the tuples of a relation */
+typedef struct RelationIterator
+{
+    Relation *rel;
+    int row;
+} RelationIterator;
+
+#define FOREACH_REL_TUPLE(_it_,_rel_) \
+    for(RelationIterator _it_ = { (_rel_), -1 }; ++(_it_).row < getRelationNumTuples((_it_).rel); )
+
+#define REL_ITER_VALUE(_it_,_col_) getRelationValue((_it_).rel, (_it_).row, (_col_))
+
+/* create relations */
+extern Relation *makeRelation (List *schema);
+extern Relation *makeEncodedRelation (List *schema);
+extern Relation *makeResultRelation (List *schema);
+extern Relation *encodeRelation (Relation *r);
+
+/* add tuples and access their values */
+extern void addRelationTuple (Relation *r, char **values);
+extern int getRelationNumTuples (Relation *r);
+extern int getRelationNumColumns (Relation *r);
+extern char *getRelationValue (Relation *r, int row, int col);
+extern Vector *getRelationTuple (Relation *r, int row);
+extern unsigned long getRelationBytes (Relation *r);
+
 #endif /* INCLUDE_MODEL_RELATION_RELATION_H_ */
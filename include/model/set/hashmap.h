@@ -38,6 +38,8 @@ extern HashMap *newHashMap(NodeTag keyType, NodeTag valueType, boolean (*eq) (vo
 
 // accessing map elements
 extern boolean hasMapKey (HashMap *map, Node *key);
+extern boolean hasMapKeyByHashValue (HashMap *map, Node *key, unsigned hashv);
+extern unsigned mapKeysHashValue (HashMap *map);
 extern boolean hasMapStringKey (HashMap *map, char *key);
 extern boolean hasMapIntKey (HashMap *map, int key);
 extern boolean hasMapLongKey (HashMap *map, gprom_long_t key);
@@ -56,6 +58,7 @@ extern Node *getMapLong (HashMap *map, gprom_long_t key);
 #define MAP_GET_POINTER(map,key) getMapLong(map, (gprom_long_t) key)
 
 extern KeyValue *getMapEntry (HashMap *map, Node *key);
+extern KeyValue *getMapEntryByHashValue (HashMap *map, Node *key, unsigned hashv);
 #define MAP_GET_STRING_ENTRY(map,key) getMapEntry(map, (Node *) createConstString(key))
 extern List *getKeys(HashMap *map);
 extern List *getEntries(HashMap *map);
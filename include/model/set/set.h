@@ -134,6 +134,8 @@ extern List *makeNodeListFromSet(Set *s);
 
 
 extern boolean hasSetElem (Set *set, void *_el);
+extern boolean hasSetElemByHashValue (Set *set, void *_el, unsigned hashv);
+extern unsigned setElemsHashValue (Set *set);
 extern boolean hasSetIntElem (Set *set, int _el);
 extern boolean hasSetLongElem (Set *set, gprom_long_t _el);
 
@@ -0,0 +1,22 @@
+/*-----------------------------------------------------------------------------
+ *
+ * common_subplans.h
+ *		Detect structurally equal subplans and share them.
+ *
+ *		Rewrites often create separate copies of the same subplan, e.g., the
+ *		same selection over a table for the normal and the provenance side of
+ *		a query. Such copies are merged into a single operator with multiple
+ *		parents. The SQL serializers emit operators with multiple parents
+ *		once as a WITH view.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDE_OPERATOR_OPTIMIZER_COMMON_SUBPLANS_H_
+#define INCLUDE_OPERATOR_OPTIMIZER_COMMON_SUBPLANS_H_
+
+#include "model/query_operator/query_operator.h"
+
+extern QueryOperator *shareCommonSubplans (QueryOperator *root);
+
+#endif /* INCLUDE_OPERATOR_OPTIMIZER_COMMON_SUBPLANS_H_ */
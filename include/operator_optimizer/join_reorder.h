@@ -0,0 +1,27 @@
+/*-----------------------------------------------------------------------------
+ *
+ * join_reorder.h
+ *		Reorder trees of inner joins based on estimated intermediate result
+ *		sizes.
+ *
+ *		Rewrites keep the join order of the user's query and add joins of
+ *		their own (e.g., self-joins for why-not provenance or joins with
+ *		annotations for reenactment). Maximal trees of inner joins (and a
+ *		selection on top of them) are reordered using dynamic programming
+ *		over sets of join inputs. Cardinalities are estimated from catalog
+ *		statistics (number of rows, min and max values, histograms) and keys.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDE_OPERATOR_OPTIMIZER_JOIN_REORDER_H_
+#define INCLUDE_OPERATOR_OPTIMIZER_JOIN_REORDER_H_
+
+#include "model/query_operator/query_operator.h"
+
+/* maximal number of inputs of a join tree that is reordered */
+#define JOIN_REORDER_MAX_INPUTS 12
+
+extern QueryOperator *reorderJoins (QueryOperator *root);
+
+#endif /* INCLUDE_OPERATOR_OPTIMIZER_JOIN_REORDER_H_ */
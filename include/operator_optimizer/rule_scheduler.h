@@ -0,0 +1,43 @@
+/*-----------------------------------------------------------------------------
+ *
+ * rule_scheduler.h
+ *		Apply a sequence of optimization rules to an operator graph.
+ *
+ *		Rules are applied in the order given. Rules that only rewrite a
+ *		single operator based on the operator and its neighbours (local rules)
+ *		can provide a function to apply the rule to one operator. If
+ *		optimizer_rule_fixpoint is set, local rules are only reapplied to
+ *		operators that have been changed (or whose neighbours have been
+ *		changed) since the rule was last applied, until no more changes occur.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDE_OPERATOR_OPTIMIZER_RULE_SCHEDULER_H_
+#define INCLUDE_OPERATOR_OPTIMIZER_RULE_SCHEDULER_H_
+
+#include "model/query_operator/query_operator.h"
+
+/* apply a rule to the whole graph and return the new root */
+typedef QueryOperator *(*OptRuleGraphFunc) (QueryOperator *root);
+/* apply a rule to a single operator, returns TRUE if the graph was changed */
+typedef boolean (*OptRuleOpFunc) (QueryOperator *op);
+
+typedef struct OptimizationRule
+{
+    char *name;                     // name used for logging
+    char *timerName;                // name of the timer for the rule
+    char *option;                   // option that activates the rule
+    OptRuleGraphFunc applyToGraph;
+    OptRuleOpFunc applyToOp;        // NULL if not a local rule
+} OptimizationRule;
+
+#define OPT_RULE(_name,_graphFunc,_opFunc,_option) \
+    { _name, "OptimizeModel - " _name, _option, _graphFunc, _opFunc }
+
+extern QueryOperator *applyOptimizationRules (QueryOperator *root,
+        OptimizationRule *rules, int numRules);
+extern QueryOperator *applyOptimizationRulesUntilFixpoint (QueryOperator *root,
+        OptimizationRule *rules, int numRules);
+
+#endif /* INCLUDE_OPERATOR_OPTIMIZER_RULE_SCHEDULER_H_ */
@@ -0,0 +1,22 @@
+/*-----------------------------------------------------------------------------
+ *
+ * selection_pushdown.h
+ *		Push conjuncts of selection conditions towards the leaves of a query.
+ *
+ *		Provenance rewrites add large joins (e.g., with annotated copies of
+ *		tables) below the selections of the user's query. Pushing conjuncts
+ *		down evaluates them before these joins.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDE_OPERATOR_OPTIMIZER_SELECTION_PUSHDOWN_H_
+#define INCLUDE_OPERATOR_OPTIMIZER_SELECTION_PUSHDOWN_H_
+
+#include "model/query_operator/query_operator.h"
+
+/* push selections through projections, aggregations, set operations, and
+ * duplicate removal (and joins if throughJoins is true) */
+extern QueryOperator *pushDownSelections (QueryOperator *root, boolean throughJoins);
+
+#endif /* INCLUDE_OPERATOR_OPTIMIZER_SELECTION_PUSHDOWN_H_ */
@@ -28,5 +28,13 @@ extern QueryOperator *parameterizedQueryApplyBinds(char *paramQ, List *binds);
 extern ParameterizedQuery *queryToTemplate(QueryOperator *root);
 extern char *queryToSqlTemplate(QueryOperator * op);
 
+// prepared rewrites: rewritten and optimized queries with parameters that are
+// instantiated by substituting binds into the cached SQL code or model
+extern void createPreparedRewrite(char *name, Node *rewrittenQ, List *params);
+extern ParameterizedQuery *getPreparedRewrite(char *name);
+extern boolean preparedRewriteExists(char *name);
+extern void removePreparedRewrite(char *name);
+extern char *preparedRewriteApplyBinds(char *name, List *binds);
+
 
 #endif /* _PARAMETERIZED_QUERIES_H_ */
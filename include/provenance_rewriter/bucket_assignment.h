@@ -0,0 +1,48 @@
+/*-----------------------------------------------------------------------------
+ *
+ * bucket_assignment.h
+ *		Generate expressions that assign values to buckets (ranges, fragments).
+ *
+ *		Buckets are defined by a list of bounds b_0 < b_1 < ... < b_n-1. The
+ *		bucket number of a value v is i if b_i <= v < b_i+1, -1 if v < b_0,
+ *		and n-1 if v >= b_n-1. Depending on the backend bucket numbers are
+ *		computed with width_bucket, with an array binary search function, or
+ *		with a balanced tree of nested CASE expressions. In all cases a value
+ *		is assigned to its bucket with O(log n) comparisons. The SQLite and
+ *		DuckDB plugins register the array search function natively.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDE_PROVENANCE_REWRITER_BUCKET_ASSIGNMENT_H_
+#define INCLUDE_PROVENANCE_REWRITER_BUCKET_ASSIGNMENT_H_
+
+#include "model/list/list.h"
+#include "model/node/nodetype.h"
+
+/* values of option bucket_assignment */
+#define BUCKET_ASSIGNMENT_AUTO "auto"
+#define BUCKET_ASSIGNMENT_WIDTH_BUCKET "width_bucket"
+#define BUCKET_ASSIGNMENT_ARRAY_SEARCH "array_search"
+#define BUCKET_ASSIGNMENT_CASE_TREE "case_tree"
+
+/* array binary search function (has to be installed in the database unless
+ * the backend registers it natively) */
+#define BINARY_SEARCH_ARRAY_POS_FUNC "binary_search_array_pos"
+
+typedef enum BucketAssignmentMethod
+{
+    BUCKET_METHOD_WIDTH_BUCKET,
+    BUCKET_METHOD_ARRAY_SEARCH,
+    BUCKET_METHOD_CASE_TREE
+} BucketAssignmentMethod;
+
+extern BucketAssignmentMethod getBucketAssignmentMethod(void);
+extern Node *createBucketNumberExpr(Node *value, List *bounds);
+extern Node *createBucketNumberExprWithMethod(Node *value, List *bounds,
+        BucketAssignmentMethod method);
+extern Node *createBucketLookupExpr(Node *value, List *bounds, List *results);
+extern Node *createSketchContainsExpr(Node *value, List *bounds, char *sketch);
+extern char *boundsToArrayLiteral(List *bounds);
+
+#endif /* INCLUDE_PROVENANCE_REWRITER_BUCKET_ASSIGNMENT_H_ */
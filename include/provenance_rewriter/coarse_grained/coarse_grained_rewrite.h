@@ -69,6 +69,26 @@ typedef struct psInfoCell
 #define COARSE_GRAINED_RANGEA "RANGEA"
 #define COARSE_GRAINED_FRAGMENT "FRAGMENT"
 
+/* predicates used to filter a table with a range partition sketch */
+NEW_ENUM_WITH_TO_STRING(SketchUsePredicate,
+	SKETCH_USE_NONE,
+	SKETCH_USE_RANGES,
+	SKETCH_USE_IN_LIST,
+	SKETCH_USE_BRIN
+);
+
+/* values of option ps_use_predicate */
+#define PS_USE_PREDICATE_AUTO "auto"
+#define PS_USE_PREDICATE_RANGES "ranges"
+#define PS_USE_PREDICATE_IN_LIST "in_list"
+#define PS_USE_PREDICATE_BRIN "brin"
+
+/* kinds of modifications of a table stored provenance sketches are maintained for */
+NEW_ENUM_WITH_TO_STRING(PSDeltaType,
+	PS_DELTA_INSERT,
+	PS_DELTA_DELETE
+);
+
 //extern List *psinfos;
 //extern List *psinfosLoad;
 
@@ -87,13 +107,20 @@ extern void bottomUpPropagateLevelAggregation(QueryOperator *op, psInfo *psPara)
 //extern void bottomUpPropagateLevelWindow(QueryOperator *op, psInfo *psPara);
 extern char *parameterToCharsSepByComma(List* paras);
 //extern psInfo *addPsIntoPsInfo(psInfo *psPara,HashMap *psMap);
-extern void cachePsInfo(QueryOperator *op, psInfo *psPara, HashMap *psMap);
+extern void cachePsInfo(QueryOperator *op, psInfo *psPara, HashMap *psMap, QueryOperator *capOp);
 extern int getPsSize(BitSet* psBitVector);
 //extern void printListPSInfoCells(List *l);
 extern void loadPSInfoFromTable();
 //extern void storePSInfoToTable();
 extern void storePS();
 extern HashMap *getPSFromCache(QueryOperator *op);
+extern List *getPSIfExists(QueryOperator *op);
+
+/* incremental maintenance of cached and stored provenance sketches */
+extern void maintainPSForDelta(char *tableName, QueryOperator *delta, PSDeltaType type);
+extern void maintainPSForDeltaTable(char *tableName, char *deltaTable, PSDeltaType type);
+extern boolean maintainPSForUpdate(QueryOperator *update);
+extern boolean isTableModification(QueryOperator *op);
 
 extern char *getPSCellsTableName();
 extern char *getTemplatesTableName();
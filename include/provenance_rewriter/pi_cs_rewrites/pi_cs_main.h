@@ -12,7 +12,12 @@
 #define PI_CS_MAIN_H_
 
 #include "model/query_operator/query_operator.h"
+#include "provenance_rewriter/coarse_grained/coarse_grained_rewrite.h"
 
 extern QueryOperator *rewritePI_CS (ProvenanceComputation *op);
 
+/* filter conditions for tables with provenance sketches */
+extern SketchUsePredicate chooseSketchUsePredicate(int numFrags, int numSelected, int numRanges);
+extern Node *getSketchUseCond(AttributeReference *pAttr, psAttrInfo *curPSAI, char *sketchAttr);
+
 #endif /* PI_CS_MAIN_H_ */
@@ -0,0 +1,90 @@
+/*
+ *------------------------------------------------------------------------------
+ *
+ * sketch_functions.h - Backend independent parts of native sketch functions
+ *
+ *     Embedded backends (SQLite, DuckDB) do not provide the functions used by
+ *     provenance sketch capture and use, so their metadata lookup plugins
+ *     register native implementations when a connection is opened. Sketches
+ *     are bit strings of '0' and '1' characters where character i is the bit
+ *     of fragment i, i.e., the same format as used for Postgres and as
+ *     produced by bitSetToString. This file implements the parts of these
+ *     functions that do not depend on the backend API. None of the functions
+ *     allocate memory, plugins allocate with their backend's allocator.
+ *
+ *     The functions registered by the plugins are:
+ *
+ *        binary_search_array_pos(bounds, v)   - number of bounds <= v
+ *        set_bits(frag [, numFrags])          - aggregate: sketch of fragments
+ *        fast_bit_or(sketch)                  - aggregate: union of sketches
+ *        bitor(a, b), bitand(a, b)            - union / intersection
+ *        sketch_bit_count(sketch)             - number of fragments
+ *        sketch_contains(sketch, bounds, v)   - is v in a fragment of sketch
+ *
+ *        AUTHOR: lord_pretzel
+ *        SUBDIR: include/provenance_sketches/
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef _SKETCH_FUNCTIONS_H_
+#define _SKETCH_FUNCTIONS_H_
+
+#include "common.h"
+#include "configuration/option.h"
+#include "provenance_rewriter/bucket_assignment.h"
+
+/* function names */
+#define SKETCH_FUN_BUCKET_SEARCH BINARY_SEARCH_ARRAY_POS_FUNC
+#define SKETCH_FUN_SET_BITS "set_bits"
+#define SKETCH_FUN_BITOR_AGG "fast_bit_or"
+#define SKETCH_FUN_BITOR "bitor"
+#define SKETCH_FUN_BITAND "bitand"
+#define SKETCH_FUN_BIT_COUNT "sketch_bit_count"
+#define SKETCH_FUN_CONTAINS "sketch_contains"
+
+/* backends whose plugins register the native sketch functions (DuckDB only
+ * if it supports function sets, see configure.ac) */
+#if HAVE_DUCKDB_SKETCH_FUNCTIONS
+#define HAS_NATIVE_SKETCH_FUNCTIONS(_b) ((_b) == BACKEND_SQLITE || (_b) == BACKEND_DUCKDB)
+#else
+#define HAS_NATIVE_SKETCH_FUNCTIONS(_b) ((_b) == BACKEND_SQLITE)
+#endif
+
+/*
+ * Bounds of the fragments parsed from an array literal like '{1,5,10}' (see
+ * boundsToArrayLiteral). If all bounds are numbers, numeric values are
+ * compared numerically. String values are compared as strings if some bounds
+ * are quoted (bounds of a string attribute). Parsed bounds are stored in a
+ * single memory block of size sketchBoundsSize(literal) so plugins can cache
+ * them per statement.
+ */
+typedef struct SketchBounds
+{
+    int numBounds;
+    boolean numeric;
+    boolean quoted;
+    double *nums;
+    char **strs;
+} SketchBounds;
+
+extern size_t sketchBoundsSize(const char *literal);
+extern SketchBounds *parseSketchBounds(const char *literal, void *mem);
+extern int sketchBucketPosNum(SketchBounds *b, double v);
+extern int sketchBucketPosString(SketchBounds *b, const char *v);
+
+/*
+ * Aggregation state of set_bits and fast_bit_or: the number of input rows
+ * for each fragment. Keeping counts instead of bits allows backends to remove
+ * rows from window frames again.
+ */
+extern void sketchAddBits(gprom_long_t *counts, const char *sketch, int len, int delta);
+extern void sketchCountsToBits(char *sketch, const gprom_long_t *counts, int len);
+
+/* operations on sketches of possibly different length */
+extern int sketchBitOp(char *result, const char *a, int aLen, const char *b,
+        int bLen, boolean isAnd);
+extern int sketchBitCount(const char *sketch, int len);
+extern boolean sketchHasBit(const char *sketch, int len, int pos);
+
+#endif /* _SKETCH_FUNCTIONS_H_ */
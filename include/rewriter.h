@@ -15,6 +15,7 @@
 #include "model/list/list.h"
 
 #define QUERY_MEM_CONTEXT "QUERY_CONTEXT"
+#define BATCH_STMT_MEM_CONTEXT "BATCH_STMT_CONTEXT"
 
 extern int initBasicModules (void);
 extern int initBasicModulesAndReadOptions (char *appName, char *appHelpText, int argc, char* argv[]);
@@ -47,5 +48,8 @@ extern int costQuery (char *input);
 extern char *rewriteQueryFromStream (FILE *stream);
 extern char *rewriteQueryWithOptimization(char *input);
 extern char *generatePlan(Node *oModel, boolean applyOptimizations);
+extern Node *generateOptimizedModel(Node *oModel, boolean applyOptimizations);
+extern void prepareRewrite(char *name, char *input);
+extern char *rewritePrepared(char *name, List *binds);
 
 #endif /* REWRITER_H_ */
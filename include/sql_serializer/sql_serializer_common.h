@@ -75,10 +75,27 @@ typedef struct UpdateAggAndGroupByAttrState {
 } UpdateAggAndGroupByAttrState;
 
 
+/*
+ * Maps attribute positions of a from clause (list of attribute name lists,
+ * one per from item) to the qualified name F<fromItem>_<level>.<attr> used
+ * for references to the attribute. firstAttrOfFromItem stores the position
+ * of the first attribute of each from item. Built on first use and rebuilt
+ * when from items are added.
+ */
+typedef struct FromAttrsLookup {
+    List *fromItems;
+    int numFromItems;
+    int level;
+    int numAttrs;
+    int *firstAttrOfFromItem;
+    char **qualifiedNames;
+} FromAttrsLookup;
+
 typedef struct FromAttrsContext {
     List *fromAttrs;
     List *fromAttrsList;
 	HashMap *nestAttrMap;
+	List *lookups;
 } FromAttrsContext;
 
 typedef struct JoinAttrRenameState {
@@ -138,6 +155,7 @@ typedef struct SerializeClausesAPI {
             QueryOperator *parent, FromAttrsContext *fac, struct SerializeClausesAPI *api);
     HashMap *tempViewMap;
     int viewCounter;
+    boolean materializeTempViews;
 } SerializeClausesAPI;
 
 /* generic functions for serializing queries that call an API provided as a parameter */
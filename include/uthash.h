@@ -103,16 +103,28 @@ do {
 } while (0)
 //     INFO_LOG("hv is %u", _hf_hashv);
 
-#define HASH_FIND_NODE(hh,head,keyptr,out)                                \
+#define HASH_FIND_NODE(hh,head,keyptr,out)                                       \
 do {                                                                             \
-  unsigned _hf_bkt,_hf_hashv;                                                    \
+  unsigned _hfn_hashv;                                                           \
   out=NULL;                                                                      \
   if (head) {                                                                    \
-     HASH_FCN_NODE(keyptr, (head)->hh.tbl->num_buckets, _hf_hashv, _hf_bkt);     \
-     TRACE_LOG("hashv: %u for\n%s", _hf_hashv, beatify(nodeToString(keyptr)));   \
-     if (HASH_BLOOM_TEST((head)->hh.tbl, _hf_hashv)) {                           \
-       HASH_FIND_IN_BKT_CMP((head)->hh.tbl, hh, (head)->hh.tbl->buckets[ _hf_bkt ],  \
-                        keyptr,sizeof(void *),out, equal);                      \
+     HASH_VALUE_NODE(keyptr,_hfn_hashv);                                         \
+     HASH_FIND_NODE_BYHASHVALUE(hh,head,keyptr,_hfn_hashv,out);                  \
+  }                                                                              \
+} while (0)
+
+/* find a node key whose hash value is already known, e.g., from the hash
+ * handle of an element of another table */
+#define HASH_FIND_NODE_BYHASHVALUE(hh,head,keyptr,hashval,out)                   \
+do {                                                                             \
+  unsigned _hf_bkt;                                                              \
+  out=NULL;                                                                      \
+  if (head) {                                                                    \
+     _hf_bkt = (hashval) & ((head)->hh.tbl->num_buckets-1);                      \
+     TRACE_LOG("hashv: %u", (unsigned) (hashval));                              \
+     if (HASH_BLOOM_TEST((head)->hh.tbl, (hashval))) {                           \
+       HASH_FIND_NODE_IN_BKT((head)->hh.tbl, hh, (head)->hh.tbl->buckets[ _hf_bkt ], \
+                        keyptr,(hashval),out);                                   \
      }                                                                           \
   }                                                                              \
 } while (0)
@@ -199,6 +211,15 @@ do {
 } while(0)
 
 #define HASH_ADD_NODE(hh,head,keyptr,add)                                        \
+do {                                                                             \
+ unsigned _han_hashv;                                                            \
+ HASH_VALUE_NODE(keyptr,_han_hashv);                                             \
+ HASH_ADD_NODE_BYHASHVALUE(hh,head,keyptr,_han_hashv,add);                       \
+} while(0)
+
+/* add a node key whose hash value is already known (e.g., from a failed
+ * HASH_FIND_NODE_BYHASHVALUE) */
+#define HASH_ADD_NODE_BYHASHVALUE(hh,head,keyptr,hashval,add)                    \
 do {                                                                             \
  unsigned _ha_bkt;                                                               \
  (add)->hh.next = NULL;                                                          \
@@ -215,8 +236,8 @@ do {
  }                                                                               \
  (head)->hh.tbl->num_items++;                                                    \
  (add)->hh.tbl = (head)->hh.tbl;                                                 \
- HASH_FCN_NODE(keyptr,(head)->hh.tbl->num_buckets,                               \
-         (add)->hh.hashv, _ha_bkt);                                              \
+ (add)->hh.hashv = (hashval);                                                    \
+ _ha_bkt = (add)->hh.hashv & ((head)->hh.tbl->num_buckets-1);                    \
  HASH_ADD_TO_BKT((head)->hh.tbl->buckets[_ha_bkt],&(add)->hh);                   \
  HASH_BLOOM_ADD((head)->hh.tbl,(add)->hh.hashv);                                 \
  HASH_EMIT_KEY(hh,head,keyptr,sizeof(void*));                                        \
@@ -432,11 +453,14 @@ do {
  */
 #define HASH_FCN_NODE(key,num_bkts,hashv,bkt)                                    \
 do {                                                                             \
-  hashv = (unsigned) hashValue(key);                                             \
+  HASH_VALUE_NODE(key,hashv);                                                    \
   bkt = hashv & (num_bkts-1);                                                    \
 } while (0)
 
-
+#define HASH_VALUE_NODE(key,hashv)                                               \
+do {                                                                             \
+  hashv = (unsigned) hashValue(key);                                             \
+} while (0)
 
 #define HASH_FNV(key,keylen,num_bkts,hashv,bkt)                                  \
 do {                                                                             \
@@ -673,6 +697,21 @@ do {
 
 #define HASH_KEY_FUNCCMP(a,b,cmpfunction) cmpfunction(a,b)
 
+/* elements with a different hash value cannot be equal, only compare nodes
+ * (which has to traverse both nodes) if the hash values are the same */
+#define HASH_FIND_NODE_IN_BKT(tbl,hh,head,keyptr,hashval,out)                    \
+do {                                                                             \
+ if (head.hh_head) DECLTYPE_ASSIGN(out,ELMT_FROM_HH(tbl,head.hh_head));          \
+ else out=NULL;                                                                  \
+ while (out) {                                                                   \
+    if ((out)->hh.hashv == (hashval)) {                                          \
+        if (equal((out)->hh.key,keyptr)) break;                                  \
+    }                                                                            \
+    if ((out)->hh.hh_next) DECLTYPE_ASSIGN(out,ELMT_FROM_HH(tbl,(out)->hh.hh_next)); \
+    else out = NULL;                                                             \
+ }                                                                               \
+} while(0)
+
 #define HASH_FIND_IN_BKT_CMP(tbl,hh,head,keyptr,keylen_in,out,cmpfunction)       \
 do {                                                                             \
  if (head.hh_head) DECLTYPE_ASSIGN(out,ELMT_FROM_HH(tbl,head.hh_head));          \
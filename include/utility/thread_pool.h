@@ -0,0 +1,28 @@
+/*-----------------------------------------------------------------------------
+ *
+ * thread_pool.h
+ *		Run independent tasks on a pool of worker threads.
+ *
+ *		AUTHOR: lord_pretzel
+ *
+ *		Each worker thread allocates in its own memory context. Results
+ *		produced by tasks live in the context of the worker that ran the
+ *		task, so they have to be copied by the collect function which is
+ *		called on the calling thread after all tasks have finished and before
+ *		the worker contexts are freed.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef INCLUDE_UTILITY_THREAD_POOL_H_
+#define INCLUDE_UTILITY_THREAD_POOL_H_
+
+#include "common.h"
+
+typedef void (*ThreadPoolTaskFunc) (void *arg);
+
+extern void runTasksInParallel (int numThreads, int numTasks,
+        ThreadPoolTaskFunc task, ThreadPoolTaskFunc collect, void **args);
+extern boolean isWorkerThread (void);
+
+#endif /* INCLUDE_UTILITY_THREAD_POOL_H_ */
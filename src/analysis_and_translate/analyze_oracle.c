@@ -115,6 +115,8 @@ static boolean schemaInfoHasTable(char *tableName);
 static List *schemaInfoGetSchema(char *tableName);
 static List *schemaInfoGetAttributeNames (char *tableName);
 static List *schemaInfoGetAttributeDataTypes (char *tableName);
+static void prefetchCatalogInfo (Node *stmt);
+static boolean findCatalogObjects (Node *node, List **state);
 
 /* holder for schema information when analyzing reenactment with potential DDL */
 static HashMap *schemaInfo = NULL;
@@ -124,11 +126,69 @@ analyzeOracleModel (Node *stmt)
 {
     adaptIdentifiers(stmt);
     DEBUG_NODE_BEATIFY_LOG("After backendifying identifiers: ", stmt);
+    if (getBoolOption(OPTION_PREFETCH_CATALOG))
+        prefetchCatalogInfo(stmt);
     analyzeQueryBlockStmt(stmt, NULL);
 
     return stmt;
 }
 
+/*
+ * Collect the tables and functions referenced anywhere in the statement and
+ * let the metadata lookup plugin fetch their catalog information at once
+ * instead of one table (or function) at a time during analysis. References to
+ * views defined in a WITH clause are not looked up.
+ */
+static void
+prefetchCatalogInfo (Node *stmt)
+{
+    List *objects[3] = { NIL, NIL, NIL }; // table names, function names, WITH view names
+    List *tables = NIL;
+
+    findCatalogObjects(stmt, objects);
+    FOREACH(char,t,objects[0])
+        if (!searchListString(objects[2], t))
+            tables = appendToTailOfList(tables, t);
+
+    DEBUG_LOG("prefetch catalog information for tables <%s> and functions <%s>",
+            stringListToString(tables), stringListToString(objects[1]));
+    prefetchCatalog(tables, objects[1]);
+}
+
+static boolean
+findCatalogObjects (Node *node, List **state)
+{
+    if (node == NULL)
+        return TRUE;
+
+    switch(node->type)
+    {
+        case T_FromTableRef:
+            state[0] = appendToTailOfList(state[0], ((FromTableRef *) node)->tableId);
+            break;
+        case T_Insert:
+            state[0] = appendToTailOfList(state[0], ((Insert *) node)->insertTableName);
+            break;
+        case T_Update:
+            state[0] = appendToTailOfList(state[0], ((Update *) node)->updateTableName);
+            break;
+        case T_Delete:
+            state[0] = appendToTailOfList(state[0], ((Delete *) node)->deleteTableName);
+            break;
+        case T_FunctionCall:
+            state[1] = appendToTailOfList(state[1], ((FunctionCall *) node)->functionname);
+            break;
+        case T_WithStmt:
+            FOREACH(KeyValue,v,((WithStmt *) node)->withViews)
+                state[2] = appendToTailOfList(state[2], STRING_VALUE(v->key));
+            break;
+        default:
+            break;
+    }
+
+    return visit(node, findCatalogObjects, state);
+}
+
 static void
 adaptIdentifiers (Node *stmt)
 {
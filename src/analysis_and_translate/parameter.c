@@ -33,7 +33,6 @@ typedef struct ParByNameState
 static boolean findParamVisitor(Node *node, List **state);
 static Node *replaceParamMutator (Node *node, List *state);
 static Node *replaceParamByNameMutator (Node *node, ParByNameState *state);
-static Constant *createBindConstant (char *value);
 
 Node *
 applyBinds(ParameterizedQuery *p, List *values)
@@ -179,9 +178,12 @@ oracleBindToConsts (char *binds)
  * For now we try to infer the type of bind variable from its string
  * representation. Is there a better way?
  */
-static Constant *
+Constant *
 createBindConstant (char *value)
 {
+    if(value == NULL)
+        return createNullConst(DT_STRING);
+
     if(regExMatch("^[0-9][0-9]*$",value))
         return createConstLong(atol(value));
 
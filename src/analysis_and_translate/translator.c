@@ -53,8 +53,12 @@ translateParse(Node *q)
     ASSERT(plugin);
 
     NEW_AND_ACQUIRE_MEMCONTEXT("TRANSLATOR_CONTEXT");
+    START_TIMER("module - analyzer");
     q = analyzeParseModel(q);
+    STOP_TIMER("module - analyzer");
+    START_TIMER("module - translator");
     result = plugin->translateParse(q);
+    STOP_TIMER("module - translator");
 
     FREE_MEM_CONTEXT_AND_RETURN_COPY(Node,result);
 }
@@ -85,10 +85,14 @@ char *connection_db = NULL;
 char *connection_user = NULL;
 char *connection_passwd = NULL;
 int connection_port = 0;
+int connection_pool_size = 1;
 
 // backend specific options
 char *oracle_audit_log_table = NULL;
 boolean oracle_use_service_name = FALSE;
+int sqlite_stmt_cache_size = 64;
+boolean prefetch_catalog = FALSE;
+boolean dict_encode_results = FALSE;
 
 char *odbc_driver = NULL;
 
@@ -119,12 +123,16 @@ char *plugin_cbo = NULL;
 boolean opt_inputdb = FALSE;
 boolean opt_timing = FALSE;
 boolean opt_memmeasure = FALSE;
+boolean opt_backend_instrumentation = FALSE;
 boolean opt_graphviz_output = FALSE;
 boolean opt_graphviz_detail = FALSE;
 boolean opt_show_query_runtime = FALSE;
 char *time_query_format = NULL;
 int query_repeat_count = 1;
 boolean opt_show_query_result = TRUE;
+boolean opt_batch_mode = FALSE;
+char *profile_format = NULL;
+char *profile_file = NULL;
 
 // rewrite options
 boolean opt_aggressive_model_checking = FALSE;
@@ -136,6 +144,8 @@ boolean opt_pi_cs_composable = FALSE;
 boolean opt_pi_cs_rewrite_agg_window = FALSE;
 boolean opt_optimize_operator_model = FALSE;
 boolean opt_translate_update_with_case = FALSE;
+boolean opt_prepared_rewrite_use_model = FALSE;
+boolean opt_materialize_shared_views = FALSE;
 //boolean   = FALSE;
 
 // cost based optimization option
@@ -146,6 +156,12 @@ int cost_sim_ann_const = 10;
 int cost_sim_ann_cooldown_rate = 5;
 int cost_based_num_heuristic_opt_iterations = 1;
 
+// number of threads used to optimize independent subgraphs concurrently
+int optimizer_threads = 1;
+
+// apply local optimization rules only to changed operators until fixpoint
+boolean optimizer_rule_fixpoint = FALSE;
+
 // optimization options
 boolean opt_optimization_push_selections = FALSE;
 boolean opt_optimization_merge_ops = FALSE;
@@ -163,6 +179,8 @@ boolean opt_optimization_pull_up_duplicate_remove_operators = FALSE;
 
 // optimization options for group by operator
 boolean opt_optimization_push_down_aggregation_through_join = FALSE;
+boolean opt_optimization_share_common_subplans = FALSE;
+boolean opt_optimization_join_reorder = FALSE;
 
 // sanity check options
 boolean opt_operator_model_unique_schema_attribues = FALSE;
@@ -175,6 +193,7 @@ boolean opt_operator_model_data_structure_consistency = FALSE;
 boolean temporal_use_coalesce =	 TRUE;
 boolean temporal_use_normalization = TRUE;
 boolean temporal_use_normalization_window = FALSE;
+boolean temporal_use_coalesce_window = FALSE;
 boolean temporal_agg_combine_with_norm = TRUE;
 
 // lateral rewrite for nesting operator
@@ -190,10 +209,16 @@ boolean ps_binary_search_case_when = FALSE;
 boolean ps_settings = FALSE;
 boolean ps_set_bits = FALSE;
 boolean ps_use_brin_op = FALSE;
+char *ps_use_predicate = NULL;
+int ps_use_max_ranges = 32;
 boolean ps_analyze = TRUE;
 boolean ps_use_nest = FALSE;
 boolean ps_post_to_oracle = FALSE;
 char *ps_store_table = NULL;
+boolean ps_maintain = FALSE;
+boolean ps_sample_histogram = FALSE;
+int ps_histogram_sample_size = 30000;
+char *bucket_assignment = NULL;
 
 // Uncertainty rewriter options
 boolean range_optimize_join = TRUE;
@@ -366,6 +391,14 @@ OptionInfo opts[] =
                 wrapOptionInt(&connection_port),
                 defOptionInt(1521)
         },
+        {
+                OPTION_CONN_POOL_SIZE,
+                "-pool_size",
+                "Maximal number of connections to the backend DB (additional connections are used to overlap backend calls). Temporary tables are not visible on additional connections.",
+                OPTION_INT,
+                wrapOptionInt(&connection_pool_size),
+                defOptionInt(1)
+        },
         // backend specific options
         {
                 OPTION_ORACLE_AUDITTABLE,
@@ -383,6 +416,30 @@ OptionInfo opts[] =
                 wrapOptionString(&oracle_use_service_name),
                 defOptionBool(FALSE)
         },
+        {
+                OPTION_SQLITE_STMT_CACHE_SIZE,
+                "-Bsqlite.stmt_cache_size",
+                "Number of prepared statements cached per SQLite connection (0 deactivates caching)",
+                OPTION_INT,
+                wrapOptionInt(&sqlite_stmt_cache_size),
+                defOptionInt(64)
+        },
+        {
+                OPTION_PREFETCH_CATALOG,
+                "-Bprefetch_catalog",
+                "Lookup catalog information for all tables and functions of a query in bulk before analyzing the query.",
+                OPTION_BOOL,
+                wrapOptionBool(&prefetch_catalog),
+                defOptionBool(FALSE)
+        },
+        {
+                OPTION_DICT_ENCODE_RESULTS,
+                "-Bdict_encode_results",
+                "Store query results dictionary encoded per column instead of as one string per value.",
+                OPTION_BOOL,
+                wrapOptionBool(&dict_encode_results),
+                defOptionBool(FALSE)
+        },
         {
                 OPTION_ODBC_DRIVER,
                 "-Bodbc.driver",
@@ -575,6 +632,15 @@ OptionInfo opts[] =
                 wrapOptionBool(&opt_memmeasure),
                 defOptionBool(FALSE)
         },
+        {
+                OPTION_BACKEND_INSTRUMENTATION,
+                "-backend_instrumentation",
+                "count calls, round trips to the backend, bytes transferred and "
+                "latency (histogram) for each metadata lookup function.",
+                OPTION_BOOL,
+                wrapOptionBool(&opt_backend_instrumentation),
+                defOptionBool(FALSE)
+        },
         aRewriteOption(OPTION_GRAPHVIZ,
                 "-show_graphviz",
                 "output created relational algebra graphs as graphviz scripts.",
@@ -613,6 +679,32 @@ OptionInfo opts[] =
                 "show query result (only makes a difference for executor <run>).",
                 opt_show_query_result,
                 TRUE),
+        aRewriteOption(OPTION_BATCH_MODE,
+                "-batch",
+                "process a script with multiple statements one statement at a time. "
+                "If the backend supports it, the next statement is rewritten while "
+                "the previous one is still running (only makes a difference for executor <run>).",
+                opt_batch_mode,
+                FALSE),
+        {
+                OPTION_PROFILE_FORMAT,
+                "-profile_format",
+                "record a profile (phases with runtime and memory allocations, "
+                "operator counts, backend round trips) for each query and output it "
+                "in this format: json or chrome (Chrome trace events).",
+                OPTION_STRING,
+                wrapOptionString(&profile_format),
+                defOptionString(NULL)
+        },
+        {
+                OPTION_PROFILE_FILE,
+                "-profile_file",
+                "append query profiles to this file (one line per query). If not set, "
+                "profiles are written to the log (level INFO).",
+                OPTION_STRING,
+                wrapOptionString(&profile_file),
+                defOptionString(NULL)
+        },
         // boolean rewrite options
         aRewriteOption(OPTION_AGGRESSIVE_MODEL_CHECKING,
                 "-aggressive_model_checking",
@@ -672,6 +764,19 @@ OptionInfo opts[] =
 				"Activate aggregation reduction model rewrite",
 				opt_agg_reduction_model_rewrite,
 				FALSE),
+		aRewriteOption(OPTION_PREPARED_REWRITE_USE_MODEL,
+				"-prepared_rewrite_use_model",
+				"Instantiate prepared rewrites by substituting binds into the cached "
+				"rewritten operator model and serializing it instead of substituting "
+				"binds into the cached SQL code.",
+				opt_prepared_rewrite_use_model,
+				FALSE),
+		aRewriteOption(OPTION_MATERIALIZE_SHARED_VIEWS,
+				"-materialize_shared_views",
+				"Declare WITH views for operators with multiple parents as MATERIALIZED "
+				"(only supported by the postgres SQL serializer, requires Postgres 12+).",
+				opt_materialize_shared_views,
+				FALSE),
         // Optimization Options
         {
                 OPTION_OPTIMIZE_OPERATOR_MODEL,
@@ -729,6 +834,24 @@ OptionInfo opts[] =
                  wrapOptionInt(&cost_based_num_heuristic_opt_iterations),
                  defOptionInt(1)
          },
+         {
+                 OPTION_OPTIMIZER_THREADS,
+                 "-optimizer_threads",
+                 "Optimization: number of threads used to apply the heuristic optimization "
+                 "rules to independent subgraphs of a query (e.g., inputs of unions) concurrently",
+                 OPTION_INT,
+                 wrapOptionInt(&optimizer_threads),
+                 defOptionInt(1)
+         },
+         {
+                 OPTION_OPTIMIZER_RULE_FIXPOINT,
+                 "-optimizer_rule_fixpoint",
+                 "Optimization: track which operators are changed by optimization rules and "
+                 "reapply operator-local rules only to changed operators until fixpoint",
+                 OPTION_BOOL,
+                 wrapOptionBool(&optimizer_rule_fixpoint),
+                 defOptionBool(FALSE)
+         },
          {
         		 OPTION_MAX_NUMBER_PARTITIONS_FOR_USE,
                  "-cmax_number_paritions_for_uses",
@@ -753,6 +876,30 @@ OptionInfo opts[] =
 				 wrapOptionString(&ps_store_table),
 				 defOptionString(NULL)
 		 },
+		 {
+				 OPTION_PS_MAINTAIN,
+				 "-ps_maintain",
+				 "maintain cached provenance sketches incrementally when tables are modified",
+				 OPTION_BOOL,
+				 wrapOptionBool(&ps_maintain),
+				 defOptionBool(FALSE)
+		 },
+		 {
+				 OPTION_PS_SAMPLE_HISTOGRAM,
+				 "-ps_sample_histogram",
+				 "compute histograms for range partitioning from a sample instead of using backend statistics",
+				 OPTION_BOOL,
+				 wrapOptionBool(&ps_sample_histogram),
+				 defOptionBool(FALSE)
+		 },
+		 {
+				 OPTION_PS_HISTOGRAM_SAMPLE_SIZE,
+				 "-ps_histogram_sample_size",
+				 "number of values sampled to compute a histogram for range partitioning",
+				 OPTION_INT,
+				 wrapOptionInt(&ps_histogram_sample_size),
+				 defOptionInt(30000)
+		 },
 		 {
 				 OPTION_PS_BINARY_SEARCH,
 				 "-ps_binary_search",
@@ -769,6 +916,15 @@ OptionInfo opts[] =
 				 wrapOptionBool(&ps_binary_search_case_when),
 				 defOptionBool(FALSE)
 		 },
+		 {
+				 OPTION_BUCKET_ASSIGNMENT,
+				 "-bucket_assignment",
+				 "How to assign values to ranges (sketch fragments, compressed ranges): "
+				 "auto, width_bucket, array_search, or case_tree",
+				 OPTION_STRING,
+				 wrapOptionString(&bucket_assignment),
+				 defOptionString("auto")
+		 },
 		 {
 				 OPTION_PS_SETTINGS,
 				 "-ps_settings",
@@ -817,10 +973,29 @@ OptionInfo opts[] =
 				 wrapOptionBool(&ps_use_brin_op),
 				 defOptionBool(FALSE)
 		 },
+		 {
+				 OPTION_PS_USE_PREDICATE,
+				 "-ps_use_predicate",
+				 "Predicate used to filter tables with a provenance sketch: "
+				 "auto, ranges, in_list, or brin",
+				 OPTION_STRING,
+				 wrapOptionString(&ps_use_predicate),
+				 defOptionString("auto")
+		 },
+		 {
+				 OPTION_PS_USE_MAX_RANGES,
+				 "-ps_use_max_ranges",
+				 "Maximal number of ranges of adjacent fragments for which a provenance sketch "
+				 "is used with a disjunction of range predicates (for ps_use_predicate auto)",
+				 OPTION_INT,
+				 wrapOptionInt(&ps_use_max_ranges),
+				 defOptionInt(32)
+		 },
         // AGM (Query operator model) individual optimizations
         anOptimizationOption(OPTIMIZATION_SELECTION_PUSHING,
                 "-Opush_selections",
-                "Optimization: Activate selection move-around",
+                "Optimization: push selections through projections, aggregations "
+                "(on group-by attributes), set operations, and duplicate removal",
                 opt_optimization_push_selections,
                 FALSE
         ),
@@ -891,7 +1066,8 @@ OptionInfo opts[] =
         ),
         anOptimizationOption(OPTIMIZATION_SELECTION_PUSHING_THROUGH_JOINS,
                 "-Opush_selections_through_joins",
-                "Optimization: try to push selections through joins",
+                "Optimization: try to push selections through joins (and all "
+                "operators supported by push_selections)",
                 opt_optimization_push_selections_through_joins,
                 FALSE
         ),
@@ -907,6 +1083,20 @@ OptionInfo opts[] =
 				opt_optimization_push_down_aggregation_through_join,
 				TRUE
 		),
+		anOptimizationOption(OPTIMIZATION_SHARE_COMMON_SUBPLANS,
+				"-Oshare_common_subplans",
+				"Optimization: merge structurally equal subplans into one operator "
+				"that is computed once (as a WITH view)",
+				opt_optimization_share_common_subplans,
+				FALSE
+		),
+		anOptimizationOption(OPTIMIZATION_JOIN_REORDER,
+				"-Ojoin_reorder",
+				"Optimization: reorder trees of inner joins based on cardinality "
+				"estimates computed from catalog statistics",
+				opt_optimization_join_reorder,
+				FALSE
+		),
         // temporal database options for coalesce and normalization
         anTemporaldbOption(TEMPORAL_USE_COALSECE,
                 "-temporal_use_coalesce",
@@ -925,6 +1115,12 @@ OptionInfo opts[] =
                 "Temporaldb: Activate normalization using window",
 				temporal_use_normalization_window,
                 FALSE
+        ),
+		anTemporaldbOption(TEMPORAL_USE_COALESCE_WINDOW,
+                "-temporal_use_coalesce_window",
+                "Temporaldb: Coalesce in a single pass using window functions",
+				temporal_use_coalesce_window,
+                FALSE
         ),
         anTemporaldbOption(TEMPORAL_AGG_WITH_NORM,
                 "-temporal_agg_combine_with_norm",
@@ -21,10 +21,11 @@ typedef void (*ExceptionCallbackFunction) (const char *,const char *,int,int);
 
 // callback function
 static GProMExceptionCallbackFunctionInternal exceptionCallback = NULL;
-static ExceptionSeverity severity;
-static const char *exceptionMessage = NULL;
-static const char *file = NULL;
-static int line = -1;
+// information about the last exception thrown by this thread
+static THREAD_LOCAL ExceptionSeverity severity;
+static THREAD_LOCAL const char *exceptionMessage = NULL;
+static THREAD_LOCAL const char *file = NULL;
+static THREAD_LOCAL int line = -1;
 static void sigsegv_handler(int signo);
 static char *wipeContext = QUERY_MEM_CONTEXT;
 
@@ -41,7 +42,7 @@ static char filenameBuffer[FALLBACK_BUFFER_SIZE];
 #define EXCEPTION_CONTEXT "_EXCEPTION_HANDLING_CONTEXT"
 
 // for storing pointer to long jmp stack
-sigjmp_buf *exceptionBuf = NULL;
+THREAD_LOCAL sigjmp_buf *exceptionBuf = NULL;
 
 // information about exception
 void
@@ -172,6 +173,12 @@ currentExceptionToString(void)
     return result->data;
 }
 
+ExceptionSeverity
+currentExceptionSeverity(void)
+{
+    return severity;
+}
+
 void
 setWipeContext(char *wContext)
 {
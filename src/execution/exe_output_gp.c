@@ -13,6 +13,7 @@
 #include "common.h"
 
 #include "log/logger.h"
+#include "exception/exception.h"
 #include "mem_manager/mem_mgr.h"
 #include "utility/string_utils.h"
 #include "execution/exe_output_gp.h"
@@ -125,8 +126,7 @@ executeOutputGP(void *sql)
     StringInfo script = makeStringInfo();
     StringInfo edges = makeStringInfo();
     HashMap *noteTypes = NEW_MAP(Constant,Set);
-    Vector *queryRes;
-    Relation *r;
+    Vector *t;
 
     for (int i = 0; i < NUM_ELEM_GPNodeType; i++)
         MAP_ADD_INT_KEY(noteTypes, i, STRSET());
@@ -134,55 +134,65 @@ executeOutputGP(void *sql)
     // append pre fix
     appendStringInfoString(script, DOT_PREFIX);
 
-    // execute GP query
+    // execute GP query, edges are processed while the result is streamed
     sql = replaceSubstr((char *) sql, ";", "");
-    r = executeQuery(sql);
-    queryRes = r->tuples;
+    openResultStream(sql);
 
     // loop through query result creating edges and caching nodes
     // add loop
 	int i = 0;
 	List *existingNodes = NIL;
 
-    FOREACH_VEC(Vector,t,queryRes)
+    TRY
     {
-        Set *nodes;
-		char **tuplev = VEC_TO_ARR(t, char);
-
-        char *lRawId = tuplev[0];
-        lRawId = strtrim(lRawId);
-        GPNodeType lType = getNodeType(lRawId);
-        char *lId = getNodeId(lRawId);
-        nodes = (Set *) MAP_GET_INT(noteTypes, lType);
-        addToSet(nodes, lRawId);
-
-        char *rRawId = (char *) tuplev[1];
-        rRawId = strtrim(rRawId);
-        GPNodeType rType = getNodeType(rRawId);
-        char *rId = getNodeId(rRawId);
-
-        if(rType == GP_NODE_NUMPROVRECALL)
+        while((t = nextStreamTuple()) != NULL)
         {
-        	if(searchListString(existingNodes,rRawId))
-        		rRawId = CONCAT_STRINGS(rRawId,"_",gprom_itoa(i));
+            Set *nodes;
+			char **tuplev = VEC_TO_ARR(t, char);
+
+            char *lRawId = tuplev[0];
+            lRawId = strtrim(lRawId);
+            GPNodeType lType = getNodeType(lRawId);
+            char *lId = getNodeId(lRawId);
+            nodes = (Set *) MAP_GET_INT(noteTypes, lType);
+            addToSet(nodes, lRawId);
+
+            char *rRawId = (char *) tuplev[1];
+            rRawId = strtrim(rRawId);
+            GPNodeType rType = getNodeType(rRawId);
+            char *rId = getNodeId(rRawId);
+
+            if(rType == GP_NODE_NUMPROVRECALL)
+            {
+                if(searchListString(existingNodes,rRawId))
+                    rRawId = CONCAT_STRINGS(rRawId,"_",gprom_itoa(i));
 
-       		existingNodes = appendToTailOfList(existingNodes,rRawId);
-       		i++;
-        }
+                existingNodes = appendToTailOfList(existingNodes,rRawId);
+                i++;
+            }
 
-        nodes = (Set *) MAP_GET_INT(noteTypes, rType);
-        addToSet(nodes, rRawId);
+            nodes = (Set *) MAP_GET_INT(noteTypes, rType);
+            addToSet(nodes, rRawId);
 
-        DEBUG_LOG("edge <%s - %s> between nodes of types %s, %s", lRawId, rRawId,
-                GPNodeTypeToString(lType), GPNodeTypeToString(rType));
+            DEBUG_LOG("edge <%s - %s> between nodes of types %s, %s", lRawId, rRawId,
+                    GPNodeTypeToString(lType), GPNodeTypeToString(rType));
 
-        // create edge
-        if (rType == GP_NODE_HYPEREDGE || rType == GP_NODE_GOALHYPEREDGE)
-            appendStringInfo(edges, DOT_UNDIR_EDGE_TEMP, lId, rId);
-        else if(rType != GP_NODE_NUMPROVRECALL)
-            appendStringInfo(edges, DOT_EDGE_TEMP, lId, rId);
+            // create edge
+            if (rType == GP_NODE_HYPEREDGE || rType == GP_NODE_GOALHYPEREDGE)
+                appendStringInfo(edges, DOT_UNDIR_EDGE_TEMP, lId, rId);
+            else if(rType != GP_NODE_NUMPROVRECALL)
+                appendStringInfo(edges, DOT_EDGE_TEMP, lId, rId);
+        }
+    }
+    ON_EXCEPTION
+    {
+        // the connection cannot be used for other queries while the stream is open
+        closeResultStream();
+        RETHROW();
     }
+    END_ON_EXCEPTION
 
+    closeResultStream();
 
     // store the num prov + recall
     HashMap *numProvRecall = NEW_MAP(Constant,Constant);
@@ -12,6 +12,8 @@
 
 #include "common.h"
 #include "log/logger.h"
+#include "exception/exception.h"
+#include "mem_manager/mem_mgr.h"
 #include "model/relation/relation.h"
 #include "metadata_lookup/metadata_lookup.h"
 #include "execution/exe_run_query.h"
@@ -20,7 +22,20 @@
 #include "provenance_rewriter/game_provenance/gp_bottom_up_program.h"
 
 static void outputResult(Relation *res);
+static void outputStreamedResult(char *query);
+static int *determineColSizes(Relation *r);
+static void outputHeader(List *schema, int *colSizes);
+static void outputTuple(Relation *r, int row, int *colSizes);
 static void printDBsample(List *stmts);
+static void printQueryTime(struct timeval *st, struct timeval *et, boolean showResult);
+static char *stripTrailingSemicolon(char *code);
+
+// number of tuples of a streamed result that are read before they are printed
+#define OUTPUT_BATCH_SIZE 1000
+
+// statement of a batch that is still running on the backend
+static boolean batchStmtPending = FALSE;
+static struct timeval batchStmtStart;
 
 
 void
@@ -32,13 +47,8 @@ exeRunQuery (void *code)
     boolean showTime = getBoolOption(OPTION_TIME_QUERIES);
     struct timeval st;
     struct timeval et;
-    char *format = getStringOption(OPTION_TIME_QUERY_OUTPUT_FORMAT);	
     int repeats = getIntOption(OPTION_REPEAT_QUERY);
 
-	// replace \n with new line in format string
-	if (format != NULL)
-		format = replaceSubstr(format, "\\n", "\n");
-
 	if (getBoolOption(OPTION_INPUTDB))
 	{
 		List *codes = splitString(code, ";");
@@ -59,7 +69,9 @@ exeRunQuery (void *code)
             gettimeofday(&st, NULL);
         }
 
-        if (showResult)
+        if (showResult && supportsResultStreaming())
+            outputStreamedResult((char *) adaptedQuery);
+        else if (showResult)
             res = executeQuery((char *) adaptedQuery);
         else
             executeQueryIgnoreResult((char *) adaptedQuery);
@@ -69,31 +81,109 @@ exeRunQuery (void *code)
             gettimeofday(&et, NULL);
         }
 
-        if (showResult == TRUE)
+        if (showResult == TRUE && res != NULL)
         {
             outputResult(res);
         }
 
         if (showTime)
-        {
-            long usecDiff;
-            long secDiff;
-            double msecs;
+            printQueryTime(&st, &et, showResult);
+    }
+}
 
-            secDiff = et.tv_sec - st.tv_sec;
-            usecDiff = et.tv_usec - st.tv_usec;
+/*
+ * Execute one statement of a batch. If the backend supports asynchronous
+ * execution we only send the statement and return. The caller can then
+ * rewrite the next statement while this one is running. The result is
+ * fetched (and printed) when the next statement is submitted or when the
+ * batch is finished.
+ */
+void
+exeRunQueryBatchStmt (void *code)
+{
+    char *adaptedQuery;
 
-            msecs = secDiff * 1000 + (((double) usecDiff) / 1000.0);
-            if (showResult)
-                printf("\n");
+    exeRunQueryFinishBatch();
 
-            if (format != NULL)
-                printf(format, msecs);
-            else
-                printf("query took %12f msec\n", msecs);
-            fflush(stdout);
-        }
+    if (!supportsAsyncExecution()
+            || getIntOption(OPTION_REPEAT_QUERY) > 1
+            || getBoolOption(OPTION_INPUTDB))
+    {
+        exeRunQuery(code);
+        return;
     }
+
+    adaptedQuery = stripTrailingSemicolon((char *) code);
+    INFO_LOG("send batch statement:\n%s", adaptedQuery);
+
+    gettimeofday(&batchStmtStart, NULL);
+    sendQuery(adaptedQuery);
+    batchStmtPending = TRUE;
+}
+
+void
+exeRunQueryFinishBatch (void)
+{
+    boolean showResult = getBoolOption(OPTION_SHOW_QUERY_RESULT);
+    struct timeval et;
+    Relation *res;
+
+    if (!batchStmtPending)
+        return;
+
+    // reset first, if the statement failed we do not want to fetch again
+    batchStmtPending = FALSE;
+    res = getQueryResult(!showResult);
+    gettimeofday(&et, NULL);
+
+    if (showResult)
+        outputResult(res);
+
+    // runtime of asynchronously executed statements includes the time spend on rewriting the next statement
+    if (getBoolOption(OPTION_TIME_QUERIES))
+        printQueryTime(&batchStmtStart, &et, showResult);
+}
+
+static void
+printQueryTime(struct timeval *st, struct timeval *et, boolean showResult)
+{
+    char *format = getStringOption(OPTION_TIME_QUERY_OUTPUT_FORMAT);
+    long usecDiff;
+    long secDiff;
+    double msecs;
+
+	// replace \n with new line in format string
+	if (format != NULL)
+		format = replaceSubstr(format, "\\n", "\n");
+
+    secDiff = et->tv_sec - st->tv_sec;
+    usecDiff = et->tv_usec - st->tv_usec;
+
+    msecs = secDiff * 1000 + (((double) usecDiff) / 1000.0);
+    if (showResult)
+        printf("\n");
+
+    if (format != NULL)
+        printf(format, msecs);
+    else
+        printf("query took %12f msec\n", msecs);
+    fflush(stdout);
+}
+
+/*
+ * Remove the semicolon terminating a single statement (unlike the
+ * replacement done in exeRunQuery this keeps semicolons in string literals).
+ */
+static char *
+stripTrailingSemicolon(char *code)
+{
+    char *result = strdup(code);
+    int i = strlen(result) - 1;
+
+    while(i >= 0 && (isspace(result[i]) || result[i] == ';'))
+        result[i--] = '\0';
+
+    return result;
 }
 
 static void
@@ -120,38 +210,114 @@ printDBsample(List *stmts)
 static void
 outputResult(Relation *res)
 {
-    int *colSizes;
-    int numCol;
-    int totalSize = 0;
+    int *colSizes = determineColSizes(res);
+
+    outputHeader(res->schema, colSizes);
+
+    // output results
+	FOREACH_REL_TUPLE(it,res)
+	{
+        outputTuple(res, it.row, colSizes);
+
+        if ((it.row % 1000) == 0)
+            fflush(stdout);
+	}
+}
+
+/*
+ * Print the result of a query while it is read from the backend. Tuples are
+ * read in batches of OUTPUT_BATCH_SIZE that are freed once they have been
+ * printed, so results of any size are printed in constant memory. Column
+ * widths are determined from the first batch, longer values of later tuples
+ * are not padded.
+ */
+static void
+outputStreamedResult(char *query)
+{
+    MemContext *batchContext = NEW_MEM_CONTEXT("QueryResultBatchContext");
+    List *schema = openResultStream(query);
+    int *colSizes = NULL;
+    boolean done = FALSE;
+
+    TRY
+    {
+        while(!done)
+        {
+            Relation *batch;
+            Vector *tuple = NULL;
+
+            // streamed tuples are in row format
+            ACQUIRE_MEM_CONTEXT(batchContext);
+            batch = makeRelation(schema);
+            while(VEC_LENGTH(batch->tuples) < OUTPUT_BATCH_SIZE && (tuple = nextStreamTuple()) != NULL)
+                VEC_ADD_NODE(batch->tuples, tuple);
+            done = (tuple == NULL);
+            RELEASE_MEM_CONTEXT();
+
+            if (colSizes == NULL)
+            {
+                colSizes = determineColSizes(batch);
+                outputHeader(schema, colSizes);
+            }
+
+            FOREACH_REL_TUPLE(it,batch)
+                outputTuple(batch, it.row, colSizes);
+            fflush(stdout);
+
+            ACQUIRE_MEM_CONTEXT(batchContext);
+            CLEAR_CUR_MEM_CONTEXT();
+            RELEASE_MEM_CONTEXT();
+        }
+    }
+    ON_EXCEPTION
+    {
+        // the connection cannot be used for other queries while the stream is open
+        closeResultStream();
+        RETHROW();
+    }
+    END_ON_EXCEPTION
+
+    closeResultStream();
+    FREE_MEM_CONTEXT(batchContext);
+}
+
+static int *
+determineColSizes(Relation *r)
+{
+    int numCols = getRelationNumColumns(r);
+    int *colSizes = MALLOC(MAX(numCols,1) * sizeof(int));
     int i = 0;
-    int l = 0;
-    numCol = LIST_LENGTH(res->schema);
-    colSizes = MALLOC(numCol * sizeof(int));
 
-    // determine column sizes
-    i = 0;
-    FOREACH(char,a,res->schema)
+    FOREACH(char,a,r->schema)
     {
         colSizes[i++] = strlen(a) + 2;
     }
 
-    FOREACH_VEC(Vector,t,res->tuples)
+    FOREACH_REL_TUPLE(it,r)
     {
-        i = 0;
-        FOREACH_VEC(char,a,t)
+        for(i = 0; i < numCols; i++)
         {
+            char *a = REL_ITER_VALUE(it,i);
             int len = a ? strlen(a) : 4;
             colSizes[i] = colSizes[i] < len + 2 ? len + 2 : colSizes[i];
-            i++;
         }
     }
 
-    for (i = 0; i < numCol; i++)
+    return colSizes;
+}
+
+static void
+outputHeader(List *schema, int *colSizes)
+{
+    int totalSize = 0;
+    int i = 0;
+
+    for (i = 0; i < LIST_LENGTH(schema); i++)
         totalSize += colSizes[i] + 1;
 
     // output columns
     i = 0;
-    FOREACH(char,a,res->schema)
+    FOREACH(char,a,schema)
     {
         printf(" %s", a);
         for(int j = strlen(a) + 1; j < colSizes[i]; j++)
@@ -163,40 +329,19 @@ outputResult(Relation *res)
     for (int j = 0; j < totalSize; j++)
         printf("-");
     printf("\n");
+}
 
-    // output results
-	FOREACH_VEC(Vector,t,res->tuples)
-	{
-		i = 0;
-		FOREACH_VEC(char,a,t)
-		{
-            char *out = a ? a : "NULL";
-            printf(" %s", out);
-            for(int j = strlen(out) + 1; j < colSizes[i]; j++)
-                printf(" ");
-            printf("|");
-            i++;
-		}
-		printf("\n");
-				
-        if ((l++ % 1000) == 0)
-            fflush(stdout);
-	}
-    /* FOREACH(List,t,res->tuples) */
-    /* { */
-    /*     i = 0; */
-    /*     FOREACH(char,a,t) */
-    /*     { */
-    /*         char *out = a ? a : "NULL"; */
-    /*         printf(" %s", out); */
-    /*         for(int j = strlen(out) + 1; j < colSizes[i]; j++) */
-    /*             printf(" "); */
-    /*         printf("|"); */
-    /*         i++; */
-    /*     } */
-    /*     printf("\n"); */
-
-    /*     if ((l++ % 1000) == 0) */
-    /*         fflush(stdout); */
-    /* } */
+static void
+outputTuple(Relation *r, int row, int *colSizes)
+{
+    for(int i = 0; i < getRelationNumColumns(r); i++)
+    {
+        char *a = getRelationValue(r, row, i);
+        char *out = a ? a : "NULL";
+        printf(" %s", out);
+        for(int j = strlen(out) + 1; j < colSizes[i]; j++)
+            printf(" ");
+        printf("|");
+    }
+    printf("\n");
 }
@@ -32,6 +32,26 @@ execute (void *code)
     plugin->execute(code);
 }
 
+void
+executeBatchStatement (void *code)
+{
+    ASSERT(plugin);
+
+    if (plugin->executeBatchStmt)
+        plugin->executeBatchStmt(code);
+    else
+        plugin->execute(code);
+}
+
+void
+finishBatchExecution (void)
+{
+    ASSERT(plugin);
+
+    if (plugin->finishBatch)
+        plugin->finishBatch();
+}
+
 // plugin management
 void
 chooseExecutorPlugin(ExecutorPluginType type)
@@ -47,6 +67,8 @@ chooseExecutorPlugin(ExecutorPluginType type)
             break;
         case EXECUTOR_PLUGIN_RUN_QUERY:
             plugin->execute = exeRunQuery;
+            plugin->executeBatchStmt = exeRunQueryBatchStmt;
+            plugin->finishBatch = exeRunQueryFinishBatch;
             break;
         case EXECUTOR_PLUGIN_OUTPUT_DATALOG:
             plugin->execute = executeOutputDL;
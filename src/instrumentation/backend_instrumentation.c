@@ -0,0 +1,325 @@
+/*-----------------------------------------------------------------------------
+ *
+ * backend_instrumentation.c
+ *			  Statistics for calls to the metadata lookup plugin and round trips
+ *			  to the backend database.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "common.h"
+#include "uthash.h"
+
+#include "mem_manager/mem_mgr.h"
+#include "configuration/option.h"
+#include "log/logger.h"
+#include "model/node/nodetype.h"
+#include "instrumentation/query_profile.h"
+#include "instrumentation/backend_instrumentation.h"
+
+// statistics for one entry point of the metadata lookup interface
+typedef struct BackendCallStats
+{
+    char *name;
+    long calls;
+    long roundTrips;
+    unsigned long bytes;
+    long totalUsec;
+    long maxUsec;
+    long latency[BACKEND_LATENCY_BUCKETS];
+    UT_hash_handle hh;
+} BackendCallStats;
+
+// an entry point call that has not returned yet
+typedef struct RunningCall
+{
+    const char *name;
+    long start;
+    unsigned long roundTripBytes;
+} RunningCall;
+
+#define MAX_CALL_DEPTH 32
+#define NO_ENTRY_POINT "other"
+
+// variables
+static MemContext *sessionContext = NULL;
+static MemContext *queryContext = NULL;
+static MemContext *outputContext = NULL;
+static BackendCallStats *sessionStats = NULL;
+static BackendCallStats *queryStats = NULL;
+static RunningCall callStack[MAX_CALL_DEPTH];
+static int callDepth = 0;
+
+static const char *bucketNames[BACKEND_LATENCY_BUCKETS] = {
+        "<10us", "<100us", "<1ms", "<10ms", "<100ms", "<1s", ">=1s"
+};
+
+// static functions
+static long getTimeUsec (void);
+static int getLatencyBucket (long usec);
+static BackendCallStats *getOrCreateStats (BackendCallStats **stats, const char *name);
+static void recordCall (BackendCallStats *s, long usec, unsigned long bytes);
+static void statsToJSON (StringInfo str, BackendCallStats *stats);
+
+boolean
+isBackendInstrumentationActive(void)
+{
+    return opt_backend_instrumentation || isProfilingQuery();
+}
+
+void
+backendCallStart(const char *entryPoint)
+{
+    if (callDepth < MAX_CALL_DEPTH)
+    {
+        callStack[callDepth].name = entryPoint;
+        callStack[callDepth].start = getTimeUsec();
+        callStack[callDepth].roundTripBytes = 0;
+    }
+    callDepth++;
+}
+
+/*
+ * An entry point returns. Bytes are the size of the result as seen by the
+ * interface, they are only used if the plugin has not reported round trips
+ * with their size itself.
+ */
+void
+backendCallEnd(const char *entryPoint, unsigned long bytes)
+{
+    RunningCall *c;
+    long usec;
+
+    // calls that did not return because of an exception are skipped
+    while (callDepth > 0 && callDepth <= MAX_CALL_DEPTH
+            && !streq(callStack[callDepth - 1].name, entryPoint))
+        callDepth--;
+
+    if (callDepth == 0)
+        return;
+
+    callDepth--;
+    if (callDepth >= MAX_CALL_DEPTH)
+        return;
+
+    c = &(callStack[callDepth]);
+    usec = getTimeUsec() - c->start;
+    bytes = (c->roundTripBytes > 0) ? 0 : bytes;
+
+    if (opt_backend_instrumentation)
+    {
+        if (sessionContext == NULL)
+            sessionContext = NEW_LONGLIVED_MEMCONTEXT(BACKEND_INSTRUMENTATION_CONTEXT_NAME);
+        if (queryContext == NULL)
+            queryContext = NEW_LONGLIVED_MEMCONTEXT(BACKEND_INSTRUMENTATION_CONTEXT_NAME);
+
+        ACQUIRE_MEM_CONTEXT(sessionContext);
+        recordCall(getOrCreateStats(&sessionStats, entryPoint), usec, bytes);
+        RELEASE_MEM_CONTEXT();
+
+        ACQUIRE_MEM_CONTEXT(queryContext);
+        recordCall(getOrCreateStats(&queryStats, entryPoint), usec, bytes);
+        RELEASE_MEM_CONTEXT();
+    }
+
+    if (isProfilingQuery())
+    {
+        profileIncrCounter(CONCAT_STRINGS("backend_calls.", (char *) entryPoint), 1);
+        profileIncrCounter(CONCAT_STRINGS("backend_usec.", (char *) entryPoint), usec);
+    }
+}
+
+/*
+ * Called by plugins for each request sent to the database. The round trip
+ * is attributed to the innermost running entry point.
+ */
+void
+recordBackendRoundTrip(unsigned long bytes)
+{
+    const char *name = NO_ENTRY_POINT;
+    BackendCallStats *s;
+
+    PROFILE_INCR_COUNTER(PROFILE_COUNTER_BACKEND_ROUND_TRIPS, 1);
+
+    if (!opt_backend_instrumentation)
+        return;
+
+    if (callDepth > 0 && callDepth <= MAX_CALL_DEPTH)
+    {
+        name = callStack[callDepth - 1].name;
+        callStack[callDepth - 1].roundTripBytes += bytes;
+    }
+
+    if (sessionContext == NULL)
+        sessionContext = NEW_LONGLIVED_MEMCONTEXT(BACKEND_INSTRUMENTATION_CONTEXT_NAME);
+    if (queryContext == NULL)
+        queryContext = NEW_LONGLIVED_MEMCONTEXT(BACKEND_INSTRUMENTATION_CONTEXT_NAME);
+
+    ACQUIRE_MEM_CONTEXT(sessionContext);
+    s = getOrCreateStats(&sessionStats, name);
+    s->roundTrips++;
+    s->bytes += bytes;
+    RELEASE_MEM_CONTEXT();
+
+    ACQUIRE_MEM_CONTEXT(queryContext);
+    s = getOrCreateStats(&queryStats, name);
+    s->roundTrips++;
+    s->bytes += bytes;
+    RELEASE_MEM_CONTEXT();
+}
+
+/*
+ * Forget statistics of the previous query.
+ */
+void
+backendInstrumentationStartQuery(void)
+{
+    callDepth = 0;
+
+    if (queryContext != NULL)
+    {
+        HASH_CLEAR(hh, queryStats);
+        FREE_MEM_CONTEXT(queryContext);
+        queryContext = NULL;
+    }
+    queryStats = NULL;
+}
+
+/*
+ * Return statistics for the session or the current query as a JSON object.
+ * The result is valid until the next call of this function.
+ */
+char *
+backendStatsToJSON(boolean currentQueryOnly)
+{
+    StringInfo str;
+
+    if (outputContext != NULL)
+        FREE_MEM_CONTEXT(outputContext);
+    outputContext = NEW_LONGLIVED_MEMCONTEXT(BACKEND_INSTRUMENTATION_CONTEXT_NAME);
+    ACQUIRE_MEM_CONTEXT(outputContext);
+
+    str = makeStringInfo();
+    statsToJSON(str, currentQueryOnly ? queryStats : sessionStats);
+
+    RELEASE_MEM_CONTEXT();
+    return str->data;
+}
+
+void
+outputBackendStats(void)
+{
+    BackendCallStats *s;
+    int maxNameLength = 30;
+
+    for(s = sessionStats; s != NULL; s = s->hh.next)
+    {
+        int len = strlen(s->name);
+        maxNameLength = (maxNameLength < len) ? len : maxNameLength;
+    }
+
+    for(s = sessionStats; s != NULL; s = s->hh.next)
+    {
+        printf("backend: %-*s - calls: %9ld round trips: %9ld bytes: %12lu total: %12f sec max: %12f sec |",
+                maxNameLength,
+                s->name,
+                s->calls,
+                s->roundTrips,
+                s->bytes,
+                ((double) s->totalUsec) / 1000000.0,
+                ((double) s->maxUsec) / 1000000.0);
+        for(int i = 0; i < BACKEND_LATENCY_BUCKETS; i++)
+            printf(" %s: %ld", bucketNames[i], s->latency[i]);
+        printf("\n");
+    }
+}
+
+void
+shutdownBackendInstrumentation(void)
+{
+    HASH_CLEAR(hh, sessionStats);
+    HASH_CLEAR(hh, queryStats);
+
+    if (sessionContext != NULL)
+        FREE_MEM_CONTEXT(sessionContext);
+    if (queryContext != NULL)
+        FREE_MEM_CONTEXT(queryContext);
+    if (outputContext != NULL)
+        FREE_MEM_CONTEXT(outputContext);
+
+    sessionContext = queryContext = outputContext = NULL;
+    callDepth = 0;
+}
+
+static long
+getTimeUsec (void)
+{
+    struct timeval st;
+
+    gettimeofday(&st, NULL);
+
+    return st.tv_sec * 1000000 + st.tv_usec;
+}
+
+static int
+getLatencyBucket (long usec)
+{
+    int bucket = 0;
+    long bound = 10;
+
+    while (bucket < BACKEND_LATENCY_BUCKETS - 1 && usec >= bound)
+    {
+        bound *= 10;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+static BackendCallStats *
+getOrCreateStats (BackendCallStats **stats, const char *name)
+{
+    BackendCallStats *s = NULL;
+
+    HASH_FIND_STR(*stats, name, s);
+
+    if (s == NULL)
+    {
+        s = NEW(BackendCallStats);
+        s->name = strdup((char *) name);
+        HASH_ADD_KEYPTR(hh, *stats, s->name, strlen(s->name), s);
+    }
+
+    return s;
+}
+
+static void
+recordCall (BackendCallStats *s, long usec, unsigned long bytes)
+{
+    s->calls++;
+    s->bytes += bytes;
+    s->totalUsec += usec;
+    s->maxUsec = (usec > s->maxUsec) ? usec : s->maxUsec;
+    s->latency[getLatencyBucket(usec)]++;
+}
+
+static void
+statsToJSON (StringInfo str, BackendCallStats *stats)
+{
+    BackendCallStats *s;
+
+    appendStringInfoString(str, "{\"entry_points\": [");
+    for(s = stats; s != NULL; s = s->hh.next)
+    {
+        appendStringInfo(str, "{\"name\": \"%s\", \"calls\": %ld, \"round_trips\": %ld, "
+                "\"bytes\": %lu, \"total_usec\": %ld, \"max_usec\": %ld, \"latency_hist\": {",
+                s->name, s->calls, s->roundTrips, s->bytes, s->totalUsec, s->maxUsec);
+        for(int i = 0; i < BACKEND_LATENCY_BUCKETS; i++)
+            appendStringInfo(str, "%s\"%s\": %ld", i == 0 ? "" : ", ",
+                    bucketNames[i], s->latency[i]);
+        appendStringInfoString(str, "}}");
+        if (s->hh.next != NULL)
+            appendStringInfoString(str, ", ");
+    }
+    appendStringInfoString(str, "]}");
+}
@@ -0,0 +1,464 @@
+/*-----------------------------------------------------------------------------
+ *
+ * query_profile.c
+ *			  Record a profile for each processed query. Phases are created
+ *			  from the timers used throughout the code (see
+ *			  timing_instrumentation.c), memory is tracked by the memory
+ *			  manager which reports how many bytes have been allocated in
+ *			  total and in each freed context.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "common.h"
+#include "mem_manager/mem_mgr.h"
+#include "configuration/option.h"
+#include "log/logger.h"
+#include "model/expression/expression.h"
+#include "model/list/list.h"
+#include "model/set/hashmap.h"
+#include "utility/string_utils.h"
+#include "utility/thread_pool.h"
+#include "instrumentation/query_profile.h"
+
+// a phase of query processing
+typedef struct ProfilePhase
+{
+    char *name;
+    long start;                 // usec since start of the query
+    long end;
+    unsigned long allocStart;
+    unsigned long allocBytes;
+    boolean isRunning;
+    List *children;
+    struct ProfilePhase *parent;
+} ProfilePhase;
+
+// profile for one query
+typedef struct QueryProfile
+{
+    char *query;
+    long startTime;
+    ProfilePhase *root;
+    ProfilePhase *cur;
+    HashMap *contextAllocs;     // context name -> bytes allocated in the context
+    HashMap *counters;          // counter name -> value
+    MemContext *queryContext;   // context that was active when the query started
+    unsigned long queryContextAllocStart;
+    unsigned long overhead;     // bytes allocated for the profile itself
+} QueryProfile;
+
+// variables
+static MemContext *context = NULL;
+static QueryProfile *profile = NULL;
+static char *lastProfile = NULL;
+static boolean inProfileCode = FALSE;
+
+// static functions
+static long getTimeUsec (void);
+static unsigned long getAllocatedBytes (void);
+static ProfilePhase *newPhase (char *name, ProfilePhase *parent);
+static void closePhase (ProfilePhase *p);
+static char *profileToJSON (QueryProfile *p);
+static void phaseToJSON (StringInfo str, ProfilePhase *p);
+static char *profileToChromeTrace (QueryProfile *p);
+static void phaseToChromeTrace (StringInfo str, ProfilePhase *p);
+static void mapToJSON (StringInfo str, HashMap *m);
+static void appendJSONString (StringInfo str, char *s);
+static void writeProfile (char *p);
+
+/*
+ * Allocations done for the profile should not be attributed to the phases of
+ * the query. We keep track of them and subtract them.
+ */
+#define ACQUIRE_PROFILE_CONTEXT() \
+    unsigned long _allocBefore = getTotalAllocatedBytes(); \
+    inProfileCode = TRUE; \
+    ACQUIRE_MEM_CONTEXT(context)
+
+#define RELEASE_PROFILE_CONTEXT() \
+    do { \
+        RELEASE_MEM_CONTEXT(); \
+        if (profile != NULL) \
+            profile->overhead += getTotalAllocatedBytes() - _allocBefore; \
+        inProfileCode = FALSE; \
+    } while (0)
+
+void
+profileStartQuery(char *query)
+{
+    if (getStringOption(OPTION_PROFILE_FORMAT) == NULL || inProfileCode)
+        return;
+
+    // the previous profile is discarded
+    inProfileCode = TRUE;
+    if (context != NULL)
+        FREE_MEM_CONTEXT(context);
+    context = NEW_LONGLIVED_MEMCONTEXT(PROFILE_CONTEXT_NAME);
+    profile = NULL;
+    lastProfile = NULL;
+    inProfileCode = FALSE;
+
+    MemContext *queryContext = getCurMemContext();
+
+    ACQUIRE_PROFILE_CONTEXT();
+
+    profile = NEW(QueryProfile);
+    profile->queryContext = queryContext;
+    profile->queryContextAllocStart = queryContext->allocatedBytes;
+    profile->query = query ? strdup(query) : strdup("");
+    profile->startTime = getTimeUsec();
+    profile->contextAllocs = NEW_MAP(Constant,Constant);
+    profile->counters = NEW_MAP(Constant,Constant);
+    profile->overhead = 0;
+    profile->root = newPhase("query", NULL);
+    profile->cur = profile->root;
+
+    RELEASE_PROFILE_CONTEXT();
+}
+
+void
+profileEndQuery(void)
+{
+    char *format = getStringOption(OPTION_PROFILE_FORMAT);
+
+    if (!isProfilingQuery())
+        return;
+
+    // the context of the query is typically only freed after the query is done
+    if (getCurMemContext() == profile->queryContext)
+        profileAddContextAllocation(profile->queryContext->contextName,
+                profile->queryContext->allocatedBytes - profile->queryContextAllocStart);
+
+    ACQUIRE_PROFILE_CONTEXT();
+
+    // phases that have not been stopped end with the query
+    while(profile->cur != NULL)
+    {
+        closePhase(profile->cur);
+        profile->cur = profile->cur->parent;
+    }
+
+    if (strieq(format, PROFILE_FORMAT_CHROME))
+        lastProfile = profileToChromeTrace(profile);
+    else
+        lastProfile = profileToJSON(profile);
+
+    writeProfile(lastProfile);
+
+    RELEASE_PROFILE_CONTEXT();
+    profile = NULL;
+}
+
+boolean
+isProfilingQuery(void)
+{
+    return profile != NULL && !inProfileCode;
+}
+
+void
+profileStartPhase(char *name)
+{
+    if (!isProfilingQuery())
+        return;
+
+    ACQUIRE_PROFILE_CONTEXT();
+    profile->cur = newPhase(name, profile->cur);
+    RELEASE_PROFILE_CONTEXT();
+}
+
+/*
+ * Stop the innermost running phase with this name. Phases that were started
+ * within this phase and are still running are stopped too.
+ */
+void
+profileEndPhase(char *name)
+{
+    ProfilePhase *p;
+
+    if (!isProfilingQuery())
+        return;
+
+    for(p = profile->cur; p != NULL && p != profile->root; p = p->parent)
+    {
+        if (streq(p->name, name))
+            break;
+    }
+
+    // no running phase with this name (was started before the query)
+    if (p == NULL || p == profile->root)
+        return;
+
+    ACQUIRE_PROFILE_CONTEXT();
+    while(profile->cur != p)
+    {
+        closePhase(profile->cur);
+        profile->cur = profile->cur->parent;
+    }
+    closePhase(p);
+    profile->cur = p->parent;
+    RELEASE_PROFILE_CONTEXT();
+}
+
+void
+profileIncrCounter(char *name, long value)
+{
+    // the profile is not shared with worker threads
+    if (!isProfilingQuery() || isWorkerThread())
+        return;
+
+    ACQUIRE_PROFILE_CONTEXT();
+    if (MAP_HAS_STRING_KEY(profile->counters, name))
+        LONG_VALUE(MAP_GET_STRING(profile->counters, name)) += value;
+    else
+        MAP_ADD_STRING_KEY(profile->counters, name, createConstLong(value));
+    RELEASE_PROFILE_CONTEXT();
+}
+
+void
+profileAddContextAllocation(char *contextName, unsigned long bytes)
+{
+    if (!isProfilingQuery() || streq(contextName, PROFILE_CONTEXT_NAME))
+        return;
+
+    ACQUIRE_PROFILE_CONTEXT();
+    if (MAP_HAS_STRING_KEY(profile->contextAllocs, contextName))
+        LONG_VALUE(MAP_GET_STRING(profile->contextAllocs, contextName)) += bytes;
+    else
+        MAP_ADD_STRING_KEY(profile->contextAllocs, contextName, createConstLong(bytes));
+    RELEASE_PROFILE_CONTEXT();
+}
+
+/*
+ * Returns the profile of the last query in the format determined by option
+ * profile_format. The string is valid until the next query is processed.
+ */
+char *
+getLastQueryProfile(void)
+{
+    return lastProfile;
+}
+
+void
+shutdownQueryProfiling(void)
+{
+    if (context != NULL)
+    {
+        inProfileCode = TRUE;
+        FREE_MEM_CONTEXT(context);
+        inProfileCode = FALSE;
+    }
+    context = NULL;
+    profile = NULL;
+    lastProfile = NULL;
+}
+
+static long
+getTimeUsec (void)
+{
+    struct timeval st;
+
+    gettimeofday(&st, NULL);
+
+    return st.tv_sec * 1000000 + st.tv_usec;
+}
+
+static unsigned long
+getAllocatedBytes (void)
+{
+    return getTotalAllocatedBytes() - profile->overhead;
+}
+
+static ProfilePhase *
+newPhase (char *name, ProfilePhase *parent)
+{
+    ProfilePhase *p = NEW(ProfilePhase);
+
+    p->name = strdup(name);
+    p->start = getTimeUsec() - (profile->startTime);
+    p->end = p->start;
+    p->allocStart = getAllocatedBytes();
+    p->allocBytes = 0;
+    p->isRunning = TRUE;
+    p->children = NIL;
+    p->parent = parent;
+
+    if (parent != NULL)
+        parent->children = appendToTailOfList(parent->children, p);
+
+    return p;
+}
+
+static void
+closePhase (ProfilePhase *p)
+{
+    p->end = getTimeUsec() - profile->startTime;
+    p->allocBytes = getAllocatedBytes() - p->allocStart;
+    p->isRunning = FALSE;
+}
+
+static char *
+profileToJSON (QueryProfile *p)
+{
+    StringInfo str = makeStringInfo();
+
+    appendStringInfoString(str, "{\"query\": ");
+    appendJSONString(str, p->query);
+    appendStringInfo(str, ", \"total_usec\": %ld, \"alloc_bytes\": %lu",
+            p->root->end - p->root->start, p->root->allocBytes);
+    appendStringInfoString(str, ", \"counters\": ");
+    mapToJSON(str, p->counters);
+    appendStringInfoString(str, ", \"mem_contexts\": ");
+    mapToJSON(str, p->contextAllocs);
+    appendStringInfoString(str, ", \"phases\": [");
+    FOREACH(ProfilePhase,c,p->root->children)
+    {
+        phaseToJSON(str, c);
+        if (FOREACH_HAS_MORE(c))
+            appendStringInfoString(str, ", ");
+    }
+    appendStringInfoString(str, "]}");
+
+    return str->data;
+}
+
+static void
+phaseToJSON (StringInfo str, ProfilePhase *p)
+{
+    appendStringInfoString(str, "{\"name\": ");
+    appendJSONString(str, p->name);
+    appendStringInfo(str, ", \"start_usec\": %ld, \"duration_usec\": %ld, \"alloc_bytes\": %lu",
+            p->start, p->end - p->start, p->allocBytes);
+
+    if (p->children != NIL)
+    {
+        appendStringInfoString(str, ", \"phases\": [");
+        FOREACH(ProfilePhase,c,p->children)
+        {
+            phaseToJSON(str, c);
+            if (FOREACH_HAS_MORE(c))
+                appendStringInfoString(str, ", ");
+        }
+        appendStringInfoString(str, "]");
+    }
+
+    appendStringInfoString(str, "}");
+}
+
+/*
+ * Chrome trace event format: one complete event ("ph": "X") per phase and a
+ * counter event ("ph": "C") for the counters of the query.
+ */
+static char *
+profileToChromeTrace (QueryProfile *p)
+{
+    StringInfo str = makeStringInfo();
+
+    appendStringInfoString(str, "{\"traceEvents\": [");
+    appendStringInfo(str, "{\"name\": \"query\", \"cat\": \"gprom\", \"ph\": \"X\", "
+            "\"ts\": %ld, \"dur\": %ld, \"pid\": 1, \"tid\": 1, \"args\": {\"query\": ",
+            p->startTime, p->root->end - p->root->start);
+    appendJSONString(str, p->query);
+    appendStringInfo(str, ", \"alloc_bytes\": %lu, \"mem_contexts\": ", p->root->allocBytes);
+    mapToJSON(str, p->contextAllocs);
+    appendStringInfoString(str, "}}");
+
+    FOREACH(ProfilePhase,c,p->root->children)
+        phaseToChromeTrace(str, c);
+
+    appendStringInfo(str, ", {\"name\": \"counters\", \"cat\": \"gprom\", \"ph\": \"C\", "
+            "\"ts\": %ld, \"pid\": 1, \"tid\": 1, \"args\": ",
+            p->startTime + p->root->end);
+    mapToJSON(str, p->counters);
+    appendStringInfoString(str, "}]}");
+
+    return str->data;
+}
+
+static void
+phaseToChromeTrace (StringInfo str, ProfilePhase *p)
+{
+    appendStringInfoString(str, ", {\"name\": ");
+    appendJSONString(str, p->name);
+    appendStringInfo(str, ", \"cat\": \"gprom\", \"ph\": \"X\", \"ts\": %ld, \"dur\": %ld, "
+            "\"pid\": 1, \"tid\": 1, \"args\": {\"alloc_bytes\": %lu}}",
+            profile->startTime + p->start, p->end - p->start, p->allocBytes);
+
+    FOREACH(ProfilePhase,c,p->children)
+        phaseToChromeTrace(str, c);
+}
+
+static void
+mapToJSON (StringInfo str, HashMap *m)
+{
+    boolean first = TRUE;
+
+    appendStringInfoString(str, "{");
+    FOREACH_HASH_ENTRY(kv,m)
+    {
+        if (!first)
+            appendStringInfoString(str, ", ");
+        appendJSONString(str, STRING_VALUE(kv->key));
+        appendStringInfo(str, ": %ld", LONG_VALUE(kv->value));
+        first = FALSE;
+    }
+    appendStringInfoString(str, "}");
+}
+
+static void
+appendJSONString (StringInfo str, char *s)
+{
+    appendStringInfoChar(str, '"');
+    for(char *c = s; *c != '\0'; c++)
+    {
+        switch(*c)
+        {
+            case '"':
+                appendStringInfoString(str, "\\\"");
+                break;
+            case '\\':
+                appendStringInfoString(str, "\\\\");
+                break;
+            case '\n':
+                appendStringInfoString(str, "\\n");
+                break;
+            case '\r':
+                appendStringInfoString(str, "\\r");
+                break;
+            case '\t':
+                appendStringInfoString(str, "\\t");
+                break;
+            default:
+                if ((unsigned char) *c < 0x20)
+                    appendStringInfo(str, "\\u%04x", (unsigned int) *c);
+                else
+                    appendStringInfoChar(str, *c);
+        }
+    }
+    appendStringInfoChar(str, '"');
+}
+
+/*
+ * Append the profile as one line to the file given by option profile_file.
+ */
+static void
+writeProfile (char *p)
+{
+    char *fName = getStringOption(OPTION_PROFILE_FILE);
+    FILE *f;
+
+    if (fName == NULL)
+    {
+        INFO_LOG("query profile: %s", p);
+        return;
+    }
+
+    f = fopen(fName, "a");
+    if (f == NULL)
+    {
+        ERROR_LOG("could not open profile file %s: %s", fName, strerror(errno));
+        return;
+    }
+    fprintf(f, "%s\n", p);
+    fclose(f);
+}
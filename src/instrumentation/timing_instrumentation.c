@@ -19,6 +19,8 @@
 #include "model/expression/expression.h"
 #include "model/list/list.h"
 #include "instrumentation/timing_instrumentation.h"
+#include "instrumentation/query_profile.h"
+#include "utility/thread_pool.h"
 
 // store timings and summary data for a certain timer
 typedef struct Timer
@@ -78,6 +80,12 @@ startTimer(char *name, int line, const char *function, const char *sourceFile)
     Timer *t = NULL;
     struct timeval st;
 
+    // timers are not shared with worker threads
+    if (isWorkerThread())
+        return;
+
+    profileStartPhase(name);
+
     if(!isRewriteOptionActivated(OPTION_TIMING))
         return;
 
@@ -105,6 +113,11 @@ endTimer(char *name, int line, const char *function, const char *sourceFile)
     Timer *t;
     struct timeval st;
 
+    if (isWorkerThread())
+        return;
+
+    profileEndPhase(name);
+
     if(!isRewriteOptionActivated("timing"))
         return;
 
@@ -129,7 +142,7 @@ isTimerRunning(char *name)
   Timer *t;
   boolean isRunning = FALSE;
 
-  if (!isRewriteOptionActivated("timing"))
+  if (!isRewriteOptionActivated("timing") || isWorkerThread())
     return isRunning;
 
   HASH_FIND_STR(allTimers, name, t);
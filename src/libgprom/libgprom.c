@@ -19,6 +19,10 @@
 #include "rewriter.h"
 #include "metadata_lookup/metadata_lookup.h"
 #include "metadata_lookup/metadata_lookup_external.h"
+#include "analysis_and_translate/parameter.h"
+#include "parameterized_query/parameterized_queries.h"
+#include "instrumentation/query_profile.h"
+#include "instrumentation/backend_instrumentation.h"
 
 #define LIBARY_REWRITE_CONTEXT "LIBGRPROM_QUERY_CONTEXT"
 
@@ -131,6 +135,84 @@ gprom_rewriteQuery(const char *query)
     return returnResult;
 }
 
+boolean
+gprom_prepareRewrite(const char *name, const char *query)
+{
+    volatile boolean result = FALSE;
+    LOCK_MUTEX();
+    TRY
+    {
+        prepareRewrite((char *) name, (char *) query);
+        result = TRUE;
+    }
+    ON_EXCEPTION
+    {
+        ERROR_LOG("\nLIBGPROM Error occured\n%s", currentExceptionToString());
+    }
+    END_ON_EXCEPTION
+    UNLOCK_MUTEX();
+    return result;
+}
+
+const char *
+gprom_rewritePrepared(const char *name, int numBinds, const char *binds[])
+{
+    LOCK_MUTEX();
+    NEW_AND_ACQUIRE_MEMCONTEXT(LIBARY_REWRITE_CONTEXT);
+    char *result = "";
+    char * volatile  returnResult = NULL;
+    TRY
+    {
+        List *bindConsts = NIL;
+
+        for(int i = 0; i < numBinds; i++)
+            bindConsts = appendToTailOfList(bindConsts, createBindConstant((char *) binds[i]));
+
+        result = rewritePrepared((char *) name, bindConsts);
+        RELEASE_MEM_CONTEXT_AND_CREATE_STRING_COPY(result,returnResult);
+    }
+    ON_EXCEPTION
+    {
+        ERROR_LOG("\nLIBGPROM Error occured\n%s", currentExceptionToString());
+        returnResult = NULL;
+    }
+    END_ON_EXCEPTION
+    UNLOCK_MUTEX();
+    return returnResult;
+}
+
+void
+gprom_dropPreparedRewrite(const char *name)
+{
+    LOCK_MUTEX();
+    removePreparedRewrite((char *) name);
+    UNLOCK_MUTEX();
+}
+
+const char *
+gprom_getLastProfile(void)
+{
+    const char *result;
+
+    LOCK_MUTEX();
+    result = getLastQueryProfile();
+    UNLOCK_MUTEX();
+
+    return result;
+}
+
+const char *
+gprom_getBackendStats(boolean lastQueryOnly)
+{
+    const char *result;
+
+    LOCK_MUTEX();
+    result = backendStatsToJSON(lastQueryOnly);
+    UNLOCK_MUTEX();
+
+    return result;
+}
+
 const gprom_long_t
 gprom_costQuery(const char *query)
 {
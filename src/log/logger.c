@@ -47,6 +47,22 @@ struct logger_state
 typedef void (*LoggerCallbackFunction) (const char *,const char *,int,int);
 static LoggerCallbackFunction logCallback = NULL;
 
+// the buffer is shared by all threads (recursive, because a callback may log)
+#if defined(HAVE_LIBPTHREAD) && ! defined(OS_WINDOWS)
+static pthread_mutex_t logLock;
+static pthread_once_t logLockOnce = PTHREAD_ONCE_INIT;
+static void initLogLock(void);
+#define LOCK_LOGGER() \
+    do { \
+        pthread_once(&logLockOnce, initLogLock); \
+        pthread_mutex_lock(&logLock); \
+    } while (0)
+#define UNLOCK_LOGGER() pthread_mutex_unlock(&logLock)
+#else
+#define LOCK_LOGGER()
+#define UNLOCK_LOGGER()
+#endif
+
 /* internal inlined functions */
 static inline char *getHead(LogLevel level);
 static inline FILE *getOutput(LogLevel level);
@@ -58,6 +74,19 @@ static boolean vAppendBuf(StringInfo str, const char *format, va_list args);
 #undef malloc
 #endif
 
+#if defined(HAVE_LIBPTHREAD) && ! defined(OS_WINDOWS)
+static void
+initLogLock(void)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&logLock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+#endif
+
 void
 registerLogCallback (LoggerCallbackFunction callback)
 {
@@ -136,6 +165,8 @@ log_(LogLevel level, const char *file, unsigned line, const char *template, ...)
     {
         boolean success = FALSE;
         FILE *out = getOutput(level);
+
+        LOCK_LOGGER();
         buffer->len = 0;
         buffer->cursor = 0;
         buffer->data[0] = '\0';
@@ -155,6 +186,7 @@ log_(LogLevel level, const char *file, unsigned line, const char *template, ...)
             //printf("\nCALL LOGGER ********************************************\n");
             //fflush(stdout);
             logCallback(buffer->data, file, line, level);
+            UNLOCK_LOGGER();
             return;
         }
 
@@ -182,6 +214,7 @@ log_(LogLevel level, const char *file, unsigned line, const char *template, ...)
         // flush output stream
         fprintf(out, "\n");
         fflush(out);
+        UNLOCK_LOGGER();
     }
 }
 
@@ -277,6 +310,9 @@ char *
 formatMes(const char *template, ...)
 {
     boolean success = FALSE;
+    char *returnValue;
+
+    LOCK_LOGGER();
     buffer->len = 0;
     buffer->cursor = 0;
     buffer->data[0] = '\0';
@@ -292,13 +328,15 @@ formatMes(const char *template, ...)
     }
 
     if (memManagerUsable())
-        return strdup(buffer->data);
+        returnValue = strdup(buffer->data);
     else
     {
-        char *returnValue = malloc(buffer->len); // change after we have REALLOC
+        returnValue = malloc(buffer->len); // change after we have REALLOC
         memcpy(returnValue, buffer->data, buffer->len + 1);
-        return returnValue;
     }
+    UNLOCK_LOGGER();
+
+    return returnValue;
 }
 
 static boolean
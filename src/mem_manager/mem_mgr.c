@@ -20,6 +20,8 @@
 #include "uthash.h"
 #include "instrumentation/timing_instrumentation.h"
 #include "instrumentation/memory_instrumentation.h"
+#include "instrumentation/query_profile.h"
+#include "utility/thread_pool.h"
 
 #define DEFAULT_MEM_CONTEXT_NAME "DEFAULT_MEMORY_CONTEXT"
 
@@ -73,12 +75,24 @@ static char *contextStackToString(void);
 static char *memContextToString(MemContext *m, boolean overviewOnly);
 static void internalFreeMemContext (MemContext *m, const char *file, unsigned line);
 
-static MemContext *curMemContext = NULL; // global pointer to current memory context
+// the context stack is per thread, worker threads start with a stack of their own (see initMemManagerThread)
+static THREAD_LOCAL MemContext *curMemContext = NULL; // pointer to current memory context of this thread
 static MemContext *defaultMemContext = NULL;
-static MemContextNode *topContextNode = NULL;
-static int contextStackSize = 0;
+static THREAD_LOCAL MemContextNode *topContextNode = NULL;
+static THREAD_LOCAL int contextStackSize = 0;
 static boolean destroyed = FALSE;
 static boolean initialized = FALSE;
+static THREAD_LOCAL unsigned long totalAllocatedBytes = 0; // bytes allocated in all contexts by this thread
+static unsigned long workerAllocatedBytes = 0; // bytes allocated by worker threads that have finished
+
+#if defined(HAVE_LIBPTHREAD) && ! defined(OS_WINDOWS)
+static pthread_mutex_t workerBytesLock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK_WORKER_BYTES() pthread_mutex_lock(&workerBytesLock)
+#define UNLOCK_WORKER_BYTES() pthread_mutex_unlock(&workerBytesLock)
+#else
+#define LOCK_WORKER_BYTES()
+#define UNLOCK_WORKER_BYTES()
+#endif
 
 struct mem_manager
 {
@@ -151,6 +165,46 @@ destroyMemManager(void)
     destroyed = TRUE;
 }
 
+/*
+ * Prepare the memory manager for use by a worker thread. The thread's
+ * context stack only holds threadContext which plays the role of the default
+ * context for the thread. The thread context has to be freed by the thread
+ * that created it after the worker has called shutdownMemManagerThread.
+ */
+void
+initMemManagerThread(MemContext *threadContext)
+{
+    if (!initialized || destroyed)
+    {
+        EXIT_WITH_ERROR("trying to use memory manager in a thread before it has been initialized");
+    }
+
+    topContextNode = calloc(1, sizeof(MemContextNode));
+    topContextNode->mc = threadContext;
+    contextStackSize = 1;
+    curMemContext = threadContext;
+    totalAllocatedBytes = 0;
+}
+
+/*
+ * Clear the context stack of a worker thread without freeing its contexts.
+ */
+void
+shutdownMemManagerThread(void)
+{
+    while (topContextNode->next)
+        RELEASE_MEM_CONTEXT();
+    free(topContextNode);
+    topContextNode = NULL;
+    curMemContext = NULL;
+    contextStackSize = 0;
+
+    LOCK_WORKER_BYTES();
+    workerAllocatedBytes += totalAllocatedBytes;
+    UNLOCK_WORKER_BYTES();
+    totalAllocatedBytes = 0;
+}
+
 boolean
 memManagerUsable(void)
 {
@@ -424,6 +478,7 @@ newMemContext(char *contextName, const char *file, unsigned line, boolean longLi
     mc->numChunks = 1;
     mc->unusedBytes = 0;
     mc->freedUnusedBytes = 0;
+    mc->allocatedBytes = 0;
     mc->longLived = longLived;
 
     /* create first chunk */
@@ -538,6 +593,11 @@ internalFreeMemContext (MemContext *m, const char *file, unsigned line)
 {
     int size = memContextSize(m);
     char *name = m->contextName;
+
+    // report allocations of this context to the profile of the current query (not tracked for worker threads)
+    if (m->allocatedBytes > 0 && !isWorkerThread())
+        profileAddContextAllocation(name, m->allocatedBytes);
+
     if (size > 0)
         clearAMemContext(m, file, line);
     free(m->chunks);
@@ -710,6 +770,8 @@ malloc_(size_t bytes, const char *file, unsigned line)
     void *mem = c->curAllocPos;
     c->curAllocPos += bytes;
     c->memLeftInChunk -= bytes;
+    c->allocatedBytes += bytes;
+    totalAllocatedBytes += bytes;
 //    memset(mem, 178, bytes);
 //    if (mem == NULL)
 //    {
@@ -749,6 +811,8 @@ calloc_(size_t bytes, unsigned count, const char *file, unsigned line)
     memset(c->curAllocPos,0,allocSize);
     c->curAllocPos += allocSize;
     c->memLeftInChunk -= allocSize;
+    c->allocatedBytes += allocSize;
+    totalAllocatedBytes += allocSize;
 
 
     if (mem == NULL)
@@ -805,3 +869,15 @@ getDefaultMemContext(void)
 {
     return defaultMemContext;
 }
+
+unsigned long
+getTotalAllocatedBytes(void)
+{
+    unsigned long result;
+
+    LOCK_WORKER_BYTES();
+    result = totalAllocatedBytes + workerAllocatedBytes;
+    UNLOCK_WORKER_BYTES();
+
+    return result;
+}
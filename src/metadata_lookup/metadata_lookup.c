@@ -12,11 +12,14 @@
 
 #include "common.h"
 #include "instrumentation/timing_instrumentation.h"
+#include "instrumentation/backend_instrumentation.h"
 
 #include "mem_manager/mem_mgr.h"
 #include "log/logger.h"
+#include "configuration/option.h"
 #include "metadata_lookup/metadata_lookup_odbc.h"
 #include "model/list/list.h"
+#include "model/set/vector.h"
 #include "model/query_operator/query_operator.h"
 #include "metadata_lookup/metadata_lookup.h"
 #include "metadata_lookup/metadata_lookup_oracle.h"
@@ -26,6 +29,7 @@
 #include "metadata_lookup/metadata_lookup_duckdb.h"
 #include "metadata_lookup/metadata_lookup_monetdb.h"
 #include "metadata_lookup/metadata_lookup_mssql.h"
+#include "utility/thread_pool.h"
 
 #define PLUGIN_NAME_ORACLE "oracle"
 #define PLUGIN_NAME_POSTGRES "postgres"
@@ -36,11 +40,121 @@
 #define PLUGIN_NAME_MSSQL "mssql"
 #define PLUGIN_NAME_EXTERNAL "external"
 
+/*
+ * Wrappers run plugin methods in the plugin's memory context and record
+ * calls and latency of each entry point (see backend_instrumentation.h).
+ */
+#define ENTER_PLUGIN() \
+    do { \
+        LOCK_PLUGIN(); \
+        BACKEND_CALL_START(); \
+        ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext); \
+    } while (0)
+
+#define LEAVE_PLUGIN(bytes) \
+    do { \
+        RELEASE_MEM_CONTEXT(); \
+        BACKEND_CALL_END(bytes); \
+        UNLOCK_PLUGIN(); \
+    } while (0)
+
+// calls into the plugin from worker threads are serialized (the thread that
+// started the workers waits for them). The lock is recursive, because plugins
+// call wrappers like executeQuery themselves.
+#if defined(HAVE_LIBPTHREAD) && ! defined(OS_WINDOWS)
+static pthread_mutex_t pluginLock;
+static pthread_once_t pluginLockOnce = PTHREAD_ONCE_INIT;
+static THREAD_LOCAL int pluginLockDepth = 0;    // times this thread holds the lock
+static void initPluginLock(void);
+#define LOCK_PLUGIN() \
+    do { \
+        if (isWorkerThread()) \
+        { \
+            pthread_once(&pluginLockOnce, initPluginLock); \
+            pthread_mutex_lock(&pluginLock); \
+            pluginLockDepth++; \
+        } \
+    } while (0)
+#define UNLOCK_PLUGIN() \
+    do { \
+        if (isWorkerThread()) \
+        { \
+            pluginLockDepth--; \
+            pthread_mutex_unlock(&pluginLock); \
+        } \
+    } while (0)
+#else
+#define LOCK_PLUGIN()
+#define UNLOCK_PLUGIN()
+#endif
+
 MetadataLookupPlugin *activePlugin = NULL;
 List *availablePlugins = NIL;
 
+// materialized result returned by the stream functions if the plugin does not support streaming
+static Relation *streamedResult = NULL;
+static int streamPos = 0;
+
+// a streamed result is recorded as one call of openResultStream that returns once the stream is closed
+static boolean streamCallRunning = FALSE;
+static unsigned long streamBytes = 0;
+
+// connection pool: connections opened in addition to the plugin's own connection
+#define POOL_CONTEXT_NAME "CONNECTION_POOL_CONTEXT"
+
+#if defined(HAVE_LIBPTHREAD) && ! defined(OS_WINDOWS)
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK_POOL() pthread_mutex_lock(&poolLock)
+#define UNLOCK_POOL() pthread_mutex_unlock(&poolLock)
+#else
+#define LOCK_POOL()
+#define UNLOCK_POOL()
+#endif
+
+static MemContext *poolContext = NULL;
+static MetadataLookupPlugin *poolPlugin = NULL;     // plugin the pooled connections belong to
+static List *idleConnections = NIL;
+static int numPooledConnections = 0;                // idle and checked out connections
+
 static MetadataLookupPluginType stringToPluginType(char *type);
 static char *pluginTypeToString(MetadataLookupPluginType type);
+static unsigned long relationBytes(Relation *r);
+static unsigned long tupleBytes(Vector *t);
+static List *sampleHistogram (char *tableName, char *attrName, int numPartitions);
+static void keepSampleValue (char **slot, char *value);
+static int compareSampleNums (const void *a, const void *b);
+static int compareSampleStrings (const void *a, const void *b);
+static boolean isNumericValue (char *value);
+static void appendHistogramBound (StringInfo str, char *value);
+
+#if defined(HAVE_LIBPTHREAD) && ! defined(OS_WINDOWS)
+static void
+initPluginLock(void)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&pluginLock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+#endif
+
+/*
+ * Release the plugin lock held by a worker thread whose call into the plugin
+ * was aborted by an exception.
+ */
+void
+releasePluginLock(void)
+{
+#if defined(HAVE_LIBPTHREAD) && ! defined(OS_WINDOWS)
+    while (pluginLockDepth > 0)
+    {
+        pluginLockDepth--;
+        pthread_mutex_unlock(&pluginLock);
+    }
+#endif
+}
 
 /* create list of available plugins */
 int
@@ -177,6 +291,30 @@ pluginTypeToString(MetadataLookupPluginType type)
 }
 
 
+// size of the values of a query result
+static unsigned long
+relationBytes(Relation *r)
+{
+    if (r == NULL || !isBackendInstrumentationActive())
+        return 0;
+
+    return getRelationBytes(r);
+}
+
+static unsigned long
+tupleBytes(Vector *t)
+{
+    unsigned long bytes = 0;
+
+    if (t == NULL || !isBackendInstrumentationActive())
+        return 0;
+
+    FOREACH_VEC(char,v,t)
+        bytes += (v != NULL) ? strlen(v) : 0;
+
+    return bytes;
+}
+
 /* wrappers to plugin methods */
 int
 initMetadataLookupPlugin (void)
@@ -218,9 +356,9 @@ char *
 getConnectionDescription (void)
 {
     ASSERT(activePlugin);
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     char *result = activePlugin->connectionDescription();
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -228,9 +366,9 @@ boolean
 catalogTableExists (char * tableName)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     boolean result = activePlugin->catalogTableExists(tableName);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -238,19 +376,37 @@ boolean
 catalogViewExists (char * viewName)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     boolean result = activePlugin->catalogViewExists(viewName);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
+/*
+ * Let the plugin cache catalog information for the given tables (or views)
+ * and functions in bulk before they are looked up one at a time. Plugins
+ * for which a lookup is cheap do not implement this.
+ */
+void
+prefetchCatalog (List *tableNames, List *functionNames)
+{
+    if (tableNames == NIL && functionNames == NIL)
+        return;
+    ASSERT(activePlugin && activePlugin->isInitialized());
+    if (activePlugin->prefetchCatalog == NULL)
+        return;
+    ENTER_PLUGIN();
+    activePlugin->prefetchCatalog(tableNames, functionNames);
+    LEAVE_PLUGIN(0);
+}
+
 List *
 getAttributes (char *tableName)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     List *result = activePlugin->getAttributes(tableName);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -258,9 +414,9 @@ List *
 getAttributeNames (char *tableName)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     List *result = activePlugin->getAttributeNames(tableName);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -268,9 +424,9 @@ Node *
 getAttributeDefaultVal (char *schema, char *tableName, char *attrName)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     Node *result = activePlugin->getAttributeDefaultVal(schema, tableName,attrName);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -281,12 +437,12 @@ getAttributeDataTypes (char *tableName)
     List *attrs = NIL;
     ASSERT(activePlugin && activePlugin->isInitialized());
 
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     attrs = activePlugin->getAttributes(tableName);
     List *result = NIL;
     FOREACH(AttributeDef,a,attrs)
         result = appendToTailOfListInt(result, a->dataType);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -294,9 +450,9 @@ boolean
 isAgg(char *functionName)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     boolean result = activePlugin->isAgg(functionName);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -304,9 +460,9 @@ boolean
 isWindowFunction(char *functionName)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     boolean result = activePlugin->isWindowFunction(functionName);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -314,9 +470,9 @@ DataType
 getFuncReturnType (char *fName, List *argTypes, boolean *funcExists)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     DataType result = activePlugin->getFuncReturnType(fName, argTypes, funcExists);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -324,9 +480,9 @@ DataType
 getOpReturnType (char *oName, List *argTypes, boolean *funcExists)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     DataType result = activePlugin->getOpReturnType(oName, argTypes, funcExists);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -334,9 +490,9 @@ DataType
 backendSQLTypeToDT (char *sqlType)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     DataType result = activePlugin->sqlTypeToDT(sqlType);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -344,9 +500,9 @@ char *
 backendDatatypeToSQL (DataType dt)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     char *result = activePlugin->dataTypeToSQL(dt);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -355,9 +511,9 @@ char *
 getTableDefinition(char *tableName)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     char *result = activePlugin->getTableDefinition(tableName);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -365,9 +521,9 @@ char *
 getViewDefinition(char *viewName)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     char *result = activePlugin->getViewDefinition(viewName);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -375,9 +531,9 @@ List *
 getKeyInformation (char *tableName)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     List *result = activePlugin->getKeyInformation(tableName);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -386,9 +542,9 @@ getTransactionSQLAndSCNs (char *xid, List **scns, List **sqls,
         List **sqlBinds, IsolationLevel *iso, Constant *commitScn)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     activePlugin->getTransactionSQLAndSCNs(xid, scns, sqls, sqlBinds, iso, commitScn);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     //return result;
 }
 
@@ -396,9 +552,9 @@ Relation *
 executeQuery (char *sql)
 {
     //ASSERT(activePlugin && activePlugin->isInitialized() && activePlugin->executeQuery);
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     Relation *result = activePlugin->executeQuery(sql);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(relationBytes(result));
     return result;
 }
 
@@ -406,18 +562,233 @@ void
 executeQueryIgnoreResult (char *sql)
 {
     ASSERT(activePlugin && activePlugin->isInitialized() && activePlugin->executeQuery);
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     activePlugin->executeQueryIgnoreResult(sql);
+    LEAVE_PLUGIN(0);
+}
+
+boolean
+supportsAsyncExecution (void)
+{
+    return activePlugin != NULL && activePlugin->sendQuery != NULL
+            && activePlugin->getQueryResult != NULL;
+}
+
+void
+sendQuery (char *sql)
+{
+    ASSERT(activePlugin && activePlugin->isInitialized() && activePlugin->sendQuery);
+    ENTER_PLUGIN();
+    activePlugin->sendQuery(sql);
+    LEAVE_PLUGIN(0);
+}
+
+Relation *
+getQueryResult (boolean ignoreResult)
+{
+    ASSERT(activePlugin && activePlugin->isInitialized() && activePlugin->getQueryResult);
+    ENTER_PLUGIN();
+    Relation *result = activePlugin->getQueryResult(ignoreResult);
+    LEAVE_PLUGIN(relationBytes(result));
+    return result;
+}
+
+boolean
+supportsResultStreaming (void)
+{
+    return activePlugin != NULL && activePlugin->openResultStream != NULL
+            && activePlugin->nextStreamTuple != NULL
+            && activePlugin->closeResultStream != NULL;
+}
+
+/*
+ * Read the result of a query one tuple at a time. Unlike other plugin methods
+ * these do not run in the plugin's memory context: the schema and tuples are
+ * allocated in the caller's context, so consumers of large results can free
+ * each tuple (or clear their context) once it has been processed. For
+ * plugins that do not support streaming the result is materialized with
+ * executeQuery and its tuples are returned one by one.
+ */
+List *
+openResultStream (char *sql)
+{
+    List *schema;
+
+    ASSERT(activePlugin && activePlugin->isInitialized());
+    if (!supportsResultStreaming())
+    {
+        streamedResult = executeQuery(sql);
+        streamPos = 0;
+        return copyList(streamedResult->schema);
+    }
+
+    BACKEND_CALL_START();
+    schema = activePlugin->openResultStream(sql);
+    streamCallRunning = TRUE;
+    streamBytes = 0;
+    return schema;
+}
+
+Vector *
+nextStreamTuple (void)
+{
+    Vector *result;
+
+    if (!supportsResultStreaming())
+    {
+        if (streamedResult == NULL || streamPos >= getRelationNumTuples(streamedResult))
+            return NULL;
+        return getRelationTuple(streamedResult, streamPos++);
+    }
+
+    result = activePlugin->nextStreamTuple();
+    streamBytes += tupleBytes(result);
+    return result;
+}
+
+void
+closeResultStream (void)
+{
+    if (!supportsResultStreaming())
+    {
+        streamedResult = NULL;
+        return;
+    }
+
+    activePlugin->closeResultStream();
+    if (streamCallRunning && isBackendInstrumentationActive())
+        backendCallEnd("openResultStream", streamBytes);
+    streamCallRunning = FALSE;
+}
+
+boolean
+supportsConnectionPool (void)
+{
+    return activePlugin != NULL && activePlugin->openPooledConnection != NULL
+            && activePlugin->closePooledConnection != NULL
+            && activePlugin->switchConnection != NULL;
+}
+
+/*
+ * Check out a connection of the pool that is not used by anybody else. A
+ * new connection is opened if there is no idle connection and the pool has
+ * less than OPTION_CONN_POOL_SIZE connections (the plugin's own connection
+ * counts towards this limit). Returns NULL if the pool is exhausted or the
+ * plugin does not support additional connections. Methods run on the
+ * connection after it has been made the plugin's connection with
+ * useConnection. All connections share the plugin's catalog cache, but
+ * objects that are private to a connection (e.g., temporary tables) are not
+ * visible on the other connections.
+ */
+void *
+checkoutConnection (void)
+{
+    void *conn = NULL;
+    boolean open = FALSE;
+
+    if (!supportsConnectionPool())
+        return NULL;
+
+    // connections of a plugin that is not used anymore
+    if (poolPlugin != activePlugin)
+        closeConnectionPool();
+
+    LOCK_POOL();
+    if (poolContext == NULL)
+        poolContext = NEW_LONGLIVED_MEMCONTEXT(POOL_CONTEXT_NAME);
+    poolPlugin = activePlugin;
+    if (idleConnections != NIL)
+    {
+        conn = getHeadOfListP(idleConnections);
+        idleConnections = removeFromHead(idleConnections);
+    }
+    else if (numPooledConnections + 1 < getIntOption(OPTION_CONN_POOL_SIZE))
+    {
+        numPooledConnections++;
+        open = TRUE;
+    }
+    UNLOCK_POOL();
+
+    // opening may take a while, do not block other sessions
+    if (open)
+    {
+        ACQUIRE_MEM_CONTEXT(poolContext);
+        conn = activePlugin->openPooledConnection();
+        RELEASE_MEM_CONTEXT();
+
+        if (conn == NULL)
+        {
+            LOCK_POOL();
+            numPooledConnections--;
+            UNLOCK_POOL();
+        }
+    }
+
+    DEBUG_LOG("checked out pooled connection %p (%d connections)", conn,
+            numPooledConnections);
+    return conn;
+}
+
+void
+checkinConnection (void *conn)
+{
+    if (conn == NULL)
+        return;
+
+    LOCK_POOL();
+    ACQUIRE_MEM_CONTEXT(poolContext);
+    idleConnections = appendToTailOfList(idleConnections, conn);
     RELEASE_MEM_CONTEXT();
+    UNLOCK_POOL();
+}
+
+/*
+ * Make conn (a connection returned by checkoutConnection or by a previous
+ * call of useConnection) the connection used by the plugin's methods and
+ * return the connection that was used before.
+ */
+void *
+useConnection (void *conn)
+{
+    ASSERT(supportsConnectionPool());
+    return activePlugin->switchConnection(conn);
+}
+
+/*
+ * Close all idle connections of the pool. Connections that are still
+ * checked out are closed by the next call after they have been returned.
+ */
+void
+closeConnectionPool (void)
+{
+    List *idle;
+
+    LOCK_POOL();
+    idle = idleConnections;
+    idleConnections = NIL;
+    numPooledConnections -= LIST_LENGTH(idle);
+    UNLOCK_POOL();
+
+    FOREACH(void,conn,idle)
+        poolPlugin->closePooledConnection(conn);
+
+    LOCK_POOL();
+    if (numPooledConnections == 0 && poolContext != NULL)
+    {
+        FREE_MEM_CONTEXT(poolContext);
+        poolContext = NULL;
+        poolPlugin = NULL;
+    }
+    UNLOCK_POOL();
 }
 
 gprom_long_t
 getCommitScn (char *tableName, gprom_long_t maxScn, char *xid)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     gprom_long_t result = activePlugin->getCommitScn(tableName, maxScn, xid);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -425,9 +796,9 @@ Node *
 executeAsTransactionAndGetXID (List *statements, IsolationLevel isoLevel)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     Node *result = activePlugin->executeAsTransactionAndGetXID(statements, isoLevel);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -435,20 +806,96 @@ int
 getCostEstimation(char *query)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     int result = activePlugin->getCostEstimation(query);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
+/*
+ * Return an equi-depth histogram for attribute attrName of table tableName as
+ * a list [histogram bounds "{b1,...,bn}", min, max]. Histograms are cached in
+ * the catalog cache until invalidateHistograms is called for the table. They
+ * are taken from the backend's statistics unless the backend does not
+ * maintain histograms or OPTION_PS_SAMPLE_HISTOGRAM is set, in which case we
+ * compute them from a sample (see sampleHistogram).
+ */
 List *
 getHist (char *tableName, char *attrName, int numPartitions)
 {
+    CatalogCache *cache;
+    HashMap *tableHists = NULL;
+    List *result = NULL;
+    char *key;
+
     ASSERT(activePlugin && activePlugin->isInitialized());
+    ENTER_PLUGIN();
+    cache = activePlugin->cache;
+    key = CONCAT_STRINGS(attrName, "#", gprom_itoa(numPartitions));
+    if (cache != NULL)
+    {
+        tableHists = (HashMap *) MAP_GET_STRING(cache->histograms, tableName);
+        if (tableHists == NULL)
+        {
+            tableHists = NEW_MAP(Constant,List);
+            MAP_ADD_STRING_KEY(cache->histograms, tableName, tableHists);
+        }
+        result = (List *) MAP_GET_STRING(tableHists, key);
+    }
+    if (result == NULL && activePlugin->getHistogram != NULL
+            && !getBoolOption(OPTION_PS_SAMPLE_HISTOGRAM))
+    {
+        result = activePlugin->getHistogram(tableName,attrName,numPartitions);
+        if (tableHists != NULL)
+            MAP_ADD_STRING_KEY(tableHists, key, result);
+    }
+    LEAVE_PLUGIN(0);
+
+    // the sample is read with the generic query interface which enters the plugin itself
+    if (result == NULL)
+    {
+        result = sampleHistogram(tableName, attrName, numPartitions);
+        if (tableHists != NULL)
+        {
+            ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+            MAP_ADD_STRING_KEY(tableHists, key, deepCopyStringList(result));
+            RELEASE_MEM_CONTEXT();
+        }
+        return result;
+    }
+
+    return deepCopyStringList(result);
+}
+
+/*
+ * Drop cached histograms and row counts of table tableName (of all tables if
+ * tableName is NULL). Has to be called whenever the table is modified.
+ */
+void
+invalidateHistograms (char *tableName)
+{
+    if (activePlugin == NULL || activePlugin->cache == NULL
+            || activePlugin->cache->histograms == NULL)
+        return;
+
     ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
-    List *result = activePlugin->getHistogram(tableName,attrName,numPartitions);
+    if (tableName == NULL)
+    {
+        activePlugin->cache->histograms = NEW_MAP(Constant,HashMap);
+        activePlugin->cache->rowNums = NEW_MAP(Constant,Constant);
+    }
+    else
+    {
+        if (MAP_HAS_STRING_KEY(activePlugin->cache->histograms, tableName))
+        {
+            DEBUG_LOG("invalidate cached histograms of table %s", tableName);
+            removeMapStringElem(activePlugin->cache->histograms, tableName);
+        }
+        if (activePlugin->cache->rowNums != NULL
+                && MAP_HAS_STRING_KEY(activePlugin->cache->rowNums, tableName))
+            removeMapStringElem(activePlugin->cache->rowNums, tableName);
+    }
     RELEASE_MEM_CONTEXT();
-    return result;
 }
 
 
@@ -456,9 +903,31 @@ HashMap *
 getPS (char *sql, List *attrNames)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+
+    // backends without a dedicated implementation: sketches are taken from the last row
+    if (activePlugin->getProvenanceSketch == NULL)
+    {
+        HashMap *result = NEW_MAP(Constant,Constant);
+        Relation *r = executeQuery(sql);
+        int last = getRelationNumTuples(r) - 1;
+
+        if (last >= 0)
+        {
+            for(int j = 0; j < LIST_LENGTH(attrNames); j++)
+            {
+                char *attrName = getNthOfListP(attrNames, j);
+                char *ps = getRelationValue(r, last, j);
+                Constant *c = (ps == NULL) ? createNullConst(DT_STRING) : createConstString(ps);
+
+                MAP_ADD_STRING_KEY(result, attrName, c);
+            }
+        }
+        return result;
+    }
+
+    ENTER_PLUGIN();
     HashMap *result = activePlugin->getProvenanceSketch(sql, attrNames);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -466,9 +935,9 @@ HashMap *
 getPSInfoFromTable ()
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     HashMap *result = activePlugin->getProvenanceSketchInfoFromTable();
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -476,9 +945,9 @@ HashMap *
 getPSTemplateFromTable ()
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     HashMap *result = activePlugin->getProvenanceSketchTemplateFromTable();
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -486,9 +955,9 @@ HashMap *
 getPSHistogramFromTable ()
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     HashMap *result = activePlugin->getProvenanceSketchHistogramFromTable();
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -496,27 +965,27 @@ void
 createPSTemplateTable ()
 {
     ASSERT(activePlugin && activePlugin->isInitialized() && activePlugin->executeQuery);
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     activePlugin->createProvenanceSketchTemplateTable();
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
 }
 
 void
 createPSInfoTable ()
 {
     ASSERT(activePlugin && activePlugin->isInitialized() && activePlugin->executeQuery);
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     activePlugin->createProvenanceSketchInfoTable();
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
 }
 
 void
 createPSHistTable ()
 {
     ASSERT(activePlugin && activePlugin->isInitialized() && activePlugin->executeQuery);
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     activePlugin->createProvenanceSketchHistTable();
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
 }
 
 
@@ -524,27 +993,36 @@ void
 storePsInfo (int tNo, char *paras, psInfoCell *psc)
 {
     ASSERT(activePlugin && activePlugin->isInitialized() && activePlugin->executeQuery);
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     activePlugin->storePsInformation(tNo,paras,psc);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
+}
+
+void
+deletePsInfo (int tNo, char *paras)
+{
+    ASSERT(activePlugin && activePlugin->isInitialized() && activePlugin->deletePsInformation);
+    ENTER_PLUGIN();
+    activePlugin->deletePsInformation(tNo,paras);
+    LEAVE_PLUGIN(0);
 }
 
 void
 storePsTemplate (KeyValue *kv)
 {
     ASSERT(activePlugin && activePlugin->isInitialized() && activePlugin->executeQuery);
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     activePlugin->storePsTemplates(kv);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
 }
 
 void
 storePsHist (KeyValue *kv, int n)
 {
     ASSERT(activePlugin && activePlugin->isInitialized() && activePlugin->executeQuery);
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     activePlugin->storePsHistogram(kv,n);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
 }
 
 
@@ -552,9 +1030,9 @@ int
 databaseConnectionOpen (void)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     int result = activePlugin->databaseConnectionOpen();
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -563,9 +1041,10 @@ int
 databaseConnectionClose()
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    closeConnectionPool();
+    ENTER_PLUGIN();
     int result = activePlugin->databaseConnectionClose();
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -582,6 +1061,8 @@ createCache(void)
     result->tableNames = STRSET();
     result->aggFuncNames = STRSET();
     result->winFuncNames = STRSET();
+    result->histograms = NEW_MAP(Constant,HashMap);
+    result->rowNums = NEW_MAP(Constant,Constant);
     result->cacheHook = NULL;
 
     return result;
@@ -592,9 +1073,9 @@ boolean
 isPostive(char *tableName, char *colName)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     boolean result = activePlugin->checkPostive(tableName, colName);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 */
@@ -602,9 +1083,9 @@ isPostive(char *tableName, char *colName)
 Constant*
 transferRawData(char *data, char *dataType){
 	ASSERT(activePlugin && activePlugin->isInitialized());
-	ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+	ENTER_PLUGIN();
 	Constant* result = activePlugin->trasnferRawData(data, dataType);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -612,9 +1093,9 @@ HashMap *
 getMinAndMax(char *tableName, char *colName)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     HashMap * result = activePlugin->getMinAndMax(tableName, colName);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
@@ -622,20 +1103,234 @@ List *
 getAllMinAndMax(TableAccessOperator *table)
 {
     ASSERT(activePlugin && activePlugin->isInitialized());
-    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+    ENTER_PLUGIN();
     List * result = activePlugin->getAllMinAndMax(table);
-    RELEASE_MEM_CONTEXT();
+    LEAVE_PLUGIN(0);
     return result;
 }
 
 
+/*
+ * Return the number of rows of table tableName. Plugins that do not provide
+ * a cheaper way (e.g., statistics maintained by the database) count the rows
+ * of the table. The result is cached until the table is modified (see
+ * invalidateHistograms).
+ */
 int
 getRowNum(char* tableName)
 {
-	 ASSERT(activePlugin && activePlugin->isInitialized());
-	    ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
-	    int result = activePlugin->getRowNum(tableName);
-	    RELEASE_MEM_CONTEXT();
-	    return result;
+    CatalogCache *cache;
+    Constant *cached = NULL;
+    int result;
+
+    ASSERT(activePlugin && activePlugin->isInitialized());
+    // the lock is held while counting to not count a table twice
+    LOCK_PLUGIN();
+    cache = activePlugin->cache;
+    if (cache != NULL && cache->rowNums != NULL)
+        cached = (Constant *) MAP_GET_STRING(cache->rowNums, tableName);
+    if (cached != NULL)
+    {
+        result = INT_VALUE(cached);
+        UNLOCK_PLUGIN();
+        return result;
+    }
+
+    if (activePlugin->getRowNum != NULL)
+    {
+        ENTER_PLUGIN();
+        result = activePlugin->getRowNum(tableName);
+        LEAVE_PLUGIN(0);
+    }
+    // the generic query interface enters the plugin itself
+    else
+    {
+        StringInfo q = makeStringInfo();
+        Relation *r;
+
+        appendStringInfo(q, "SELECT count(*) FROM %s", tableName);
+        r = executeQuery(q->data);
+        result = getRelationNumTuples(r) > 0 ? atoi(getRelationValue(r, 0, 0)) : 0;
+    }
+
+    if (cache != NULL && cache->rowNums != NULL)
+    {
+        ACQUIRE_MEM_CONTEXT(activePlugin->metadataLookupContext);
+        MAP_ADD_STRING_KEY(cache->rowNums, tableName, createConstInt(result));
+        RELEASE_MEM_CONTEXT();
+    }
+    UNLOCK_PLUGIN();
+
+    return result;
+}
+
+/*
+ * Compute an equi-depth histogram with numPartitions partitions from a
+ * uniform sample of at most OPTION_PS_HISTOGRAM_SAMPLE_SIZE non-NULL values
+ * of the attribute. The sample is drawn with reservoir sampling (Algorithm R)
+ * over the result of a single scan of the table which also determines the
+ * exact min and max. Values are compared as numbers if all values are
+ * numeric and as strings otherwise. The result has the same format as the
+ * histograms returned by the plugins.
+ */
+#define HISTOGRAM_SAMPLE_BATCH_SIZE 1000
+
+static List *
+sampleHistogram (char *tableName, char *attrName, int numPartitions)
+{
+    int sampleSize;
+    char **sample;
+    char *numMin = NULL, *numMax = NULL, *strMin = NULL, *strMax = NULL;
+    double minNum = 0, maxNum = 0;
+    boolean numeric = TRUE;
+    gprom_long_t numValues = 0;
+    int numSampled;
+    MemContext *batchContext;
+    StringInfo q = makeStringInfo();
+    StringInfo hist = makeStringInfo();
+    Vector *tuple;
+    char *prev = NULL;
+
+    numPartitions = MAX(numPartitions, 1);
+    sampleSize = MAX(getIntOption(OPTION_PS_HISTOGRAM_SAMPLE_SIZE), numPartitions + 1);
+    sample = CALLOC(sizeof(char *), sampleSize);
+
+    START_TIMER("metadata lookup - sample histogram");
+    appendStringInfo(q, "SELECT %s FROM %s WHERE %s IS NOT NULL",
+            attrName, tableName, attrName);
+
+    // tuples are read into a context that is cleared after each batch, kept values are copied
+    batchContext = NEW_MEM_CONTEXT("HistogramSampleContext");
+    ACQUIRE_MEM_CONTEXT(batchContext);
+    openResultStream(q->data);
+    while ((tuple = nextStreamTuple()) != NULL)
+    {
+        char *v = getVecString(tuple, 0);
+        gprom_long_t pos = numValues++;
+
+        if (numeric && isNumericValue(v))
+        {
+            double d = strtod(v, NULL);
+
+            if (numMin == NULL || d < minNum)
+            {
+                minNum = d;
+                keepSampleValue(&numMin, v);
+            }
+            if (numMax == NULL || d > maxNum)
+            {
+                maxNum = d;
+                keepSampleValue(&numMax, v);
+            }
+        }
+        else
+            numeric = FALSE;
+        if (strMin == NULL || strcmp(v, strMin) < 0)
+            keepSampleValue(&strMin, v);
+        if (strMax == NULL || strcmp(v, strMax) > 0)
+            keepSampleValue(&strMax, v);
+
+        // the i-th value replaces a random element of the sample with probability sampleSize / i
+        if (pos >= sampleSize)
+            pos = (gprom_long_t) ((rand() / (RAND_MAX + 1.0)) * numValues);
+        if (pos < sampleSize)
+            keepSampleValue(sample + pos, v);
+
+        if (numValues % HISTOGRAM_SAMPLE_BATCH_SIZE == 0)
+            CLEAR_CUR_MEM_CONTEXT();
+    }
+    closeResultStream();
+    FREE_AND_RELEASE_CUR_MEM_CONTEXT();
+
+    // bounds of the partitions are the values at equi-distant positions of the sorted sample
+    numSampled = (int) MIN(numValues, sampleSize);
+    qsort(sample, numSampled, sizeof(char *),
+            numeric ? compareSampleNums : compareSampleStrings);
+
+    appendStringInfoChar(hist, '{');
+    for (int i = 0; i <= numPartitions && numSampled > 0; i++)
+    {
+        char *b = sample[(gprom_long_t) i * (numSampled - 1) / numPartitions];
+
+        if (prev != NULL && strcmp(prev, b) == 0)
+            continue;
+        if (prev != NULL)
+            appendStringInfoChar(hist, ',');
+        appendHistogramBound(hist, b);
+        prev = b;
+    }
+    appendStringInfoChar(hist, '}');
+    STOP_TIMER("metadata lookup - sample histogram");
+
+    DEBUG_LOG("sampled %d of %lld values of %s.%s for histogram <%s>",
+            numSampled, (long long) numValues, tableName, attrName, hist->data);
+
+    if (numValues == 0)
+        return LIST_MAKE(hist->data, strdup(""), strdup(""));
+    return LIST_MAKE(hist->data, numeric ? numMin : strMin, numeric ? numMax : strMax);
+}
+
+/*
+ * Copy a value that is kept in the sample into the caller's context of
+ * sampleHistogram (the current context is the batch context).
+ */
+static void
+keepSampleValue (char **slot, char *value)
+{
+    MemContext *batchContext = RELEASE_MEM_CONTEXT();
+
+    *slot = strdup(value);
+    ACQUIRE_MEM_CONTEXT(batchContext);
+}
+
+static int
+compareSampleNums (const void *a, const void *b)
+{
+    double l = strtod(*((char **) a), NULL);
+    double r = strtod(*((char **) b), NULL);
 
+    return (l < r) ? -1 : ((l > r) ? 1 : 0);
+}
+
+static int
+compareSampleStrings (const void *a, const void *b)
+{
+    return strcmp(*((char **) a), *((char **) b));
+}
+
+static boolean
+isNumericValue (char *value)
+{
+    char *end;
+
+    strtod(value, &end);
+    return end != value && *end == '\0';
+}
+
+/*
+ * Append a bound to a histogram using the Postgres array literal syntax,
+ * i.e., values containing delimiters or whitespace are quoted.
+ */
+static void
+appendHistogramBound (StringInfo str, char *value)
+{
+    boolean quote = (*value == '\0') || streq(value, "NULL");
+
+    for (char *c = value; *c != '\0' && !quote; c++)
+        quote = (strchr("{},\"\\", *c) != NULL) || isspace(*c);
+
+    if (!quote)
+    {
+        appendStringInfoString(str, value);
+        return;
+    }
+
+    appendStringInfoChar(str, '"');
+    for (char *c = value; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            appendStringInfoChar(str, '\\');
+        appendStringInfoChar(str, *c);
+    }
+    appendStringInfoChar(str, '"');
 }
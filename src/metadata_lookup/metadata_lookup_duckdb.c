@@ -14,6 +14,7 @@
 #include "model/set/hashmap.h"
 #include "model/set/vector.h"
 #include "operator_optimizer/optimizer_prop_inference.h"
+#include "provenance_sketches/sketch_functions.h"
 #include "utility/string_utils.h"
 #include <stdlib.h>
 
@@ -33,17 +34,39 @@ typedef struct DuckDBPlugin
     boolean initialized;
     duckdb_connection conn; 
     duckdb_database db;
+    duckdb_connection ownConn;      // plugin's connection, conn may be a pooled connection
 } DuckDBPlugin; 
 
 // global vars
 static DuckDBPlugin *plugin = NULL;
 static MemContext *memContext = NULL;
 
+// describes a result column and the vectors of the current chunk for this column
+typedef struct DuckDBColumn
+{
+    duckdb_type type;
+    duckdb_type internalType;   // physical type of DECIMAL
+    uint8_t scale;              // scale of DECIMAL
+    void *data;
+    uint64_t *validity;
+    char *buf;                  // buffer values are converted into
+    size_t bufSize;
+} DuckDBColumn;
+
 // functions
-// static duckdb_result runQuery (char *q);
+static void runQuery (char *q, duckdb_result *result);
+static void readTuples (duckdb_result *rs, Relation *r);
+static void readTuplesAsVarchar (duckdb_result *rs, Relation *r);
+static boolean isVectorReadable (duckdb_type type);
+static char *valueToString (DuckDBColumn *c, idx_t row);
+static char *hugeintToString (duckdb_hugeint v, uint8_t scale, char *buf, size_t bufSize);
 static DataType stringToDT (char *dataType);
 static char *duckdbGetConnectionDescription (void);
 static void initCache(CatalogCache *c);
+static duckdb_state registerSketchFunctions (duckdb_connection conn);
+static void *duckdbOpenPooledConnection (void);
+static void duckdbClosePooledConnection (void *conn);
+static void *duckdbSwitchConnection (void *conn);
 
 MetadataLookupPlugin *
 assembleDuckDBMetadataLookupPlugin (void)
@@ -78,6 +101,9 @@ assembleDuckDBMetadataLookupPlugin (void)
     p->sqlTypeToDT = duckdbBackendSQLTypeToDT;
     p->dataTypeToSQL = duckdbBackendDatatypeToSQL;
     p->getMinAndMax = duckdbGetMinAndMax;
+    p->openPooledConnection = duckdbOpenPooledConnection;
+    p->closePooledConnection = duckdbClosePooledConnection;
+    p->switchConnection = duckdbSwitchConnection;
     return p;
 }
 
@@ -135,6 +161,14 @@ duckdbDatabaseConnectionOpen (void)
         return EXIT_FAILURE;
     }
 
+    rc = registerSketchFunctions(plugin->conn);
+    if(rc != DuckDBSuccess)
+    {
+        fprintf(stderr, "Can not register provenance sketch functions for <%s>", dbfile);
+        return EXIT_FAILURE;
+    }
+    plugin->ownConn = plugin->conn;
+
     return EXIT_SUCCESS;
 }
 
@@ -142,12 +176,57 @@ int
 duckdbDatabaseConnectionClose()
 {
 
+    plugin->conn = plugin->ownConn;
     duckdb_disconnect(&(plugin->conn)); 
     duckdb_close(&(plugin->db)); 
 
     return EXIT_SUCCESS;
 }
 
+/*
+ * Connections of the pool are additional connections to the plugin's
+ * database, i.e., they share its catalog and buffer manager.
+ */
+static void *
+duckdbOpenPooledConnection (void)
+{
+    duckdb_connection conn = NULL;
+
+    if (duckdb_connect(plugin->db, &conn) != DuckDBSuccess)
+    {
+        ERROR_LOG("can not open pooled connection to database <%s>",
+                getStringOption(OPTION_CONN_DB));
+        return NULL;
+    }
+    if (registerSketchFunctions(conn) != DuckDBSuccess)
+    {
+        ERROR_LOG("can not register provenance sketch functions for pooled connection");
+        duckdb_disconnect(&conn);
+        return NULL;
+    }
+
+    return (void *) conn;
+}
+
+static void
+duckdbClosePooledConnection (void *conn)
+{
+    duckdb_connection c = (duckdb_connection) conn;
+
+    if (plugin->conn == c)
+        plugin->conn = plugin->ownConn;
+    duckdb_disconnect(&c);
+}
+
+static void *
+duckdbSwitchConnection (void *conn)
+{
+    duckdb_connection prev = plugin->conn;
+
+    plugin->conn = (duckdb_connection) conn;
+    return (void *) prev;
+}
+
 boolean
 duckdbIsInitialized (void)
 {
@@ -169,26 +248,13 @@ boolean
 duckdbCatalogTableExists (char * tableName)
 {
 
-    duckdb_result result;
-    duckdb_connection c = plugin->conn;
-
-    char query[256];
-    snprintf(query, sizeof(query),
-                "SELECT COUNT(*) FROM information_schema.tables WHERE table_name='%s';", tableName);
-
-    int rc;
-    rc = duckdb_query(c, query, &result);
-
-    if (rc != DuckDBSuccess) {
-        fprintf(stderr, "Failed to execute query to check duckdbCatalogTableExists.");
-        return EXIT_FAILURE;
-    }
-
-    int table_count = duckdb_value_int32(&result, 0, 0);
+    StringInfo q = makeStringInfo();
+    Relation *r;
 
-    duckdb_destroy_result(&result);
+    appendStringInfo(q, "SELECT COUNT(*) FROM information_schema.tables WHERE table_name='%s';", tableName);
+    r = duckdbExecuteQuery(q->data);
 
-    return table_count > 0;
+    return atoi(getRelationValue(r, 0, 0)) > 0;
 }
 
 boolean
@@ -199,37 +265,23 @@ duckdbCatalogViewExists (char * viewName)
 
 List * 
 duckdbGetAttributes(char *tableName) {
-    duckdb_result result;
     StringInfo q;
+    Relation *r;
     List *resultList = NIL;
 
     q = makeStringInfo();
     appendStringInfo(q, QUERY_TABLE_COL_COUNT, tableName);
+    r = duckdbExecuteQuery(q->data);
 
-    int rc = duckdb_query(plugin->conn, q->data, &result);
-
-    // Execute the query
-    if (rc != DuckDBSuccess) {
-        fprintf(stderr, "error getting attributes of table <%s>", tableName);
-    }
-
-    // Iterate over the result set
-    for (idx_t row = 0; row < duckdb_row_count(&result); row++) {
-        const char *colName = duckdb_value_varchar(&result, 0, row);
-        const char *dt = duckdb_value_varchar(&result, 1, row);
-        
-        DataType ourDT = stringToDT((char *)dt);
+    FOREACH_REL_TUPLE(it,r)
+    {
+        char *colName = REL_ITER_VALUE(it, 0);
+        DataType ourDT = stringToDT(REL_ITER_VALUE(it, 1));
 
-        AttributeDef *a = createAttributeDef(
-            strToUpper(strdup((char *) colName)),
-            ourDT);
+        AttributeDef *a = createAttributeDef(strToUpper(colName), ourDT);
         resultList = appendToTailOfList(resultList, a);
-
-        duckdb_free((void *)colName);
-        duckdb_free((void *)dt);
     }
 
-    duckdb_destroy_result(&result);
     DEBUG_NODE_LOG("columns are: ", resultList);
 
     return resultList;
@@ -267,6 +319,17 @@ DataType
 duckdbGetFuncReturnType (char *fName, List *argTypes, boolean *funcExists)
 {
     *funcExists = TRUE;
+
+#if HAVE_DUCKDB_SKETCH_FUNCTIONS
+    char *f = strToLower(fName);
+
+    // native sketch functions
+    if (streq(f, SKETCH_FUN_BUCKET_SEARCH) || streq(f, SKETCH_FUN_BIT_COUNT))
+        return DT_INT;
+    if (streq(f, SKETCH_FUN_CONTAINS))
+        return DT_BOOL;
+#endif
+
     return DT_STRING; //TODO
 }
 
@@ -337,30 +400,19 @@ duckdbGetCostEstimation(char *query)
 
 List* 
 duckdbGetKeyInformation(char *tableName) {
-    duckdb_result result;
     StringInfo q;
+    Relation *r;
     Set *key = STRSET();
     List *keys = NIL;
-    int rc;
 
     q = makeStringInfo();
     appendStringInfo(q, QUERY_TABLE_COL_COUNT, tableName);
-    rc = duckdb_query(plugin->conn, q->data, &result);
-
-    if (rc != DuckDBSuccess) {
-        fprintf(stderr, "Error getting primary key information for table <%s>", tableName);
-        return NULL; 
-    }
+    r = duckdbExecuteQuery(q->data);
 
-    for (idx_t row = 0; row < duckdb_row_count(&result); row++) {
-        const char *colname = duckdb_value_varchar(&result, row, 0);
-        
-        addToSet(key, strToUpper(strdup((char *) colname)));
+    FOREACH_REL_TUPLE(it,r)
+        addToSet(key, strToUpper(REL_ITER_VALUE(it, 0)));
 
-        duckdb_free((void *)colname);
-    }
-
-    if (duckdb_row_count(&result) == 0) {
+    if (getRelationNumTuples(r) == 0) {
         fprintf(stderr, "No primary key information found for table <%s>", tableName);
     } else {
         DEBUG_LOG("Key for %s are: %s", tableName, beatify(nodeToString(key)));
@@ -370,8 +422,6 @@ duckdbGetKeyInformation(char *tableName) {
         keys = singleton(key);
     }
 
-    duckdb_destroy_result(&result);
-
     return keys;
 }
 
@@ -427,13 +477,13 @@ duckdbBackendDatatypeToSQL (DataType dt)
 HashMap 
 *duckdbGetMinAndMax(char* tableName, char* colName) {
     HashMap *result_map = NEW_MAP(Constant, HashMap);
-    duckdb_result rs;
+    Relation *rs;
+    Vector *minMaxes;
     StringInfo q;
     StringInfo colMinMax;
     List *attr = duckdbGetAttributes(tableName);
     List *aNames = getAttrDefNames(attr);
     List *aDTs = getAttrDataTypes(attr);
-    int rc;
 
     q = makeStringInfo();
     colMinMax = makeStringInfo();
@@ -446,20 +496,16 @@ HashMap
 
     appendStringInfo(q, QUERY_TABLE_ATTR_MIN_MAX, colMinMax->data, tableName);
 
-    rc = duckdb_query(plugin->conn, q->data, &rs);
-
-    if (rc != DuckDBSuccess) {
-        fprintf(stderr, "Error executing query to get min and max values for table <%s>", tableName);
-        return NULL; 
-    }
+    rs = duckdbExecuteQuery(q->data);
+    minMaxes = getRelationTuple(rs, 0);
 
-    // Iterate over the result set
+    // the result has one row with the min and max of each attribute
     for (idx_t pos = 0, attr_idx = 0; attr_idx < getListLength(aNames); ++attr_idx) {
         char *aname = getNthOfListP(aNames, attr_idx);
         DataType dt = (DataType) getNthOfListInt(aDTs, attr_idx);
         HashMap *minmax = NEW_MAP(Constant, Constant);
-        const char *minVal = duckdb_value_varchar(&rs, 0, pos++);  
-        const char *maxVal = duckdb_value_varchar(&rs, 0, pos++);  
+        char *minVal = getVecString(minMaxes, pos++);
+        char *maxVal = getVecString(minMaxes, pos++);
         Constant *min, *max;
 
         switch(dt) {
@@ -481,20 +527,14 @@ HashMap
                 break;
             default:
                 THROW(SEVERITY_RECOVERABLE, "Received unknown data type from DuckDB: %s", DataTypeToString(dt));
-                duckdb_destroy_result(&rs);
                 return NULL;
         }
 
         MAP_ADD_STRING_KEY(minmax, MIN_KEY, min);
         MAP_ADD_STRING_KEY(minmax, MAX_KEY, max);
         MAP_ADD_STRING_KEY(result_map, aname, minmax);
-
-        duckdb_free((void *)minVal);
-        duckdb_free((void *)maxVal);
     }
 
-    duckdb_destroy_result(&rs);
-
     DEBUG_NODE_BEATIFY_LOG("min maxes", MAP_GET_STRING(result_map, colName));
 
     return (HashMap *) MAP_GET_STRING(result_map, colName);
@@ -514,84 +554,374 @@ duckdbExecuteAsTransactionAndGetXID (List *statements, IsolationLevel isoLevel)
     return NULL;
 }
 
-Relation *duckdbExecuteQuery(char *query) {
-    Relation *r = makeNode(Relation);
+Relation *
+duckdbExecuteQuery(char *query)
+{
+    Relation *r;
+    List *schema = NIL;
     duckdb_result rs;
-    int rc;
-
-    rc = duckdb_query(plugin->conn, query, &rs);
-    
-    if (rc != DuckDBSuccess) {
-        fprintf(stderr, "Failed to execute query <%s>", query);
-        return NULL;
-    }
+    idx_t numFields;
 
-    int numFields = duckdb_column_count(&rs);
+    runQuery(query, &rs);
+    numFields = duckdb_column_count(&rs);
 
-    r->schema = NIL;
-    for (int i = 0; i < numFields; i++) {
+    // set schema
+    for (idx_t i = 0; i < numFields; i++)
+    {
         const char *name = duckdb_column_name(&rs, i);
-        r->schema = appendToTailOfList(r->schema, strdup((char *) name));
-    }
-
-    // Read rows
-    r->tuples = makeVector(VECTOR_NODE, T_Vector);
-    for (idx_t row = 0; row < duckdb_row_count(&rs); row++) {
-        Vector *tuple = makeVector(VECTOR_STRING, -1);
-        for (int j = 0; j < numFields; j++) {
-            if (duckdb_value_is_null(&rs, j, row)) {
-                vecAppendString(tuple, strdup("NULL"));
-            } else {
-                const char *val = duckdb_value_varchar(&rs, j, row);
-                vecAppendString(tuple, strdup((char *) val));
-                duckdb_free((void *)val); 
-            }
-        }
-        VEC_ADD_NODE(r->tuples, tuple);
-        DEBUG_NODE_LOG("read tuple <%s>", tuple);
+        schema = appendToTailOfList(schema, strdup((char *) name));
     }
+    r = makeResultRelation(schema);
 
+    // read rows
+    readTuples(&rs, r);
     duckdb_destroy_result(&rs);
 
     return r;
 }
 
-void 
-duckdbExecuteQueryIgnoreResults(char *query) {
+void
+duckdbExecuteQueryIgnoreResults(char *query)
+{
     duckdb_result rs;
-    int rc;
 
-    rc = duckdb_query(plugin->conn, query, &rs);
+    runQuery(query, &rs);
+    duckdb_destroy_result(&rs);
+}
 
-    if (rc != DuckDBSuccess) {
-        fprintf(stderr, "Failed to execute query <%s>", query);
-        return;
+static void
+runQuery (char *q, duckdb_result *result)
+{
+    duckdb_state rc;
+
+    DEBUG_LOG("run query:\n<%s>", q);
+    rc = duckdb_query(plugin->conn, q, result);
+
+    if (rc != DuckDBSuccess)
+    {
+        char *errMes = strdup((char *) duckdb_result_error(result));
+
+        duckdb_destroy_result(result);
+        FATAL_LOG("error (%s)\n%u\n\nfailed to execute query <%s>", errMes, rc, q);
     }
+}
 
-    duckdb_destroy_result(&rs);
+/*
+ * Read all rows of a result chunk by chunk and add them to relation r. For
+ * each chunk we read the data and validity mask of each column vector once
+ * and then convert the values of all rows of the chunk directly from these
+ * arrays.
+ */
+static void
+readTuples (duckdb_result *rs, Relation *r)
+{
+    idx_t numFields = duckdb_column_count(rs);
+    DuckDBColumn *cols = CALLOC(sizeof(DuckDBColumn), MAX(numFields, 1));
+    char **values = CNEW(char *, MAX(numFields, 1));
+    duckdb_data_chunk chunk;
+
+    // values of other types are converted to strings by DuckDB
+    for (idx_t j = 0; j < numFields; j++)
+    {
+        if (!isVectorReadable(duckdb_column_type(rs, j)))
+        {
+            FREE(cols);
+            FREE(values);
+            readTuplesAsVarchar(rs, r);
+            return;
+        }
+    }
+
+    for (idx_t j = 0; j < numFields; j++)
+    {
+        cols[j].type = duckdb_column_type(rs, j);
+        if (cols[j].type == DUCKDB_TYPE_DECIMAL)
+        {
+            duckdb_logical_type lt = duckdb_column_logical_type(rs, j);
+
+            cols[j].internalType = duckdb_decimal_internal_type(lt);
+            cols[j].scale = duckdb_decimal_scale(lt);
+            duckdb_destroy_logical_type(&lt);
+        }
+        cols[j].bufSize = 128;
+        cols[j].buf = MALLOC(cols[j].bufSize);
+    }
+
+    while ((chunk = duckdb_fetch_chunk(*rs)) != NULL)
+    {
+        idx_t numRows = duckdb_data_chunk_get_size(chunk);
+
+        for (idx_t j = 0; j < numFields; j++)
+        {
+            duckdb_vector v = duckdb_data_chunk_get_vector(chunk, j);
+
+            cols[j].data = duckdb_vector_get_data(v);
+            cols[j].validity = duckdb_vector_get_validity(v);
+        }
+
+        // values are converted into the column buffers and copied by addRelationTuple
+        for (idx_t row = 0; row < numRows; row++)
+        {
+            for (idx_t j = 0; j < numFields; j++)
+            {
+                if (!duckdb_validity_row_is_valid(cols[j].validity, row))
+                    values[j] = NULL;
+                else
+                    values[j] = valueToString(cols + j, row);
+            }
+            addRelationTuple(r, values);
+        }
+
+        duckdb_destroy_data_chunk(&chunk);
+    }
+
+    for (idx_t j = 0; j < numFields; j++)
+        FREE(cols[j].buf);
+    FREE(cols);
+    FREE(values);
+    DEBUG_LOG("read %d tuples", getRelationNumTuples(r));
+}
+
+/*
+ * Read all rows of a result with columns of types that valueToString does
+ * not support (e.g., intervals or lists) using DuckDB's conversion to strings.
+ */
+static void
+readTuplesAsVarchar (duckdb_result *rs, Relation *r)
+{
+    idx_t numFields = duckdb_column_count(rs);
+    idx_t numRows = duckdb_row_count(rs);
+    char **values = CNEW(char *, MAX(numFields, 1));
+
+    for (idx_t row = 0; row < numRows; row++)
+    {
+        for (idx_t j = 0; j < numFields; j++)
+            values[j] = duckdb_value_is_null(rs, j, row) ? NULL
+                    : duckdb_value_varchar(rs, j, row);
+        addRelationTuple(r, values);
+        for (idx_t j = 0; j < numFields; j++)
+            if (values[j] != NULL)
+                duckdb_free(values[j]);
+    }
+
+    FREE(values);
+    DEBUG_LOG("read %d tuples as strings", getRelationNumTuples(r));
 }
 
-// static duckdb_result 
-// runQuery(char *q) {
-//     duckdb_result result;
-//     duckdb_state rc;
+/*
+ * Types whose values valueToString reads from column vectors.
+ */
+static boolean
+isVectorReadable (duckdb_type type)
+{
+    switch (type)
+    {
+        case DUCKDB_TYPE_BOOLEAN:
+        case DUCKDB_TYPE_TINYINT:
+        case DUCKDB_TYPE_SMALLINT:
+        case DUCKDB_TYPE_INTEGER:
+        case DUCKDB_TYPE_BIGINT:
+        case DUCKDB_TYPE_UTINYINT:
+        case DUCKDB_TYPE_USMALLINT:
+        case DUCKDB_TYPE_UINTEGER:
+        case DUCKDB_TYPE_UBIGINT:
+        case DUCKDB_TYPE_HUGEINT:
+        case DUCKDB_TYPE_FLOAT:
+        case DUCKDB_TYPE_DOUBLE:
+        case DUCKDB_TYPE_DECIMAL:
+        case DUCKDB_TYPE_VARCHAR:
+        case DUCKDB_TYPE_BLOB:
+        case DUCKDB_TYPE_DATE:
+        case DUCKDB_TYPE_TIMESTAMP:
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
 
-//     DEBUG_LOG("run query:\n<%s>", q);
+#define FORMAT_VALUE(_fmt,_val) \
+    do { \
+        snprintf(c->buf, c->bufSize, _fmt, _val); \
+        return c->buf; \
+    } while(0)
+
+/*
+ * Translate a value from a column vector into the string representation
+ * used in Relations. The result is stored in the buffer of the column and
+ * is overwritten by the next call for the same column.
+ */
+static char *
+valueToString (DuckDBColumn *c, idx_t row)
+{
+    char *buf = c->buf;
+    size_t bufSize = c->bufSize;
 
-//     rc = duckdb_query(plugin->conn, q, &result);
+    switch (c->type)
+    {
+        case DUCKDB_TYPE_BOOLEAN:
+            return ((bool *) c->data)[row] ? "true" : "false";
+        case DUCKDB_TYPE_TINYINT:
+            FORMAT_VALUE("%d", (int) ((int8_t *) c->data)[row]);
+        case DUCKDB_TYPE_SMALLINT:
+            FORMAT_VALUE("%d", (int) ((int16_t *) c->data)[row]);
+        case DUCKDB_TYPE_INTEGER:
+            FORMAT_VALUE("%d", ((int32_t *) c->data)[row]);
+        case DUCKDB_TYPE_BIGINT:
+            FORMAT_VALUE("%lld", (long long) ((int64_t *) c->data)[row]);
+        case DUCKDB_TYPE_UTINYINT:
+            FORMAT_VALUE("%u", (unsigned) ((uint8_t *) c->data)[row]);
+        case DUCKDB_TYPE_USMALLINT:
+            FORMAT_VALUE("%u", (unsigned) ((uint16_t *) c->data)[row]);
+        case DUCKDB_TYPE_UINTEGER:
+            FORMAT_VALUE("%u", ((uint32_t *) c->data)[row]);
+        case DUCKDB_TYPE_UBIGINT:
+            FORMAT_VALUE("%llu", (unsigned long long) ((uint64_t *) c->data)[row]);
+        case DUCKDB_TYPE_HUGEINT:
+            return hugeintToString(((duckdb_hugeint *) c->data)[row], 0, buf, bufSize);
+        case DUCKDB_TYPE_FLOAT:
+        case DUCKDB_TYPE_DOUBLE:
+        {
+            double d = (c->type == DUCKDB_TYPE_FLOAT) ? ((float *) c->data)[row]
+                    : ((double *) c->data)[row];
+
+            // shortest representation that reads back as the same value
+            snprintf(buf, bufSize, "%.15g", d);
+            if (strtod(buf, NULL) != d)
+                snprintf(buf, bufSize, "%.17g", d);
+            return buf;
+        }
+        case DUCKDB_TYPE_DECIMAL:
+        {
+            duckdb_hugeint v;
 
-//     if (rc != DuckDBSuccess) {
-//         StringInfo _newmes = makeStringInfo();
-//         appendStringInfo(_newmes, "failed to prepare query <%s>", q);
-//         StringInfo _errMes = makeStringInfo();
-//         appendStringInfo(_errMes, duckdb_result_error(&result)); // DuckDB provides error message
-//         FATAL_LOG("error (%s)\n%u\n\n%s", _errMes->data, rc, _newmes->data);
-        
-//         duckdb_destroy_result(&result);
-//     }
+            // decimals are stored as integers scaled by 10^scale
+            switch (c->internalType)
+            {
+                case DUCKDB_TYPE_SMALLINT:
+                    v.upper = ((int16_t *) c->data)[row];
+                    break;
+                case DUCKDB_TYPE_INTEGER:
+                    v.upper = ((int32_t *) c->data)[row];
+                    break;
+                case DUCKDB_TYPE_BIGINT:
+                    v.upper = ((int64_t *) c->data)[row];
+                    break;
+                default:
+                    return hugeintToString(((duckdb_hugeint *) c->data)[row], c->scale, buf, bufSize);
+            }
+            v.lower = (uint64_t) v.upper;
+            v.upper = (v.upper < 0) ? -1 : 0;
+            return hugeintToString(v, c->scale, buf, bufSize);
+        }
+        case DUCKDB_TYPE_VARCHAR:
+        case DUCKDB_TYPE_BLOB:
+        {
+            duckdb_string_t *s = ((duckdb_string_t *) c->data) + row;
+            uint32_t len = duckdb_string_t_length(*s);
 
-//     return result;
-// }
+            if (len + 1 > c->bufSize)
+            {
+                FREE(c->buf);
+                c->bufSize = len + 1;
+                c->buf = MALLOC(c->bufSize);
+            }
+            memcpy(c->buf, duckdb_string_t_data(s), len);
+            c->buf[len] = '\0';
+            return c->buf;
+        }
+        case DUCKDB_TYPE_DATE:
+        {
+            duckdb_date_struct d = duckdb_from_date(((duckdb_date *) c->data)[row]);
+
+            snprintf(buf, bufSize, "%04d-%02d-%02d", d.year, d.month, d.day);
+            return buf;
+        }
+        case DUCKDB_TYPE_TIMESTAMP:
+        {
+            duckdb_timestamp_struct t = duckdb_from_timestamp(((duckdb_timestamp *) c->data)[row]);
+
+            snprintf(buf, bufSize, "%04d-%02d-%02d %02d:%02d:%02d",
+                    t.date.year, t.date.month, t.date.day,
+                    t.time.hour, t.time.min, t.time.sec);
+            if (t.time.micros != 0)
+                snprintf(buf + strlen(buf), bufSize - strlen(buf), ".%06d", t.time.micros);
+            return buf;
+        }
+        // other types are read by readTuplesAsVarchar (see isVectorReadable)
+        default:
+            break;
+    }
+
+    return NULL;
+}
+
+/*
+ * Format a 128 bit integer (scaled by 10^scale for decimals) exactly. The
+ * absolute value is divided by 10 in 32 bit digits to extract its decimal
+ * digits from the right.
+ */
+static char *
+hugeintToString (duckdb_hugeint v, uint8_t scale, char *buf, size_t bufSize)
+{
+    char digits[64];
+    int numDigits = 0;
+    boolean negative = v.upper < 0;
+    uint64_t hi = (uint64_t) v.upper;
+    uint64_t lo = v.lower;
+    uint32_t parts[4];
+    boolean isZero;
+    char *pos = buf;
+
+    // absolute value (two's complement)
+    if (negative)
+    {
+        lo = ~lo + 1;
+        hi = ~hi + (lo == 0 ? 1 : 0);
+    }
+    parts[0] = (uint32_t) (hi >> 32);
+    parts[1] = (uint32_t) hi;
+    parts[2] = (uint32_t) (lo >> 32);
+    parts[3] = (uint32_t) lo;
+
+    do
+    {
+        uint64_t rem = 0;
+
+        isZero = TRUE;
+        for (int i = 0; i < 4; i++)
+        {
+            uint64_t cur = (rem << 32) | parts[i];
+
+            parts[i] = (uint32_t) (cur / 10);
+            rem = cur % 10;
+            isZero = isZero && parts[i] == 0;
+        }
+        digits[numDigits++] = '0' + (char) rem;
+    } while (!isZero);
+
+    // decimals have at least one digit before the point
+    while (numDigits <= scale)
+        digits[numDigits++] = '0';
+
+    if (negative && bufSize > 1)
+    {
+        *pos++ = '-';
+        bufSize--;
+    }
+    for (int i = numDigits - 1; i >= 0 && bufSize > 1; i--)
+    {
+        *pos++ = digits[i];
+        bufSize--;
+        if (i == scale && scale > 0 && bufSize > 1)
+        {
+            *pos++ = '.';
+            bufSize--;
+        }
+    }
+    *pos = '\0';
+
+    return buf;
+}
 
 static DataType
 stringToDT (char *dataType)
@@ -615,6 +945,544 @@ duckdbGetConnectionDescription (void)
     return CONCAT_STRINGS("DuckDB:", getStringOption("connection.db"));
 }
 
+#if HAVE_DUCKDB_SKETCH_FUNCTIONS
+
+/*
+ * Native provenance sketch functions (see sketch_functions.h) registered
+ * through the DuckDB C API. Sketches are VARCHARs. Functions that search
+ * fragment bounds have one overload for numeric (DOUBLE) and one for VARCHAR
+ * values and parse the bounds once per chunk unless they change. The
+ * aggregates keep one count per fragment in their state.
+ */
+typedef struct DuckDBSketchAggState
+{
+    idx_t len;
+    gprom_long_t *counts;
+} DuckDBSketchAggState;
+
+typedef struct DuckDBBoundsCache
+{
+    char *literal;
+    SketchBounds *bounds;
+} DuckDBBoundsCache;
+
+static char *
+duckdbCopyString (duckdb_string_t *s)
+{
+    uint32_t len = duckdb_string_t_length(*s);
+    char *result = duckdb_malloc(len + 1);
+
+    memcpy(result, duckdb_string_t_data(s), len);
+    result[len] = '\0';
+
+    return result;
+}
+
+static SketchBounds *
+duckdbGetSketchBounds (DuckDBBoundsCache *c, duckdb_string_t *s)
+{
+    uint32_t len = duckdb_string_t_length(*s);
+    const char *literal = duckdb_string_t_data(s);
+
+    if (c->literal != NULL && strlen(c->literal) == len
+            && strncmp(c->literal, literal, len) == 0)
+        return c->bounds;
+
+    if (c->literal != NULL)
+    {
+        duckdb_free(c->literal);
+        duckdb_free(c->bounds);
+    }
+    c->literal = duckdbCopyString(s);
+    c->bounds = parseSketchBounds(c->literal, duckdb_malloc(sketchBoundsSize(c->literal)));
+
+    return c->bounds;
+}
+
+static void
+duckdbFreeBoundsCache (DuckDBBoundsCache *c)
+{
+    if (c->literal != NULL)
+    {
+        duckdb_free(c->literal);
+        duckdb_free(c->bounds);
+    }
+}
+
+static void
+duckdbSetNull (duckdb_vector output, idx_t row)
+{
+    duckdb_vector_ensure_validity_writable(output);
+    duckdb_validity_set_row_invalid(duckdb_vector_get_validity(output), row);
+}
+
+/*
+ * Bucket position of the value in row of vector v (after the bounds were
+ * found at column boundsCol). Returns -1 if the value is NULL.
+ */
+static int
+duckdbBucketPos (DuckDBBoundsCache *c, duckdb_data_chunk input, idx_t boundsCol,
+        idx_t row, boolean isNum)
+{
+    duckdb_vector bv = duckdb_data_chunk_get_vector(input, boundsCol);
+    duckdb_vector vv = duckdb_data_chunk_get_vector(input, boundsCol + 1);
+    SketchBounds *b;
+    int pos;
+
+    if (!duckdb_validity_row_is_valid(duckdb_vector_get_validity(bv), row)
+            || !duckdb_validity_row_is_valid(duckdb_vector_get_validity(vv), row))
+        return -1;
+
+    b = duckdbGetSketchBounds(c, ((duckdb_string_t *) duckdb_vector_get_data(bv)) + row);
+    if (isNum)
+        return sketchBucketPosNum(b, ((double *) duckdb_vector_get_data(vv))[row]);
+
+    char *str = duckdbCopyString(((duckdb_string_t *) duckdb_vector_get_data(vv)) + row);
+    pos = sketchBucketPosString(b, str);
+    duckdb_free(str);
+
+    return pos;
+}
+
+static void
+duckdbBucketSearch (duckdb_data_chunk input, duckdb_vector output, boolean isNum)
+{
+    idx_t n = duckdb_data_chunk_get_size(input);
+    int32_t *result = (int32_t *) duckdb_vector_get_data(output);
+    DuckDBBoundsCache c = { NULL, NULL };
+
+    for(idx_t i = 0; i < n; i++)
+    {
+        int pos = duckdbBucketPos(&c, input, 0, i, isNum);
+
+        if (pos < 0)
+            duckdbSetNull(output, i);
+        else
+            result[i] = pos;
+    }
+    duckdbFreeBoundsCache(&c);
+}
+
+static void
+duckdbBucketSearchNum (duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output)
+{
+    duckdbBucketSearch(input, output, TRUE);
+}
+
+static void
+duckdbBucketSearchString (duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output)
+{
+    duckdbBucketSearch(input, output, FALSE);
+}
+
+static void
+duckdbSketchContains (duckdb_data_chunk input, duckdb_vector output, boolean isNum)
+{
+    idx_t n = duckdb_data_chunk_get_size(input);
+    duckdb_vector sv = duckdb_data_chunk_get_vector(input, 0);
+    duckdb_string_t *sketches = (duckdb_string_t *) duckdb_vector_get_data(sv);
+    bool *result = (bool *) duckdb_vector_get_data(output);
+    DuckDBBoundsCache c = { NULL, NULL };
+
+    for(idx_t i = 0; i < n; i++)
+    {
+        int pos;
+
+        if (!duckdb_validity_row_is_valid(duckdb_vector_get_validity(sv), i)
+                || (pos = duckdbBucketPos(&c, input, 1, i, isNum)) < 0)
+        {
+            duckdbSetNull(output, i);
+            continue;
+        }
+        result[i] = sketchHasBit(duckdb_string_t_data(sketches + i),
+                duckdb_string_t_length(sketches[i]), pos - 1);
+    }
+    duckdbFreeBoundsCache(&c);
+}
+
+static void
+duckdbSketchContainsNum (duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output)
+{
+    duckdbSketchContains(input, output, TRUE);
+}
+
+static void
+duckdbSketchContainsString (duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output)
+{
+    duckdbSketchContains(input, output, FALSE);
+}
+
+static void
+duckdbSketchBitOp (duckdb_data_chunk input, duckdb_vector output, boolean isAnd)
+{
+    idx_t n = duckdb_data_chunk_get_size(input);
+    duckdb_vector av = duckdb_data_chunk_get_vector(input, 0);
+    duckdb_vector bv = duckdb_data_chunk_get_vector(input, 1);
+    duckdb_string_t *a = (duckdb_string_t *) duckdb_vector_get_data(av);
+    duckdb_string_t *b = (duckdb_string_t *) duckdb_vector_get_data(bv);
+
+    for(idx_t i = 0; i < n; i++)
+    {
+        uint32_t aLen, bLen;
+        char *result;
+        int len;
+
+        if (!duckdb_validity_row_is_valid(duckdb_vector_get_validity(av), i)
+                || !duckdb_validity_row_is_valid(duckdb_vector_get_validity(bv), i))
+        {
+            duckdbSetNull(output, i);
+            continue;
+        }
+
+        aLen = duckdb_string_t_length(a[i]);
+        bLen = duckdb_string_t_length(b[i]);
+        result = duckdb_malloc(MAX(aLen, bLen) + 1);
+        len = sketchBitOp(result, duckdb_string_t_data(a + i), aLen,
+                duckdb_string_t_data(b + i), bLen, isAnd);
+        duckdb_vector_assign_string_element_len(output, i, result, len);
+        duckdb_free(result);
+    }
+}
+
+static void
+duckdbSketchBitOr (duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output)
+{
+    duckdbSketchBitOp(input, output, FALSE);
+}
+
+static void
+duckdbSketchBitAnd (duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output)
+{
+    duckdbSketchBitOp(input, output, TRUE);
+}
+
+static void
+duckdbSketchBitCount (duckdb_function_info info, duckdb_data_chunk input, duckdb_vector output)
+{
+    idx_t n = duckdb_data_chunk_get_size(input);
+    duckdb_vector sv = duckdb_data_chunk_get_vector(input, 0);
+    duckdb_string_t *s = (duckdb_string_t *) duckdb_vector_get_data(sv);
+    int32_t *result = (int32_t *) duckdb_vector_get_data(output);
+
+    for(idx_t i = 0; i < n; i++)
+    {
+        if (!duckdb_validity_row_is_valid(duckdb_vector_get_validity(sv), i))
+            duckdbSetNull(output, i);
+        else
+            result[i] = sketchBitCount(duckdb_string_t_data(s + i),
+                    duckdb_string_t_length(s[i]));
+    }
+}
+
+static idx_t
+duckdbSketchAggSize (duckdb_function_info info)
+{
+    return sizeof(DuckDBSketchAggState);
+}
+
+static void
+duckdbSketchAggInit (duckdb_function_info info, duckdb_aggregate_state state)
+{
+    DuckDBSketchAggState *s = (DuckDBSketchAggState *) state;
+
+    s->len = 0;
+    s->counts = NULL;
+}
+
+static void
+growDuckDBSketchAggState (DuckDBSketchAggState *s, idx_t len)
+{
+    gprom_long_t *counts;
+
+    if (len <= s->len)
+        return;
+
+    counts = duckdb_malloc(sizeof(gprom_long_t) * len);
+    memset(counts, 0, sizeof(gprom_long_t) * len);
+    if (s->counts != NULL)
+    {
+        memcpy(counts, s->counts, sizeof(gprom_long_t) * s->len);
+        duckdb_free(s->counts);
+    }
+    s->counts = counts;
+    s->len = len;
+}
+
+/*
+ * Add rows to the states. The first column is a fragment number (BIGINT) or
+ * a sketch (VARCHAR), the optional second column the number of fragments.
+ */
+static void
+duckdbSketchAggUpdate (duckdb_data_chunk input, duckdb_aggregate_state *states,
+        boolean isFrag)
+{
+    idx_t n = duckdb_data_chunk_get_size(input);
+    duckdb_vector v = duckdb_data_chunk_get_vector(input, 0);
+    int64_t *numFrags = NULL;
+
+    if (duckdb_data_chunk_get_column_count(input) > 1)
+        numFrags = (int64_t *) duckdb_vector_get_data(duckdb_data_chunk_get_vector(input, 1));
+
+    for(idx_t i = 0; i < n; i++)
+    {
+        DuckDBSketchAggState *s = (DuckDBSketchAggState *) states[i];
+
+        if (numFrags != NULL && numFrags[i] > 0)
+            growDuckDBSketchAggState(s, numFrags[i]);
+        if (!duckdb_validity_row_is_valid(duckdb_vector_get_validity(v), i))
+            continue;
+
+        if (isFrag)
+        {
+            int64_t frag = ((int64_t *) duckdb_vector_get_data(v))[i];
+
+            if (frag >= 0)
+            {
+                growDuckDBSketchAggState(s, frag + 1);
+                s->counts[frag]++;
+            }
+        }
+        else
+        {
+            duckdb_string_t *sketch = ((duckdb_string_t *) duckdb_vector_get_data(v)) + i;
+            uint32_t len = duckdb_string_t_length(*sketch);
+
+            growDuckDBSketchAggState(s, len);
+            sketchAddBits(s->counts, duckdb_string_t_data(sketch), len, 1);
+        }
+    }
+}
+
+static void
+duckdbSketchAggUpdateFrag (duckdb_function_info info, duckdb_data_chunk input,
+        duckdb_aggregate_state *states)
+{
+    duckdbSketchAggUpdate(input, states, TRUE);
+}
+
+static void
+duckdbSketchAggUpdateSketch (duckdb_function_info info, duckdb_data_chunk input,
+        duckdb_aggregate_state *states)
+{
+    duckdbSketchAggUpdate(input, states, FALSE);
+}
+
+static void
+duckdbSketchAggCombine (duckdb_function_info info, duckdb_aggregate_state *source,
+        duckdb_aggregate_state *target, idx_t count)
+{
+    for(idx_t i = 0; i < count; i++)
+    {
+        DuckDBSketchAggState *s = (DuckDBSketchAggState *) source[i];
+        DuckDBSketchAggState *t = (DuckDBSketchAggState *) target[i];
+
+        growDuckDBSketchAggState(t, s->len);
+        for(idx_t j = 0; j < s->len; j++)
+            t->counts[j] += s->counts[j];
+    }
+}
+
+static void
+duckdbSketchAggFinalize (duckdb_function_info info, duckdb_aggregate_state *source,
+        duckdb_vector result, idx_t count, idx_t offset)
+{
+    for(idx_t i = 0; i < count; i++)
+    {
+        DuckDBSketchAggState *s = (DuckDBSketchAggState *) source[i];
+        char *sketch;
+
+        if (s->len == 0)
+        {
+            duckdbSetNull(result, offset + i);
+            continue;
+        }
+        sketch = duckdb_malloc(s->len + 1);
+        sketchCountsToBits(sketch, s->counts, s->len);
+        duckdb_vector_assign_string_element_len(result, offset + i, sketch, s->len);
+        duckdb_free(sketch);
+    }
+}
+
+static void
+duckdbSketchAggDestroy (duckdb_aggregate_state *states, idx_t count)
+{
+    for(idx_t i = 0; i < count; i++)
+    {
+        DuckDBSketchAggState *s = (DuckDBSketchAggState *) states[i];
+
+        if (s->counts != NULL)
+            duckdb_free(s->counts);
+        s->counts = NULL;
+        s->len = 0;
+    }
+}
+
+/*
+ * Create one overload of a scalar sketch function. Parameter types are given
+ * as a list of duckdb_type terminated by DUCKDB_TYPE_INVALID.
+ */
+static duckdb_scalar_function
+createSketchScalar (char *name, duckdb_scalar_function_t f, duckdb_type returnType, ...)
+{
+    duckdb_scalar_function result = duckdb_create_scalar_function();
+    duckdb_logical_type t;
+    duckdb_type pType;
+    va_list args;
+
+    duckdb_scalar_function_set_name(result, name);
+    va_start(args, returnType);
+    while((pType = va_arg(args, duckdb_type)) != DUCKDB_TYPE_INVALID)
+    {
+        t = duckdb_create_logical_type(pType);
+        duckdb_scalar_function_add_parameter(result, t);
+        duckdb_destroy_logical_type(&t);
+    }
+    va_end(args);
+
+    t = duckdb_create_logical_type(returnType);
+    duckdb_scalar_function_set_return_type(result, t);
+    duckdb_destroy_logical_type(&t);
+    duckdb_scalar_function_set_function(result, f);
+
+    return result;
+}
+
+static duckdb_aggregate_function
+createSketchAgg (char *name, duckdb_aggregate_update_t update, duckdb_type inType,
+        boolean withNumFrags)
+{
+    duckdb_aggregate_function result = duckdb_create_aggregate_function();
+    duckdb_logical_type t;
+
+    duckdb_aggregate_function_set_name(result, name);
+    t = duckdb_create_logical_type(inType);
+    duckdb_aggregate_function_add_parameter(result, t);
+    duckdb_destroy_logical_type(&t);
+    if (withNumFrags)
+    {
+        t = duckdb_create_logical_type(DUCKDB_TYPE_BIGINT);
+        duckdb_aggregate_function_add_parameter(result, t);
+        duckdb_destroy_logical_type(&t);
+    }
+
+    t = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
+    duckdb_aggregate_function_set_return_type(result, t);
+    duckdb_destroy_logical_type(&t);
+    duckdb_aggregate_function_set_functions(result, duckdbSketchAggSize,
+            duckdbSketchAggInit, update, duckdbSketchAggCombine,
+            duckdbSketchAggFinalize);
+    duckdb_aggregate_function_set_destructor(result, duckdbSketchAggDestroy);
+
+    return result;
+}
+
+static duckdb_state
+registerSketchScalarSet (duckdb_connection conn, char *name,
+        duckdb_scalar_function f1, duckdb_scalar_function f2)
+{
+    duckdb_scalar_function_set set = duckdb_create_scalar_function_set(name);
+    duckdb_state rc;
+
+    duckdb_add_scalar_function_to_set(set, f1);
+    if (f2 != NULL)
+        duckdb_add_scalar_function_to_set(set, f2);
+    rc = duckdb_register_scalar_function_set(conn, set);
+
+    duckdb_destroy_scalar_function(&f1);
+    if (f2 != NULL)
+        duckdb_destroy_scalar_function(&f2);
+    duckdb_destroy_scalar_function_set(&set);
+
+    return rc;
+}
+
+static duckdb_state
+registerSketchAggSet (duckdb_connection conn, char *name, List *overloads)
+{
+    duckdb_aggregate_function_set set = duckdb_create_aggregate_function_set(name);
+    duckdb_state rc;
+
+    FOREACH_LC(lc,overloads)
+        duckdb_add_aggregate_function_to_set(set, (duckdb_aggregate_function) LC_P_VAL(lc));
+    rc = duckdb_register_aggregate_function_set(conn, set);
+
+    FOREACH_LC(lc,overloads)
+    {
+        duckdb_aggregate_function f = (duckdb_aggregate_function) LC_P_VAL(lc);
+        duckdb_destroy_aggregate_function(&f);
+    }
+    duckdb_destroy_aggregate_function_set(&set);
+
+    return rc;
+}
+
+#define CHECK_REGISTER(_call) \
+    do { \
+        if ((_call) != DuckDBSuccess) \
+        { \
+            ERROR_LOG("failed to register native sketch function: %s", #_call); \
+            return DuckDBError; \
+        } \
+    } while(0)
+
+static duckdb_state
+registerSketchFunctions (duckdb_connection conn)
+{
+    CHECK_REGISTER(registerSketchScalarSet(conn, SKETCH_FUN_BUCKET_SEARCH,
+            createSketchScalar(SKETCH_FUN_BUCKET_SEARCH, duckdbBucketSearchNum,
+                    DUCKDB_TYPE_INTEGER, DUCKDB_TYPE_VARCHAR, DUCKDB_TYPE_DOUBLE,
+                    DUCKDB_TYPE_INVALID),
+            createSketchScalar(SKETCH_FUN_BUCKET_SEARCH, duckdbBucketSearchString,
+                    DUCKDB_TYPE_INTEGER, DUCKDB_TYPE_VARCHAR, DUCKDB_TYPE_VARCHAR,
+                    DUCKDB_TYPE_INVALID)));
+    CHECK_REGISTER(registerSketchScalarSet(conn, SKETCH_FUN_CONTAINS,
+            createSketchScalar(SKETCH_FUN_CONTAINS, duckdbSketchContainsNum,
+                    DUCKDB_TYPE_BOOLEAN, DUCKDB_TYPE_VARCHAR, DUCKDB_TYPE_VARCHAR,
+                    DUCKDB_TYPE_DOUBLE, DUCKDB_TYPE_INVALID),
+            createSketchScalar(SKETCH_FUN_CONTAINS, duckdbSketchContainsString,
+                    DUCKDB_TYPE_BOOLEAN, DUCKDB_TYPE_VARCHAR, DUCKDB_TYPE_VARCHAR,
+                    DUCKDB_TYPE_VARCHAR, DUCKDB_TYPE_INVALID)));
+    CHECK_REGISTER(registerSketchScalarSet(conn, SKETCH_FUN_BITOR,
+            createSketchScalar(SKETCH_FUN_BITOR, duckdbSketchBitOr, DUCKDB_TYPE_VARCHAR,
+                    DUCKDB_TYPE_VARCHAR, DUCKDB_TYPE_VARCHAR, DUCKDB_TYPE_INVALID),
+            NULL));
+    CHECK_REGISTER(registerSketchScalarSet(conn, SKETCH_FUN_BITAND,
+            createSketchScalar(SKETCH_FUN_BITAND, duckdbSketchBitAnd, DUCKDB_TYPE_VARCHAR,
+                    DUCKDB_TYPE_VARCHAR, DUCKDB_TYPE_VARCHAR, DUCKDB_TYPE_INVALID),
+            NULL));
+    CHECK_REGISTER(registerSketchScalarSet(conn, SKETCH_FUN_BIT_COUNT,
+            createSketchScalar(SKETCH_FUN_BIT_COUNT, duckdbSketchBitCount,
+                    DUCKDB_TYPE_INTEGER, DUCKDB_TYPE_VARCHAR, DUCKDB_TYPE_INVALID),
+            NULL));
+
+    CHECK_REGISTER(registerSketchAggSet(conn, SKETCH_FUN_SET_BITS, LIST_MAKE(
+            createSketchAgg(SKETCH_FUN_SET_BITS, duckdbSketchAggUpdateFrag, DUCKDB_TYPE_BIGINT, FALSE),
+            createSketchAgg(SKETCH_FUN_SET_BITS, duckdbSketchAggUpdateFrag, DUCKDB_TYPE_BIGINT, TRUE),
+            createSketchAgg(SKETCH_FUN_SET_BITS, duckdbSketchAggUpdateSketch, DUCKDB_TYPE_VARCHAR, FALSE),
+            createSketchAgg(SKETCH_FUN_SET_BITS, duckdbSketchAggUpdateSketch, DUCKDB_TYPE_VARCHAR, TRUE))));
+    CHECK_REGISTER(registerSketchAggSet(conn, SKETCH_FUN_BITOR_AGG, singleton(
+            createSketchAgg(SKETCH_FUN_BITOR_AGG, duckdbSketchAggUpdateSketch, DUCKDB_TYPE_VARCHAR, FALSE))));
+
+    DEBUG_LOG("registered native provenance sketch functions");
+
+    return DuckDBSuccess;
+}
+
+#else
+
+/*
+ * DuckDB versions without function sets: sketch capture and use fall back
+ * to the rewrites used for backends without native sketch functions.
+ */
+static duckdb_state
+registerSketchFunctions (duckdb_connection conn)
+{
+    DEBUG_LOG("DuckDB does not support function sets, no native provenance sketch functions");
+    return DuckDBSuccess;
+}
+
+#endif /* HAVE_DUCKDB_SKETCH_FUNCTIONS */
+
 #define ADD_AGGR_FUNC(name) addToSet(plugin->plugin.cache->aggFuncNames, strdup(name))
 #define ADD_WIN_FUNC(name) addToSet(plugin->plugin.cache->winFuncNames, strdup(name))
 #define ADD_BOTH_FUNC(name) \
@@ -633,6 +1501,10 @@ initCache(CatalogCache *c)
     ADD_BOTH_FUNC("min");
     ADD_BOTH_FUNC("sum");
     ADD_BOTH_FUNC("total");
+#if HAVE_DUCKDB_SKETCH_FUNCTIONS
+    ADD_BOTH_FUNC(SKETCH_FUN_SET_BITS);
+    ADD_BOTH_FUNC(SKETCH_FUN_BITOR_AGG);
+#endif
 
     ADD_WIN_FUNC("row_number");
     ADD_WIN_FUNC("rank");
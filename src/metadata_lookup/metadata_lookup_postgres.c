@@ -16,6 +16,7 @@
 #include "mem_manager/mem_mgr.h"
 #include "log/logger.h"
 #include "instrumentation/timing_instrumentation.h"
+#include "instrumentation/backend_instrumentation.h"
 
 #include "configuration/option.h"
 #include "metadata_lookup/metadata_lookup.h"
@@ -36,6 +37,7 @@
 
 // Mem context
 #define CONTEXT_NAME "PostgresMemContext"
+#define PREFETCH_CONTEXT_NAME "PostgresPrefetchMemContext"
 
 #define EXPLAIN_FUNC_NAME "_get_explain_json"
 #define CREATE_EXPLAIN_FUNC "create or replace function " EXPLAIN_FUNC_NAME "(in qry text, out r jsonb) returns setof jsonb as $$" \
@@ -132,6 +134,38 @@
                      "FROM pg_constraint c, pg_class t, pg_attribute a " \
                      "WHERE c.contype = 'p' AND c.conrelid = t.oid AND t.relname = $1::text AND a.attrelid = t.oid AND a.attnum = ANY(c.conkey);"
 
+// bulk versions of the lookups above used to prefetch catalog information
+#define NAME_PREFETCH_RELS "GPRoM_PrefetchRelations"
+#define PARAMS_PREFETCH_RELS 1
+#define QUERY_PREFETCH_RELS "SELECT c.relname, c.relkind, a.attname, a.atttypid, " \
+        "CASE WHEN c.relkind = 'v' THEN pg_get_viewdef(c.oid) END " \
+        "FROM pg_class c LEFT OUTER JOIN pg_attribute a " \
+        "ON (c.oid = a.attrelid " \
+        "AND c.relkind = 'r' " \
+        "AND a.atttypid != 0 " \
+        "AND a.attisdropped = false " \
+        "AND a.attname NOT IN ('tableoid', 'cmax', 'xmax', 'cmin', 'xmin', 'ctid')) " \
+        "WHERE c.relkind IN ('r', 'v') AND c.relname = ANY($1::text[]) " \
+        "ORDER BY c.relname, c.relkind, a.attnum;"
+
+#define NAME_PREFETCH_PKS "GPRoM_PrefetchPKs"
+#define PARAMS_PREFETCH_PKS 1
+#define QUERY_PREFETCH_PKS "SELECT t.relname, a.attname " \
+        "FROM pg_constraint c, pg_class t, pg_attribute a " \
+        "WHERE c.contype = 'p' AND c.conrelid = t.oid AND t.relname = ANY($1::text[]) AND a.attrelid = t.oid AND a.attnum = ANY(c.conkey);"
+
+#define NAME_PREFETCH_FUNCS_11 "GPRoM_PrefetchFuncs"
+#define PARAMS_PREFETCH_FUNCS_11 1
+#define QUERY_PREFETCH_FUNCS_11 "SELECT proname, bool_or(prokind = 'a') AS is_agg, " \
+        "bool_or(prokind = 'w' OR prokind = 'a') AS is_win FROM pg_proc " \
+        "WHERE proname = ANY($1::text[]) GROUP BY proname;"
+
+#define NAME_PREFETCH_FUNCS "GPRoM_PrefetchFuncs"
+#define PARAMS_PREFETCH_FUNCS 1
+#define QUERY_PREFETCH_FUNCS "SELECT proname, bool_or(proisagg) AS is_agg, " \
+        "bool_or(proiswindow OR proisagg) AS is_win FROM pg_proc " \
+        "WHERE proname = ANY($1::text[]) GROUP BY proname;"
+
 #define NAME_GET_HIST "GPRoM_GetHist"
 #define PARAMS_GET_HIST 2
 #define QUERY_GET_HIST "SELECT histogram_bounds FROM pg_stats WHERE tablename = $1::text AND attname = $2::text;"
@@ -152,7 +186,6 @@
 // functions
 static void execStmt (char *stmt);
 static PGresult *execQuery(char *query);
-static void execCommit(void);
 static PGresult *execPrepared(char *qName, List *values);
 static boolean prepareQuery(char *qName, char *query, int parameters,
         Oid *types);
@@ -168,15 +201,23 @@ static List *oidVecToOidList (char *oidVec);
 static DataType postgresOidToDT(char *Oid);
 static DataType postgresOidIntToDT(int oid);
 static DataType postgresTypenameToDT (char *typName);
-
-// closing result sets and connections
-#define CLOSE_QUERY() \
-		do { \
-		    PGresult *_res; \
-            _res = PQexec(conn, "CLOSE myportal"); \
-            PQclear(_res); \
-		} while(0)
-
+static Relation *pgResultToRelation (PGresult *rs);
+static Vector *pgRowToTuple (PGresult *rs, int row);
+static PGresult *getStreamResult (void);
+static void drainPendingQuery (void);
+static void readPendingResult (void);
+static boolean isReadOnlyQuery (char *query);
+static PGconn *connectToServer (void);
+static void *postgresOpenPooledConnection (void);
+static void postgresClosePooledConnection (void *conn);
+static void *postgresSwitchConnection (void *conn);
+static PGresult *trackRoundTrip (PGresult *res);
+static char *stringListToPgArray (List *strs);
+static void prefetchRelations (List *names);
+static void prefetchKeys (List *tableNames);
+static void prefetchFunctions (List *functionNames);
+
+// closing connections
 #define CLOSE_CONN_AND_FATAL(...)                           \
     do {                                                    \
         PQfinish(plugin->conn);                             \
@@ -203,6 +244,13 @@ typedef struct PostgresPlugin
     boolean initialized;
     int serverMajorVersion;
     int serverMinorVersion;
+    boolean queryPending;       // query sent with postgresSendQuery whose result has not been fetched yet
+    boolean pendingDrained;     // result of pending query has been read from the connection
+    PGresult *pendingResult;
+    PGconn *pendingConn;        // connection the pending query runs on
+    boolean pendingPooled;      // pendingConn has been checked out from the connection pool
+    boolean streamOpen;         // result of a query is read row by row (see postgresOpenResultStream)
+    PGresult *streamResult;     // first result of the stream read to determine its schema
 } PostgresPlugin;
 
 // data types: additional cache entries
@@ -210,6 +258,12 @@ typedef struct PostgresMetaCache {
     HashMap *oidToDT;   // maps datatype OID to GProM datatypes
     Set *anyOids;
 	HashMap *tableMinMax;
+    // prefetched for the current statement only, since DDL statements like
+    // ALTER TABLE ... ADD PRIMARY KEY or CREATE AGGREGATE may change them
+    MemContext *prefetchContext;
+    HashMap *tableKeys;         // tablename -> set of primary key attributes (empty if there is none)
+    Set *nonAggFuncNames;       // functions known to not be aggregate functions
+    Set *nonWinFuncNames;       // functions known to not be window functions
 } PostgresMetaCache;
 
 #define GET_CACHE() ((PostgresMetaCache *) plugin->plugin.cache->cacheHook)
@@ -222,6 +276,8 @@ typedef struct PostgresMetaCache {
 #define METADATA_LOOKUP_PREPARE_QUERY_TIME "Postgres - execute prepare query"
 #define METADATA_LOOKUP_EXEC_PREPARED "Postgres - execute prepared"
 #define METADATA_LOOKUP_EXEC_STMT "Postgres - execute stmt"
+#define METADATA_LOOKUP_ASYNC_WAIT "Postgres - wait for async query"
+#define METADATA_LOOKUP_STREAM "Postgres - stream query result"
 
 // global vars
 static PostgresPlugin *plugin = NULL;
@@ -243,6 +299,7 @@ assemblePostgresMetadataLookupPlugin (void)
     p->isInitialized = postgresIsInitialized;
     p->catalogTableExists = postgresCatalogTableExists;
     p->catalogViewExists = postgresCatalogViewExists;
+    p->prefetchCatalog = postgresPrefetchCatalog;
     p->getAttributes = postgresGetAttributes;
     p->getAttributeNames = postgresGetAttributeNames;
     p->getHistogram = postgresGetHist;
@@ -253,6 +310,7 @@ assemblePostgresMetadataLookupPlugin (void)
     p->storePsTemplates = postgresStorePsTemplate;
     p->storePsHistogram = postgresStorePsHist;
     p->storePsInformation = postgresStorePsInfo;
+    p->deletePsInformation = postgresDeletePsInfo;
     p->createProvenanceSketchTemplateTable = postgresCreatePSTemplateTable;
     p->createProvenanceSketchInfoTable = postgresCreatePSInfoTable;
     p->createProvenanceSketchHistTable = postgresCreatePSHistTable;
@@ -268,6 +326,14 @@ assemblePostgresMetadataLookupPlugin (void)
     p->getKeyInformation = postgresGetKeyInformation;
     p->executeQuery = postgresExecuteQuery;
     p->executeQueryIgnoreResult = postgresExecuteQueryIgnoreResult;
+    p->sendQuery = postgresSendQuery;
+    p->getQueryResult = postgresGetQueryResult;
+    p->openResultStream = postgresOpenResultStream;
+    p->nextStreamTuple = postgresNextStreamTuple;
+    p->closeResultStream = postgresCloseResultStream;
+    p->openPooledConnection = postgresOpenPooledConnection;
+    p->closePooledConnection = postgresClosePooledConnection;
+    p->switchConnection = postgresSwitchConnection;
     p->connectionDescription = postgresGetConnectionDescription;
     p->sqlTypeToDT = postgresBackendSQLTypeToDT;
     p->dataTypeToSQL = postgresBackendDatatypeToSQL;
@@ -302,6 +368,10 @@ postgresInitMetadataLookupPlugin (void)
     psqlCache->oidToDT = NEW_MAP(Constant,Constant);
     psqlCache->anyOids = INTSET();
 	psqlCache->tableMinMax = NEW_MAP(Constant,HashMap);
+    psqlCache->prefetchContext = NULL;
+    psqlCache->tableKeys = NEW_MAP(Constant,Set);
+    psqlCache->nonAggFuncNames = STRSET();
+    psqlCache->nonWinFuncNames = STRSET();
     plugin->plugin.cache->cacheHook = (void *) psqlCache;
 
     plugin->initialized = TRUE;
@@ -314,6 +384,8 @@ postgresInitMetadataLookupPlugin (void)
 int
 postgresShutdownMetadataLookupPlugin (void)
 {
+    if (GET_CACHE()->prefetchContext != NULL)
+        FREE_MEM_CONTEXT(GET_CACHE()->prefetchContext);
     ACQUIRE_MEM_CONTEXT(memContext);
 
     // clear cache and postgres cache
@@ -327,13 +399,43 @@ postgresShutdownMetadataLookupPlugin (void)
 int
 postgresDatabaseConnectionOpen (void)
 {
-    StringInfo connStr;
-//    OptionConnection *op = getOptions()->optionConnection;
-
     ACQUIRE_MEM_CONTEXT(memContext);
 	START_TIMER(METADATA_LOOKUP_TIMER);
 
-	connStr = makeStringInfo();
+    /* try to connect to db */
+    plugin->conn = connectToServer();
+    if (plugin->conn == NULL)
+    {
+        STOP_TIMER(METADATA_LOOKUP_TIMER);
+        RELEASE_MEM_CONTEXT();
+        return EXIT_FAILURE;
+    }
+
+    plugin->initialized = TRUE;
+
+    // determine server version
+    determineServerVersion();
+
+    // prepare queries
+    prepareLookupQueries();
+
+    // initialize cache
+    fillOidToDTMap(GET_CACHE()->oidToDT, GET_CACHE()->anyOids);
+
+	STOP_TIMER(METADATA_LOOKUP_TIMER);
+    RELEASE_MEM_CONTEXT();
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Open a connection with the connection parameters from the options. Returns
+ * NULL if the connection cannot be established.
+ */
+static PGconn *
+connectToServer (void)
+{
+    StringInfo connStr = makeStringInfo();
+    PGconn *conn;
 
     /* create connection string */
     appendStringInfo(connStr, " host=%s", getStringOption("connection.host"));
@@ -343,44 +445,63 @@ postgresDatabaseConnectionOpen (void)
         appendStringInfo(connStr, " password=%s", getStringOption("connection.passwd"));
     appendStringInfo(connStr, " port=%u", getIntOption("connection.port"));
 
-    /* try to connect to db */
-    plugin->conn = PQconnectdb(connStr->data);
+    conn = PQconnectdb(connStr->data);
 
     /* check to see that the backend connection was successfully made */
-    if (plugin->conn == NULL || PQstatus(plugin->conn) == CONNECTION_BAD)
+    if (conn == NULL)
     {
-        if(plugin->conn != NULL)
-        {
-            char *error = PQerrorMessage(plugin->conn);
-            PQfinish(plugin->conn);
-            plugin->conn = NULL;
-            RELEASE_MEM_CONTEXT();
-            ERROR_LOG("unable to connect to postgres database %s\n\nfailed "
-                      "because of:\n%s", connStr->data, error);
-            return EXIT_FAILURE;
-        }
-        else
-        {
-            RELEASE_MEM_CONTEXT();
-            ERROR_LOG("unable to connect to postgres, no connection object was created.");
-            return EXIT_FAILURE;
-        }
+        ERROR_LOG("unable to connect to postgres, no connection object was created.");
+        return NULL;
     }
+    if (PQstatus(conn) == CONNECTION_BAD)
+    {
+        char *error = strdup(PQerrorMessage(conn));
 
-    plugin->initialized = TRUE;
+        PQfinish(conn);
+        ERROR_LOG("unable to connect to postgres database %s\n\nfailed "
+                  "because of:\n%s", connStr->data, error);
+        return NULL;
+    }
 
-    // determine server version
-    determineServerVersion();
+    return conn;
+}
 
-    // prepare queries
+/*
+ * Open an additional connection for the connection pool. The lookup queries
+ * are prepared on the new connection, so all plugin methods can run on it.
+ */
+static void *
+postgresOpenPooledConnection (void)
+{
+    PGconn *conn = connectToServer();
+    PGconn *mainConn = plugin->conn;
+
+    if (conn == NULL)
+        return NULL;
+
+    plugin->conn = conn;
     prepareLookupQueries();
+    plugin->conn = mainConn;
 
-    // initialize cache
-    fillOidToDTMap(GET_CACHE()->oidToDT, GET_CACHE()->anyOids);
+    return conn;
+}
 
-	STOP_TIMER(METADATA_LOOKUP_TIMER);
-    RELEASE_MEM_CONTEXT();
-    return EXIT_SUCCESS;
+static void
+postgresClosePooledConnection (void *conn)
+{
+    PQfinish((PGconn *) conn);
+}
+
+static void *
+postgresSwitchConnection (void *conn)
+{
+    PGconn *prev = plugin->conn;
+
+    if (plugin->streamOpen)
+        FATAL_LOG("cannot switch connection while a result stream is open");
+
+    plugin->conn = (PGconn *) conn;
+    return prev;
 }
 
 static char *
@@ -413,7 +534,7 @@ fillOidToDTMap (HashMap *oidToDT, Set *anyOids)
     }
 
     PQclear(res);
-    execCommit();
+    STOP_TIMER(METADATA_LOOKUP_QUERY_TIMER);
 
     // get OIDs of any/anyelement types that have to be treated special
 	START_TIMER(METADATA_LOOKUP_QUERY_TIMER);
@@ -430,7 +551,7 @@ fillOidToDTMap (HashMap *oidToDT, Set *anyOids)
     }
 
     PQclear(res);
-    execCommit();
+    STOP_TIMER(METADATA_LOOKUP_QUERY_TIMER);
 
     DEBUG_NODE_BEATIFY_LOG("oid -> DT map:", oidToDT);
 }
@@ -460,7 +581,7 @@ determineServerVersion(void)
     }
 
     PQclear(res);
-    execCommit();
+    STOP_TIMER(METADATA_LOOKUP_QUERY_TIMER);
 }
 
 static void
@@ -502,17 +623,21 @@ prepareLookupQueries(void)
     PREP_QUERY(GET_OP_DEFS);
     PREP_QUERY(GET_PK);
     PREP_QUERY(GET_HIST);
+    PREP_QUERY(PREFETCH_RELS);
+    PREP_QUERY(PREFETCH_PKS);
 
     // catalog pg_proc has changed in 11
     if (plugin->serverMajorVersion >= 11)
     {
         PREP_QUERY(IS_WIN_FUNC_11);
         PREP_QUERY(IS_AGG_FUNC_11);
+        PREP_QUERY(PREFETCH_FUNCS_11);
     }
     else
     {
         PREP_QUERY(IS_WIN_FUNC);
         PREP_QUERY(IS_AGG_FUNC);
+        PREP_QUERY(PREFETCH_FUNCS);
     }
 }
 
@@ -522,6 +647,21 @@ postgresDatabaseConnectionClose()
     ACQUIRE_MEM_CONTEXT(memContext);
     ASSERT(plugin && plugin->initialized);
 
+    if (plugin->pendingResult != NULL)
+        PQclear(plugin->pendingResult);
+    plugin->pendingResult = NULL;
+    if (plugin->queryPending && plugin->pendingPooled)
+        PQfinish(plugin->pendingConn);
+    plugin->queryPending = FALSE;
+    // the rest of a stream that was not closed is discarded with the connection
+    if (plugin->streamOpen)
+    {
+        if (plugin->streamResult != NULL)
+            PQclear(plugin->streamResult);
+        plugin->streamResult = NULL;
+        plugin->streamOpen = FALSE;
+        STOP_TIMER(METADATA_LOOKUP_STREAM);
+    }
     PQfinish(plugin->conn);
 
     RELEASE_MEM_CONTEXT();
@@ -843,6 +983,235 @@ postgresCatalogViewExists (char * viewName)
 }
 
 
+/*
+ * Fill the cache for all tables, views, and functions referenced by a query
+ * using one query per kind of catalog information instead of one query per
+ * object and kind.
+ */
+void
+postgresPrefetchCatalog (List *tableNames, List *functionNames)
+{
+    CatalogCache *cache = plugin->plugin.cache;
+    PostgresMetaCache *psqlCache = GET_CACHE();
+    List *rels = NIL;
+    List *keys = NIL;
+    List *funcs = NIL;
+
+    START_TIMER(METADATA_LOOKUP_TIMER);
+    ACQUIRE_MEM_CONTEXT(memContext);
+
+    // forget what was prefetched for the previous statement
+    if (psqlCache->prefetchContext != NULL)
+        FREE_MEM_CONTEXT(psqlCache->prefetchContext);
+    psqlCache->prefetchContext = NEW_LONGLIVED_MEMCONTEXT(PREFETCH_CONTEXT_NAME);
+    ACQUIRE_MEM_CONTEXT(psqlCache->prefetchContext);
+    psqlCache->tableKeys = NEW_MAP(Constant,Set);
+    psqlCache->nonAggFuncNames = STRSET();
+    psqlCache->nonWinFuncNames = STRSET();
+    RELEASE_MEM_CONTEXT();
+
+    // only lookup objects we do not know about yet
+    FOREACH(char,t,tableNames)
+    {
+        if (!MAP_HAS_STRING_KEY(cache->tableAttrDefs, t)
+                && !hasSetElem(cache->viewNames, t)
+                && !searchListString(rels, t))
+            rels = appendToTailOfList(rels, t);
+    }
+    if (rels != NIL)
+        prefetchRelations(rels);
+
+    FOREACH(char,t,tableNames)
+    {
+        if (hasSetElem(cache->tableNames, t)
+                && !MAP_HAS_STRING_KEY(psqlCache->tableKeys, t)
+                && !searchListString(keys, t))
+            keys = appendToTailOfList(keys, t);
+    }
+    if (keys != NIL)
+        prefetchKeys(keys);
+
+    FOREACH(char,fName,functionNames)
+    {
+        char *f = strdup(fName);
+
+        for(char *p = f; *p != '\0'; *(p) = tolower(*p), p++)
+            ;
+        if (!(hasSetElem(cache->aggFuncNames, f) || hasSetElem(psqlCache->nonAggFuncNames, f))
+                && !searchListString(funcs, f))
+            funcs = appendToTailOfList(funcs, f);
+    }
+    if (funcs != NIL)
+        prefetchFunctions(funcs);
+
+    RELEASE_MEM_CONTEXT();
+    STOP_TIMER(METADATA_LOOKUP_TIMER);
+}
+
+/*
+ * Determine which of the relations exist and cache the attributes of tables
+ * and the definitions of views. Rows are sorted by relation, so the
+ * attributes of a table are consecutive.
+ */
+static void
+prefetchRelations (List *names)
+{
+    CatalogCache *cache = plugin->plugin.cache;
+    PGresult *res;
+    char *curTable = NULL;
+    List *attrDefs = NIL;
+    List *attrNames = NIL;
+
+    res = execPrepared(NAME_PREFETCH_RELS,
+            singleton(createConstString(stringListToPgArray(names))));
+
+    for(int i = 0; i <= PQntuples(res); i++)
+    {
+        char *relName = (i < PQntuples(res)) ? PQgetvalue(res,i,0) : NULL;
+
+        // store attributes of previous table
+        if (curTable != NULL && (relName == NULL || !streq(relName, curTable)))
+        {
+            addToSet(cache->tableNames, curTable);
+            MAP_ADD_STRING_KEY(cache->tableAttrDefs, curTable, attrDefs);
+            MAP_ADD_STRING_KEY(cache->tableAttrs, curTable, attrNames);
+            DEBUG_LOG("prefetched table %s attributes are <%s>", curTable,
+                    stringListToString(attrNames));
+            curTable = NULL;
+            attrDefs = NIL;
+            attrNames = NIL;
+        }
+        if (relName == NULL)
+            break;
+
+        if (streq(PQgetvalue(res,i,1), "v"))
+        {
+            char *v = strdup(relName);
+
+            addToSet(cache->viewNames, v);
+            if (!MAP_HAS_STRING_KEY(cache->viewDefs, v))
+                MAP_ADD_STRING_KEY(cache->viewDefs, v,
+                        createConstString(PQgetvalue(res,i,4)));
+            continue;
+        }
+
+        if (curTable == NULL)
+            curTable = strdup(relName);
+        if (!PQgetisnull(res,i,2))
+        {
+            attrDefs = appendToTailOfList(attrDefs, createAttributeDef(
+                    strdup(PQgetvalue(res,i,2)),
+                    postgresOidToDT(strdup(PQgetvalue(res,i,3)))));
+            attrNames = appendToTailOfList(attrNames, strdup(PQgetvalue(res,i,2)));
+        }
+    }
+
+    PQclear(res);
+}
+
+static void
+prefetchKeys (List *tableNames)
+{
+    PostgresMetaCache *psqlCache = GET_CACHE();
+    PGresult *res;
+
+    res = execPrepared(NAME_PREFETCH_PKS,
+            singleton(createConstString(stringListToPgArray(tableNames))));
+
+    ACQUIRE_MEM_CONTEXT(psqlCache->prefetchContext);
+
+    // tables without a primary key are cached with an empty set
+    FOREACH(char,t,tableNames)
+        MAP_ADD_STRING_KEY(psqlCache->tableKeys, t, STRSET());
+
+    for(int i = 0; i < PQntuples(res); i++)
+    {
+        Set *keySet = (Set *) MAP_GET_STRING(psqlCache->tableKeys, PQgetvalue(res,i,0));
+
+        addToSet(keySet, strdup(PQgetvalue(res,i,1)));
+    }
+    RELEASE_MEM_CONTEXT();
+
+    PQclear(res);
+}
+
+static void
+prefetchFunctions (List *functionNames)
+{
+    CatalogCache *cache = plugin->plugin.cache;
+    PostgresMetaCache *psqlCache = GET_CACHE();
+    PGresult *res;
+    Set *found = STRSET();
+
+    res = execPrepared(NAME_PREFETCH_FUNCS,
+            singleton(createConstString(stringListToPgArray(functionNames))));
+
+    for(int i = 0; i < PQntuples(res); i++)
+    {
+        char *f = strdup(PQgetvalue(res,i,0));
+
+        addToSet(found, f);
+        if (streq(PQgetvalue(res,i,1),"t"))
+            addToSet(cache->aggFuncNames, f);
+        if (streq(PQgetvalue(res,i,2),"t"))
+            addToSet(cache->winFuncNames, f);
+    }
+
+    // negative results are only valid for the current statement
+    ACQUIRE_MEM_CONTEXT(psqlCache->prefetchContext);
+    for(int i = 0; i < PQntuples(res); i++)
+    {
+        char *f = strdup(PQgetvalue(res,i,0));
+
+        if (!streq(PQgetvalue(res,i,1),"t"))
+            addToSet(psqlCache->nonAggFuncNames, f);
+        if (!streq(PQgetvalue(res,i,2),"t"))
+            addToSet(psqlCache->nonWinFuncNames, f);
+    }
+    // functions that do not exist in the catalog are neither
+    FOREACH(char,fName,functionNames)
+    {
+        if (!hasSetElem(found, fName))
+        {
+            char *f = strdup(fName);
+
+            addToSet(psqlCache->nonAggFuncNames, f);
+            addToSet(psqlCache->nonWinFuncNames, f);
+        }
+    }
+    RELEASE_MEM_CONTEXT();
+
+    PQclear(res);
+}
+
+/*
+ * Create a Postgres array literal, e.g., {"a","b"} from a list of strings.
+ */
+static char *
+stringListToPgArray (List *strs)
+{
+    StringInfo str = makeStringInfo();
+
+    appendStringInfoChar(str, '{');
+    FOREACH(char,s,strs)
+    {
+        appendStringInfoChar(str, '"');
+        for(char *c = s; *c != '\0'; c++)
+        {
+            if (*c == '"' || *c == '\\')
+                appendStringInfoChar(str, '\\');
+            appendStringInfoChar(str, *c);
+        }
+        appendStringInfoChar(str, '"');
+        if (FOREACH_HAS_MORE(s))
+            appendStringInfoChar(str, ',');
+    }
+    appendStringInfoChar(str, '}');
+
+    return str->data;
+}
+
+
 List *
 postgresGetAttributes (char *tableName)
 {
@@ -913,7 +1282,8 @@ HashMap *
 postgresGetPS (char *sql, List *attrNames)
 {
     //List *attrs = NIL;
-    PGresult *res = NULL;
+    Vector *tuple;
+    Vector *last = NULL;
     HashMap *hm = NEW_MAP(Constant,Constant);
     //ASSERT(postgresCatalogTableExists(tableName));
 
@@ -924,21 +1294,25 @@ postgresGetPS (char *sql, List *attrNames)
     ACQUIRE_MEM_CONTEXT(memContext);
     START_TIMER(METADATA_LOOKUP_TIMER);
     START_TIMER("Postgres - execute get ps");
-	res = execQuery(sql);
+    postgresOpenResultStream(sql);
 
-    // loop through results
-    for(int i = 0; i < PQntuples(res); i++) {
-    		for(int j = 0; j < LIST_LENGTH(attrNames); j++) {
-    			//attrs = appendToTailOfList(attrs, strdup(PQgetvalue(res,i,j)));
-    			char *attrName = getNthOfListP(attrNames, j);
-    			MAP_ADD_STRING_KEY(hm, attrName, createConstString(strdup(PQgetvalue(res,i,j))));
-    		}
+    // stream results, the sketches are taken from the last row
+    while((tuple = postgresNextStreamTuple()) != NULL)
+    {
+        if (last != NULL)
+            deepFreeVec(last);
+        last = tuple;
+    }
+
+    if (last != NULL)
+    {
+        for(int j = 0; j < LIST_LENGTH(attrNames); j++) {
+            char *attrName = getNthOfListP(attrNames, j);
+            MAP_ADD_STRING_KEY(hm, attrName, createConstString(getVecString(last, j)));
+        }
     }
 
     STOP_TIMER("Postgres - execute get ps");
-    execStmt("commit;");
-    // clear result
-    PQclear(res);
 
     DEBUG_NODE_LOG("Captured Provenance Sketch :", (Node *) hm);
     //DEBUG_LOG("Captured Provenance Sketch : <%s>", stringListToString(attrs));
@@ -978,7 +1352,6 @@ postgresGetPSTemplateFromTable ()
 //    setLtempNoMap(tmap);
 
     START_TIMER("Postgres - execute get stored ps template");
-    execStmt("commit;");
     // clear result
     PQclear(res);
 
@@ -1049,7 +1422,6 @@ postgresGetPSInfoFromTable ()
     }
 
     START_TIMER("Postgres - execute get stored ps information");
-    execStmt("commit;");
     // clear result
     PQclear(res);
 
@@ -1097,8 +1469,7 @@ postgresGetPSInfoFromTable ()
 //    }
 //
 //    START_TIMER("Postgres - execute get stored ps information");
-//    execStmt("commit;");
-//    // clear result
+////    // clear result
 //    PQclear(res);
 //
 //    //DEBUG_NODE_LOG("Captured Provenance Sketch :", (Node *) hm);
@@ -1165,7 +1536,6 @@ postgresGetPSHistogramFromTable ()
     }
 
     START_TIMER("Postgres - execute get stored ps template");
-    execStmt("commit;");
     // clear result
     PQclear(res);
 
@@ -1363,6 +1733,34 @@ postgresStorePsInfo(int tNo, char *paras, psInfoCell *psc)
 	STOP_TIMER("Postgres - store ps information");
 }
 
+/*
+ * Remove the stored provenance sketches for a template and parameter values,
+ * e.g., if they are no longer valid because the underlying tables have changed.
+ */
+void
+postgresDeletePsInfo(int tNo, char *paras)
+{
+	char *tableName = getPSCellsTableName();
+	StringInfo deleteInfo = makeStringInfo();
+	PGresult *res;
+
+	START_TIMER("Postgres - delete ps information");
+
+    appendStringInfo(deleteInfo,"delete from %s where tid = %d and parameters = '%s';",
+    			tableName,
+				tNo,
+				paras);
+
+    DEBUG_LOG("postgresDeletePsInfo: %s", deleteInfo->data);
+	res = execQuery(deleteInfo->data);
+	// the row may have been deleted by another session already, nothing to do then
+	if (atoi(PQcmdTuples(res)) == 0)
+		DEBUG_LOG("no sketch stored for template %d with parameters %s", tNo, paras);
+	PQclear(res);
+
+	STOP_TIMER("Postgres - delete ps information");
+}
+
 List *
 postgresGetHist (char *tableName, char *attrName, int numPartitions)
 {
@@ -1412,8 +1810,6 @@ postgresGetHist (char *tableName, char *attrName, int numPartitions)
 			attrName, attrName, tableName);
 	resMinMax = execQuery(minMax->data);
         STOP_TIMER("Postgres - execute get minmax");
-	//have to commit, otherwise, if you run another query, will get warning: there is already a transaction in progress
-	execStmt("commit;");
     // loop through results
     for(int i = 0; i < PQntuples(resMinMax); i++) {
         attrs = appendToTailOfList(attrs, strdup(PQgetvalue(resMinMax,i,0)));
@@ -1440,6 +1836,8 @@ postgresIsAgg(char *functionName)
 
     if (hasSetElem(plugin->plugin.cache->aggFuncNames, f))
         return TRUE;
+    if (getBoolOption(OPTION_PREFETCH_CATALOG) && hasSetElem(GET_CACHE()->nonAggFuncNames, f))
+        return FALSE;
 
     // do query
     ACQUIRE_MEM_CONTEXT(memContext);
@@ -1448,6 +1846,7 @@ postgresIsAgg(char *functionName)
     {
         addToSet(plugin->plugin.cache->aggFuncNames, f);
         PQclear(res);
+        RELEASE_MEM_CONTEXT();
         return TRUE;
     }
     PQclear(res);
@@ -1462,6 +1861,8 @@ postgresIsWindowFunction(char *functionName)
     PGresult *res = NULL;
     if (hasSetElem(plugin->plugin.cache->winFuncNames, functionName))
         return TRUE;
+    if (getBoolOption(OPTION_PREFETCH_CATALOG) && hasSetElem(GET_CACHE()->nonWinFuncNames, functionName))
+        return FALSE;
 
     // do query
     ACQUIRE_MEM_CONTEXT(memContext);
@@ -1551,24 +1952,30 @@ postgresGetKeyInformation(char *tableName)
 
     // do query
     ACQUIRE_MEM_CONTEXT(memContext);
-    keySet = STRSET();
     START_TIMER(METADATA_LOOKUP_TIMER);
-    res = execPrepared(NAME_GET_PK, singleton(createConstString(tableName)));
+    // keys prefetched for the current statement
+    keySet = getBoolOption(OPTION_PREFETCH_CATALOG)
+            ? (Set *) MAP_GET_STRING(GET_CACHE()->tableKeys, tableName) : NULL;
+    if (keySet == NULL)
+    {
+        keySet = STRSET();
+        res = execPrepared(NAME_GET_PK, singleton(createConstString(tableName)));
 
-    // loop through results
-    for(int i = 0; i < PQntuples(res); i++)
-	{
-        addToSet(keySet, strdup(PQgetvalue(res,i,0)));
-	}
+        // loop through results
+        for(int i = 0; i < PQntuples(res); i++)
+        {
+            addToSet(keySet, strdup(PQgetvalue(res,i,0)));
+        }
+
+        // cleanup
+        PQclear(res);
+    }
 
-	if (PQntuples(res) > 0)
+	if (!EMPTY_SET(keySet))
 	{
 		result = singleton(keySet);
 	}
 
-    // cleanup
-    PQclear(res);
-
     STOP_TIMER(METADATA_LOOKUP_TIMER);
     RELEASE_MEM_CONTEXT_AND_RETURN_COPY(List,result);
 }
@@ -1698,7 +2105,7 @@ postgresGetAllMinAndMax(TableAccessOperator* table)
     }
 
     PQclear(res);
-    execCommit();
+    STOP_TIMER(METADATA_LOOKUP_QUERY_TIMER);
 
 //	MAP_ADD_STRING_KEY(tableMap, colName, result_map);
 //    DEBUG_LOG("POSTGRES_GET_MINMAX: GOT (%s.%s)\n%s",
@@ -1788,7 +2195,7 @@ postgresGetMinAndMax(char* tableName, char* colName)
     }
 
     PQclear(res);
-    execCommit();
+    STOP_TIMER(METADATA_LOOKUP_QUERY_TIMER);
 
 	MAP_ADD_STRING_KEY(tableMap, colName, result_map);
     DEBUG_LOG("POSTGRES_GET_MINMAX: GOT (%s.%s)\n%s",
@@ -1822,90 +2229,47 @@ execStmt (char *stmt)
     PGresult *res = NULL;
     ASSERT(postgresIsInitialized());
     PGconn *c = plugin->conn;;
+    drainPendingQuery();
     START_TIMER(METADATA_LOOKUP_EXEC_STMT);
-    res = PQexec(c, "BEGIN TRANSACTION;");
-        if (PQresultStatus(res) != PGRES_COMMAND_OK){
-            STOP_TIMER(METADATA_LOOKUP_EXEC_STMT);
-            CLOSE_RES_CONN_AND_FATAL(res, "BEGIN TRANSACTION for statement failed: %s",
-                    PQerrorMessage(c));
-        }
-    PQclear(res);
-
     DEBUG_LOG("execute statement %s", stmt);
-    res = PQexec(c, stmt);
+    res = trackRoundTrip(PQexec(c, stmt));
     if (PQresultStatus(res) != PGRES_COMMAND_OK){
         STOP_TIMER(METADATA_LOOKUP_EXEC_STMT);
-        CLOSE_RES_CONN_AND_FATAL(res, "DECLARE CURSOR failed: %s",
+        CLOSE_RES_CONN_AND_FATAL(res, "execute statement failed: %s",
                 PQerrorMessage(c));
     }
     PQclear(res);
 
     STOP_TIMER(METADATA_LOOKUP_EXEC_STMT);
-
-    execCommit();
+    STOP_TIMER(METADATA_LOOKUP_QUERY_TIMER);
 }
 
+/*
+ * Run a query in a single round trip. The query is sent with the extended
+ * protocol (PQexecParams) which only allows a single statement and runs it
+ * in its own transaction. The whole result is materialized by libpq, so this
+ * should only be used for small results (catalog lookups), large results are
+ * read with postgresOpenResultStream.
+ */
 static PGresult *
 execQuery(char *query)
 {
     PGresult *res = NULL;
     ASSERT(postgresIsInitialized());
     PGconn *c = plugin->conn;
+    drainPendingQuery();
     START_TIMER(METADATA_LOOKUP_EXEC_QUERY_TIME);
-    START_TIMER("Postgres - execute query - BEGIN TRANSACTION");
-    res = PQexec(c, "BEGIN TRANSACTION;");
-    if (PQresultStatus(res) != PGRES_COMMAND_OK){
-        STOP_TIMER("Postgres - execute query - BEGIN TRANSACTION");
+    DEBUG_LOG("execute query %s", query);
+    res = trackRoundTrip(PQexecParams(c, query, 0, NULL, NULL, NULL, NULL, 0));
+    if (PQresultStatus(res) != PGRES_TUPLES_OK
+            && PQresultStatus(res) != PGRES_COMMAND_OK){
         STOP_TIMER(METADATA_LOOKUP_EXEC_QUERY_TIME);
-        CLOSE_RES_CONN_AND_FATAL(res, "BEGIN TRANSACTION for DECLARE CURSOR failed: %s",
-                                 PQerrorMessage(c));
+        CLOSE_RES_CONN_AND_FATAL(res, "query failed: %s", PQerrorMessage(c));
     }
-    PQclear(res);
-    STOP_TIMER("Postgres - execute query - BEGIN TRANSACTION");
-
-    START_TIMER("Postgres - execute query - DECLARE CURSOR");
-    DEBUG_LOG("create cursor for %s", query);
-    res = PQexec(c, CONCAT_STRINGS("DECLARE myportal CURSOR FOR ", query));
-    if (PQresultStatus(res) != PGRES_COMMAND_OK){
-        STOP_TIMER("Postgres - execute query - DECLARE CURSOR");
-        STOP_TIMER(METADATA_LOOKUP_EXEC_QUERY_TIME);
-        CLOSE_RES_CONN_AND_FATAL(res, "DECLARE CURSOR failed: %s",
-                                 PQerrorMessage(c));
-    }
-    PQclear(res);
-    STOP_TIMER("Postgres - execute query - DECLARE CURSOR");
-
-    START_TIMER("Postgres - execute query - FETCH ALL");
-    res = PQexec(c, "FETCH ALL in myportal");
-    if (PQresultStatus(res) != PGRES_TUPLES_OK){
-        STOP_TIMER("Postgres - execute query - FETCH ALL");
-        STOP_TIMER(METADATA_LOOKUP_EXEC_QUERY_TIME);
-        CLOSE_RES_CONN_AND_FATAL(res, "FETCH ALL failed: %s", PQerrorMessage(c));
-    }
-    STOP_TIMER("Postgres - execute query - FETCH ALL");
     STOP_TIMER(METADATA_LOOKUP_EXEC_QUERY_TIME);
     return res;
 }
 
-static void
-execCommit(void)
-{
-    PGresult *res = NULL;
-    ASSERT(postgresIsInitialized());
-    PGconn *c = plugin->conn;
-    START_TIMER(METADATA_LOOKUP_COMMIT_TIMER);
-    res = PQexec(c, "COMMIT;");
-        if (PQresultStatus(res) != PGRES_COMMAND_OK){
-            STOP_TIMER(METADATA_LOOKUP_COMMIT_TIMER);
-            CLOSE_RES_CONN_AND_FATAL(res, "COMMIT for DECLARE CURSOR failed: %s",
-                    PQerrorMessage(c));
-        }
-    STOP_TIMER(METADATA_LOOKUP_COMMIT_TIMER);
-    PQclear(res);
-
-	STOP_TIMER(METADATA_LOOKUP_QUERY_TIMER);
-}
-
 static PGresult *
 execPrepared(char *qName, List *values)
 {
@@ -1917,6 +2281,7 @@ execPrepared(char *qName, List *values)
 
     START_TIMER(METADATA_LOOKUP_EXEC_PREPARED);
     ASSERT(postgresIsInitialized());
+    drainPendingQuery();
     START_TIMER(METADATA_LOOKUP_QUERY_TIMER);
 
     i = 0;
@@ -1928,13 +2293,13 @@ execPrepared(char *qName, List *values)
     DEBUG_LOG("run query %s with parameters <%s>",
 			  qName, exprToSQL((Node *) values, NULL, FALSE));
 
-    res = PQexecPrepared(plugin->conn,
+    res = trackRoundTrip(PQexecPrepared(plugin->conn,
 						 qName,
 						 nParams,
 						 (const char *const *) params,
 						 NULL,
 						 NULL,
-						 0);
+						 0));
 
     if (PQresultStatus(res) != PGRES_TUPLES_OK){
         STOP_TIMER(METADATA_LOOKUP_EXEC_PREPARED);
@@ -1952,12 +2317,13 @@ prepareQuery(char *qName, char *query, int parameters, Oid *types)
     PGresult *res = NULL;
     ASSERT(postgresIsInitialized());
     PGconn *c = plugin->conn;
+    drainPendingQuery();
     START_TIMER(METADATA_LOOKUP_PREPARE_QUERY_TIME);
-    res = PQprepare(c,
+    res = trackRoundTrip(PQprepare(c,
                     qName,
                     query,
                     parameters,
-                    types);
+                    types));
     if (PQresultStatus(res) != PGRES_COMMAND_OK){
         STOP_TIMER(METADATA_LOOKUP_PREPARE_QUERY_TIME);
         CLOSE_RES_CONN_AND_FATAL(res, "prepare query %s failed: %s",
@@ -2041,94 +2407,383 @@ postgresExecuteQuery(char *query)
     START_TIMER(METADATA_LOOKUP_TIMER);
     START_TIMER("Postgres - execute ExecuteQuery");
     START_TIMER(METADATA_LOOKUP_QUERY_TIMER);
-    Relation *r = makeNode(Relation);
     PGresult *rs = execQuery(query);
+    Relation *r = pgResultToRelation(rs);
+
+    PQclear(rs);
+    STOP_TIMER(METADATA_LOOKUP_QUERY_TIMER);
+    STOP_TIMER("Postgres - execute ExecuteQuery");
+    STOP_TIMER(METADATA_LOOKUP_TIMER);
+    return r;
+}
+
+/*
+ * Record a round trip to the server. The size of the result is only
+ * computed if backend instrumentation is active.
+ */
+static PGresult *
+trackRoundTrip (PGresult *res)
+{
+    unsigned long bytes = 0;
+
+    if (isBackendInstrumentationActive() && res != NULL)
+    {
+        int numRows = PQntuples(res);
+        int numFields = PQnfields(res);
+
+        for(int i = 0; i < numRows; i++)
+            for(int j = 0; j < numFields; j++)
+                bytes += PQgetlength(res, i, j);
+    }
+
+    recordBackendRoundTrip(bytes);
+
+    return res;
+}
+
+static Relation *
+pgResultToRelation (PGresult *rs)
+{
+    Relation *r;
+    List *schema = NIL;
     int numRes = PQntuples(rs);
     int numFields = PQnfields(rs);
+    char **values = CNEW(char *, MAX(numFields, 1));
 
     // set schema
-    r->schema = NIL;
     for(int i = 0; i < numFields; i++)
     {
         char *name = PQfname(rs, i);
-        r->schema = appendToTailOfList(r->schema, strdup((char *) name));
+        schema = appendToTailOfList(schema, strdup((char *) name));
     }
+    r = makeResultRelation(schema);
 
     // read rows
-    r->tuples = makeVector(VECTOR_NODE, T_Vector);
     for(int i = 0; i < numRes; i++)
     {
-        Vector *tuple = makeVectorOfSize(VECTOR_STRING, -1, numFields);
         for (int j = 0; j < numFields; j++)
+            values[j] = PQgetisnull(rs,i,j) ? NULL : PQgetvalue(rs,i,j);
+        addRelationTuple(r, values);
+    }
+
+    FREE(values);
+    DEBUG_LOG("read %d tuples", numRes);
+
+    return r;
+}
+
+static Vector *
+pgRowToTuple (PGresult *rs, int row)
+{
+    int numFields = PQnfields(rs);
+    Vector *tuple = makeVectorOfSize(VECTOR_STRING, -1, numFields);
+
+    for (int j = 0; j < numFields; j++)
+    {
+        if (PQgetisnull(rs,row,j))
+            vecAppendString(tuple, strdup("NULL"));
+        else
+            vecAppendString(tuple, strdup(PQgetvalue(rs,row,j)));
+    }
+
+    return tuple;
+}
+
+/*
+ * Stream the result of a query. The query is sent with the extended protocol
+ * in single row mode, libpq then only buffers one row at a time, so results
+ * of any size are read in constant memory. The first result is read right
+ * away to determine the schema. No other query can be run on the connection
+ * until the stream has been closed.
+ */
+List *
+postgresOpenResultStream (char *query)
+{
+    List *schema = NIL;
+    PGresult *res;
+
+    ASSERT(postgresIsInitialized());
+    drainPendingQuery();
+    START_TIMER(METADATA_LOOKUP_STREAM);
+
+    DEBUG_LOG("stream result of query %s", query);
+    recordBackendRoundTrip(0);
+    if (!PQsendQueryParams(plugin->conn, query, 0, NULL, NULL, NULL, NULL, 0))
+    {
+        STOP_TIMER(METADATA_LOOKUP_STREAM);
+        FATAL_LOG("sending query failed: %s", PQerrorMessage(plugin->conn));
+    }
+    if (!PQsetSingleRowMode(plugin->conn))
+        WARN_LOG("could not activate single row mode, the whole result is buffered");
+
+    plugin->streamOpen = TRUE;
+    res = getStreamResult();
+    plugin->streamResult = res;
+
+    if (res != NULL)
+    {
+        for(int i = 0; i < PQnfields(res); i++)
+            schema = appendToTailOfList(schema, strdup(PQfname(res, i)));
+    }
+
+    return schema;
+}
+
+/*
+ * Return the next row of the streamed result or NULL once all rows have been
+ * read. The stream is closed when the end of the result is reached.
+ */
+Vector *
+postgresNextStreamTuple (void)
+{
+    PGresult *res;
+    Vector *tuple = NULL;
+
+    if (!plugin->streamOpen)
+        return NULL;
+
+    res = (plugin->streamResult != NULL) ? plugin->streamResult : getStreamResult();
+    plugin->streamResult = NULL;
+
+    if (res != NULL && PQresultStatus(res) == PGRES_SINGLE_TUPLE)
+    {
+        tuple = pgRowToTuple(res, 0);
+        PQclear(res);
+        return tuple;
+    }
+
+    // end of result (or a query without single row mode which may still contain rows)
+    if (res != NULL && PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0)
+    {
+        FATAL_LOG("result stream was not opened in single row mode");
+    }
+
+    PQclear(res);
+    postgresCloseResultStream();
+
+    return NULL;
+}
+
+/*
+ * Close the stream. If not all rows have been read, then the remaining rows
+ * are read from the connection and discarded.
+ */
+void
+postgresCloseResultStream (void)
+{
+    PGresult *res;
+
+    if (!plugin->streamOpen)
+        return;
+
+    if (plugin->streamResult != NULL)
+        PQclear(plugin->streamResult);
+    plugin->streamResult = NULL;
+
+    while((res = getStreamResult()) != NULL)
+        PQclear(res);
+
+    plugin->streamOpen = FALSE;
+    STOP_TIMER(METADATA_LOOKUP_STREAM);
+}
+
+static PGresult *
+getStreamResult (void)
+{
+    PGresult *res = PQgetResult(plugin->conn);
+
+    if (res == NULL)
+        return NULL;
+
+    switch(PQresultStatus(res))
+    {
+        case PGRES_SINGLE_TUPLE:
+        case PGRES_TUPLES_OK:
+        case PGRES_COMMAND_OK:
+        case PGRES_EMPTY_QUERY:
+            return res;
+        default:
         {
-            if (PQgetisnull(rs,i,j))
-            {
-                vecAppendString(tuple, strdup("NULL"));
-            }
-            else
-            {
-                char *val = PQgetvalue(rs,i,j);
-				vecAppendString(tuple,  strdup(val));
-            }
+            char *msg = strdup(PQresultErrorMessage(res));
+
+            // read the rest of the result to make the connection usable again
+            PQclear(res);
+            while((res = PQgetResult(plugin->conn)) != NULL)
+                PQclear(res);
+            plugin->streamOpen = FALSE;
+            plugin->streamResult = NULL;
+            STOP_TIMER(METADATA_LOOKUP_STREAM);
+            FATAL_LOG("query failed: %s", msg);
         }
-        VEC_ADD_NODE(r->tuples, tuple);
-        DEBUG_NODE_LOG("read tuple <%s>", tuple);
     }
-    PQclear(rs);
-    execCommit();
-    STOP_TIMER("Postgres - execute ExecuteQuery");
-    STOP_TIMER(METADATA_LOOKUP_TIMER);
-    return r;
+
+    return res;
 }
 
+/*
+ * Send a query without waiting for its result. The result has to be fetched
+ * with postgresGetQueryResult before the next query can be sent. libpq only
+ * allows one command at a time per connection. If the connection pool has
+ * room for another connection, read-only queries are sent on a pooled
+ * connection, so catalog lookups that happen in between can run on the
+ * plugin's connection. Otherwise, catalog lookups first read the pending
+ * result from the connection (see drainPendingQuery). Other statements
+ * always run on the plugin's connection, because catalog lookups for the
+ * next statement have to see their changes.
+ */
 void
-postgresExecuteQueryIgnoreResult (char *query)
+postgresSendQuery (char *query)
 {
-    PGresult *res = NULL;
+    PGconn *conn = plugin->conn;
+    PGconn *pooled = NULL;
+
     ASSERT(postgresIsInitialized());
-    PGconn *c = plugin->conn;
-    boolean done = FALSE;
-    START_TIMER(METADATA_LOOKUP_TIMER);
-    START_TIMER(METADATA_LOOKUP_QUERY_TIMER);
-    START_TIMER("Postgres - execute ExecuteQueryIgnoreResult");
-    START_TIMER("Postgres - execute ExecuteQueryIgnoreResult - Begin Transaction");
-    // start transaction
-    res = PQexec(c, CONCAT_STRINGS("BEGIN TRANSACTION;"));
-        if (PQresultStatus(res) != PGRES_COMMAND_OK){
-            STOP_TIMER("Postgres - execute ExecuteQueryIgnoreResult - Begin Transaction");
-            CLOSE_RES_CONN_AND_FATAL(res, "DECLARE CURSOR failed: %s",
-                    PQerrorMessage(c));
+
+    if (plugin->queryPending)
+        FATAL_LOG("cannot send query before the result of the previous query has been fetched");
+
+    // a query inside an open transaction has to see the transaction's changes
+    if (isReadOnlyQuery(query) && PQtransactionStatus(plugin->conn) == PQTRANS_IDLE
+            && (pooled = (PGconn *) checkoutConnection()) != NULL)
+        conn = pooled;
+
+    DEBUG_LOG("send query on %s connection %s", pooled ? "pooled" : "main", query);
+    recordBackendRoundTrip(0);
+    if (!PQsendQuery(conn, query))
+    {
+        char *msg = strdup(PQerrorMessage(conn));
+
+        checkinConnection(pooled);
+        FATAL_LOG("sending query failed: %s", msg);
+    }
+
+    plugin->queryPending = TRUE;
+    plugin->pendingConn = conn;
+    plugin->pendingPooled = (pooled != NULL);
+    plugin->pendingDrained = FALSE;
+    plugin->pendingResult = NULL;
+}
+
+Relation *
+postgresGetQueryResult (boolean ignoreResult)
+{
+    Relation *r = NULL;
+    PGresult *res;
+
+    ASSERT(postgresIsInitialized());
+
+    if (!plugin->queryPending)
+        FATAL_LOG("no query has been sent");
+
+    readPendingResult();
+    res = plugin->pendingResult;
+    plugin->pendingResult = NULL;
+    plugin->queryPending = FALSE;
+    if (plugin->pendingPooled)
+        checkinConnection(plugin->pendingConn);
+    plugin->pendingPooled = FALSE;
+
+    if (res != NULL)
+    {
+        switch(PQresultStatus(res))
+        {
+            case PGRES_TUPLES_OK:
+                if (!ignoreResult)
+                    r = pgResultToRelation(res);
+                break;
+            case PGRES_COMMAND_OK:
+            case PGRES_EMPTY_QUERY:
+                break;
+            default:
+            {
+                char *msg = strdup(PQresultErrorMessage(res));
+                PQclear(res);
+                FATAL_LOG("query failed: %s", msg);
+            }
         }
-    PQclear(res);
-    STOP_TIMER("Postgres - execute ExecuteQueryIgnoreResult - Begin Transaction");
+        PQclear(res);
+    }
 
-    // create a cursor
-    DEBUG_LOG("create cursor for %s", query);
-    START_TIMER("Postgres - execute ExecuteQueryIgnoreResult - Declare Cursor");
-    res = PQexec(c, CONCAT_STRINGS("DECLARE myportal CURSOR FOR ", query));
-    if (PQresultStatus(res) != PGRES_COMMAND_OK){
-        STOP_TIMER("Postgres - execute ExecuteQueryIgnoreResult - Declare Cursor");
-        CLOSE_RES_CONN_AND_FATAL(res, "DECLARE CURSOR failed: %s",
-                PQerrorMessage(c));
+    // statements that do not return results
+    if (r == NULL)
+    {
+        r = makeResultRelation(NIL);
     }
-    PQclear(res);
-    STOP_TIMER("Postgres - execute ExecuteQueryIgnoreResult - Declare Cursor");
 
-    START_TIMER("Postgres - execute ExecuteQueryIgnoreResult - FETCH");
-    while(!done)
+    return r;
+}
+
+/*
+ * Called before a query is run on the plugin's connection. If the pending
+ * query runs on this connection we have to read its result first.
+ */
+static void
+drainPendingQuery (void)
+{
+    if (plugin->streamOpen)
+        FATAL_LOG("cannot run a query before the result stream of the previous query has been closed");
+
+    if (plugin->queryPending && plugin->pendingConn == plugin->conn)
+        readPendingResult();
+}
+
+/*
+ * Read all results of the pending query from its connection. For a script
+ * with multiple statements we keep the first error if any or the result of
+ * the last statement.
+ */
+static void
+readPendingResult (void)
+{
+    PGresult *res;
+
+    if (!plugin->queryPending || plugin->pendingDrained)
+        return;
+
+    START_TIMER(METADATA_LOOKUP_ASYNC_WAIT);
+    while((res = PQgetResult(plugin->pendingConn)) != NULL)
     {
-        res = PQexec(c, "FETCH 1000 FROM myportal");
-        if (PQresultStatus(res) != PGRES_TUPLES_OK){
-            STOP_TIMER("Postgres - execute ExecuteQueryIgnoreResult - FETCH");
-            CLOSE_RES_CONN_AND_FATAL(res, "FETCH ALL failed: %s", PQerrorMessage(c));
+        if (plugin->pendingResult != NULL
+                && PQresultStatus(plugin->pendingResult) == PGRES_FATAL_ERROR)
+        {
+            PQclear(res);
+        }
+        else
+        {
+            if (plugin->pendingResult != NULL)
+                PQclear(plugin->pendingResult);
+            plugin->pendingResult = res;
         }
-        int numRes = PQntuples(res);
-        if (numRes == 0)
-            done = TRUE;
     }
-    STOP_TIMER("Postgres - execute ExecuteQueryIgnoreResult - FETCH");
+    plugin->pendingDrained = TRUE;
+    STOP_TIMER(METADATA_LOOKUP_ASYNC_WAIT);
+}
+
+/*
+ * Queries starting with SELECT or WITH do not modify the database (GProM
+ * does not generate data-modifying WITH clauses).
+ */
+static boolean
+isReadOnlyQuery (char *query)
+{
+    while (isspace(*query) || *query == '(')
+        query++;
+
+    return strncasecmp(query, "SELECT", 6) == 0 || strncasecmp(query, "WITH", 4) == 0;
+}
 
-    execCommit();
+void
+postgresExecuteQueryIgnoreResult (char *query)
+{
+    START_TIMER(METADATA_LOOKUP_TIMER);
+    START_TIMER(METADATA_LOOKUP_QUERY_TIMER);
+    START_TIMER("Postgres - execute ExecuteQueryIgnoreResult");
+
+    // stream the result to discard rows as they arrive
+    postgresOpenResultStream(query);
+    postgresCloseResultStream();
+
+    STOP_TIMER(METADATA_LOOKUP_QUERY_TIMER);
     STOP_TIMER("Postgres - execute ExecuteQueryIgnoreResult");
     STOP_TIMER(METADATA_LOOKUP_TIMER);
 }
@@ -2184,6 +2839,11 @@ postgresCatalogViewExists (char * viewName)
     return FALSE;
 }
 
+void
+postgresPrefetchCatalog (List *tableNames, List *functionNames)
+{
+}
+
 List *
 postgresGetAttributes (char *tableName)
 {
@@ -2262,4 +2922,34 @@ postgresExecuteQueryIgnoreResult (char *query)
 
 }
 
+void
+postgresSendQuery (char *query)
+{
+
+}
+
+Relation *
+postgresGetQueryResult (boolean ignoreResult)
+{
+    return NULL;
+}
+
+List *
+postgresOpenResultStream (char *query)
+{
+    return NIL;
+}
+
+Vector *
+postgresNextStreamTuple (void)
+{
+    return NULL;
+}
+
+void
+postgresCloseResultStream (void)
+{
+
+}
+
 #endif
@@ -26,6 +26,7 @@
 #include "model/set/hashmap.h"
 #include "model/set/vector.h"
 #include "operator_optimizer/optimizer_prop_inference.h"
+#include "provenance_sketches/sketch_functions.h"
 #include "utility/string_utils.h"
 #include <stdlib.h>
 
@@ -33,29 +34,70 @@
 #define CONTEXT_NAME "SQLiteMemContext"
 
 // query templates
-#define QUERY_TABLE_COL_COUNT "PRAGMA table_info(%s)"
+#define QUERY_TABLE_COL_COUNT "SELECT cid, name, type, \"notnull\", dflt_value, pk FROM pragma_table_info(?1)"
 #define QUERY_TABLE_ATTR_MIN_MAX "SELECT %s FROM %s"
 
 // Only define real plugin structure and methods if libsqlite3 is present
 #ifdef HAVE_SQLITE_BACKEND
 
+// prepared statement in the statement cache of a connection
+typedef struct SQLiteCachedStmt
+{
+    char *sql;
+    sqlite3_stmt *stmt;
+    boolean inUse;                      // returned by runQuery and not finished yet
+    struct SQLiteCachedStmt *prev;      // more recently used
+    struct SQLiteCachedStmt *next;      // less recently used
+} SQLiteCachedStmt;
+
+// state of a connection that is not used by the plugin (see sqliteSwitchConnection)
+typedef struct SQLiteConnection
+{
+    sqlite3 *conn;
+    HashMap *stmtCache;
+    HashMap *stmtToEntry;
+    SQLiteCachedStmt *lruHead;
+    SQLiteCachedStmt *lruTail;
+    int numCachedStmts;
+} SQLiteConnection;
+
 // extends MetadataLookupPlugin with sqlite specific information
 typedef struct SQlitePlugin
 {
     MetadataLookupPlugin plugin;
     boolean initialized;
     sqlite3 *conn;
+    HashMap *stmtCache;                 // SQL text -> SQLiteCachedStmt (pointer stored as long constant)
+    HashMap *stmtToEntry;               // sqlite3_stmt -> SQLiteCachedStmt (both pointers stored as long constants)
+    SQLiteCachedStmt *lruHead;          // most recently used statement
+    SQLiteCachedStmt *lruTail;          // least recently used statement
+    int numCachedStmts;
+    SQLiteConnection mainConn;          // the plugin's own connection if a pooled connection is used
+    SQLiteConnection *activeConn;       // connection whose state is stored in the fields above
 } SQlitePlugin;
 
+// wait for locks held by other connections of the pool
+#define POOLED_CONNECTION_BUSY_TIMEOUT 10000
+
 // global vars
 static SQlitePlugin *plugin = NULL;
 static MemContext *memContext = NULL;
 
 // functions
 static sqlite3_stmt *runQuery (char *q);
+static void finishQuery (sqlite3_stmt *stmt);
+static SQLiteCachedStmt *getCachedStmt (char *q);
+static SQLiteCachedStmt *getCachedStmtEntry (sqlite3_stmt *stmt);
+static void cacheStmt (char *q, sqlite3_stmt *stmt);
+static void unlinkCachedStmt (SQLiteCachedStmt *e);
+static void evictCachedStmts (int maxSize);
 static DataType stringToDT (char *dataType);
 static char *sqliteGetConnectionDescription (void);
 static void initCache(CatalogCache *c);
+static int registerSketchFunctions (sqlite3 *conn);
+static void *sqliteOpenPooledConnection (void);
+static void sqliteClosePooledConnection (void *conn);
+static void *sqliteSwitchConnection (void *conn);
 
 #define HANDLE_ERROR_MSG(_rc,_expected,_message, ...) \
     do { \
@@ -65,7 +107,22 @@ static void initCache(CatalogCache *c);
             appendStringInfo(_newmes, _message, ##__VA_ARGS__); \
             StringInfo _errMes = makeStringInfo(); \
             appendStringInfo(_errMes, strdup((char *) sqlite3_errmsg(plugin->conn))); \
-            FATAL_LOG("error (%s)\n%u\n\n%s", _errMes, _rc, _newmes->data); \
+            FATAL_LOG("error (%s)\n%u\n\n%s", _errMes->data, _rc, _newmes->data); \
+        } \
+    } while(0)
+
+/* same as HANDLE_ERROR_MSG, but release statement _stmt before raising the
+ * error, otherwise a cached statement would stay in use forever */
+#define HANDLE_STMT_ERROR_MSG(_rc,_expected,_stmt,_message, ...) \
+    do { \
+        if (_rc != _expected) \
+        { \
+            StringInfo _newmes = makeStringInfo(); \
+            appendStringInfo(_newmes, _message, ##__VA_ARGS__); \
+            StringInfo _errMes = makeStringInfo(); \
+            appendStringInfo(_errMes, "%s", (char *) sqlite3_errmsg(plugin->conn)); \
+            finishQuery(_stmt); \
+            FATAL_LOG("error (%s)\n%u\n\n%s", _errMes->data, _rc, _newmes->data); \
         } \
     } while(0)
 
@@ -103,6 +160,10 @@ assembleSqliteMetadataLookupPlugin (void)
     p->sqlTypeToDT = sqliteBackendSQLTypeToDT;
     p->dataTypeToSQL = sqliteBackendDatatypeToSQL;
     p->getMinAndMax = sqliteGetMinAndMax;
+    p->openPooledConnection = sqliteOpenPooledConnection;
+    p->closePooledConnection = sqliteClosePooledConnection;
+    p->switchConnection = sqliteSwitchConnection;
+    plugin->activeConn = &(plugin->mainConn);
     return p;
 }
 
@@ -152,6 +213,10 @@ sqliteDatabaseConnectionOpen (void)
           sqlite3_close(plugin->conn);
           return EXIT_FAILURE;
     }
+
+    rc = registerSketchFunctions(plugin->conn);
+    HANDLE_ERROR_MSG(rc, SQLITE_OK, "Can not register provenance sketch functions");
+
     return EXIT_SUCCESS;
 }
 
@@ -159,9 +224,15 @@ int
 sqliteDatabaseConnectionClose()
 {
     int rc;
+
+    sqliteSwitchConnection(&(plugin->mainConn));
+
+    // cached statements have to be finalized before the connection can be closed
+    evictCachedStmts(0);
     rc = sqlite3_close(plugin->conn);
 
     HANDLE_ERROR_MSG(rc, SQLITE_OK, "Can not close database");
+    plugin->conn = NULL;
 
     return EXIT_SUCCESS;
 }
@@ -202,13 +273,11 @@ List *
 sqliteGetAttributes (char *tableName)
 {
     sqlite3_stmt *rs;
-    StringInfo q;
     List *result = NIL;
     int rc;
 
-    q = makeStringInfo();
-    appendStringInfo(q, QUERY_TABLE_COL_COUNT, tableName);
-    rs = runQuery(q->data);
+    rs = runQuery(QUERY_TABLE_COL_COUNT);
+    sqlite3_bind_text(rs, 1, tableName, -1, SQLITE_TRANSIENT);
 
     while((rc = sqlite3_step(rs)) == SQLITE_ROW)
     {
@@ -222,7 +291,8 @@ sqliteGetAttributes (char *tableName)
         result = appendToTailOfList(result, a);
     }
 
-    HANDLE_ERROR_MSG(rc, SQLITE_DONE, "error getting attributes of table <%s>", tableName);
+    HANDLE_STMT_ERROR_MSG(rc, SQLITE_DONE, rs, "error getting attributes of table <%s>", tableName);
+    finishQuery(rs);
 
     DEBUG_NODE_LOG("columns are: ", result);
 
@@ -260,7 +330,16 @@ sqliteIsWindowFunction(char *functionName)
 DataType
 sqliteGetFuncReturnType (char *fName, List *argTypes, boolean *funcExists)
 {
+    char *f = strToLower(fName);
+
     *funcExists = TRUE;
+
+    // native sketch functions
+    if (streq(f, SKETCH_FUN_BUCKET_SEARCH) || streq(f, SKETCH_FUN_BIT_COUNT))
+        return DT_INT;
+    if (streq(f, SKETCH_FUN_CONTAINS))
+        return DT_BOOL;
+
     return DT_STRING; //TODO
 }
 
@@ -333,14 +412,12 @@ List *
 sqliteGetKeyInformation(char *tableName)
 {
     sqlite3_stmt *rs;
-    StringInfo q;
     Set *key = STRSET();
     List *keys = NIL;
     int rc;
 
-    q = makeStringInfo();
-    appendStringInfo(q, QUERY_TABLE_COL_COUNT, tableName);
-    rs = runQuery(q->data);
+    rs = runQuery(QUERY_TABLE_COL_COUNT);
+    sqlite3_bind_text(rs, 1, tableName, -1, SQLITE_TRANSIENT);
 
     while((rc = sqlite3_step(rs)) == SQLITE_ROW)
     {
@@ -353,7 +430,8 @@ sqliteGetKeyInformation(char *tableName)
         }
     }
 
-    HANDLE_ERROR_MSG(rc, SQLITE_DONE, "error getting attributes of table <%s>", tableName);
+    HANDLE_STMT_ERROR_MSG(rc, SQLITE_DONE, rs, "error getting attributes of table <%s>", tableName);
+    finishQuery(rs);
 
     DEBUG_LOG("Key for %s are: %s", tableName, beatify(nodeToString(key)));
 
@@ -466,8 +544,8 @@ sqliteGetMinAndMax(char* tableName, char* colName)
                 max = createConstFloat(atof((char *) maxVal));
                 break;
             case DT_STRING:
-                min = createConstString((char *) minVal);
-                max = createConstString((char *) maxVal);
+                min = createConstString(strdup((char *) minVal));
+                max = createConstString(strdup((char *) maxVal));
                 break;
             default:
                 THROW(SEVERITY_RECOVERABLE, "received unkown DT from sqlite: %s", DataTypeToString(dt));
@@ -479,7 +557,8 @@ sqliteGetMinAndMax(char* tableName, char* colName)
         }
     }
 
-    HANDLE_ERROR_MSG(rc, SQLITE_DONE, "error getting min and max values of attributes for table <%s>", tableName);
+    HANDLE_STMT_ERROR_MSG(rc, SQLITE_DONE, rs, "error getting min and max values of attributes for table <%s>", tableName);
+    finishQuery(rs);
 
     DEBUG_NODE_BEATIFY_LOG("min maxes", MAP_GET_STRING(result_map, colName));
 
@@ -505,44 +584,38 @@ sqliteExecuteAsTransactionAndGetXID (List *statements, IsolationLevel isoLevel)
 Relation *
 sqliteExecuteQuery(char *query)
 {
-    Relation *r = makeNode(Relation);
+    Relation *r;
+    List *schema = NIL;
     sqlite3_stmt *rs = runQuery(query);
     int numFields = sqlite3_column_count(rs);
+    char **values = CNEW(char *, MAX(numFields, 1));
     int rc = SQLITE_OK;
 
     // set schema
-    r->schema = NIL;
     for(int i = 0; i < numFields; i++)
     {
         const char *name = sqlite3_column_name(rs, i);
-        r->schema = appendToTailOfList(r->schema, strdup((char *) name));
+        schema = appendToTailOfList(schema, strdup((char *) name));
     }
+    r = makeResultRelation(schema);
 
     // read rows
-    r->tuples = makeVector(VECTOR_NODE, T_Vector);
     while((rc = sqlite3_step(rs)) == SQLITE_ROW)
     {
-        Vector *tuple = makeVector(VECTOR_STRING, -1);
         for (int j = 0; j < numFields; j++)
         {
             if (sqlite3_column_type(rs,j) == SQLITE_NULL)
-            {
-                vecAppendString(tuple, strdup("NULL"));
-            }
+                values[j] = NULL;
             else
-            {
-                const unsigned char *val = sqlite3_column_text(rs,j);
-                vecAppendString(tuple, strdup((char *) val));
-            }
+                values[j] = (char *) sqlite3_column_text(rs,j);
         }
-        VEC_ADD_NODE(r->tuples, tuple);
-        DEBUG_NODE_LOG("read tuple <%s>", tuple);
+        addRelationTuple(r, values);
     }
 
-    HANDLE_ERROR_MSG(rc,SQLITE_DONE, "failed to execute query <%s>", query);
-
-    rc = sqlite3_finalize(rs);
-    HANDLE_ERROR_MSG(rc,SQLITE_OK, "failed to finalize query <%s>", query);
+    HANDLE_STMT_ERROR_MSG(rc, SQLITE_DONE, rs, "failed to execute query <%s>", query);
+    finishQuery(rs);
+    FREE(values);
+    DEBUG_LOG("read %d tuples", getRelationNumTuples(r));
 
     return r;
 }
@@ -556,35 +629,266 @@ sqliteExecuteQueryIgnoreResults(char *query)
     while((rc = sqlite3_step(rs)) == SQLITE_ROW)
         ;
 
-    HANDLE_ERROR_MSG(rc,SQLITE_DONE, "failed to execute query <%s>", query);
-
-    rc = sqlite3_finalize(rs);
-    HANDLE_ERROR_MSG(rc,SQLITE_OK, "failed to finalize query <%s>", query);
+    HANDLE_STMT_ERROR_MSG(rc, SQLITE_DONE, rs, "failed to execute query <%s>", query);
+    finishQuery(rs);
 }
 
+/*
+ * Return a prepared statement for query q. Statements are cached per
+ * connection in an LRU cache keyed by the SQL text (at most
+ * OPTION_SQLITE_STMT_CACHE_SIZE statements), so catalog lookups that run for
+ * every table of every query are only prepared once. Parameters of cached
+ * statements are cleared, callers bind them with sqlite3_bind_*. Statements
+ * have to be passed to finishQuery once the caller is done with them.
+ * Statements prepared with sqlite3_prepare_v2 are recompiled by SQLite if
+ * the schema changes, so cached statements do not become invalid.
+ */
 static sqlite3_stmt *
 runQuery (char *q)
 {
     sqlite3 *conn = plugin->conn;
+    SQLiteCachedStmt *e;
     sqlite3_stmt *stmt;
     int rc;
 
     DEBUG_LOG("run query:\n<%s>", q);
-    rc = sqlite3_prepare(conn, strdup(q), -1, &stmt, NULL);
-//    HANDLE_ERROR_MSG(rc, SQLITE_OK, "failed to prepare query <%s>", q);
-
-   if (rc != SQLITE_OK)
-   {
-       StringInfo _newmes = makeStringInfo();
-       appendStringInfo(_newmes, "failed to prepare query <%s>", q);
-       StringInfo _errMes = makeStringInfo();
-       appendStringInfo(_errMes, strdup((char *) sqlite3_errmsg(plugin->conn)));
-       FATAL_LOG("error (%s)\n%u\n\n%s", _errMes->data, rc, _newmes->data);
-   }
+
+    // reuse cached statement unless it is still used by a caller
+    e = getCachedStmt(q);
+    if (e != NULL && !e->inUse)
+    {
+        unlinkCachedStmt(e);
+        e->next = plugin->lruHead;
+        if (plugin->lruHead != NULL)
+            plugin->lruHead->prev = e;
+        plugin->lruHead = e;
+        if (plugin->lruTail == NULL)
+            plugin->lruTail = e;
+        e->inUse = TRUE;
+        sqlite3_clear_bindings(e->stmt);
+        return e->stmt;
+    }
+
+    rc = sqlite3_prepare_v2(conn, q, -1, &stmt, NULL);
+
+    if (rc != SQLITE_OK)
+    {
+        StringInfo _newmes = makeStringInfo();
+        appendStringInfo(_newmes, "failed to prepare query <%s>", q);
+        StringInfo _errMes = makeStringInfo();
+        appendStringInfo(_errMes, strdup((char *) sqlite3_errmsg(plugin->conn)));
+        FATAL_LOG("error (%s)\n%u\n\n%s", _errMes->data, rc, _newmes->data);
+    }
+
+    if (e == NULL && getIntOption(OPTION_SQLITE_STMT_CACHE_SIZE) > 0)
+        cacheStmt(q, stmt);
 
     return stmt;
 }
 
+/*
+ * Reset a cached statement so it can be reused (this also releases its read
+ * locks). Statements that are not cached are finalized. The cache entry is
+ * found through the statement handle, sqlite3_sql only returns the first SQL
+ * statement of the text the statement was prepared for.
+ */
+static void
+finishQuery (sqlite3_stmt *stmt)
+{
+    SQLiteCachedStmt *e = getCachedStmtEntry(stmt);
+
+    if (e != NULL)
+    {
+        sqlite3_reset(stmt);
+        e->inUse = FALSE;
+        evictCachedStmts(getIntOption(OPTION_SQLITE_STMT_CACHE_SIZE));
+    }
+    else
+        sqlite3_finalize(stmt);
+}
+
+static SQLiteCachedStmt *
+getCachedStmt (char *q)
+{
+    Constant *p;
+
+    if (plugin->stmtCache == NULL || q == NULL)
+        return NULL;
+
+    p = (Constant *) MAP_GET_STRING(plugin->stmtCache, q);
+    return (p == NULL) ? NULL : (SQLiteCachedStmt *) LONG_VALUE(p);
+}
+
+static SQLiteCachedStmt *
+getCachedStmtEntry (sqlite3_stmt *stmt)
+{
+    Constant *p;
+
+    if (plugin->stmtToEntry == NULL)
+        return NULL;
+
+    p = (Constant *) MAP_GET_POINTER(plugin->stmtToEntry, stmt);
+    return (p == NULL) ? NULL : (SQLiteCachedStmt *) LONG_VALUE(p);
+}
+
+static void
+cacheStmt (char *q, sqlite3_stmt *stmt)
+{
+    SQLiteCachedStmt *e;
+
+    // plugin methods run in the long-lived context of the plugin
+    if (plugin->stmtCache == NULL)
+    {
+        plugin->stmtCache = NEW_MAP(Constant,Constant);
+        plugin->stmtToEntry = NEW_MAP(Constant,Constant);
+    }
+
+    e = NEW(SQLiteCachedStmt);
+    e->sql = strdup(q);
+    e->stmt = stmt;
+    e->inUse = TRUE;
+    e->prev = NULL;
+    e->next = plugin->lruHead;
+    if (plugin->lruHead != NULL)
+        plugin->lruHead->prev = e;
+    plugin->lruHead = e;
+    if (plugin->lruTail == NULL)
+        plugin->lruTail = e;
+    plugin->numCachedStmts++;
+
+    MAP_ADD_STRING_KEY(plugin->stmtCache, e->sql, createConstLong((gprom_long_t) e));
+    MAP_ADD_POINTER_KEY(plugin->stmtToEntry, stmt, createConstLong((gprom_long_t) e));
+}
+
+static void
+unlinkCachedStmt (SQLiteCachedStmt *e)
+{
+    if (e->prev != NULL)
+        e->prev->next = e->next;
+    else
+        plugin->lruHead = e->next;
+    if (e->next != NULL)
+        e->next->prev = e->prev;
+    else
+        plugin->lruTail = e->prev;
+    e->prev = e->next = NULL;
+}
+
+/*
+ * Finalize least recently used statements until at most maxSize statements
+ * are cached. Statements that are in use are kept.
+ */
+static void
+evictCachedStmts (int maxSize)
+{
+    SQLiteCachedStmt *e = plugin->lruTail;
+
+    while(e != NULL && plugin->numCachedStmts > maxSize)
+    {
+        SQLiteCachedStmt *prev = e->prev;
+
+        if (!e->inUse)
+        {
+            DEBUG_LOG("evict statement from cache:\n<%s>", e->sql);
+            unlinkCachedStmt(e);
+            removeMapStringElem(plugin->stmtCache, e->sql);
+            removeMapElem(plugin->stmtToEntry, (Node *) createConstLong((gprom_long_t) e->stmt));
+            sqlite3_finalize(e->stmt);
+            FREE(e->sql);
+            FREE(e);
+            plugin->numCachedStmts--;
+        }
+        e = prev;
+    }
+}
+
+/*
+ * Number of cached statements of the current connection that are in use.
+ */
+int
+sqliteGetNumCachedStmtsInUse (void)
+{
+    int n = 0;
+
+    for(SQLiteCachedStmt *e = plugin->lruHead; e != NULL; e = e->next)
+        if (e->inUse)
+            n++;
+
+    return n;
+}
+
+/*
+ * Open another connection to the database file. Each connection has its own
+ * statement cache. Connections wait for locks of other connections instead
+ * of failing immediately.
+ */
+static void *
+sqliteOpenPooledConnection (void)
+{
+    char *dbfile = getStringOption(OPTION_CONN_DB);
+    SQLiteConnection *c = NEW(SQLiteConnection);
+    int rc;
+
+    rc = sqlite3_open(dbfile, &(c->conn));
+    if (rc == SQLITE_OK)
+        rc = registerSketchFunctions(c->conn);
+    if (rc != SQLITE_OK)
+    {
+        ERROR_LOG("can not open pooled connection to database <%s>: %s", dbfile,
+                sqlite3_errmsg(c->conn));
+        sqlite3_close(c->conn);
+        return NULL;
+    }
+
+    sqlite3_busy_timeout(c->conn, POOLED_CONNECTION_BUSY_TIMEOUT);
+    sqlite3_busy_timeout((plugin->activeConn == &(plugin->mainConn)) ? plugin->conn
+            : plugin->mainConn.conn, POOLED_CONNECTION_BUSY_TIMEOUT);
+
+    return c;
+}
+
+static void
+sqliteClosePooledConnection (void *conn)
+{
+    SQLiteConnection *c = (SQLiteConnection *) conn;
+    SQLiteConnection *prev = sqliteSwitchConnection(c);
+
+    // cached statements have to be finalized before the connection can be closed
+    evictCachedStmts(0);
+    sqliteSwitchConnection((prev == c) ? &(plugin->mainConn) : prev);
+    sqlite3_close(c->conn);
+}
+
+/*
+ * Store the connection and statement cache of the active connection in its
+ * SQLiteConnection and load the ones of conn.
+ */
+static void *
+sqliteSwitchConnection (void *conn)
+{
+    SQLiteConnection *next = (SQLiteConnection *) conn;
+    SQLiteConnection *prev = plugin->activeConn;
+
+    if (next == prev)
+        return prev;
+
+    prev->conn = plugin->conn;
+    prev->stmtCache = plugin->stmtCache;
+    prev->stmtToEntry = plugin->stmtToEntry;
+    prev->lruHead = plugin->lruHead;
+    prev->lruTail = plugin->lruTail;
+    prev->numCachedStmts = plugin->numCachedStmts;
+
+    plugin->conn = next->conn;
+    plugin->stmtCache = next->stmtCache;
+    plugin->stmtToEntry = next->stmtToEntry;
+    plugin->lruHead = next->lruHead;
+    plugin->lruTail = next->lruTail;
+    plugin->numCachedStmts = next->numCachedStmts;
+    plugin->activeConn = next;
+
+    return prev;
+}
 
 static DataType
 stringToDT (char *dataType)
@@ -608,6 +912,311 @@ sqliteGetConnectionDescription (void)
     return CONCAT_STRINGS("SQLite:", getStringOption("connection.db"));
 }
 
+/*
+ * Native provenance sketch functions (see sketch_functions.h). Sketches are
+ * passed as TEXT. Parsed fragment bounds are cached with the statement as
+ * auxiliary data of the constant bounds argument. The aggregates keep one
+ * count per fragment in their state and implement xInverse, so they can be
+ * used as window functions with arbitrary frames.
+ */
+typedef struct SketchAggState
+{
+    int len;
+    gprom_long_t *counts;
+} SketchAggState;
+
+/*
+ * Get the cached bounds of argument pos or parse them. Freshly parsed bounds
+ * have to be passed to cacheSketchBounds once the function is done with them,
+ * because sqlite may free auxiliary data as soon as it is set.
+ */
+static SketchBounds *
+getSketchBounds (sqlite3_context *ctx, sqlite3_value **argv, int pos, boolean *fresh)
+{
+    SketchBounds *b = (SketchBounds *) sqlite3_get_auxdata(ctx, pos);
+    const char *literal;
+    void *mem;
+
+    *fresh = FALSE;
+    if (b != NULL)
+        return b;
+
+    literal = (const char *) sqlite3_value_text(argv[pos]);
+    if (literal == NULL)
+        return NULL;
+    mem = sqlite3_malloc64(sketchBoundsSize(literal));
+    if (mem == NULL)
+    {
+        sqlite3_result_error_nomem(ctx);
+        return NULL;
+    }
+
+    *fresh = TRUE;
+    return parseSketchBounds(literal, mem);
+}
+
+static void
+cacheSketchBounds (sqlite3_context *ctx, int pos, SketchBounds *b, boolean fresh)
+{
+    if (fresh)
+        sqlite3_set_auxdata(ctx, pos, b, sqlite3_free);
+}
+
+static int
+sketchBucketPos (SketchBounds *b, sqlite3_value *v)
+{
+    switch(sqlite3_value_numeric_type(v))
+    {
+        case SQLITE_INTEGER:
+        case SQLITE_FLOAT:
+            return sketchBucketPosNum(b, sqlite3_value_double(v));
+        default:
+            return sketchBucketPosString(b, (const char *) sqlite3_value_text(v));
+    }
+}
+
+static void
+sqliteBucketSearch (sqlite3_context *ctx, int argc, sqlite3_value **argv)
+{
+    SketchBounds *b;
+    boolean fresh;
+
+    if (sqlite3_value_type(argv[1]) == SQLITE_NULL
+            || (b = getSketchBounds(ctx, argv, 0, &fresh)) == NULL)
+    {
+        sqlite3_result_null(ctx);
+        return;
+    }
+
+    sqlite3_result_int(ctx, sketchBucketPos(b, argv[1]));
+    cacheSketchBounds(ctx, 0, b, fresh);
+}
+
+static void
+sqliteSketchContains (sqlite3_context *ctx, int argc, sqlite3_value **argv)
+{
+    SketchBounds *b;
+    boolean fresh;
+
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL
+            || sqlite3_value_type(argv[2]) == SQLITE_NULL
+            || (b = getSketchBounds(ctx, argv, 1, &fresh)) == NULL)
+    {
+        sqlite3_result_null(ctx);
+        return;
+    }
+
+    sqlite3_result_int(ctx, sketchHasBit((const char *) sqlite3_value_text(argv[0]),
+            sqlite3_value_bytes(argv[0]), sketchBucketPos(b, argv[2]) - 1));
+    cacheSketchBounds(ctx, 1, b, fresh);
+}
+
+static void
+sqliteSketchBitOp (sqlite3_context *ctx, sqlite3_value **argv, boolean isAnd)
+{
+    const char *a, *bits;
+    int aLen, bLen;
+    char *result;
+    int len;
+
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL
+            || sqlite3_value_type(argv[1]) == SQLITE_NULL)
+    {
+        sqlite3_result_null(ctx);
+        return;
+    }
+
+    a = (const char *) sqlite3_value_text(argv[0]);
+    aLen = sqlite3_value_bytes(argv[0]);
+    bits = (const char *) sqlite3_value_text(argv[1]);
+    bLen = sqlite3_value_bytes(argv[1]);
+    result = sqlite3_malloc(MAX(aLen, bLen) + 1);
+    if (result == NULL)
+    {
+        sqlite3_result_error_nomem(ctx);
+        return;
+    }
+
+    len = sketchBitOp(result, a, aLen, bits, bLen, isAnd);
+    sqlite3_result_text(ctx, result, len, sqlite3_free);
+}
+
+static void
+sqliteSketchBitOr (sqlite3_context *ctx, int argc, sqlite3_value **argv)
+{
+    sqliteSketchBitOp(ctx, argv, FALSE);
+}
+
+static void
+sqliteSketchBitAnd (sqlite3_context *ctx, int argc, sqlite3_value **argv)
+{
+    sqliteSketchBitOp(ctx, argv, TRUE);
+}
+
+static void
+sqliteSketchBitCount (sqlite3_context *ctx, int argc, sqlite3_value **argv)
+{
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL)
+    {
+        sqlite3_result_null(ctx);
+        return;
+    }
+
+    sqlite3_result_int(ctx, sketchBitCount((const char *) sqlite3_value_text(argv[0]),
+            sqlite3_value_bytes(argv[0])));
+}
+
+static boolean
+growSketchAggState (sqlite3_context *ctx, SketchAggState *s, int len)
+{
+    gprom_long_t *counts;
+
+    if (len <= s->len)
+        return TRUE;
+
+    counts = sqlite3_malloc64(sizeof(gprom_long_t) * len);
+    if (counts == NULL)
+    {
+        sqlite3_result_error_nomem(ctx);
+        return FALSE;
+    }
+    memset(counts, 0, sizeof(gprom_long_t) * len);
+    if (s->counts != NULL)
+    {
+        memcpy(counts, s->counts, sizeof(gprom_long_t) * s->len);
+        sqlite3_free(s->counts);
+    }
+    s->counts = counts;
+    s->len = len;
+
+    return TRUE;
+}
+
+/*
+ * Add (delta = 1) or remove (delta = -1) a row. The input is either a
+ * fragment number or a sketch. An optional second argument is the number of
+ * fragments (the length of the result).
+ */
+static void
+sketchAggAddRow (sqlite3_context *ctx, int argc, sqlite3_value **argv, int delta)
+{
+    SketchAggState *s = sqlite3_aggregate_context(ctx, sizeof(SketchAggState));
+    int numFrags = (argc > 1) ? sqlite3_value_int(argv[1]) : 0;
+
+    if (s == NULL)
+    {
+        sqlite3_result_error_nomem(ctx);
+        return;
+    }
+    if (!growSketchAggState(ctx, s, numFrags))
+        return;
+
+    switch(sqlite3_value_type(argv[0]))
+    {
+        case SQLITE_NULL:
+            break;
+        case SQLITE_INTEGER:
+        {
+            int frag = sqlite3_value_int(argv[0]);
+
+            if (frag >= 0 && growSketchAggState(ctx, s, frag + 1))
+                s->counts[frag] += delta;
+        }
+        break;
+        default:
+        {
+            const char *sketch = (const char *) sqlite3_value_text(argv[0]);
+            int len = sqlite3_value_bytes(argv[0]);
+
+            if (growSketchAggState(ctx, s, len))
+                sketchAddBits(s->counts, sketch, len, delta);
+        }
+        break;
+    }
+}
+
+static void
+sqliteSketchAggStep (sqlite3_context *ctx, int argc, sqlite3_value **argv)
+{
+    sketchAggAddRow(ctx, argc, argv, 1);
+}
+
+static void
+sqliteSketchAggInverse (sqlite3_context *ctx, int argc, sqlite3_value **argv)
+{
+    sketchAggAddRow(ctx, argc, argv, -1);
+}
+
+static void
+sqliteSketchAggValue (sqlite3_context *ctx)
+{
+    SketchAggState *s = sqlite3_aggregate_context(ctx, 0);
+    char *result;
+
+    if (s == NULL || s->len == 0)
+    {
+        sqlite3_result_null(ctx);
+        return;
+    }
+
+    result = sqlite3_malloc(s->len + 1);
+    if (result == NULL)
+    {
+        sqlite3_result_error_nomem(ctx);
+        return;
+    }
+    sketchCountsToBits(result, s->counts, s->len);
+    sqlite3_result_text(ctx, result, s->len, sqlite3_free);
+}
+
+static void
+sqliteSketchAggFinal (sqlite3_context *ctx)
+{
+    SketchAggState *s = sqlite3_aggregate_context(ctx, 0);
+
+    sqliteSketchAggValue(ctx);
+    if (s != NULL && s->counts != NULL)
+        sqlite3_free(s->counts);
+}
+
+#define SQLITE_SKETCH_FLAGS (SQLITE_UTF8 | SQLITE_DETERMINISTIC)
+
+#define REGISTER_SKETCH_SCALAR(_name,_nArgs,_f) \
+    do { \
+        rc = sqlite3_create_function_v2(conn, _name, _nArgs, SQLITE_SKETCH_FLAGS, \
+                NULL, _f, NULL, NULL, NULL); \
+        if (rc != SQLITE_OK) \
+            return rc; \
+    } while(0)
+
+#define REGISTER_SKETCH_AGG(_name,_nArgs) \
+    do { \
+        rc = sqlite3_create_window_function(conn, _name, _nArgs, SQLITE_SKETCH_FLAGS, \
+                NULL, sqliteSketchAggStep, sqliteSketchAggFinal, \
+                sqliteSketchAggValue, sqliteSketchAggInverse, NULL); \
+        if (rc != SQLITE_OK) \
+            return rc; \
+    } while(0)
+
+static int
+registerSketchFunctions (sqlite3 *conn)
+{
+    int rc;
+
+    REGISTER_SKETCH_SCALAR(SKETCH_FUN_BUCKET_SEARCH, 2, sqliteBucketSearch);
+    REGISTER_SKETCH_SCALAR(SKETCH_FUN_CONTAINS, 3, sqliteSketchContains);
+    REGISTER_SKETCH_SCALAR(SKETCH_FUN_BITOR, 2, sqliteSketchBitOr);
+    REGISTER_SKETCH_SCALAR(SKETCH_FUN_BITAND, 2, sqliteSketchBitAnd);
+    REGISTER_SKETCH_SCALAR(SKETCH_FUN_BIT_COUNT, 1, sqliteSketchBitCount);
+    REGISTER_SKETCH_AGG(SKETCH_FUN_SET_BITS, 1);
+    REGISTER_SKETCH_AGG(SKETCH_FUN_SET_BITS, 2);
+    REGISTER_SKETCH_AGG(SKETCH_FUN_BITOR_AGG, 1);
+
+    DEBUG_LOG("registered native provenance sketch functions");
+
+    return SQLITE_OK;
+}
+
 #define ADD_AGGR_FUNC(name) addToSet(plugin->plugin.cache->aggFuncNames, strdup(name))
 #define ADD_WIN_FUNC(name) addToSet(plugin->plugin.cache->winFuncNames, strdup(name))
 #define ADD_BOTH_FUNC(name) \
@@ -626,6 +1235,8 @@ initCache(CatalogCache *c)
     ADD_BOTH_FUNC("min");
     ADD_BOTH_FUNC("sum");
     ADD_BOTH_FUNC("total");
+    ADD_BOTH_FUNC(SKETCH_FUN_SET_BITS);
+    ADD_BOTH_FUNC(SKETCH_FUN_BITOR_AGG);
 
     ADD_WIN_FUNC("row_number");
     ADD_WIN_FUNC("rank");
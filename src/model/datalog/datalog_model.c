@@ -787,6 +787,152 @@ argListsUnifyable (List *argsL, List *argsR)
     return TRUE;
 }
 
+/*
+ * Index a universe of arguments (e.g., the args of a rule head) for building
+ * bitsets over it. Variables are indexed by name, other arguments (constants
+ * and expressions) are rare and are later compared using equal. The index
+ * should be created once and reused for all sets over the same universe.
+ */
+DLArgIndex *
+createArgIndex(List *universe)
+{
+    DLArgIndex *idx = NEW(DLArgIndex);
+    int pos = 0;
+
+    idx->universe = universe;
+    idx->numArgs = LIST_LENGTH(universe);
+    idx->args = (Node **) MALLOC(sizeof(Node *) * (idx->numArgs + 1));
+    idx->varPos = NEW_MAP(Constant,List);
+    idx->otherPos = NIL;
+
+    FOREACH(Node,u,universe)
+    {
+        idx->args[pos] = u;
+        if (isA(u,DLVar))
+            addToMapValueList(idx->varPos,
+                              (Node *) createConstString(((DLVar *) u)->name),
+                              (Node *) createConstInt(pos),
+                              FALSE);
+        else
+            idx->otherPos = appendToTailOfListInt(idx->otherPos, pos);
+        pos++;
+    }
+
+    return idx;
+}
+
+/*
+ * Translate a list of arguments into a bitset over an indexed universe (bit i
+ * is set if the i-th element of the universe occurs in args).
+ */
+BitSet *
+argIndexToBitSet(DLArgIndex *idx, List *args)
+{
+    BitSet *result = newBitSet(idx->numArgs + 1);
+
+    FOREACH(Node,a,args)
+    {
+        if (isA(a,DLVar))
+        {
+            DLVar *v = (DLVar *) a;
+            List *candPos = (List *) MAP_GET_STRING(idx->varPos, v->name);
+
+            FOREACH(Constant,p,candPos)
+            {
+                int i = INT_VALUE(p);
+
+                if (equal(idx->args[i], v))
+                    setBit(result, i, TRUE);
+            }
+        }
+        else
+        {
+            FOREACH_INT(i,idx->otherPos)
+            {
+                if (equal(idx->args[i], a))
+                    setBit(result, i, TRUE);
+            }
+        }
+    }
+
+    return result;
+}
+
+/*
+ * Elements of the indexed universe that do not occur in args (preserving the
+ * order of the universe).
+ */
+List *
+argIndexMinus(DLArgIndex *idx, List *args)
+{
+    BitSet *b = argIndexToBitSet(idx, args);
+    List *result = NIL;
+
+    for(int i = 0; i < idx->numArgs; i++)
+    {
+        if (!isBitSet(b, i))
+            result = appendToTailOfList(result, idx->args[i]);
+    }
+
+    return result;
+}
+
+boolean
+argIndexOverlap(DLArgIndex *idx, List *args)
+{
+    BitSet *b = argIndexToBitSet(idx, args);
+
+    for(int i = 0; i < idx->numArgs; i++)
+    {
+        if (isBitSet(b, i))
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*
+ * Versions of the above for universes that are only used once.
+ */
+BitSet *
+argsToBitSet(List *universe, List *args)
+{
+    return argIndexToBitSet(createArgIndex(universe), args);
+}
+
+List *
+bitSetToArgs(List *universe, BitSet *b)
+{
+    List *result = NIL;
+    int pos = 0;
+
+    FOREACH(Node,u,universe)
+    {
+        if (isBitSet(b, pos++))
+            result = appendToTailOfList(result, u);
+    }
+
+    return result;
+}
+
+List *
+argsMinus(List *universe, List *args)
+{
+    return argIndexMinus(createArgIndex(universe), args);
+}
+
+List *
+argsIntersect(List *universe, List *args)
+{
+    return bitSetToArgs(universe, argsToBitSet(universe, args));
+}
+
+boolean
+argsOverlap(List *universe, List *args)
+{
+    return argIndexOverlap(createArgIndex(universe), args);
+}
+
 Node *
 applyVarMapAsLists(Node *input, List *vars, List *replacements)
 {
@@ -1536,6 +1536,21 @@ getSelectionCondOperatorList(Node *expr, List **opList)
 	}
 }
 
+void
+splitConjuncts (Node *cond, List **conjuncts)
+{
+    if (cond == NULL)
+        return;
+
+    if (isA(cond, Operator) && strieq(((Operator *) cond)->name, OPNAME_AND))
+    {
+        FOREACH(Node,arg,((Operator *) cond)->args)
+            splitConjuncts(arg, conjuncts);
+    }
+    else
+        *conjuncts = appendToTailOfList(*conjuncts, cond);
+}
+
 Node *
 changeListOpToAnOpNode(List *l1)
 {
@@ -268,6 +268,8 @@ deepCopyVector(Vector *from, OperatorMap **opMap)
                 VEC_ADD_NODE(new,copyObject(n));
             break;
         case VECTOR_STRING:
+            for(int i = 0; i < from->length; i++)
+                VEC_TO_ARR(new,char)[i] = strdup(VEC_TO_ARR(from,char)[i]);
             break;
     }
 
@@ -701,6 +703,7 @@ copyParameterizedQuery(ParameterizedQuery *from, OperatorMap **opMap)
 	COPY_INIT(ParameterizedQuery);
 	COPY_NODE_FIELD(q);
 	COPY_NODE_FIELD(parameters);
+	COPY_NODE_FIELD(sqlTemplate);
 
 	return new;
 }
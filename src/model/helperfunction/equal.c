@@ -574,14 +574,13 @@ equalSet (Set *a, Set *b, HashMap *seenOps, MemContext *c)
         return TRUE;
     }
 
-    FOREACH_SET(void,el,a)
-    {
-        if (!hasSetElem(b,el))
-            return FALSE;
-    }
-    FOREACH_SET(void,el,b)
+    // sets whose elements have different hash values cannot be equal
+    if (setElemsHashValue(a) != setElemsHashValue(b))
+        return FALSE;
+
+    for(SetElem *s = a->elem; s != NULL; s = s->hh.next)
     {
-        if (!hasSetElem(a,el))
+        if (!hasSetElemByHashValue(b, s->data, s->hh.hashv))
             return FALSE;
     }
 
@@ -603,13 +602,19 @@ equalHashMap (HashMap *a, HashMap *b, HashMap *seenOps, MemContext *c)
     COMPARE_SCALAR_FIELD(keyType);
     COMPARE_SCALAR_FIELD(valueType);
 
-    FOREACH_HASH_KEY(Node,k,a)
-        if(!hasMapKey(b,k) || !equal(getMap(a,k),getMap(b,k)))
-            return FALSE;
+    // maps with different sets of keys cannot be equal
+    if (mapSize(a) != mapSize(b) || mapKeysHashValue(a) != mapKeysHashValue(b))
+        return FALSE;
 
-    FOREACH_HASH_KEY(Node,k,b)
-        if(!hasMapKey(a,k))
+    // same size, so every key of b is a key of a if all keys of a are keys of b
+    for(HashElem *e = a->elem; e != NULL; e = e->hh.next)
+    {
+        KeyValue *kv = (KeyValue *) e->data;
+        KeyValue *bKv = getMapEntryByHashValue(b, kv->key, e->hh.hashv);
+
+        if (bKv == NULL || !equal(kv->value, bKv->value))
             return FALSE;
+    }
 
     return TRUE;
 }
@@ -669,19 +674,20 @@ equalRelation(Relation *a, Relation *b,  HashMap *seenOps, MemContext *c)
 	aset = NEW_MAP(List,Constant);
 	bset = NEW_MAP(List,Constant);
 
-	FOREACH_VEC(List,tuple,a->tuples)
+	FOREACH_REL_TUPLE(it,a)
 	{
-		mapIncr(aset, (Node *) tuple);
+		mapIncr(aset, (Node *) getRelationTuple(a, it.row));
 	}
 
-	FOREACH_VEC(List,tuple,b->tuples)
+	FOREACH_REL_TUPLE(it,b)
 	{
-		mapIncr(bset, (Node *) tuple);
+		mapIncr(bset, (Node *) getRelationTuple(b, it.row));
 	}
 
 	//maybe map tuples into string constants
 
-	return equal(a->schema, b->schema)
+	// schemas are lists of strings
+	return equalStringList(a->schema, b->schema)
 		&& equal(aset, bset);
 }
 
@@ -761,6 +767,7 @@ equalParameterizedQuery(ParameterizedQuery *a, ParameterizedQuery *b, HashMap *s
 {
 	COMPARE_NODE_FIELD(q);
 	COMPARE_NODE_FIELD(parameters);
+	COMPARE_NODE_FIELD(sqlTemplate);
 
 	return TRUE;
 }
@@ -215,34 +215,16 @@ hashStringList(uint64_t cur, List *node)
     HASH_RETURN();
 }
 
+/*
+ * Sets and maps store the hash value of each element (key). Combine these
+ * stored hash values independent of the order of elements instead of hashing
+ * all elements again.
+ */
 static uint64_t
 hashSet (uint64_t cur, Set *node)
 {
     HASH_INT(setType);
-
-    switch (node->setType)
-    {
-        case SET_TYPE_INT:
-            FOREACH_SET_INT(i,node)
-                hashInt(cur, i);
-            break;
-        case SET_TYPE_LONG:
-            FOREACH_SET_LONG(i,node)
-                hashLong(cur, i);
-            break;
-        case SET_TYPE_NODE:
-            FOREACH_SET(Node,n,node)
-                hashValueInternal(cur,n);
-            break;
-        case SET_TYPE_STRING:
-            FOREACH_SET(char,c,node)
-                hashString(cur,c);
-            break;
-        case SET_TYPE_POINTER:
-            FOREACH_SET(void,p,node)
-                hashLong(cur, (gprom_long_t) p);
-            break;
-    }
+    cur = hashInt(cur, (int) setElemsHashValue(node));
 
     HASH_RETURN();
 }
@@ -253,9 +235,7 @@ hashHashMap (uint64_t cur, HashMap *node)
 {
     HASH_INT(keyType);
     HASH_INT(valueType);
-
-    FOREACH_HASH_ENTRY(e,node)
-        hashKeyValue(cur, e);
+    cur = hashInt(cur, (int) mapKeysHashValue(node));
 
     HASH_RETURN();
 }
@@ -268,15 +248,15 @@ hashVector (uint64_t cur, Vector *node)
     {
         case VECTOR_INT:
             FOREACH_VEC_INT(i,node)
-                hashInt(cur,i);
+                cur = hashInt(cur,i);
         break;
         case VECTOR_NODE:
             FOREACH_VEC(Node,n,node)
-                hashValueInternal(cur, n);
+                cur = hashValueInternal(cur, n);
             break;
         case VECTOR_STRING:
             FOREACH_VEC(char,c,node)
-                hashString(cur, c);
+                cur = hashString(cur, c);
             break;
     }
 
@@ -768,6 +748,7 @@ hashParameterizedQuery (uint64_t cur, ParameterizedQuery *node)
 {
 	HASH_NODE(q);
 	HASH_NODE(parameters);
+	HASH_NODE(sqlTemplate);
 
 	HASH_RETURN();
 }
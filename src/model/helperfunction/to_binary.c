@@ -0,0 +1,1540 @@
+/*-----------------------------------------------------------------------------
+ *
+ * to_binary.c
+ *		Compact binary representation of nodes for persisting and passing
+ *		around plans, sketch templates, and catalog data.
+ *
+ *		A serialized node starts with a header (magic number, format version,
+ *		byte order, and size of long) followed by the node tree. Each node is
+ *		written as its tag followed by its fields in the order they are listed
+ *		in the per-type functions below. Tags, lengths, and operator ids are
+ *		variable length integers, scalar fields are written as they are stored
+ *		in memory. Operators are numbered in the order they are written and
+ *		operators that have been written before (shared subgraphs of a DAG)
+ *		are written as a reference to their number.
+ *
+ *		The same per-type function is used for writing and reading a node.
+ *		When reading, strings are not copied, they point into the buffer
+ *		passed to binaryToNode.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "common.h"
+#include "mem_manager/mem_mgr.h"
+#include "log/logger.h"
+#include "model/node/nodetype.h"
+#include "model/list/list.h"
+#include "model/set/set.h"
+#include "model/set/hashmap.h"
+#include "model/set/vector.h"
+#include "model/graph/graph.h"
+#include "model/bitset/bitset.h"
+#include "model/expression/expression.h"
+#include "model/query_block/query_block.h"
+#include "model/datalog/datalog_model.h"
+#include "model/query_operator/query_operator.h"
+#include "model/integrity_constraints/integrity_constraints.h"
+#include "model/rpq/rpq_model.h"
+#include "provenance_rewriter/coarse_grained/coarse_grained_rewrite.h"
+
+#define BINARY_MAGIC "GPRB"
+#define BINARY_MAGIC_LEN 4
+#define BINARY_HEADER_LEN 8
+#define BINARY_LITTLE_ENDIAN 1
+#define BINARY_BIG_ENDIAN 2
+
+/* markers written instead of a node tag, tags are shifted by BINARY_TAG_OFFSET */
+#define BINARY_NULL 0
+#define BINARY_OP_REFERENCE 1
+#define BINARY_TAG_OFFSET 2
+
+/* maps operators that have been written to their number */
+typedef struct WrittenOperator
+{
+    void *op;
+    unsigned long id;
+    UT_hash_handle hh;
+} WrittenOperator;
+
+typedef struct BinaryState
+{
+    boolean reading;
+    StringInfo out;             // output when writing
+    char *data;                 // input when reading
+    size_t len;
+    size_t pos;
+    WrittenOperator *written;   // operators written so far
+    unsigned long numOps;
+    Vector *readOps;            // operators read so far indexed by number
+} BinaryState;
+
+/* helpers for writing and reading basic values */
+static char getByteOrder(void);
+static void binRaw(BinaryState *s, void *p, size_t size);
+static void binUInt(BinaryState *s, unsigned long *v);
+static void binString(BinaryState *s, char **str);
+static void binStringList(BinaryState *s, List **l);
+static void binNode(BinaryState *s, void **node);
+static boolean isOperatorTag(NodeTag tag);
+static void checkAvailable(BinaryState *s, size_t size);
+
+/* collection types */
+static void binList(BinaryState *s, List **l, NodeTag tag);
+static void binSet(BinaryState *s, Set **set);
+static void binHashMap(BinaryState *s, HashMap **map);
+static void binVector(BinaryState *s, Vector **vec);
+static void binBitSet(BinaryState *s, BitSet **b);
+static void binGraph(Graph *n, BinaryState *s);
+
+/* expression node types */
+static void binAttributeReference(AttributeReference *n, BinaryState *s);
+static void binFunctionCall(FunctionCall *n, BinaryState *s);
+static void binKeyValue(KeyValue *n, BinaryState *s);
+static void binOperator(Operator *n, BinaryState *s);
+static void binSQLParameter(SQLParameter *n, BinaryState *s);
+static void binCaseExpr(CaseExpr *n, BinaryState *s);
+static void binCaseWhen(CaseWhen *n, BinaryState *s);
+static void binIsNullExpr(IsNullExpr *n, BinaryState *s);
+static void binWindowBound(WindowBound *n, BinaryState *s);
+static void binWindowFrame(WindowFrame *n, BinaryState *s);
+static void binWindowDef(WindowDef *n, BinaryState *s);
+static void binWindowFunction(WindowFunction *n, BinaryState *s);
+static void binRowNumExpr(RowNumExpr *n, BinaryState *s);
+static void binOrderExpr(OrderExpr *n, BinaryState *s);
+static void binQuantifiedComparison(QuantifiedComparison *n, BinaryState *s);
+static void binCastExpr(CastExpr *n, BinaryState *s);
+static void binConstant(Constant *n, BinaryState *s);
+
+/* integrity constraints */
+static void binFD(FD *n, BinaryState *s);
+static void binFOdep(FOdep *n, BinaryState *s);
+
+/* schema */
+static void binAttributeDef(AttributeDef *n, BinaryState *s);
+static void binSchema(Schema *n, BinaryState *s);
+
+/* query operators */
+static void binQueryOperator(QueryOperator *n, BinaryState *s);
+static void binParameterizedQuery(ParameterizedQuery *n, BinaryState *s);
+static void binTableAccessOperator(TableAccessOperator *n, BinaryState *s);
+static void binSampleClauseOperator(SampleClauseOperator *n, BinaryState *s);
+static void binJsonTableOperator(JsonTableOperator *n, BinaryState *s);
+static void binJsonPath(JsonPath *n, BinaryState *s);
+static void binSelectionOperator(SelectionOperator *n, BinaryState *s);
+static void binProjectionOperator(ProjectionOperator *n, BinaryState *s);
+static void binJoinOperator(JoinOperator *n, BinaryState *s);
+static void binAggregationOperator(AggregationOperator *n, BinaryState *s);
+static void binSetOperator(SetOperator *n, BinaryState *s);
+static void binDuplicateRemoval(DuplicateRemoval *n, BinaryState *s);
+static void binProvenanceComputation(ProvenanceComputation *n, BinaryState *s);
+static void binConstRelOperator(ConstRelOperator *n, BinaryState *s);
+static void binNestingOperator(NestingOperator *n, BinaryState *s);
+static void binWindowOperator(WindowOperator *n, BinaryState *s);
+static void binOrderOperator(OrderOperator *n, BinaryState *s);
+static void binLimitOperator(LimitOperator *n, BinaryState *s);
+static void binJsonColInfoItem(JsonColInfoItem *n, BinaryState *s);
+static void binExecPreparedOperator(ExecPreparedOperator *n, BinaryState *s);
+
+/* query blocks */
+static void binSetQuery(SetQuery *n, BinaryState *s);
+static void binQueryBlock(QueryBlock *n, BinaryState *s);
+static void binNestedSubquery(NestedSubquery *n, BinaryState *s);
+static void binProvenanceStmt(ProvenanceStmt *n, BinaryState *s);
+static void binProvenanceTransactionInfo(ProvenanceTransactionInfo *n, BinaryState *s);
+static void binSelectItem(SelectItem *n, BinaryState *s);
+static void binFromItem(FromItem *n, BinaryState *s);
+static void binFromTableRef(FromTableRef *n, BinaryState *s);
+static void binFromJsonTable(FromJsonTable *n, BinaryState *s);
+static void binFromSubquery(FromSubquery *n, BinaryState *s);
+static void binFromLateralSubquery(FromLateralSubquery *n, BinaryState *s);
+static void binFromJoinExpr(FromJoinExpr *n, BinaryState *s);
+static void binFromProvInfo(FromProvInfo *n, BinaryState *s);
+static void binDistinctClause(DistinctClause *n, BinaryState *s);
+static void binInsert(Insert *n, BinaryState *s);
+static void binDelete(Delete *n, BinaryState *s);
+static void binUpdate(Update *n, BinaryState *s);
+static void binTransactionStmt(TransactionStmt *n, BinaryState *s);
+static void binWithStmt(WithStmt *n, BinaryState *s);
+static void binCreateTable(CreateTable *n, BinaryState *s);
+static void binAlterTable(AlterTable *n, BinaryState *s);
+static void binPreparedQuery(PreparedQuery *n, BinaryState *s);
+static void binExecQuery(ExecQuery *n, BinaryState *s);
+
+/* datalog model */
+static void binDLAtom(DLAtom *n, BinaryState *s);
+static void binDLVar(DLVar *n, BinaryState *s);
+static void binDLComparison(DLComparison *n, BinaryState *s);
+static void binDLDomain(DLDomain *n, BinaryState *s);
+static void binDLRule(DLRule *n, BinaryState *s);
+static void binDLProgram(DLProgram *n, BinaryState *s);
+
+/* regex */
+static void binRegex(Regex *n, BinaryState *s);
+static void binRPQQuery(RPQQuery *n, BinaryState *s);
+
+/* provenance sketches */
+static void binPSInfo(psInfo *n, BinaryState *s);
+static void binPSAttrInfo(psAttrInfo *n, BinaryState *s);
+static void binPSInfoCell(psInfoCell *n, BinaryState *s);
+
+/* macros for per-type functions (the variables are 'n' and 's') */
+#define BIN_SCALAR_FIELD(fldname) \
+        binRaw(s, &(n->fldname), sizeof(n->fldname))
+
+#define BIN_NODE_FIELD(fldname) \
+        binNode(s, (void **) &(n->fldname))
+
+#define BIN_STRING_FIELD(fldname) \
+        binString(s, &(n->fldname))
+
+#define BIN_STRING_LIST_FIELD(fldname) \
+        binStringList(s, (List **) &(n->fldname))
+
+#define BIN_OPERATOR() binQueryOperator((QueryOperator *) n, s)
+#define BIN_FROM() binFromItem((FromItem *) n, s)
+
+/* node types whose per-type function is called through binNode */
+#define BIN_CASE(_type) \
+        case T_ ## _type: \
+            if (s->reading) \
+                *node = makeNode(_type); \
+            bin ## _type((_type *) *node, s); \
+            break
+
+#define BIN_CASE_FUNC(_type,_func) \
+        case T_ ## _type: \
+            if (s->reading) \
+                *node = makeNode(_type); \
+            _func((_type *) *node, s); \
+            break
+
+/*
+ * Serialize a node into a newly allocated buffer. The length of the result
+ * is stored in len.
+ */
+char *
+nodeToBinary(void *obj, size_t *len)
+{
+    BinaryState state;
+    BinaryState *s = &state;
+    char header[BINARY_HEADER_LEN];
+
+    state.reading = FALSE;
+    state.out = makeStringInfo();
+    state.data = NULL;
+    state.len = 0;
+    state.pos = 0;
+    state.written = NULL;
+    state.numOps = 0;
+    state.readOps = NULL;
+
+    memcpy(header, BINARY_MAGIC, BINARY_MAGIC_LEN);
+    header[4] = NODE_BINARY_FORMAT_VERSION;
+    header[5] = getByteOrder();
+    header[6] = (char) sizeof(long);
+    header[7] = 0;
+    appendBinaryStringInfo(s->out, header, BINARY_HEADER_LEN);
+
+    binNode(s, &obj);
+
+    HASH_CLEAR(hh, state.written);
+
+    *len = (size_t) state.out->len;
+    return state.out->data;
+}
+
+/*
+ * Deserialize a node produced by nodeToBinary. Strings of the result point
+ * into data, so data has to be kept around as long as the result is used.
+ * Use copyObject to get a node that does not depend on data.
+ */
+void *
+binaryToNode(char *data, size_t len)
+{
+    BinaryState state;
+    BinaryState *s = &state;
+    void *result = NULL;
+
+    if (len < BINARY_HEADER_LEN || memcmp(data, BINARY_MAGIC, BINARY_MAGIC_LEN) != 0)
+        FATAL_LOG("not a binary serialized node");
+    if (data[4] != NODE_BINARY_FORMAT_VERSION)
+        FATAL_LOG("binary node format version %d is not supported (expected %d)",
+                (int) data[4], NODE_BINARY_FORMAT_VERSION);
+    if (data[5] != getByteOrder() || data[6] != (char) sizeof(long))
+        FATAL_LOG("binary serialized node was produced on a platform with"
+                " a different byte order or word size");
+
+    state.reading = TRUE;
+    state.out = NULL;
+    state.data = data;
+    state.len = len;
+    state.pos = BINARY_HEADER_LEN;
+    state.written = NULL;
+    state.numOps = 0;
+    state.readOps = makeVector(VECTOR_NODE, T_QueryOperator);
+
+    binNode(s, &result);
+
+    if (state.pos != len)
+        FATAL_LOG("binary serialized node has %zu trailing bytes", len - state.pos);
+
+    return result;
+}
+
+static char
+getByteOrder(void)
+{
+    int one = 1;
+
+    return (*((char *) &one) == 1) ? BINARY_LITTLE_ENDIAN : BINARY_BIG_ENDIAN;
+}
+
+static void
+checkAvailable(BinaryState *s, size_t size)
+{
+    if (s->len - s->pos < size)
+        FATAL_LOG("binary serialized node is truncated at byte %zu", s->pos);
+}
+
+static void
+binRaw(BinaryState *s, void *p, size_t size)
+{
+    if (s->reading)
+    {
+        checkAvailable(s, size);
+        memcpy(p, s->data + s->pos, size);
+        s->pos += size;
+    }
+    else
+        appendBinaryStringInfo(s->out, (char *) p, (int) size);
+}
+
+/* unsigned integers are stored with 7 bits per byte, the high bit marks continuation */
+static void
+binUInt(BinaryState *s, unsigned long *v)
+{
+    if (s->reading)
+    {
+        unsigned long result = 0;
+        int shift = 0;
+        unsigned char b;
+
+        do {
+            checkAvailable(s, 1);
+            b = (unsigned char) s->data[s->pos++];
+            result |= ((unsigned long) (b & 0x7F)) << shift;
+            shift += 7;
+        } while ((b & 0x80) && shift < 64);
+
+        *v = result;
+    }
+    else
+    {
+        unsigned long val = *v;
+
+        while (val >= 0x80)
+        {
+            appendStringInfoChar(s->out, (char) ((val & 0x7F) | 0x80));
+            val >>= 7;
+        }
+        appendStringInfoChar(s->out, (char) val);
+    }
+}
+
+/* strings are stored as length + 1 (0 for NULL) followed by the characters and '\0' */
+static void
+binString(BinaryState *s, char **str)
+{
+    unsigned long len;
+
+    if (s->reading)
+    {
+        binUInt(s, &len);
+        if (len == 0)
+        {
+            *str = NULL;
+            return;
+        }
+        checkAvailable(s, len);
+        if (s->data[s->pos + len - 1] != '\0')
+            FATAL_LOG("string in binary serialized node is not terminated");
+        *str = s->data + s->pos;
+        s->pos += len;
+    }
+    else
+    {
+        len = (*str == NULL) ? 0 : strlen(*str) + 1;
+        binUInt(s, &len);
+        if (len > 0)
+            appendBinaryStringInfo(s->out, *str, (int) len);
+    }
+}
+
+static void
+binStringList(BinaryState *s, List **l)
+{
+    unsigned long len = LIST_LENGTH(*l);
+
+    binUInt(s, &len);
+
+    if (s->reading)
+    {
+        *l = NIL;
+        for(unsigned long i = 0; i < len; i++)
+        {
+            char *str;
+            binString(s, &str);
+            *l = appendToTailOfList(*l, str);
+        }
+    }
+    else
+    {
+        FOREACH_LC(lc, *l)
+        {
+            char *str = LC_STRING_VAL(lc);
+            binString(s, &str);
+        }
+    }
+}
+
+static boolean
+isOperatorTag(NodeTag tag)
+{
+    switch(tag)
+    {
+        case T_TableAccessOperator:
+        case T_SampleClauseOperator:
+        case T_JsonTableOperator:
+        case T_SelectionOperator:
+        case T_ProjectionOperator:
+        case T_JoinOperator:
+        case T_AggregationOperator:
+        case T_SetOperator:
+        case T_DuplicateRemoval:
+        case T_ProvenanceComputation:
+        case T_ConstRelOperator:
+        case T_NestingOperator:
+        case T_WindowOperator:
+        case T_OrderOperator:
+        case T_LimitOperator:
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
+
+static void
+binNode(BinaryState *s, void **node)
+{
+    unsigned long code;
+    NodeTag tag;
+
+    if (s->reading)
+    {
+        binUInt(s, &code);
+        if (code == BINARY_NULL)
+        {
+            *node = NULL;
+            return;
+        }
+        if (code == BINARY_OP_REFERENCE)
+        {
+            unsigned long id;
+
+            binUInt(s, &id);
+            if (id >= (unsigned long) VEC_LENGTH(s->readOps))
+                FATAL_LOG("binary serialized node references unknown operator %lu", id);
+            *node = getVecNode(s->readOps, (int) id);
+            return;
+        }
+        tag = (NodeTag) (code - BINARY_TAG_OFFSET);
+    }
+    else
+    {
+        if (*node == NULL)
+        {
+            code = BINARY_NULL;
+            binUInt(s, &code);
+            return;
+        }
+
+        tag = nodeTag(*node);
+
+        // operators that have been written before are replaced with their number
+        if (isOperatorTag(tag))
+        {
+            WrittenOperator *w;
+
+            HASH_FIND_PTR(s->written, node, w);
+            if (w != NULL)
+            {
+                code = BINARY_OP_REFERENCE;
+                binUInt(s, &code);
+                binUInt(s, &(w->id));
+                return;
+            }
+        }
+
+        code = ((unsigned long) tag) + BINARY_TAG_OFFSET;
+        binUInt(s, &code);
+    }
+
+    switch(tag)
+    {
+        /* collection type nodes */
+        case T_List:
+        case T_IntList:
+            binList(s, (List **) node, tag);
+            break;
+        case T_Set:
+            binSet(s, (Set **) node);
+            break;
+        case T_HashMap:
+            binHashMap(s, (HashMap **) node);
+            break;
+        case T_Vector:
+            binVector(s, (Vector **) node);
+            break;
+        case T_BitSet:
+            binBitSet(s, (BitSet **) node);
+            break;
+        BIN_CASE(Graph);
+        /* expression model */
+        BIN_CASE(AttributeReference);
+        BIN_CASE(FunctionCall);
+        BIN_CASE(KeyValue);
+        BIN_CASE(Operator);
+        BIN_CASE(Schema);
+        BIN_CASE(AttributeDef);
+        BIN_CASE(SQLParameter);
+        BIN_CASE(CaseExpr);
+        BIN_CASE(CaseWhen);
+        BIN_CASE(IsNullExpr);
+        BIN_CASE(WindowBound);
+        BIN_CASE(WindowFrame);
+        BIN_CASE(WindowDef);
+        BIN_CASE(WindowFunction);
+        BIN_CASE(RowNumExpr);
+        BIN_CASE(OrderExpr);
+        BIN_CASE(QuantifiedComparison);
+        BIN_CASE(CastExpr);
+        BIN_CASE(FD);
+        BIN_CASE(FOdep);
+        BIN_CASE(Constant);
+        /* query block model nodes */
+        BIN_CASE(SetQuery);
+        BIN_CASE(ProvenanceStmt);
+        BIN_CASE(ProvenanceTransactionInfo);
+        BIN_CASE(QueryBlock);
+        BIN_CASE(WithStmt);
+        BIN_CASE(SelectItem);
+        BIN_CASE(NestedSubquery);
+        BIN_CASE(FromTableRef);
+        BIN_CASE(FromSubquery);
+        BIN_CASE(FromLateralSubquery);
+        BIN_CASE(FromJoinExpr);
+        BIN_CASE(FromProvInfo);
+        BIN_CASE(FromJsonTable);
+        BIN_CASE(DistinctClause);
+        BIN_CASE(Insert);
+        BIN_CASE(Delete);
+        BIN_CASE(Update);
+        BIN_CASE(TransactionStmt);
+        BIN_CASE(CreateTable);
+        BIN_CASE(AlterTable);
+        BIN_CASE(PreparedQuery);
+        BIN_CASE(ExecQuery);
+        /* query operator model nodes */
+        BIN_CASE(ParameterizedQuery);
+        BIN_CASE(SelectionOperator);
+        BIN_CASE(ProjectionOperator);
+        BIN_CASE(JoinOperator);
+        BIN_CASE(AggregationOperator);
+        BIN_CASE(ProvenanceComputation);
+        BIN_CASE(TableAccessOperator);
+        BIN_CASE(SampleClauseOperator);
+        BIN_CASE(SetOperator);
+        BIN_CASE(DuplicateRemoval);
+        BIN_CASE(ConstRelOperator);
+        BIN_CASE(NestingOperator);
+        BIN_CASE(WindowOperator);
+        BIN_CASE(OrderOperator);
+        BIN_CASE(LimitOperator);
+        BIN_CASE(JsonTableOperator);
+        BIN_CASE(JsonPath);
+        BIN_CASE(JsonColInfoItem);
+        BIN_CASE(ExecPreparedOperator);
+        /* datalog model nodes */
+        BIN_CASE(DLAtom);
+        BIN_CASE(DLVar);
+        BIN_CASE(DLRule);
+        BIN_CASE(DLProgram);
+        BIN_CASE(DLComparison);
+        BIN_CASE(DLDomain);
+        /* regex */
+        BIN_CASE(Regex);
+        BIN_CASE(RPQQuery);
+        /* provenance sketch */
+        BIN_CASE_FUNC(psInfo, binPSInfo);
+        BIN_CASE_FUNC(psAttrInfo, binPSAttrInfo);
+        BIN_CASE_FUNC(psInfoCell, binPSInfoCell);
+        default:
+            FATAL_LOG("binary serialization does not support nodes of type %s",
+                    NodeTagToString(tag));
+            break;
+    }
+}
+
+/* collection types */
+static void
+binList(BinaryState *s, List **l, NodeTag tag)
+{
+    unsigned long len = LIST_LENGTH(*l);
+
+    binUInt(s, &len);
+
+    if (s->reading)
+    {
+        *l = NIL;
+        for(unsigned long i = 0; i < len; i++)
+        {
+            if (tag == T_IntList)
+            {
+                int val;
+                binRaw(s, &val, sizeof(int));
+                *l = appendToTailOfListInt(*l, val);
+            }
+            else
+            {
+                void *el;
+                binNode(s, &el);
+                *l = appendToTailOfList(*l, el);
+            }
+        }
+    }
+    else
+    {
+        FOREACH_LC(lc, *l)
+        {
+            if (tag == T_IntList)
+                binRaw(s, &(LC_INT_VAL(lc)), sizeof(int));
+            else
+                binNode(s, &(LC_P_VAL(lc)));
+        }
+    }
+}
+
+static void
+binSet(BinaryState *s, Set **set)
+{
+    Set *in;
+    SetType setType;
+    int typelen;
+    unsigned long size;
+
+    if (!s->reading)
+    {
+        setType = (*set)->setType;
+        typelen = (*set)->typelen;
+        size = setSize(*set);
+        if (setType == SET_TYPE_POINTER)
+            FATAL_LOG("cannot serialize a set of pointers");
+    }
+
+    binRaw(s, &setType, sizeof(SetType));
+    binRaw(s, &typelen, sizeof(int));
+    binUInt(s, &size);
+
+    if (s->reading)
+    {
+        if (setType == SET_TYPE_NODE)
+            *set = newSet(setType, typelen, equal, copyObject);
+        else
+            *set = newSet(setType, typelen, NULL, NULL);
+
+        for(unsigned long i = 0; i < size; i++)
+        {
+            switch(setType)
+            {
+                case SET_TYPE_INT:
+                {
+                    int val;
+                    binRaw(s, &val, sizeof(int));
+                    addIntToSet(*set, val);
+                }
+                break;
+                case SET_TYPE_LONG:
+                {
+                    gprom_long_t val;
+                    binRaw(s, &val, sizeof(gprom_long_t));
+                    addLongToSet(*set, val);
+                }
+                break;
+                case SET_TYPE_NODE:
+                {
+                    void *el;
+                    binNode(s, &el);
+                    addToSet(*set, el);
+                }
+                break;
+                case SET_TYPE_STRING:
+                {
+                    char *el;
+                    binString(s, &el);
+                    addToSet(*set, el);
+                }
+                break;
+                case SET_TYPE_POINTER:
+                    FATAL_LOG("cannot deserialize a set of pointers");
+                    break;
+            }
+        }
+        return;
+    }
+
+    in = *set;
+    switch(setType)
+    {
+        case SET_TYPE_INT:
+            FOREACH_SET_INT(val,in)
+                binRaw(s, &val, sizeof(int));
+            break;
+        case SET_TYPE_LONG:
+            FOREACH_SET_LONG(val,in)
+                binRaw(s, &val, sizeof(gprom_long_t));
+            break;
+        case SET_TYPE_NODE:
+            FOREACH_SET(void,el,in)
+                binNode(s, &el);
+            break;
+        case SET_TYPE_STRING:
+            FOREACH_SET(char,el,in)
+                binString(s, &el);
+            break;
+        case SET_TYPE_POINTER:
+            break;
+    }
+}
+
+static void
+binHashMap(BinaryState *s, HashMap **map)
+{
+    HashMap *in;
+    NodeTag keyType;
+    NodeTag valueType;
+    unsigned long size;
+
+    if (!s->reading)
+    {
+        keyType = (*map)->keyType;
+        valueType = (*map)->valueType;
+        size = mapSize(*map);
+    }
+
+    binRaw(s, &keyType, sizeof(NodeTag));
+    binRaw(s, &valueType, sizeof(NodeTag));
+    binUInt(s, &size);
+
+    if (s->reading)
+    {
+        *map = newHashMap(keyType, valueType, NULL, NULL);
+        for(unsigned long i = 0; i < size; i++)
+        {
+            void *key;
+            void *value;
+
+            binNode(s, &key);
+            binNode(s, &value);
+            addToMap(*map, (Node *) key, (Node *) value);
+        }
+        return;
+    }
+
+    in = *map;
+    FOREACH_HASH_ENTRY(kv,in)
+    {
+        binNode(s, (void **) &(kv->key));
+        binNode(s, (void **) &(kv->value));
+    }
+}
+
+static void
+binVector(BinaryState *s, Vector **vec)
+{
+    VectorType elType;
+    NodeTag elNodeType;
+    unsigned long len;
+
+    if (!s->reading)
+    {
+        elType = (*vec)->elType;
+        elNodeType = (*vec)->elNodeType;
+        len = VEC_LENGTH(*vec);
+    }
+
+    binRaw(s, &elType, sizeof(VectorType));
+    binRaw(s, &elNodeType, sizeof(NodeTag));
+    binUInt(s, &len);
+
+    if (s->reading)
+        *vec = makeVectorOfSize(elType, elNodeType, (len > 0) ? (int) len : 1);
+
+    for(unsigned long i = 0; i < len; i++)
+    {
+        switch(elType)
+        {
+            case VECTOR_INT:
+            {
+                int val = s->reading ? 0 : getVecInt(*vec, (int) i);
+                binRaw(s, &val, sizeof(int));
+                if (s->reading)
+                    vecAppendInt(*vec, val);
+            }
+            break;
+            case VECTOR_NODE:
+            {
+                void *el = s->reading ? NULL : getVecNode(*vec, (int) i);
+                binNode(s, &el);
+                if (s->reading)
+                    vecAppendNode(*vec, (Node *) el);
+            }
+            break;
+            case VECTOR_STRING:
+            {
+                char *el = s->reading ? NULL : getVecString(*vec, (int) i);
+                binString(s, &el);
+                if (s->reading)
+                    vecAppendString(*vec, el);
+            }
+            break;
+        }
+    }
+}
+
+static void
+binBitSet(BinaryState *s, BitSet **b)
+{
+    unsigned int length = s->reading ? 0 : (*b)->length;
+
+    binRaw(s, &length, sizeof(unsigned int));
+    if (s->reading)
+        *b = newBitSet(length);
+    binRaw(s, (*b)->value, sizeof(unsigned long) * (*b)->numWords);
+}
+
+static void
+binGraph(Graph *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(nodes);
+    BIN_NODE_FIELD(edges);
+}
+
+/* expression node types */
+static void
+binAttributeReference(AttributeReference *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(name);
+    BIN_SCALAR_FIELD(fromClauseItem);
+    BIN_SCALAR_FIELD(attrPosition);
+    BIN_SCALAR_FIELD(outerLevelsUp);
+    BIN_SCALAR_FIELD(attrType);
+}
+
+static void
+binFunctionCall(FunctionCall *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(functionname);
+    BIN_NODE_FIELD(args);
+    BIN_SCALAR_FIELD(isAgg);
+    BIN_SCALAR_FIELD(isDistinct);
+}
+
+static void
+binKeyValue(KeyValue *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(key);
+    BIN_NODE_FIELD(value);
+}
+
+static void
+binOperator(Operator *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(name);
+    BIN_NODE_FIELD(args);
+}
+
+static void
+binSQLParameter(SQLParameter *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(name);
+    BIN_SCALAR_FIELD(position);
+    BIN_SCALAR_FIELD(parType);
+}
+
+static void
+binCaseExpr(CaseExpr *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(expr);
+    BIN_NODE_FIELD(whenClauses);
+    BIN_NODE_FIELD(elseRes);
+}
+
+static void
+binCaseWhen(CaseWhen *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(when);
+    BIN_NODE_FIELD(then);
+}
+
+static void
+binIsNullExpr(IsNullExpr *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(expr);
+}
+
+static void
+binWindowBound(WindowBound *n, BinaryState *s)
+{
+    BIN_SCALAR_FIELD(bType);
+    BIN_NODE_FIELD(expr);
+}
+
+static void
+binWindowFrame(WindowFrame *n, BinaryState *s)
+{
+    BIN_SCALAR_FIELD(frameType);
+    BIN_NODE_FIELD(lower);
+    BIN_NODE_FIELD(higher);
+}
+
+static void
+binWindowDef(WindowDef *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(partitionBy);
+    BIN_NODE_FIELD(orderBy);
+    BIN_NODE_FIELD(frame);
+}
+
+static void
+binWindowFunction(WindowFunction *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(f);
+    BIN_NODE_FIELD(win);
+}
+
+static void
+binRowNumExpr(RowNumExpr *n, BinaryState *s)
+{
+}
+
+static void
+binOrderExpr(OrderExpr *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(expr);
+    BIN_SCALAR_FIELD(order);
+    BIN_SCALAR_FIELD(nullOrder);
+}
+
+static void
+binQuantifiedComparison(QuantifiedComparison *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(checkExpr);
+    BIN_NODE_FIELD(exprList);
+    BIN_SCALAR_FIELD(qType);
+    BIN_STRING_FIELD(opName);
+}
+
+static void
+binCastExpr(CastExpr *n, BinaryState *s)
+{
+    BIN_SCALAR_FIELD(resultDT);
+    BIN_NODE_FIELD(expr);
+    BIN_STRING_FIELD(otherDT);
+    BIN_SCALAR_FIELD(num);
+}
+
+static void
+binConstant(Constant *n, BinaryState *s)
+{
+    BIN_SCALAR_FIELD(constType);
+    BIN_SCALAR_FIELD(isNull);
+
+    if (n->isNull)
+    {
+        n->value = NULL;
+        return;
+    }
+
+    switch(n->constType)
+    {
+        case DT_INT:
+            if (s->reading)
+                n->value = NEW(int);
+            binRaw(s, n->value, sizeof(int));
+            break;
+        case DT_FLOAT:
+            if (s->reading)
+                n->value = NEW(double);
+            binRaw(s, n->value, sizeof(double));
+            break;
+        case DT_BOOL:
+            if (s->reading)
+                n->value = NEW(boolean);
+            binRaw(s, n->value, sizeof(boolean));
+            break;
+        case DT_LONG:
+            if (s->reading)
+                n->value = NEW(long);
+            binRaw(s, n->value, sizeof(long));
+            break;
+        case DT_STRING:
+        case DT_VARCHAR2:
+            binString(s, (char **) &(n->value));
+            break;
+    }
+}
+
+/* integrity constraints */
+static void
+binFD(FD *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(table);
+    BIN_NODE_FIELD(lhs);
+    BIN_NODE_FIELD(rhs);
+}
+
+static void
+binFOdep(FOdep *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(lhs);
+    BIN_NODE_FIELD(rhs);
+}
+
+/* schema */
+static void
+binAttributeDef(AttributeDef *n, BinaryState *s)
+{
+    BIN_SCALAR_FIELD(dataType);
+    BIN_STRING_FIELD(attrName);
+}
+
+static void
+binSchema(Schema *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(name);
+    BIN_NODE_FIELD(attrDefs);
+}
+
+/*
+ * Fields shared by all operators. Operators are numbered before their
+ * children are written so references from the children's subtrees can be
+ * resolved. Parents are not stored, they are restored when reading the
+ * inputs of an operator.
+ */
+static void
+binQueryOperator(QueryOperator *n, BinaryState *s)
+{
+    unsigned long numInputs = LIST_LENGTH(n->inputs);
+
+    if (s->reading)
+        VEC_ADD_NODE(s->readOps, n);
+    else
+    {
+        WrittenOperator *w = NEW(WrittenOperator);
+        w->op = n;
+        w->id = s->numOps++;
+        HASH_ADD_PTR(s->written, op, w);
+    }
+
+    BIN_NODE_FIELD(schema);
+    BIN_NODE_FIELD(provAttrs);
+    BIN_NODE_FIELD(properties);
+
+    binUInt(s, &numInputs);
+
+    if (s->reading)
+    {
+        n->parents = NIL;
+        for(unsigned long i = 0; i < numInputs; i++)
+        {
+            QueryOperator *child;
+
+            binNode(s, (void **) &child);
+            if (child == NULL || !IS_OP(child))
+                FATAL_LOG("binary serialized node has an input that is not an operator at byte %zu", s->pos);
+            n->inputs = appendToTailOfList(n->inputs, child);
+            child->parents = appendToTailOfList(child->parents, n);
+        }
+    }
+    else
+    {
+        FOREACH_LC(lc, n->inputs)
+            binNode(s, &(LC_P_VAL(lc)));
+    }
+}
+
+static void
+binParameterizedQuery(ParameterizedQuery *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(q);
+    BIN_NODE_FIELD(parameters);
+    BIN_NODE_FIELD(sqlTemplate);
+}
+
+static void
+binTableAccessOperator(TableAccessOperator *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_STRING_FIELD(tableName);
+    BIN_NODE_FIELD(asOf);
+}
+
+static void
+binSampleClauseOperator(SampleClauseOperator *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_NODE_FIELD(sampPerc);
+}
+
+static void
+binJsonTableOperator(JsonTableOperator *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_NODE_FIELD(columns);
+    BIN_STRING_FIELD(documentcontext);
+    BIN_NODE_FIELD(jsonColumn);
+    BIN_STRING_FIELD(jsonTableIdentifier);
+    BIN_STRING_FIELD(forOrdinality);
+}
+
+static void
+binJsonPath(JsonPath *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(path);
+}
+
+static void
+binSelectionOperator(SelectionOperator *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_NODE_FIELD(cond);
+}
+
+static void
+binProjectionOperator(ProjectionOperator *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_NODE_FIELD(projExprs);
+}
+
+static void
+binJoinOperator(JoinOperator *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_SCALAR_FIELD(joinType);
+    BIN_NODE_FIELD(cond);
+}
+
+static void
+binAggregationOperator(AggregationOperator *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_NODE_FIELD(aggrs);
+    BIN_NODE_FIELD(groupBy);
+}
+
+static void
+binSetOperator(SetOperator *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_SCALAR_FIELD(setOpType);
+}
+
+static void
+binDuplicateRemoval(DuplicateRemoval *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_NODE_FIELD(attrs);
+}
+
+static void
+binProvenanceComputation(ProvenanceComputation *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_SCALAR_FIELD(provType);
+    BIN_SCALAR_FIELD(inputType);
+    BIN_NODE_FIELD(transactionInfo);
+    BIN_NODE_FIELD(asOf);
+}
+
+static void
+binConstRelOperator(ConstRelOperator *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_NODE_FIELD(values);
+}
+
+static void
+binNestingOperator(NestingOperator *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_SCALAR_FIELD(nestingType);
+    BIN_NODE_FIELD(cond);
+}
+
+static void
+binWindowOperator(WindowOperator *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_NODE_FIELD(partitionBy);
+    BIN_NODE_FIELD(orderBy);
+    BIN_NODE_FIELD(frameDef);
+    BIN_STRING_FIELD(attrName);
+    BIN_NODE_FIELD(f);
+}
+
+static void
+binOrderOperator(OrderOperator *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_NODE_FIELD(orderExprs);
+}
+
+static void
+binLimitOperator(LimitOperator *n, BinaryState *s)
+{
+    BIN_OPERATOR();
+    BIN_NODE_FIELD(limitExpr);
+    BIN_NODE_FIELD(offsetExpr);
+}
+
+static void
+binJsonColInfoItem(JsonColInfoItem *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(attrName);
+    BIN_STRING_FIELD(path);
+    BIN_STRING_FIELD(attrType);
+    BIN_STRING_FIELD(format);
+    BIN_STRING_FIELD(wrapper);
+    BIN_NODE_FIELD(nested);
+    BIN_STRING_FIELD(forOrdinality);
+}
+
+static void
+binExecPreparedOperator(ExecPreparedOperator *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(name);
+    BIN_NODE_FIELD(params);
+}
+
+/* query blocks */
+static void
+binSetQuery(SetQuery *n, BinaryState *s)
+{
+    BIN_SCALAR_FIELD(setOp);
+    BIN_SCALAR_FIELD(all);
+    BIN_STRING_LIST_FIELD(selectClause);
+    BIN_NODE_FIELD(lChild);
+    BIN_NODE_FIELD(rChild);
+}
+
+static void
+binQueryBlock(QueryBlock *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(selectClause);
+    BIN_NODE_FIELD(distinct);
+    BIN_NODE_FIELD(fromClause);
+    BIN_NODE_FIELD(whereClause);
+    BIN_NODE_FIELD(groupByClause);
+    BIN_NODE_FIELD(havingClause);
+    BIN_NODE_FIELD(orderByClause);
+    BIN_NODE_FIELD(limitClause);
+    BIN_NODE_FIELD(offsetClause);
+}
+
+static void
+binNestedSubquery(NestedSubquery *n, BinaryState *s)
+{
+    BIN_SCALAR_FIELD(nestingType);
+    BIN_NODE_FIELD(expr);
+    BIN_STRING_FIELD(comparisonOp);
+    BIN_NODE_FIELD(query);
+}
+
+static void
+binProvenanceStmt(ProvenanceStmt *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(query);
+    BIN_STRING_LIST_FIELD(selectClause);
+    BIN_NODE_FIELD(dts);
+    BIN_SCALAR_FIELD(provType);
+    BIN_SCALAR_FIELD(inputType);
+    BIN_NODE_FIELD(transInfo);
+    BIN_NODE_FIELD(asOf);
+    BIN_NODE_FIELD(options);
+    BIN_NODE_FIELD(sumOpts);
+}
+
+static void
+binProvenanceTransactionInfo(ProvenanceTransactionInfo *n, BinaryState *s)
+{
+    BIN_SCALAR_FIELD(transIsolation);
+    BIN_STRING_LIST_FIELD(updateTableNames);
+    BIN_NODE_FIELD(originalUpdates);
+    BIN_NODE_FIELD(scns);
+    BIN_NODE_FIELD(commitSCN);
+}
+
+static void
+binSelectItem(SelectItem *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(alias);
+    BIN_NODE_FIELD(expr);
+}
+
+static void
+binFromItem(FromItem *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(name);
+    BIN_STRING_LIST_FIELD(attrNames);
+    BIN_NODE_FIELD(provInfo);
+    BIN_NODE_FIELD(dataTypes);
+}
+
+static void
+binFromTableRef(FromTableRef *n, BinaryState *s)
+{
+    BIN_FROM();
+    BIN_STRING_FIELD(tableId);
+    BIN_SCALAR_FIELD(backendified);
+}
+
+static void
+binFromJsonTable(FromJsonTable *n, BinaryState *s)
+{
+    BIN_FROM();
+    BIN_NODE_FIELD(columns);
+    BIN_STRING_FIELD(documentcontext);
+    BIN_NODE_FIELD(jsonColumn);
+    BIN_STRING_FIELD(jsonTableIdentifier);
+}
+
+static void
+binFromSubquery(FromSubquery *n, BinaryState *s)
+{
+    BIN_FROM();
+    BIN_NODE_FIELD(subquery);
+}
+
+static void
+binFromLateralSubquery(FromLateralSubquery *n, BinaryState *s)
+{
+    BIN_FROM();
+    BIN_NODE_FIELD(subquery);
+}
+
+static void
+binFromJoinExpr(FromJoinExpr *n, BinaryState *s)
+{
+    BIN_FROM();
+    BIN_NODE_FIELD(left);
+    BIN_NODE_FIELD(right);
+    BIN_SCALAR_FIELD(joinType);
+    BIN_SCALAR_FIELD(joinCond);
+    if (n->joinCond == JOIN_COND_USING)
+        BIN_STRING_LIST_FIELD(cond);
+    else
+        BIN_NODE_FIELD(cond);
+}
+
+static void
+binFromProvInfo(FromProvInfo *n, BinaryState *s)
+{
+    BIN_SCALAR_FIELD(baserel);
+    BIN_SCALAR_FIELD(intermediateProv);
+    BIN_STRING_LIST_FIELD(userProvAttrs);
+    BIN_NODE_FIELD(provProperties);
+}
+
+static void
+binDistinctClause(DistinctClause *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(distinctExprs);
+}
+
+static void
+binInsert(Insert *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(schema);
+    BIN_STRING_FIELD(insertTableName);
+    BIN_STRING_LIST_FIELD(attrList);
+    BIN_NODE_FIELD(query);
+}
+
+static void
+binDelete(Delete *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(schema);
+    BIN_STRING_FIELD(deleteTableName);
+    BIN_NODE_FIELD(cond);
+}
+
+static void
+binUpdate(Update *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(schema);
+    BIN_STRING_FIELD(updateTableName);
+    BIN_NODE_FIELD(selectClause);
+    BIN_NODE_FIELD(cond);
+}
+
+static void
+binTransactionStmt(TransactionStmt *n, BinaryState *s)
+{
+    BIN_SCALAR_FIELD(stmtType);
+}
+
+static void
+binWithStmt(WithStmt *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(withViews);
+    BIN_NODE_FIELD(query);
+}
+
+static void
+binCreateTable(CreateTable *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(tableName);
+    BIN_NODE_FIELD(tableElems);
+    BIN_NODE_FIELD(constraints);
+    BIN_NODE_FIELD(query);
+}
+
+static void
+binAlterTable(AlterTable *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(tableName);
+    BIN_SCALAR_FIELD(cmdType);
+    BIN_STRING_FIELD(columnName);
+    BIN_SCALAR_FIELD(newColDT);
+    BIN_NODE_FIELD(schema);
+    BIN_NODE_FIELD(beforeSchema);
+}
+
+static void
+binPreparedQuery(PreparedQuery *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(name);
+    BIN_NODE_FIELD(q);
+    BIN_STRING_FIELD(sqlText);
+    BIN_NODE_FIELD(dts);
+}
+
+static void
+binExecQuery(ExecQuery *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(name);
+    BIN_NODE_FIELD(params);
+}
+
+/* datalog model */
+static void
+binDLAtom(DLAtom *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(rel);
+    BIN_NODE_FIELD(args);
+    BIN_SCALAR_FIELD(negated);
+    BIN_NODE_FIELD(n.properties);
+}
+
+static void
+binDLVar(DLVar *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(name);
+    BIN_SCALAR_FIELD(dt);
+    BIN_NODE_FIELD(n.properties);
+}
+
+static void
+binDLComparison(DLComparison *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(opExpr);
+    BIN_NODE_FIELD(n.properties);
+}
+
+static void
+binDLDomain(DLDomain *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(rel);
+    BIN_STRING_FIELD(attr);
+    BIN_STRING_FIELD(name);
+    BIN_NODE_FIELD(n.properties);
+}
+
+static void
+binDLRule(DLRule *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(head);
+    BIN_NODE_FIELD(body);
+    BIN_NODE_FIELD(n.properties);
+}
+
+static void
+binDLProgram(DLProgram *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(rules);
+    BIN_NODE_FIELD(facts);
+    BIN_STRING_FIELD(ans);
+    BIN_NODE_FIELD(doms);
+    BIN_NODE_FIELD(n.properties);
+    BIN_NODE_FIELD(comp);
+    BIN_NODE_FIELD(func);
+    BIN_NODE_FIELD(sumOpts);
+}
+
+/* regex */
+static void
+binRegex(Regex *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(children);
+    BIN_SCALAR_FIELD(opType);
+    BIN_STRING_FIELD(label);
+}
+
+static void
+binRPQQuery(RPQQuery *n, BinaryState *s)
+{
+    BIN_NODE_FIELD(q);
+    BIN_SCALAR_FIELD(t);
+    BIN_STRING_FIELD(edgeRel);
+    BIN_STRING_FIELD(resultRel);
+}
+
+/* provenance sketches */
+static void
+binPSInfo(psInfo *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(psType);
+    BIN_NODE_FIELD(tablePSAttrInfos);
+}
+
+static void
+binPSAttrInfo(psAttrInfo *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(attrName);
+    BIN_NODE_FIELD(rangeList);
+    BIN_NODE_FIELD(BitVector);
+    BIN_NODE_FIELD(psIndexList);
+}
+
+static void
+binPSInfoCell(psInfoCell *n, BinaryState *s)
+{
+    BIN_STRING_FIELD(tableName);
+    BIN_STRING_FIELD(attrName);
+    BIN_STRING_FIELD(provTableAttr);
+    BIN_SCALAR_FIELD(numRanges);
+    BIN_SCALAR_FIELD(psSize);
+    BIN_NODE_FIELD(ps);
+}
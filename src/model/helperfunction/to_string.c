@@ -1029,6 +1029,7 @@ outParameterizedQuery (StringInfo str, ParameterizedQuery *node)
 {
 	WRITE_NODE_FIELD(q);
 	WRITE_NODE_FIELD(parameters);
+	WRITE_NODE_FIELD(sqlTemplate);
 }
 
 static void
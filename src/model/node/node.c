@@ -111,6 +111,19 @@ appendStringInfoChar(StringInfo str, const char c)
     str->data[str->len] = '\0';
 }
 
+/*
+ * Append datalen bytes of data which may contain '\0' characters.
+ */
+void
+appendBinaryStringInfo(StringInfo str, const char *data, int datalen)
+{
+    makeStringInfoSpace(str, datalen);
+
+    memcpy(str->data + str->len, data, datalen);
+    str->len += datalen;
+    str->data[str->len] = '\0';
+}
+
 /*------------------------------------------------------------------
 *appendStringInfoString
 *The function is append a string to str.
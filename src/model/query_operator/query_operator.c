@@ -85,7 +85,7 @@ isNestingAttribute(char *attr)
 Schema *
 createSchema(char *name, List *attrDefs)
 {
-    Schema *s = NEW(Schema);
+    Schema *s = makeNode(Schema);
     s->name = name;
     s->attrDefs = attrDefs;
     return s;
@@ -1003,6 +1003,8 @@ getStringProperty (QueryOperator *op, char *key)
 void
 removeStringProperty (QueryOperator *op, char *key)
 {
+    if (op->properties == NULL)
+        return;
     removeMapStringElem((HashMap *) op->properties, key);
 }
 
@@ -0,0 +1,380 @@
+/*-----------------------------------------------------------------------------
+ *
+ * relation.c
+ *		- Query results in row format or dictionary encoded
+ *
+ *		A dictionary encoded relation stores each distinct value of a column
+ *		once. Values are copied into large arena blocks instead of being
+ *		allocated one at a time and tuples only store the position of their
+ *		value in the dictionary of each column. This keeps results with many
+ *		repeated values (e.g., node identifiers and labels of provenance
+ *		graphs) small.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "common.h"
+#include "configuration/option.h"
+#include "log/logger.h"
+#include "mem_manager/mem_mgr.h"
+#include "model/node/nodetype.h"
+#include "model/list/list.h"
+#include "model/set/vector.h"
+#include "model/relation/relation.h"
+
+#define NULL_STRING "NULL"
+#define INITIAL_TUPLE_CAPACITY 64
+#define INITIAL_DICT_CAPACITY 16
+// arena blocks grow from the initial to the maximal size
+#define INITIAL_ARENA_BLOCK_SIZE 1024
+#define MAX_ARENA_BLOCK_SIZE (64 * 1024)
+// values larger than this are not stored in the arena
+#define MAX_ARENA_VALUE_SIZE (MAX_ARENA_BLOCK_SIZE / 8)
+
+#define WORD_BITS (sizeof(unsigned long) * 8)
+#define NUM_WORDS(bits) (((bits) + WORD_BITS - 1) / WORD_BITS)
+#define IS_NULL(c,row) (((c)->nulls[(row) / WORD_BITS] >> ((row) % WORD_BITS)) & 1UL)
+#define SET_NULL(c,row) ((c)->nulls[(row) / WORD_BITS] |= (1UL << ((row) % WORD_BITS)))
+
+static void growTuples (RelationData *d);
+static int encodeValue (RelationData *d, RelationColumn *c, char *value);
+static void growDict (RelationColumn *c);
+static char *arenaStrdup (RelationData *d, char *value);
+static unsigned hashDictValue (char *value);
+
+Relation *
+makeRelation (List *schema)
+{
+    Relation *r = makeNode(Relation);
+
+    r->schema = schema;
+    r->tuples = makeVector(VECTOR_NODE, T_Vector);
+    r->data = NULL;
+
+    return r;
+}
+
+Relation *
+makeEncodedRelation (List *schema)
+{
+    Relation *r = makeNode(Relation);
+    RelationData *d = NEW(RelationData);
+
+    d->numColumns = LIST_LENGTH(schema);
+    d->numTuples = 0;
+    d->capacity = 0;
+    d->columns = CNEW(RelationColumn, MAX(d->numColumns, 1));
+    d->arena = NULL;
+    d->arenaFree = 0;
+    d->arenaBlockSize = INITIAL_ARENA_BLOCK_SIZE;
+
+    for(int i = 0; i < d->numColumns; i++)
+    {
+        RelationColumn *c = d->columns + i;
+
+        c->dictCapacity = INITIAL_DICT_CAPACITY;
+        c->dict = CNEW(char *, c->dictCapacity);
+        c->dictLength = 0;
+        c->numSlots = 2 * INITIAL_DICT_CAPACITY;
+        c->slots = MALLOC(sizeof(int) * c->numSlots);
+        memset(c->slots, -1, sizeof(int) * c->numSlots);
+    }
+
+    r->schema = schema;
+    r->tuples = NULL;
+    r->data = d;
+
+    return r;
+}
+
+/*
+ * Create a relation for storing a query result. The format is determined by
+ * option OPTION_DICT_ENCODE_RESULTS.
+ */
+Relation *
+makeResultRelation (List *schema)
+{
+    if (getBoolOption(OPTION_DICT_ENCODE_RESULTS))
+        return makeEncodedRelation(schema);
+    return makeRelation(schema);
+}
+
+/*
+ * Return a dictionary encoded version of relation r (r itself if it is
+ * encoded already).
+ */
+Relation *
+encodeRelation (Relation *r)
+{
+    Relation *result;
+    int numCols = getRelationNumColumns(r);
+    char **values;
+
+    if (r->data != NULL)
+        return r;
+
+    result = makeEncodedRelation(deepCopyStringList(r->schema));
+    values = CNEW(char *, MAX(numCols, 1));
+
+    FOREACH_REL_TUPLE(it,r)
+    {
+        for(int j = 0; j < numCols; j++)
+            values[j] = REL_ITER_VALUE(it,j);
+        addRelationTuple(result, values);
+    }
+
+    FREE(values);
+    return result;
+}
+
+/*
+ * Append a tuple to relation r. The values are copied, NULL values are
+ * represented as NULL pointers.
+ */
+void
+addRelationTuple (Relation *r, char **values)
+{
+    RelationData *d = r->data;
+    int row;
+
+    // row format
+    if (d == NULL)
+    {
+        int numCols = LIST_LENGTH(r->schema);
+        Vector *tuple = makeVectorOfSize(VECTOR_STRING, -1, numCols);
+
+        for(int j = 0; j < numCols; j++)
+            vecAppendString(tuple, strdup(values[j] != NULL ? values[j] : NULL_STRING));
+        VEC_ADD_NODE(r->tuples, tuple);
+        return;
+    }
+
+    // dictionary encoded
+    if (d->numTuples == d->capacity)
+        growTuples(d);
+    row = d->numTuples++;
+
+    for(int j = 0; j < d->numColumns; j++)
+    {
+        RelationColumn *c = d->columns + j;
+
+        if (values[j] == NULL)
+        {
+            SET_NULL(c,row);
+            c->codes[row] = 0;
+        }
+        else
+            c->codes[row] = encodeValue(d, c, values[j]);
+    }
+}
+
+int
+getRelationNumTuples (Relation *r)
+{
+    if (r->data != NULL)
+        return r->data->numTuples;
+    return VEC_LENGTH(r->tuples);
+}
+
+int
+getRelationNumColumns (Relation *r)
+{
+    return LIST_LENGTH(r->schema);
+}
+
+/*
+ * Return the value of column col of tuple row or NULL if the value is NULL.
+ * For relations in row format the string "NULL" is treated as a NULL value.
+ * The string belongs to the relation and must not be modified.
+ */
+char *
+getRelationValue (Relation *r, int row, int col)
+{
+    RelationData *d = r->data;
+    RelationColumn *c;
+    char *v;
+
+    ASSERT(row >= 0 && row < getRelationNumTuples(r));
+    ASSERT(col >= 0 && col < getRelationNumColumns(r));
+
+    if (d == NULL)
+    {
+        v = getVecString((Vector *) getVecNode(r->tuples, row), col);
+        return streq(v, NULL_STRING) ? NULL : v;
+    }
+
+    c = d->columns + col;
+    if (IS_NULL(c,row))
+        return NULL;
+    return c->dict[c->codes[row]];
+}
+
+/*
+ * Return tuple row as a vector of strings with NULL values represented as
+ * "NULL". For dictionary encoded relations the vector is created on demand,
+ * its strings are shared with the relation.
+ */
+Vector *
+getRelationTuple (Relation *r, int row)
+{
+    int numCols = getRelationNumColumns(r);
+    Vector *tuple;
+
+    if (r->data == NULL)
+        return (Vector *) getVecNode(r->tuples, row);
+
+    tuple = makeVectorOfSize(VECTOR_STRING, -1, numCols);
+    for(int j = 0; j < numCols; j++)
+    {
+        char *v = getRelationValue(r, row, j);
+
+        vecAppendString(tuple, v != NULL ? v : NULL_STRING);
+    }
+
+    return tuple;
+}
+
+/*
+ * Total size of all (non-NULL) values of the relation.
+ */
+unsigned long
+getRelationBytes (Relation *r)
+{
+    unsigned long bytes = 0;
+    int numCols = getRelationNumColumns(r);
+
+    FOREACH_REL_TUPLE(it,r)
+    {
+        for(int j = 0; j < numCols; j++)
+        {
+            char *v = REL_ITER_VALUE(it,j);
+
+            bytes += (v != NULL) ? strlen(v) : 0;
+        }
+    }
+
+    return bytes;
+}
+
+static void
+growTuples (RelationData *d)
+{
+    int newCap = (d->capacity == 0) ? INITIAL_TUPLE_CAPACITY : d->capacity * 2;
+
+    for(int j = 0; j < d->numColumns; j++)
+    {
+        RelationColumn *c = d->columns + j;
+        int *codes = MALLOC(sizeof(int) * newCap);
+        unsigned long *nulls = CNEW(unsigned long, NUM_WORDS(newCap));
+
+        if (d->capacity > 0)
+        {
+            memcpy(codes, c->codes, sizeof(int) * d->numTuples);
+            memcpy(nulls, c->nulls, sizeof(unsigned long) * NUM_WORDS(d->capacity));
+            FREE(c->codes);
+            FREE(c->nulls);
+        }
+        c->codes = codes;
+        c->nulls = nulls;
+    }
+
+    d->capacity = newCap;
+}
+
+/*
+ * Return the position of value in the dictionary of column c adding it to
+ * the dictionary if necessary. The hash table is kept at most half full.
+ */
+static int
+encodeValue (RelationData *d, RelationColumn *c, char *value)
+{
+    unsigned mask = c->numSlots - 1;
+    unsigned pos = hashDictValue(value) & mask;
+    int code;
+
+    while(c->slots[pos] != -1)
+    {
+        if (streq(c->dict[c->slots[pos]], value))
+            return c->slots[pos];
+        pos = (pos + 1) & mask;
+    }
+
+    if (c->dictLength == c->dictCapacity)
+        growDict(c);
+    code = c->dictLength++;
+    c->dict[code] = arenaStrdup(d, value);
+    c->slots[pos] = code;
+
+    // rehash all values into a hash table twice the size
+    if (c->dictLength * 2 > c->numSlots)
+    {
+        FREE(c->slots);
+        c->numSlots *= 2;
+        mask = c->numSlots - 1;
+        c->slots = MALLOC(sizeof(int) * c->numSlots);
+        memset(c->slots, -1, sizeof(int) * c->numSlots);
+
+        for(int i = 0; i < c->dictLength; i++)
+        {
+            pos = hashDictValue(c->dict[i]) & mask;
+            while(c->slots[pos] != -1)
+                pos = (pos + 1) & mask;
+            c->slots[pos] = i;
+        }
+    }
+
+    return code;
+}
+
+static void
+growDict (RelationColumn *c)
+{
+    char **dict = CNEW(char *, c->dictCapacity * 2);
+
+    memcpy(dict, c->dict, sizeof(char *) * c->dictLength);
+    FREE(c->dict);
+    c->dict = dict;
+    c->dictCapacity *= 2;
+}
+
+static char *
+arenaStrdup (RelationData *d, char *value)
+{
+    size_t len = strlen(value) + 1;
+    char *result;
+
+    if (len > MAX_ARENA_VALUE_SIZE)
+        result = MALLOC(len);
+    else
+    {
+        if (len > d->arenaFree)
+        {
+            while(d->arenaBlockSize < len)
+                d->arenaBlockSize *= 2;
+            d->arena = MALLOC(d->arenaBlockSize);
+            d->arenaFree = d->arenaBlockSize;
+            d->arenaBlockSize = MIN(d->arenaBlockSize * 2, MAX_ARENA_BLOCK_SIZE);
+        }
+        result = d->arena;
+        d->arena += len;
+        d->arenaFree -= len;
+    }
+    memcpy(result, value, len);
+
+    return result;
+}
+
+/* FNV-1a */
+static unsigned
+hashDictValue (char *value)
+{
+    unsigned h = 2166136261u;
+
+    for(unsigned char *p = (unsigned char *) value; *p != '\0'; p++)
+    {
+        h ^= *p;
+        h *= 16777619u;
+    }
+
+    return h;
+}
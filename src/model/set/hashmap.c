@@ -27,8 +27,19 @@
 static MemContext *hashContext = NULL;
 // static variables to speed up lookup for string and int keys and avoid the memory consumption of creating a new Constant node for each lookup
 // without having to implement a different backend hashmap
+// these variables are thread local, so only creating them in the shared context has to be synchronized
+#if defined(HAVE_LIBPTHREAD) && ! defined(OS_WINDOWS)
+static pthread_mutex_t hashContextLock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK_HASH_CONTEXT() pthread_mutex_lock(&hashContextLock)
+#define UNLOCK_HASH_CONTEXT() pthread_mutex_unlock(&hashContextLock)
+#else
+#define LOCK_HASH_CONTEXT()
+#define UNLOCK_HASH_CONTEXT()
+#endif
 
 static inline HashElem *getHashElem(HashMap *map, Node *key);
+static inline HashElem *getHashElemByHashValue(HashMap *map, Node *key, unsigned hashv);
+static Constant *createLookupDummy (DataType dt);
 
 
 HashMap *
@@ -55,6 +66,48 @@ getHashElem(HashMap *map, Node *key)
     return result;
 }
 
+static inline HashElem *
+getHashElemByHashValue(HashMap *map, Node *key, unsigned hashv)
+{
+    HashElem *result = NULL;
+    HASH_FIND_NODE_BYHASHVALUE(hh,map->elem, key, hashv, result);
+
+    return result;
+}
+
+/*
+ * Check for a key whose hash value is already known, e.g., because it is a
+ * key of another map.
+ */
+boolean
+hasMapKeyByHashValue (HashMap *map, Node *key, unsigned hashv)
+{
+    return getHashElemByHashValue(map, key, hashv) != NULL;
+}
+
+KeyValue *
+getMapEntryByHashValue (HashMap *map, Node *key, unsigned hashv)
+{
+    HashElem *e = getHashElemByHashValue(map, key, hashv);
+
+    return (e == NULL) ? NULL : (KeyValue *) e->data;
+}
+
+/*
+ * Combine the hash values stored for the keys of a map. The result does not
+ * depend on the order of entries and does not hash any keys again.
+ */
+unsigned
+mapKeysHashValue (HashMap *map)
+{
+    unsigned result = 0;
+
+    for(HashElem *e = map->elem; e != NULL; e = e->hh.next)
+        result += e->hh.hashv;
+
+    return result;
+}
+
 boolean
 hasMapKey (HashMap *map, Node *key)
 {
@@ -94,17 +147,11 @@ getMap (HashMap *map, Node *key)
 Node *
 getMapString (HashMap *map, char *key)
 {
-    static Constant *stringDummy = NULL;
+    static THREAD_LOCAL Constant *stringDummy = NULL;
     if (key == NULL)
         return NULL;
     if (stringDummy == NULL)
-    {
-        if (hashContext == NULL)
-            hashContext = NEW_MEM_CONTEXT(HASHMAP_MEM_CONTEXT_NAME);
-        ACQUIRE_MEM_CONTEXT(hashContext);
-        stringDummy = createConstString("");
-        RELEASE_MEM_CONTEXT();
-    }
+        stringDummy = createLookupDummy(DT_STRING);
     stringDummy->value = key;
     return getMap(map, (Node *) stringDummy);
 }
@@ -113,15 +160,9 @@ Node *
 getMapInt (HashMap *map, int key)
 {
     int *v;
-    static Constant *intDummy = NULL;
+    static THREAD_LOCAL Constant *intDummy = NULL;
     if (intDummy == NULL)
-    {
-        if (hashContext == NULL)
-            hashContext = NEW_MEM_CONTEXT(HASHMAP_MEM_CONTEXT_NAME);
-        ACQUIRE_MEM_CONTEXT(hashContext);
-        intDummy = createConstInt(0);
-        RELEASE_MEM_CONTEXT();
-    }
+        intDummy = createLookupDummy(DT_INT);
 
     v = (int *) intDummy->value;
     *v = key;
@@ -131,16 +172,10 @@ getMapInt (HashMap *map, int key)
 Node *
 getMapLong (HashMap *map, gprom_long_t key)
 {
-    static Constant *longDummy = NULL;
+    static THREAD_LOCAL Constant *longDummy = NULL;
     gprom_long_t *v;
     if (longDummy == NULL)
-    {
-        if (hashContext == NULL)
-            hashContext = NEW_MEM_CONTEXT(HASHMAP_MEM_CONTEXT_NAME);
-        ACQUIRE_MEM_CONTEXT(hashContext);
-        longDummy = createConstLong(0);
-        RELEASE_MEM_CONTEXT();
-    }
+        longDummy = createLookupDummy(DT_LONG);
 
     v = (gprom_long_t *) longDummy->value;
     *v = key;
@@ -180,7 +215,12 @@ getEntries(HashMap *map)
 boolean
 addToMap(HashMap *map, Node *key, Node *value)
 {
-    HashElem *entry = getHashElem(map, key);
+    unsigned hashv;
+    HashElem *entry;
+
+    // only hash the key once for the lookup and for adding it
+    HASH_VALUE_NODE(key, hashv);
+    entry = getHashElemByHashValue(map, key, hashv);
 
     // entry does not exist, add it
     if (entry == NULL)
@@ -190,7 +230,7 @@ addToMap(HashMap *map, Node *key, Node *value)
         entry->data = kv;
         entry->key = key;
 
-        HASH_ADD_NODE(hh, map->elem, entry->key, entry);
+        HASH_ADD_NODE_BYHASHVALUE(hh, map->elem, entry->key, hashv, entry);
         return TRUE;
     }
     // overwrite value of existing entry with same key
@@ -245,15 +285,9 @@ mapIncr(HashMap *map, Node *key)
 int
 mapIncrString(HashMap *map, char *key)
 {
-    static Constant *stringDummy = NULL;
+    static THREAD_LOCAL Constant *stringDummy = NULL;
     if (stringDummy == NULL)
-    {
-        if (hashContext == NULL)
-            hashContext = NEW_MEM_CONTEXT(HASHMAP_MEM_CONTEXT_NAME);
-        ACQUIRE_MEM_CONTEXT(hashContext);
-        stringDummy = createConstString("");
-        RELEASE_MEM_CONTEXT();
-    }
+        stringDummy = createLookupDummy(DT_STRING);
     stringDummy->value = key;
     return mapIncr(map, (Node *) stringDummy);
 }
@@ -261,17 +295,11 @@ mapIncrString(HashMap *map, char *key)
 int
 mapIncrPointer(HashMap *map, void *key)
 {
-    static Constant *longDummy = NULL;
+    static THREAD_LOCAL Constant *longDummy = NULL;
     if (longDummy == NULL)
-    {
-        if (hashContext == NULL)
-            hashContext = NEW_MEM_CONTEXT(HASHMAP_MEM_CONTEXT_NAME);
-        ACQUIRE_MEM_CONTEXT(hashContext);
-        longDummy = createConstLong(0L);
-        RELEASE_MEM_CONTEXT();
-    }
-	LONG_VALUE(longDummy) = (gprom_long_t) key;
-	return mapIncr(map, (Node *) longDummy);
+        longDummy = createLookupDummy(DT_LONG);
+    LONG_VALUE(longDummy) = (gprom_long_t) key;
+    return mapIncr(map, (Node *) longDummy);
 }
 
 void
@@ -303,17 +331,11 @@ removeMapElem (HashMap *map, Node *key)
 void
 removeMapStringElem (HashMap *map, char *key)
 {
-    static Constant *stringDummy = NULL;
+    static THREAD_LOCAL Constant *stringDummy = NULL;
     if (key == NULL)
         return;
     if (stringDummy == NULL)
-    {
-        if (hashContext == NULL)
-            hashContext = NEW_MEM_CONTEXT(HASHMAP_MEM_CONTEXT_NAME);
-        ACQUIRE_MEM_CONTEXT(hashContext);
-        stringDummy = createConstString("");
-        RELEASE_MEM_CONTEXT();
-    }
+        stringDummy = createLookupDummy(DT_STRING);
     stringDummy->value = key;
     return removeMapElem(map, (Node *) stringDummy);
 }
@@ -329,9 +351,11 @@ mapSize (HashMap *map)
 void
 unionMap(HashMap *res, HashMap *new)
 {
-	FOREACH_HASH_ENTRY(kv,new)
+	for(HashElem *e = new->elem; e != NULL; e = e->hh.next)
 	{
-		if(!hasMapKey(res, kv->key))
+		KeyValue *kv = (KeyValue *) e->data;
+
+		if(!hasMapKeyByHashValue(res, kv->key, e->hh.hashv))
 		{
 			addToMap(res, copyObject(kv->key), copyObject(kv->value));
 		}
@@ -341,11 +365,43 @@ unionMap(HashMap *res, HashMap *new)
 void
 diffMap(HashMap *res, HashMap *new)
 {
-	FOREACH_HASH_ENTRY(kv,new)
+	for(HashElem *e = new->elem; e != NULL; e = e->hh.next)
 	{
-		if(hasMapKey(res, kv->key))
+		KeyValue *kv = (KeyValue *) e->data;
+		HashElem *r = getHashElemByHashValue(res, kv->key, e->hh.hashv);
+
+		if(r != NULL)
 		{
-			removeMapElem(res, kv->key);
+			HASH_DEL(res->elem, r);
+			FREE(r->data);
+			FREE(r);
 		}
 	}
 }
+
+static Constant *
+createLookupDummy (DataType dt)
+{
+    Constant *result;
+
+    LOCK_HASH_CONTEXT();
+    if (hashContext == NULL)
+        hashContext = NEW_MEM_CONTEXT(HASHMAP_MEM_CONTEXT_NAME);
+    ACQUIRE_MEM_CONTEXT(hashContext);
+    switch(dt)
+    {
+        case DT_INT:
+            result = createConstInt(0);
+            break;
+        case DT_LONG:
+            result = createConstLong(0L);
+            break;
+        default:
+            result = createConstString("");
+            break;
+    }
+    RELEASE_MEM_CONTEXT();
+    UNLOCK_HASH_CONTEXT();
+
+    return result;
+}
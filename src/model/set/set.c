@@ -22,6 +22,7 @@
 
 
 static SetElem *getSetElem(Set *set, void *key);
+static boolean hasElemOfOtherSet(Set *set, SetElem *e);
 
 static boolean intCmp (void *a, void *b);
 static void *intCpy (void *a);
@@ -194,6 +195,45 @@ hasSetElem (Set *set, void *_el)
     return getSetElem(set, _el) != NULL;
 }
 
+/*
+ * Check whether set contains a node for which we already know the hash
+ * value, e.g., because it is stored in another set.
+ */
+boolean
+hasSetElemByHashValue (Set *set, void *_el, unsigned hashv)
+{
+    SetElem *result;
+
+    if (set->setType != SET_TYPE_NODE)
+        return hasSetElem(set, _el);
+
+    HASH_FIND_NODE_BYHASHVALUE(hh, set->elem, _el, hashv, result);
+
+    return result != NULL;
+}
+
+/*
+ * Combine the hash values stored for the elements of a set. The result does
+ * not depend on the order of elements and does not require any elements to
+ * be hashed again.
+ */
+unsigned
+setElemsHashValue (Set *set)
+{
+    unsigned result = 0;
+
+    for(SetElem *s = set->elem; s != NULL; s = s->hh.next)
+        result += s->hh.hashv;
+
+    return result;
+}
+
+static boolean
+hasElemOfOtherSet(Set *set, SetElem *e)
+{
+    return hasSetElemByHashValue(set, e->data, e->hh.hashv);
+}
+
 static SetElem *
 getSetElem(Set *set, void *key)
 {
@@ -265,6 +305,23 @@ addToSet (Set *set, void *elem)
 {
     SetElem *setEl;
 
+    // Node: only hash the new element once for the lookup and for adding it
+    if (set->setType == SET_TYPE_NODE)
+    {
+        unsigned hashv;
+
+        HASH_VALUE_NODE(elem, hashv);
+        HASH_FIND_NODE_BYHASHVALUE(hh, set->elem, elem, hashv, setEl);
+        if (setEl != NULL)
+            return FALSE;
+
+        setEl = NEW(SetElem);
+        setEl->data = elem;
+        HASH_ADD_NODE_BYHASHVALUE(hh, set->elem, setEl->data, hashv, setEl);
+
+        return TRUE;
+    }
+
     if (hasSetElem(set, elem))
         return FALSE;
 
@@ -419,7 +476,7 @@ unionSets (Set *left, Set *right)
         for(s = left->elem; s != NULL; s = s->hh.next)
             addToSet(result, left->cpy(s->data));
         for(s = right->elem; s != NULL; s = s->hh.next)
-            if (!hasSetElem(result, s->data))
+            if (!hasElemOfOtherSet(result, s))
             {
                 addToSet(result, right->cpy(s->data));
             }
@@ -451,7 +508,7 @@ unionIntoSet(Set *left, Set *right)
     else
     {
         for(s = right->elem; s != NULL; s = s->hh.next)
-            if (!hasSetElem(left, s->data))
+            if (!hasElemOfOtherSet(left, s))
             {
                 addToSet(left, right->cpy(s->data));
             }
@@ -478,7 +535,7 @@ intersectSets (Set *left, Set *right)
     else
     {
         for(s = left->elem; s != NULL; s = s->hh.next)
-            if (hasSetElem(right, s->data))
+            if (hasElemOfOtherSet(right, s))
                 addToSet(result, left->cpy(s->data));
     }
 
@@ -507,7 +564,7 @@ setDifference(Set *left, Set *right)
     else
     {
         for(s = left->elem; s != NULL; s = s->hh.next)
-            if (!hasSetElem(right, s->data))
+            if (!hasElemOfOtherSet(right, s))
                 addToSet(result, left->cpy(s->data));
     }
 
@@ -533,7 +590,7 @@ overlapsSet(Set *left, Set *right)
     else
     {
         for(s = left->elem; s != NULL; s = s->hh.next)
-            if (hasSetElem(right, s->data))
+            if (hasElemOfOtherSet(right, s))
                 return TRUE;
     }
 
@@ -545,14 +602,15 @@ containsSet(Set *left, Set *right)
 {
 
     boolean containedElem = FALSE;
+    SetElem *s;
 
     if (left->setType != right->setType)
         return FALSE;
 
-    FOREACH_SET(char, s1, left)
+    for(s = left->elem; s != NULL; s = s->hh.next)
     {
     	containedElem = FALSE;
-    	if (hasSetElem(right, s1))
+    	if (hasElemOfOtherSet(right, s))
     		containedElem = TRUE;
 
     	if (!containedElem)
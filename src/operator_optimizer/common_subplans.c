@@ -0,0 +1,275 @@
+/*-----------------------------------------------------------------------------
+ *
+ * common_subplans.c
+ *		Detect structurally equal subplans and share them.
+ *
+ *		Operators are visited bottom-up. Each operator is assigned a canonical
+ *		representative: the first operator seen that has the same type and
+ *		parameters (ignoring inputs) and whose inputs have the same canonical
+ *		representatives. Operators are found through a hash over their
+ *		parameters and the canonical inputs. Afterwards operators that are not
+ *		their own representative are replaced by the representative in their
+ *		parents (top-down, so only the topmost copy of a subplan is replaced).
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "common.h"
+#include "log/logger.h"
+#include "mem_manager/mem_mgr.h"
+#include "model/node/nodetype.h"
+#include "model/list/list.h"
+#include "model/set/set.h"
+#include "model/set/hashmap.h"
+#include "model/query_operator/query_operator.h"
+#include "model/query_operator/operator_property.h"
+#include "operator_optimizer/common_subplans.h"
+
+typedef struct SharingState {
+    HashMap *canonical;     // operator -> canonical representative
+    HashMap *buckets;       // hash -> list of representatives
+    Set *unshareable;       // operators that are never merged
+    List *postOrder;
+} SharingState;
+
+#define GET_CANONICAL(_s,_op) ((QueryOperator *) MAP_GET_POINTER((_s)->canonical, _op))
+
+static void collectPostOrder (QueryOperator *op, Set *visited, List **order);
+static void markUnshareable (QueryOperator *op, Set *unshareable);
+static void determineCanonical (QueryOperator *op, SharingState *state);
+static boolean isShareableType (QueryOperator *op);
+static uint64_t shallowHash (QueryOperator *op);
+static boolean shallowEqual (QueryOperator *a, QueryOperator *b);
+static boolean sameCanonicalInputs (QueryOperator *a, QueryOperator *b, SharingState *state);
+static void replaceWithCanonical (QueryOperator *op, QueryOperator *c);
+static void removeUnreachableParents (QueryOperator *root);
+
+QueryOperator *
+shareCommonSubplans (QueryOperator *root)
+{
+    SharingState *state = NEW(SharingState);
+    List *topDown;
+    int numMerged = 0;
+
+    state->canonical = NEW_MAP(Constant,Node);
+    state->buckets = NEW_MAP(Constant,List);
+    state->unshareable = PSET();
+    state->postOrder = NIL;
+
+    collectPostOrder(root, PSET(), &(state->postOrder));
+
+    // subqueries of nesting operators may be correlated and cannot become WITH views
+    FOREACH(QueryOperator,op,state->postOrder)
+    {
+        if (isA(op, NestingOperator))
+        {
+            addToSet(state->unshareable, op);
+            FOREACH(QueryOperator,c,op->inputs)
+                if (c != OP_LCHILD(op))
+                    markUnshareable(c, state->unshareable);
+        }
+    }
+
+    FOREACH(QueryOperator,op,state->postOrder)
+        determineCanonical(op, state);
+
+    // replace copies top-down (parents are processed before their children)
+    topDown = copyList(state->postOrder);
+    reverseList(topDown);
+    FOREACH(QueryOperator,op,topDown)
+    {
+        QueryOperator *c = GET_CANONICAL(state, op);
+
+        if (c != op && op->parents != NIL && isShareableType(op))
+        {
+            replaceWithCanonical(op, c);
+            numMerged++;
+        }
+    }
+
+    if (numMerged > 0)
+        removeUnreachableParents(root);
+
+    INFO_LOG("shared %d common subplans", numMerged);
+
+    return root;
+}
+
+static void
+collectPostOrder (QueryOperator *op, Set *visited, List **order)
+{
+    if (hasSetElem(visited, op))
+        return;
+    addToSet(visited, op);
+
+    FOREACH(QueryOperator,c,op->inputs)
+        collectPostOrder(c, visited, order);
+
+    *order = appendToTailOfList(*order, op);
+}
+
+static void
+markUnshareable (QueryOperator *op, Set *unshareable)
+{
+    if (hasSetElem(unshareable, op))
+        return;
+    addToSet(unshareable, op);
+
+    FOREACH(QueryOperator,c,op->inputs)
+        markUnshareable(c, unshareable);
+}
+
+static void
+determineCanonical (QueryOperator *op, SharingState *state)
+{
+    uint64_t h;
+    List *bucket;
+
+    if (hasSetElem(state->unshareable, op))
+    {
+        MAP_ADD_POINTER(state->canonical, op, op);
+        return;
+    }
+
+    // combine hash of the operator's parameters with its canonical inputs
+    h = shallowHash(op);
+    FOREACH(QueryOperator,c,op->inputs)
+    {
+        uint64_t cp = (uint64_t) (gprom_long_t) GET_CANONICAL(state, c);
+        h ^= cp + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+
+    bucket = (List *) MAP_GET_LONG(state->buckets, (gprom_long_t) h);
+    FOREACH(QueryOperator,cand,bucket)
+    {
+        if (sameCanonicalInputs(op, cand, state) && shallowEqual(op, cand))
+        {
+            DEBUG_LOG("operator %p is a copy of %p", op, cand);
+            MAP_ADD_POINTER(state->canonical, op, cand);
+            return;
+        }
+    }
+
+    MAP_ADD_POINTER(state->canonical, op, op);
+    MAP_ADD_LONG_KEY(state->buckets, (gprom_long_t) h,
+            appendToTailOfList(bucket, op));
+}
+
+/*
+ * Sharing base tables or constant relations does not save any work and
+ * prepared statement operators are serialized on their own.
+ */
+static boolean
+isShareableType (QueryOperator *op)
+{
+    return !(isA(op, TableAccessOperator)
+            || isA(op, ConstRelOperator)
+            || isA(op, ExecPreparedOperator)
+            || isA(op, NestingOperator));
+}
+
+/*
+ * Hash and compare operators without their inputs and parents.
+ */
+static uint64_t
+shallowHash (QueryOperator *op)
+{
+    List *inputs = op->inputs;
+    List *parents = op->parents;
+    uint64_t h;
+
+    op->inputs = NIL;
+    op->parents = NIL;
+    h = hashValue(op);
+    op->inputs = inputs;
+    op->parents = parents;
+
+    return h;
+}
+
+static boolean
+shallowEqual (QueryOperator *a, QueryOperator *b)
+{
+    List *aInputs = a->inputs;
+    List *aParents = a->parents;
+    List *bInputs = b->inputs;
+    List *bParents = b->parents;
+    boolean result;
+
+    if (a->type != b->type)
+        return FALSE;
+
+    a->inputs = a->parents = b->inputs = b->parents = NIL;
+    result = equal(a,b);
+    a->inputs = aInputs;
+    a->parents = aParents;
+    b->inputs = bInputs;
+    b->parents = bParents;
+
+    return result;
+}
+
+static boolean
+sameCanonicalInputs (QueryOperator *a, QueryOperator *b, SharingState *state)
+{
+    if (LIST_LENGTH(a->inputs) != LIST_LENGTH(b->inputs))
+        return FALSE;
+
+    FORBOTH(QueryOperator,ac,bc,a->inputs,b->inputs)
+    {
+        if (GET_CANONICAL(state, ac) != GET_CANONICAL(state, bc))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+ * Let all parents of op use c instead and detach op from its inputs. If a
+ * parent now uses c more than once (e.g., a union of two copies), then c
+ * has only one parent and we have to request materialization explicitly to
+ * get a WITH view.
+ */
+static void
+replaceWithCanonical (QueryOperator *op, QueryOperator *c)
+{
+    FOREACH(QueryOperator,p,op->parents)
+    {
+        FOREACH_LC(lc,p->inputs)
+        {
+            if (LC_P_VAL(lc) == op)
+                LC_P_VAL(lc) = c;
+        }
+        if (searchList(c->parents, p))
+            SET_BOOL_STRING_PROP(c, PROP_MATERIALIZE);
+        addParent(c, p);
+    }
+    op->parents = NIL;
+
+    FOREACH(QueryOperator,in,op->inputs)
+        removeParent(in, op);
+}
+
+/*
+ * Operators that lost all their parents because their parents were replaced
+ * with a copy may still be listed as parents of their inputs.
+ */
+static void
+removeUnreachableParents (QueryOperator *root)
+{
+    Set *reachable = PSET();
+    List *ops = NIL;
+
+    collectPostOrder(root, reachable, &ops);
+
+    FOREACH(QueryOperator,op,ops)
+    {
+        List *parents = NIL;
+
+        FOREACH(QueryOperator,p,op->parents)
+            if (hasSetElem(reachable, p))
+                parents = appendToTailOfList(parents, p);
+
+        op->parents = parents;
+    }
+}
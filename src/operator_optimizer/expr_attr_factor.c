@@ -17,6 +17,7 @@
 #include "operator_optimizer/expr_attr_factor.h"
 #include "model/expression/expression.h"
 #include "model/query_operator/query_operator.h"
+#include "model/query_operator/operator_property.h"
 
 //static boolean getCaseExprs (Node *node, List **state);
 
@@ -75,6 +76,9 @@ projectionFactorAttrReferences(ProjectionOperator *op)
         p_his_cell->data.ptr_value = factorAttrRefs(p);
     }
 
+    // reference counts cached for checking the safety of merging are outdated
+    removeStringProperty((QueryOperator *) op, PROP_MERGE_ATTR_REF_CNTS);
+
     return (QueryOperator *) op;
 }
 
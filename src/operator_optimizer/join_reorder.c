@@ -0,0 +1,1019 @@
+/*-----------------------------------------------------------------------------
+ *
+ * join_reorder.c
+ *		Reorder trees of inner joins based on estimated intermediate result
+ *		sizes.
+ *
+ *		A join tree is a maximal tree of inner joins and cross products where
+ *		each join except for the root has a single parent. A selection on top
+ *		of the root is part of the tree. The conditions of all operators of
+ *		the tree are split into conjuncts which are placed at the lowest
+ *		possible position in the new join tree. The memo stores for each set
+ *		of inputs the estimated number of rows and the cheapest plan (the
+ *		split into left and right inputs) where the cost of a plan is the sum
+ *		of the sizes of its intermediate results. Splits that would require a
+ *		cross product are only used for sets of inputs that are not connected
+ *		by any join condition. A projection on top of the new join tree
+ *		restores the order of attributes of the original join tree.
+ *
+ *		The number of rows of a table is taken from the catalog, selectivities
+ *		of conditions are estimated based on the number of distinct values of
+ *		attributes (derived from keys and min and max values) and histograms.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "common.h"
+#include "log/logger.h"
+#include "mem_manager/mem_mgr.h"
+#include "configuration/option.h"
+#include "model/node/nodetype.h"
+#include "model/list/list.h"
+#include "model/set/set.h"
+#include "model/set/hashmap.h"
+#include "model/expression/expression.h"
+#include "model/query_operator/query_operator.h"
+#include "model/query_operator/operator_property.h"
+#include "metadata_lookup/metadata_lookup.h"
+#include "operator_optimizer/cost_based_optimizer.h"
+#include "operator_optimizer/optimizer_prop_inference.h"
+#include "operator_optimizer/join_reorder.h"
+#include "provenance_rewriter/prov_utility.h"
+#include "utility/string_utils.h"
+
+// default estimates used if no statistics are available
+#define DEFAULT_ROW_NUM 1000.0
+#define DEFAULT_SELECTIVITY (1.0 / 3.0)
+
+// number of partitions of histograms used to estimate range conditions
+#define HISTOGRAM_PARTITIONS 20
+
+// relative cost improvement required to replace the original join order
+#define MIN_COST_IMPROVEMENT 1e-6
+
+typedef unsigned int InputSet;
+
+#define INPUT_BIT(_i) (((InputSet) 1) << (_i))
+#define IS_SUBSET(_s,_of) (((_s) & ~(_of)) == 0)
+
+typedef struct ReorderState
+{
+    boolean useCatalog;         // are catalog statistics available
+    HashMap *cards;             // operator -> estimated number of rows
+    HashMap *tableStats;        // table#attribute -> estimated number of distinct values
+    Set *visited;
+} ReorderState;
+
+// conjunct of a condition of a join tree
+typedef struct JoinPredicate
+{
+    Node *cond;
+    InputSet inputs;            // inputs referenced by the conjunct
+    double selectivity;
+} JoinPredicate;
+
+typedef struct JoinMemoEntry
+{
+    double card;                // estimated number of rows
+    double cost;                // sum of the sizes of intermediate results
+    InputSet left;              // left inputs of the best plan (0 for single inputs)
+} JoinMemoEntry;
+
+typedef struct JoinTree
+{
+    QueryOperator *root;        // join or selection over join
+    List *ops;                  // operators of the tree
+    List *inputs;               // inputs of the tree from left to right
+    List *preds;                // conjuncts of conditions
+    HashMap *attrToInput;       // attribute name -> position of input
+    JoinMemoEntry *memo;        // entry for each subset of inputs
+} JoinTree;
+
+static QueryOperator *reorderJoinsInternal (QueryOperator *op, ReorderState *state);
+static boolean isInnerJoin (QueryOperator *op);
+static boolean isJoinTreeRoot (QueryOperator *op);
+static JoinTree *collectJoinTree (QueryOperator *root, ReorderState *state);
+static boolean collectJoinInputs (QueryOperator *op, JoinTree *t, boolean isRoot);
+static boolean addPredicates (Node *cond, JoinTree *t);
+static void fillMemo (JoinTree *t, ReorderState *state);
+static boolean isConnected (JoinTree *t, InputSet left, InputSet right);
+static double originalCost (QueryOperator *op, JoinTree *t, InputSet *inputs);
+static QueryOperator *buildJoinTree (JoinTree *t, InputSet inputs);
+static QueryOperator *replaceJoinTree (JoinTree *t);
+static List *getPredicatesAt (JoinTree *t, InputSet inputs, InputSet left);
+static void setAttrRefPositions (Node *cond, List *inputs);
+static int numInputs (InputSet s);
+static int firstInput (InputSet s);
+
+static double estimateCard (QueryOperator *op, ReorderState *state);
+static double estimateSelectivity (Node *cond, List *inputs, ReorderState *state);
+static double estimateRangeSelectivity (char *opName, Node *attr, Node *c, List *inputs,
+        ReorderState *state);
+static double estimateDistinctValues (QueryOperator *op, char *attr, ReorderState *state);
+static double tableDistinctValues (char *table, char *attr, DataType dt, double card,
+        ReorderState *state);
+static QueryOperator *findInputWithAttr (List *inputs, char *attr);
+static boolean isKeyAttr (QueryOperator *op, char *attr);
+static TableAccessOperator *findBaseTable (QueryOperator *op, char **attr);
+static boolean constToDouble (Constant *c, double *result);
+static List *parseHistogramBounds (char *hist);
+
+/*
+ * Reorder all join trees of the graph rooted at root. If the cost-based
+ * optimizer is active then for each join tree it decides between the new and
+ * the original join order.
+ */
+QueryOperator *
+reorderJoins (QueryOperator *root)
+{
+    ReorderState *state = NEW(ReorderState);
+
+    state->useCatalog = (activePlugin != NULL && activePlugin->isInitialized());
+    state->cards = NEW_MAP(Constant,Constant);
+    state->tableStats = NEW_MAP(Constant,Constant);
+    state->visited = PSET();
+
+    return reorderJoinsInternal(root, state);
+}
+
+static QueryOperator *
+reorderJoinsInternal (QueryOperator *op, ReorderState *state)
+{
+    JoinTree *t;
+
+    if (hasSetElem(state->visited, op))
+        return op;
+    addToSet(state->visited, op);
+
+    if (isJoinTreeRoot(op) && (t = collectJoinTree(op, state)) != NULL)
+    {
+        QueryOperator *result = replaceJoinTree(t);
+
+        FOREACH(QueryOperator,in,t->inputs)
+            reorderJoinsInternal(in, state);
+
+        return result;
+    }
+
+    FOREACH(QueryOperator,child,copyList(op->inputs))
+        reorderJoinsInternal(child, state);
+
+    return op;
+}
+
+static boolean
+isInnerJoin (QueryOperator *op)
+{
+    return isA(op, JoinOperator)
+            && (((JoinOperator *) op)->joinType == JOIN_INNER
+                    || ((JoinOperator *) op)->joinType == JOIN_CROSS);
+}
+
+static boolean
+isJoinTreeRoot (QueryOperator *op)
+{
+    if (isInnerJoin(op))
+        return TRUE;
+
+    return isA(op, SelectionOperator) && isInnerJoin(OP_LCHILD(op))
+            && LIST_LENGTH(OP_LCHILD(op)->parents) == 1;
+}
+
+/*
+ * Collect the join tree rooted at root. Returns NULL if the tree cannot be
+ * reordered, e.g., because it has less than three inputs or the names of
+ * attributes of the inputs are not unique.
+ */
+static JoinTree *
+collectJoinTree (QueryOperator *root, ReorderState *state)
+{
+    JoinTree *t = NEW(JoinTree);
+    QueryOperator *top = root;
+    int pos = 0;
+
+    t->root = root;
+    t->attrToInput = NEW_MAP(Constant,Constant);
+
+    if (isA(root, SelectionOperator))
+    {
+        top = OP_LCHILD(root);
+        t->ops = singleton(root);
+        if (!equalStringList(getQueryOperatorAttrNames(root), getQueryOperatorAttrNames(top)))
+            return NULL;
+    }
+
+    if (!collectJoinInputs(top, t, TRUE))
+        return NULL;
+
+    if (LIST_LENGTH(t->inputs) < 3 || LIST_LENGTH(t->inputs) > JOIN_REORDER_MAX_INPUTS)
+    {
+        DEBUG_LOG("do not reorder join tree with %d inputs", LIST_LENGTH(t->inputs));
+        return NULL;
+    }
+
+    FOREACH(QueryOperator,in,t->inputs)
+    {
+        FOREACH(char,a,getQueryOperatorAttrNames(in))
+        {
+            if (MAP_HAS_STRING_KEY(t->attrToInput, a))
+            {
+                DEBUG_LOG("do not reorder join tree: attribute %s is not unique", a);
+                return NULL;
+            }
+            MAP_ADD_STRING_KEY(t->attrToInput, a, createConstInt(pos));
+        }
+        pos++;
+    }
+
+    FOREACH(QueryOperator,op,t->ops)
+    {
+        Node *cond = isA(op, SelectionOperator) ? ((SelectionOperator *) op)->cond
+                : ((JoinOperator *) op)->cond;
+
+        if (!addPredicates(cond, t))
+            return NULL;
+    }
+
+    // keys are used to estimate the number of distinct values
+    if (state->useCatalog)
+        FOREACH(QueryOperator,in,t->inputs)
+            computeKeyProp(in);
+
+    FOREACH(JoinPredicate,p,t->preds)
+    {
+        List *inputs = NIL;
+
+        for(int i = 0; i < LIST_LENGTH(t->inputs); i++)
+            if (p->inputs & INPUT_BIT(i))
+                inputs = appendToTailOfList(inputs, getNthOfListP(t->inputs, i));
+        p->selectivity = estimateSelectivity(p->cond, inputs, state);
+    }
+
+    fillMemo(t, state);
+
+    return t;
+}
+
+static boolean
+collectJoinInputs (QueryOperator *op, JoinTree *t, boolean isRoot)
+{
+    if (!isInnerJoin(op) || (!isRoot && LIST_LENGTH(op->parents) != 1))
+    {
+        t->inputs = appendToTailOfList(t->inputs, op);
+        return TRUE;
+    }
+
+    // the join has to output the attributes of its inputs
+    if (!equalStringList(getQueryOperatorAttrNames(op),
+            CONCAT_LISTS(getQueryOperatorAttrNames(OP_LCHILD(op)),
+                    getQueryOperatorAttrNames(OP_RCHILD(op)))))
+        return FALSE;
+
+    t->ops = appendToTailOfList(t->ops, op);
+
+    return collectJoinInputs(OP_LCHILD(op), t, FALSE)
+            && collectJoinInputs(OP_RCHILD(op), t, FALSE);
+}
+
+/*
+ * Add the conjuncts of cond to the predicates of the join tree. Returns FALSE
+ * if a conjunct references attributes that are not produced by the inputs of
+ * the tree (correlated attributes).
+ */
+static boolean
+addPredicates (Node *cond, JoinTree *t)
+{
+    List *conjuncts = NIL;
+
+    splitConjuncts(cond, &conjuncts);
+
+    FOREACH(Node,c,conjuncts)
+    {
+        JoinPredicate *p = NEW(JoinPredicate);
+
+        p->cond = c;
+        p->inputs = 0;
+        FOREACH(AttributeReference,a,getAttrReferences(c))
+        {
+            Constant *pos = (Constant *) MAP_GET_STRING(t->attrToInput, a->name);
+
+            if (a->outerLevelsUp > 0 || pos == NULL)
+                return FALSE;
+            p->inputs |= INPUT_BIT(INT_VALUE(pos));
+        }
+        t->preds = appendToTailOfList(t->preds, p);
+    }
+
+    return TRUE;
+}
+
+/*
+ * Determine the estimated number of rows and the best plan for each subset of
+ * the inputs in the order of the sets (subsets come before their supersets).
+ */
+static void
+fillMemo (JoinTree *t, ReorderState *state)
+{
+    int n = LIST_LENGTH(t->inputs);
+    InputSet all = INPUT_BIT(n) - 1;
+    double *inputCards = CNEW(double, n);
+    int i = 0;
+
+    t->memo = CNEW(JoinMemoEntry, all + 1);
+
+    FOREACH(QueryOperator,in,t->inputs)
+    {
+        inputCards[i] = estimateCard(in, state);
+        FOREACH(JoinPredicate,p,t->preds)
+            if (p->inputs == INPUT_BIT(i))
+                inputCards[i] *= p->selectivity;
+        i++;
+    }
+
+    for(InputSet s = 1; s <= all; s++)
+    {
+        JoinMemoEntry *e = t->memo + s;
+        InputSet lowest = s & (~s + 1);
+        double card = 1.0;
+        double bestConnected = -1, bestAny = -1;
+        InputSet leftConnected = 0, leftAny = 0;
+
+        for(i = 0; i < n; i++)
+            if (s & INPUT_BIT(i))
+                card *= inputCards[i];
+        FOREACH(JoinPredicate,p,t->preds)
+            if (numInputs(p->inputs) > 1 && IS_SUBSET(p->inputs, s))
+                card *= p->selectivity;
+        e->card = MAX(card, 1.0);
+
+        if (s == lowest)
+            continue;
+
+        // the left side always contains the first input (plans are symmetric)
+        for(InputSet l = (s - 1) & s; l > 0; l = (l - 1) & s)
+        {
+            InputSet r = s & ~l;
+            double cost;
+
+            if (!(l & lowest))
+                continue;
+
+            cost = t->memo[l].cost + t->memo[r].cost + e->card;
+            if (bestAny < 0 || cost < bestAny)
+            {
+                bestAny = cost;
+                leftAny = l;
+            }
+            if ((bestConnected < 0 || cost < bestConnected) && isConnected(t, l, r))
+            {
+                bestConnected = cost;
+                leftConnected = l;
+            }
+        }
+
+        if (bestConnected >= 0)
+        {
+            e->cost = bestConnected;
+            e->left = leftConnected;
+        }
+        else
+        {
+            e->cost = bestAny;
+            e->left = leftAny;
+        }
+    }
+}
+
+static boolean
+isConnected (JoinTree *t, InputSet left, InputSet right)
+{
+    FOREACH(JoinPredicate,p,t->preds)
+        if ((p->inputs & left) && (p->inputs & right)
+                && IS_SUBSET(p->inputs, left | right))
+            return TRUE;
+
+    return FALSE;
+}
+
+/* cost of the original join order according to the memo's cost model */
+static double
+originalCost (QueryOperator *op, JoinTree *t, InputSet *inputs)
+{
+    InputSet l, r;
+    double cost;
+    int pos = 0;
+
+    // inputs are compared by pointer
+    FOREACH(QueryOperator,in,t->inputs)
+    {
+        if (in == op)
+        {
+            *inputs = INPUT_BIT(pos);
+            return 0.0;
+        }
+        pos++;
+    }
+
+    if (isA(op, SelectionOperator))
+        return originalCost(OP_LCHILD(op), t, inputs);
+
+    cost = originalCost(OP_LCHILD(op), t, &l) + originalCost(OP_RCHILD(op), t, &r);
+    *inputs = l | r;
+
+    return cost + t->memo[*inputs].card;
+}
+
+/*
+ * Replace the join tree with the best plan from the memo if its estimated
+ * cost is lower than the cost of the original join order. Returns the new
+ * root of the join tree.
+ */
+static QueryOperator *
+replaceJoinTree (JoinTree *t)
+{
+    InputSet all = INPUT_BIT(LIST_LENGTH(t->inputs)) - 1;
+    QueryOperator *top;
+    ProjectionOperator *proj;
+    List *projExprs = NIL;
+    List *topPreds = getPredicatesAt(t, 0, 0);
+    InputSet origInputs;
+    double origCost = originalCost(t->root, t, &origInputs);
+    double newCost = t->memo[all].cost;
+
+    DEBUG_LOG("join tree with %d inputs: estimated cost %f of original order and %f of best order",
+            LIST_LENGTH(t->inputs), origCost, newCost);
+
+    if (newCost >= origCost * (1.0 - MIN_COST_IMPROVEMENT))
+        return t->root;
+
+    // make an optimization choice
+    if (getBoolOption(OPTION_COST_BASED_OPTIMIZER))
+    {
+        int res = callback(2);
+
+        INFO_LOG("res is %d", res);
+
+        // keep original join order
+        if (res == 1)
+            return t->root;
+    }
+
+    INFO_LOG("reorder join tree with %d inputs: estimated cost %f instead of %f",
+            LIST_LENGTH(t->inputs), newCost, origCost);
+
+    top = buildJoinTree(t, all);
+
+    // conditions that do not reference any input
+    if (topPreds != NIL)
+    {
+        QueryOperator *sel = (QueryOperator *) createSelectionOp(andExprList(topPreds),
+                top, NIL, getQueryOperatorAttrNames(top));
+
+        addParent(top, sel);
+        top = sel;
+    }
+
+    // restore the order of attributes of the original join tree
+    FOREACH(AttributeDef,a,t->root->schema->attrDefs)
+        projExprs = appendToTailOfList(projExprs,
+                createFullAttrReference(strdup(a->attrName), 0,
+                        getAttrPos(top, a->attrName), 0, a->dataType));
+    proj = createProjectionOp(projExprs, top, NIL, getQueryOperatorAttrNames(t->root));
+    addParent(top, (QueryOperator *) proj);
+    proj->op.provAttrs = copyObject(t->root->provAttrs);
+    proj->op.properties = copyObject(t->root->properties);
+
+    // detach inputs from the original join tree
+    FOREACH(QueryOperator,in,t->inputs)
+        FOREACH(QueryOperator,op,t->ops)
+            removeParent(in, op);
+
+    switchSubtrees(t->root, (QueryOperator *) proj);
+
+    return (QueryOperator *) proj;
+}
+
+static QueryOperator *
+buildJoinTree (JoinTree *t, InputSet inputs)
+{
+    JoinMemoEntry *e = t->memo + inputs;
+    List *preds;
+    QueryOperator *result;
+
+    // input with selection for conditions that only reference the input
+    if (e->left == 0)
+    {
+        QueryOperator *in = (QueryOperator *) getNthOfListP(t->inputs, firstInput(inputs));
+
+        preds = getPredicatesAt(t, inputs, 0);
+        if (preds == NIL)
+            return in;
+
+        result = (QueryOperator *) createSelectionOp(andExprList(preds), in, NIL,
+                getQueryOperatorAttrNames(in));
+        addParent(in, result);
+    }
+    else
+    {
+        QueryOperator *l = buildJoinTree(t, e->left);
+        QueryOperator *r = buildJoinTree(t, inputs & ~e->left);
+
+        preds = getPredicatesAt(t, inputs, e->left);
+        result = (QueryOperator *) createJoinOp(preds == NIL ? JOIN_CROSS : JOIN_INNER,
+                preds == NIL ? NULL : andExprList(preds), LIST_MAKE(l, r), NIL, NIL);
+        addParent(l, result);
+        addParent(r, result);
+    }
+
+    setAttrRefPositions(isA(result, SelectionOperator)
+            ? ((SelectionOperator *) result)->cond : ((JoinOperator *) result)->cond,
+            result->inputs);
+
+    return result;
+}
+
+/*
+ * Copies of the conjuncts that are evaluated by the join of left with the
+ * rest of inputs (by a selection over the input if left is 0).
+ */
+static List *
+getPredicatesAt (JoinTree *t, InputSet inputs, InputSet left)
+{
+    List *result = NIL;
+
+    FOREACH(JoinPredicate,p,t->preds)
+    {
+        boolean at;
+
+        if (left == 0)
+            at = (p->inputs == inputs);
+        else
+            at = IS_SUBSET(p->inputs, inputs) && (p->inputs & left)
+                    && (p->inputs & ~left);
+
+        if (at)
+            result = appendToTailOfList(result, copyObject(p->cond));
+    }
+
+    return result;
+}
+
+static void
+setAttrRefPositions (Node *cond, List *inputs)
+{
+    FOREACH(AttributeReference,a,getAttrReferences(cond))
+    {
+        int i = 0;
+
+        FOREACH(QueryOperator,in,inputs)
+        {
+            int pos = getAttrPos(in, a->name);
+
+            if (pos != -1)
+            {
+                a->fromClauseItem = i;
+                a->attrPosition = pos;
+                break;
+            }
+            i++;
+        }
+    }
+}
+
+static int
+numInputs (InputSet s)
+{
+    int result = 0;
+
+    for(; s != 0; s &= s - 1)
+        result++;
+
+    return result;
+}
+
+static int
+firstInput (InputSet s)
+{
+    int result = 0;
+
+    while(!(s & INPUT_BIT(result)))
+        result++;
+
+    return result;
+}
+
+/*
+ * Estimate the number of rows returned by an operator.
+ */
+static double
+estimateCard (QueryOperator *op, ReorderState *state)
+{
+    Constant *cached = (Constant *) MAP_GET_POINTER(state->cards, op);
+    double result;
+
+    if (cached != NULL)
+        return FLOAT_VALUE(cached);
+
+    switch(op->type)
+    {
+        case T_TableAccessOperator:
+        {
+            TableAccessOperator *t = (TableAccessOperator *) op;
+
+            result = state->useCatalog ? (double) getRowNum(t->tableName) : DEFAULT_ROW_NUM;
+        }
+        break;
+        case T_ConstRelOperator:
+            result = 1.0;
+        break;
+        case T_SelectionOperator:
+            result = estimateCard(OP_LCHILD(op), state)
+                    * estimateSelectivity(((SelectionOperator *) op)->cond, op->inputs, state);
+        break;
+        case T_JoinOperator:
+        {
+            JoinOperator *j = (JoinOperator *) op;
+            double l = estimateCard(OP_LCHILD(op), state);
+            double r = estimateCard(OP_RCHILD(op), state);
+
+            result = l * r * estimateSelectivity(j->cond, op->inputs, state);
+            if (j->joinType == JOIN_LEFT_OUTER || j->joinType == JOIN_FULL_OUTER)
+                result = MAX(result, l);
+            if (j->joinType == JOIN_RIGHT_OUTER || j->joinType == JOIN_FULL_OUTER)
+                result = MAX(result, r);
+        }
+        break;
+        case T_AggregationOperator:
+        {
+            AggregationOperator *a = (AggregationOperator *) op;
+            double in = estimateCard(OP_LCHILD(op), state);
+
+            result = 1.0;
+            FOREACH(Node,g,a->groupBy)
+            {
+                if (isA(g, AttributeReference))
+                    result *= estimateDistinctValues(OP_LCHILD(op),
+                            ((AttributeReference *) g)->name, state);
+                else
+                    result = in;
+            }
+            result = MIN(result, in);
+        }
+        break;
+        case T_SetOperator:
+        {
+            double l = estimateCard(OP_LCHILD(op), state);
+            double r = estimateCard(OP_RCHILD(op), state);
+
+            switch(((SetOperator *) op)->setOpType)
+            {
+                case SETOP_UNION:
+                    result = l + r;
+                    break;
+                case SETOP_INTERSECTION:
+                    result = MIN(l, r);
+                    break;
+                default:
+                    result = l;
+                    break;
+            }
+        }
+        break;
+        default:
+            result = (op->inputs != NIL) ? estimateCard(OP_LCHILD(op), state) : DEFAULT_ROW_NUM;
+        break;
+    }
+
+    result = MAX(result, 1.0);
+    MAP_ADD_POINTER(state->cards, op, createConstFloat(result));
+
+    return result;
+}
+
+/*
+ * Estimate the fraction of rows of the cross product of inputs that fulfill
+ * condition cond.
+ */
+static double
+estimateSelectivity (Node *cond, List *inputs, ReorderState *state)
+{
+    Operator *o;
+    char *name;
+    Node *l, *r;
+
+    if (cond == NULL)
+        return 1.0;
+    if (!isA(cond, Operator))
+        return DEFAULT_SELECTIVITY;
+
+    o = (Operator *) cond;
+    name = o->name;
+
+    if (strieq(name, OPNAME_AND))
+    {
+        double result = 1.0;
+
+        FOREACH(Node,arg,o->args)
+            result *= estimateSelectivity(arg, inputs, state);
+
+        return result;
+    }
+    if (strieq(name, OPNAME_OR))
+    {
+        double result = 0.0;
+
+        FOREACH(Node,arg,o->args)
+        {
+            double s = estimateSelectivity(arg, inputs, state);
+
+            result = result + s - result * s;
+        }
+
+        return result;
+    }
+    if (strieq(name, OPNAME_NOT))
+        return 1.0 - estimateSelectivity(getHeadOfListP(o->args), inputs, state);
+
+    if (LIST_LENGTH(o->args) != 2)
+        return DEFAULT_SELECTIVITY;
+
+    l = OP_LEFT_INPUT(o);
+    r = OP_RIGHT_INPUT(o);
+
+    // attribute compared with a constant is handled as constant compared with attribute
+    if (isA(l, Constant) && isA(r, AttributeReference))
+    {
+        Node *tmp = l;
+
+        l = r;
+        r = tmp;
+        if (streq(name, OPNAME_LT))
+            name = OPNAME_GT;
+        else if (streq(name, OPNAME_LE))
+            name = OPNAME_GE;
+        else if (streq(name, OPNAME_GT))
+            name = OPNAME_LT;
+        else if (streq(name, OPNAME_GE))
+            name = OPNAME_LE;
+    }
+
+    if (!isA(l, AttributeReference) || !(isA(r, AttributeReference) || isA(r, Constant)))
+        return DEFAULT_SELECTIVITY;
+
+    if (streq(name, OPNAME_EQ) || streq(name, OPNAME_NEQ)
+            || streq(name, OPNAME_NEQ_BANG) || streq(name, OPNAME_NEQ_HAT))
+    {
+        char *lName = ((AttributeReference *) l)->name;
+        QueryOperator *lIn = findInputWithAttr(inputs, lName);
+        double ndv, eq;
+
+        if (lIn == NULL)
+            return DEFAULT_SELECTIVITY;
+        ndv = estimateDistinctValues(lIn, lName, state);
+
+        // equi-join: containment of the values of the attribute with fewer distinct values
+        if (isA(r, AttributeReference))
+        {
+            char *rName = ((AttributeReference *) r)->name;
+            QueryOperator *rIn = findInputWithAttr(inputs, rName);
+
+            if (rIn == NULL)
+                return DEFAULT_SELECTIVITY;
+            ndv = MAX(ndv, estimateDistinctValues(rIn, rName, state));
+        }
+        eq = 1.0 / ndv;
+
+        return streq(name, OPNAME_EQ) ? eq : 1.0 - eq;
+    }
+
+    if (isA(r, Constant) && (streq(name, OPNAME_LT) || streq(name, OPNAME_LE)
+            || streq(name, OPNAME_GT) || streq(name, OPNAME_GE)))
+        return estimateRangeSelectivity(name, l, r, inputs, state);
+
+    return DEFAULT_SELECTIVITY;
+}
+
+/*
+ * Estimate the selectivity of attr opName c based on a histogram of the
+ * attribute's table (or its min and max values if there is no histogram).
+ */
+static double
+estimateRangeSelectivity (char *opName, Node *attr, Node *c, List *inputs,
+        ReorderState *state)
+{
+    char *a = ((AttributeReference *) attr)->name;
+    QueryOperator *in = findInputWithAttr(inputs, a);
+    TableAccessOperator *table;
+    List *bounds = NIL;
+    double value, below;
+
+    if (in == NULL || !state->useCatalog || !constToDouble((Constant *) c, &value))
+        return DEFAULT_SELECTIVITY;
+
+    table = findBaseTable(in, &a);
+    if (table == NULL || estimateCard((QueryOperator *) table, state) <= 1.0)
+        return DEFAULT_SELECTIVITY;
+
+    // histogram is a list of the bounds of partitions, the min, and the max
+    bounds = parseHistogramBounds((char *) getHeadOfListP(
+            getHist(table->tableName, a, HISTOGRAM_PARTITIONS)));
+    if (LIST_LENGTH(bounds) < 2)
+    {
+        HashMap *minMax = getMinAndMax(table->tableName, a);
+        double min, max;
+
+        if (minMax == NULL
+                || !constToDouble((Constant *) MAP_GET_STRING(minMax, MIN_KEY), &min)
+                || !constToDouble((Constant *) MAP_GET_STRING(minMax, MAX_KEY), &max)
+                || max <= min)
+            return DEFAULT_SELECTIVITY;
+        bounds = LIST_MAKE(createConstFloat(min), createConstFloat(max));
+    }
+
+    // fraction of values below value assuming uniform distribution within partitions
+    below = 1.0;
+    for(int i = 0; i < LIST_LENGTH(bounds) - 1; i++)
+    {
+        double lower = FLOAT_VALUE(getNthOfListP(bounds, i));
+        double upper = FLOAT_VALUE(getNthOfListP(bounds, i + 1));
+
+        if (value < upper)
+        {
+            below = (i + (value > lower ? (value - lower) / (upper - lower) : 0.0))
+                    / (LIST_LENGTH(bounds) - 1);
+            break;
+        }
+    }
+
+    if (streq(opName, OPNAME_LT) || streq(opName, OPNAME_LE))
+        return MAX(below, 1.0 / estimateCard(in, state));
+    return MAX(1.0 - below, 1.0 / estimateCard(in, state));
+}
+
+/*
+ * Estimate the number of distinct values of attribute attr of op. Attributes
+ * that are keys have as many distinct values as op has rows. For attributes
+ * of tables the number of distinct values is bound by the range of values.
+ */
+static double
+estimateDistinctValues (QueryOperator *op, char *attr, ReorderState *state)
+{
+    double card = estimateCard(op, state);
+    TableAccessOperator *table;
+    char *tableAttr = attr;
+    AttributeDef *def;
+
+    if (isKeyAttr(op, attr) || !state->useCatalog)
+        return card;
+
+    table = findBaseTable(op, &tableAttr);
+    if (table == NULL || isKeyAttr((QueryOperator *) table, tableAttr))
+        return card;
+
+    def = getAttrDefByName((QueryOperator *) table, tableAttr);
+    if (def == NULL)
+        return card;
+
+    return MAX(MIN(card, tableDistinctValues(table->tableName, tableAttr, def->dataType,
+            estimateCard((QueryOperator *) table, state), state)), 1.0);
+}
+
+static double
+tableDistinctValues (char *table, char *attr, DataType dt, double card,
+        ReorderState *state)
+{
+    char *key = CONCAT_STRINGS(table, "#", attr);
+    Constant *cached = (Constant *) MAP_GET_STRING(state->tableStats, key);
+    double result = card;
+
+    if (cached != NULL)
+        return FLOAT_VALUE(cached);
+
+    // integer attributes cannot have more distinct values than their range
+    if ((dt == DT_INT || dt == DT_LONG) && card > 1.0)
+    {
+        HashMap *minMax = getMinAndMax(table, attr);
+        double min, max;
+
+        if (minMax != NULL
+                && constToDouble((Constant *) MAP_GET_STRING(minMax, MIN_KEY), &min)
+                && constToDouble((Constant *) MAP_GET_STRING(minMax, MAX_KEY), &max))
+            result = MIN(card, max - min + 1);
+    }
+
+    MAP_ADD_STRING_KEY(state->tableStats, key, createConstFloat(result));
+
+    return result;
+}
+
+static QueryOperator *
+findInputWithAttr (List *inputs, char *attr)
+{
+    FOREACH(QueryOperator,in,inputs)
+        if (getAttrPos(in, attr) != -1)
+            return in;
+
+    return NULL;
+}
+
+static boolean
+isKeyAttr (QueryOperator *op, char *attr)
+{
+    List *keys = (List *) getStringProperty(op, PROP_STORE_LIST_KEY);
+
+    FOREACH(Set,k,keys)
+        if (setSize(k) == 1 && hasSetElem(k, attr))
+            return TRUE;
+
+    return FALSE;
+}
+
+/*
+ * Find the table attribute attr is copied from. Follows attribute references
+ * of projections and the inputs of other operators that pass on attr
+ * unchanged. On success *attr is set to the name of the attribute in the
+ * table.
+ */
+static TableAccessOperator *
+findBaseTable (QueryOperator *op, char **attr)
+{
+    switch(op->type)
+    {
+        case T_TableAccessOperator:
+            return (TableAccessOperator *) op;
+        case T_ProjectionOperator:
+        {
+            int pos = getAttrPos(op, *attr);
+            Node *e;
+
+            if (pos == -1)
+                return NULL;
+            e = (Node *) getNthOfListP(((ProjectionOperator *) op)->projExprs, pos);
+            if (!isA(e, AttributeReference))
+                return NULL;
+            *attr = ((AttributeReference *) e)->name;
+            return findBaseTable(OP_LCHILD(op), attr);
+        }
+        case T_SelectionOperator:
+        case T_DuplicateRemoval:
+        case T_OrderOperator:
+        case T_JoinOperator:
+        {
+            QueryOperator *in = findInputWithAttr(op->inputs, *attr);
+
+            return in == NULL ? NULL : findBaseTable(in, attr);
+        }
+        default:
+            return NULL;
+    }
+}
+
+static boolean
+constToDouble (Constant *c, double *result)
+{
+    if (c == NULL || c->isNull)
+        return FALSE;
+
+    switch(c->constType)
+    {
+        case DT_INT:
+            *result = (double) INT_VALUE(c);
+            return TRUE;
+        case DT_LONG:
+            *result = (double) LONG_VALUE(c);
+            return TRUE;
+        case DT_FLOAT:
+            *result = FLOAT_VALUE(c);
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
+
+/*
+ * Parse the bounds of a histogram of the form {b1,b2,...} into a list of
+ * float constants. Returns NIL if any bound is not a number.
+ */
+static List *
+parseHistogramBounds (char *hist)
+{
+    List *result = NIL;
+    char *pos = hist;
+
+    if (hist == NULL || *pos != '{')
+        return NIL;
+    pos++;
+
+    while (*pos != '\0' && *pos != '}')
+    {
+        char *end;
+        double b = strtod(pos, &end);
+
+        if (end == pos || (*end != ',' && *end != '}'))
+            return NIL;
+        result = appendToTailOfList(result, createConstFloat(b));
+        pos = (*end == ',') ? end + 1 : end;
+    }
+
+    return result;
+}
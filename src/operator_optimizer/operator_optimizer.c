@@ -15,9 +15,14 @@
 #include "configuration/option.h"
 #include "instrumentation/timing_instrumentation.h"
 #include "log/logger.h"
+#include "exception/exception.h"
 #include "operator_optimizer/operator_optimizer.h"
 #include "operator_optimizer/operator_merge.h"
 #include "operator_optimizer/expr_attr_factor.h"
+#include "operator_optimizer/common_subplans.h"
+#include "operator_optimizer/rule_scheduler.h"
+#include "operator_optimizer/join_reorder.h"
+#include "operator_optimizer/selection_pushdown.h"
 #include "model/query_block/query_block.h"
 #include "model/list/list.h"
 #include "model/set/hashmap.h"
@@ -31,6 +36,7 @@
 #include "model/set/set.h"
 #include "operator_optimizer/optimizer_prop_inference.h"
 #include "metadata_lookup/metadata_lookup.h"
+#include "utility/thread_pool.h"
 #include <stdint.h>
 
 // macros for running and timing an optimization rule and logging the resulting AGM graph.
@@ -54,10 +60,97 @@
         STOP_TIMER("OptimizeModel - " optName); \
     }
 
+// minimal number of operators of a subgraph that is optimized by a worker thread
+#define MIN_PARALLEL_SUBGRAPH_OPS 4
+
+// input of a union that is optimized independently of the rest of the graph
+typedef struct SubgraphTask
+{
+    QueryOperator *parent;  // union the subgraph is an input of
+    int pos;                // position of the subgraph in the inputs of parent
+    QueryOperator *op;      // root of the subgraph
+    List *attrNames;        // names of the result attributes of the subgraph
+    boolean failed;         // optimization threw an exception
+    ExceptionSeverity severity;
+    char *errorMessage;     // exception thrown by the worker
+} SubgraphTask;
+
 static QueryOperator *optimizeOneGraph (QueryOperator *root);
+static QueryOperator *applyHeuristicRules (QueryOperator *rewrittenTree);
+static QueryOperator *inferDuplicateRemovalProperties (QueryOperator *root);
+static boolean mergeAdjacentOperatorsAt (QueryOperator *op);
+static int numProjectionsBelow (QueryOperator *op);
+static boolean factorAttrsInExpressionsAt (QueryOperator *op);
+
+/* heuristic optimization rules in the order in which they are applied */
+static OptimizationRule heuristicRules[] = {
+    OPT_RULE("factor attributes in conditions",
+            factorAttrsInExpressions, factorAttrsInExpressionsAt,
+            OPTIMIZATION_FACTOR_ATTR_IN_PROJ_EXPR),
+    OPT_RULE("selection move around",
+            selectionMoveAround, NULL,
+            OPTIMIZATION_SELECTION_MOVE_AROUND),
+    OPT_RULE("selection pushdown",
+            pushDownSelectionOperatorOnProv, NULL,
+            OPTIMIZATION_SELECTION_PUSHING),
+    OPT_RULE("pushdown selections through joins",
+            pushDownSelectionThroughJoinsOperatorOnProv, NULL,
+            OPTIMIZATION_SELECTION_PUSHING_THROUGH_JOINS),
+    OPT_RULE("reorder joins",
+            reorderJoins, NULL,
+            OPTIMIZATION_JOIN_REORDER),
+    OPT_RULE("pull up duplicate remove operators",
+            pullUpDuplicateRemoval, NULL,
+            OPTIMIZATION_PULL_UP_DUPLICATE_REMOVE_OPERATORS),
+    OPT_RULE("remove unnecessary columns",
+            removeUnnecessaryColumns, NULL,
+            OPTIMIZATION_REMOVE_UNNECESSARY_COLUMNS),
+    OPT_RULE("remove unnecessary window operators",
+            removeUnnecessaryWindowOperator, NULL,
+            OPTIMIZATION_REMOVE_UNNECESSARY_WINDOW_OPERATORS),
+    OPT_RULE("merge adjacent projections and selections",
+            mergeAdjacentOperators, mergeAdjacentOperatorsAt,
+            OPTIMIZATION_MERGE_OPERATORS),
+    OPT_RULE("factor attributes in conditions",
+            factorAttrsInExpressions, factorAttrsInExpressionsAt,
+            OPTIMIZATION_FACTOR_ATTR_IN_PROJ_EXPR),
+    OPT_RULE("merge adjacent projections and selections",
+            mergeAdjacentOperators, mergeAdjacentOperatorsAt,
+            OPTIMIZATION_MERGE_OPERATORS),
+    OPT_RULE("infer keys and set semantics",
+            inferDuplicateRemovalProperties, NULL,
+            OPTIMIZATION_REMOVE_REDUNDANT_DUPLICATE_OPERATOR),
+    OPT_RULE("remove redundant duplicate removal operators by set",
+            removeRedundantDuplicateOperatorBySetWithInit, NULL,
+            OPTIMIZATION_REMOVE_REDUNDANT_DUPLICATE_OPERATOR),
+    OPT_RULE("remove redundant duplicate removal operators by key",
+            removeRedundantDuplicateOperatorByKey, NULL,
+            OPTIMIZATION_REMOVE_REDUNDANT_DUPLICATE_OPERATOR),
+    OPT_RULE("remove redundant projection operators",
+            removeRedundantProjections, NULL,
+            OPTIMIZATION_REMOVE_REDUNDANT_PROJECTIONS),
+    OPT_RULE("pull up provenance projections",
+            pullingUpProvenanceProjections, NULL,
+            OPTIMIZATION_PULLING_UP_PROVENANCE_PROJ),
+    OPT_RULE("merge adjacent projections and selections",
+            mergeAdjacentOperators, mergeAdjacentOperatorsAt,
+            OPTIMIZATION_MERGE_OPERATORS),
+    OPT_RULE("materialize projections that are unsafe to be merged",
+            materializeProjectionSequences, NULL,
+            OPTIMIZATION_MATERIALIZE_MERGE_UNSAFE_PROJ),
+    OPT_RULE("push down aggregation through join",
+            pushDownAggregationThroughJoin, NULL,
+            OPTIMIZATION_PUSH_DOWN_AGGREGATION_THROUGH_JOIN)
+};
+
+/* optimize independent subgraphs concurrently */
+static void optimizeIndependentSubgraphs (List *graphs, int numThreads);
+static void findIndependentSubgraphs (QueryOperator *op, Set *visited, List **tasks);
+static boolean isIndependentSubgraph (QueryOperator *root);
+static void collectSubgraph (QueryOperator *op, Set *ops);
+static void optimizeSubgraph (void *arg);
+static void replaceSubgraph (void *arg);
 static QueryOperator *pullup(QueryOperator *op, List *duplicateattrs, List *normalAttrNames);
-static void pushDownSelection(QueryOperator *root, List *opList,
-                              QueryOperator *r, QueryOperator *child);
 static void renameOpAttrRefs(QueryOperator *op, HashMap *nameMap, QueryOperator *pro);
 static boolean renameAttrRefs (Node *node, HashMap *nameMap);
 
@@ -86,6 +179,18 @@ static QueryOperator *removeUnnecessaryWindowOperatorInternal(QueryOperator *roo
 Node  *
 optimizeOperatorModel (Node *root)
 {
+    int numThreads = getIntOption(OPTION_OPTIMIZER_THREADS);
+
+    // first optimize independent subgraphs of all graphs concurrently (the
+    // cost based optimizer and memory debugging keep global state)
+    if (numThreads > 1 && !getBoolOption(OPTION_COST_BASED_OPTIMIZER) && !opt_memmeasure)
+    {
+        START_TIMER("OptimizeModel - optimize independent subgraphs");
+        optimizeIndependentSubgraphs(isA(root, List) ? (List *) root : singleton(root),
+                numThreads);
+        STOP_TIMER("OptimizeModel - optimize independent subgraphs");
+    }
+
     if(isA(root, List))
     {
         FOREACH_LC(lc, (List *) root)
@@ -131,85 +236,7 @@ optimizeOneGraph (QueryOperator *root)
     ERROR_LOG("numHeuOptItens = %d",numHeuOptItens);
     while(c <= res)
     {
-    	APPLY_AND_TIME_OPT("factor attributes in conditions",
-    			factorAttrsInExpressions,
-				OPTIMIZATION_FACTOR_ATTR_IN_PROJ_EXPR);
-    	APPLY_AND_TIME_OPT("selection move around",
-    			selectionMoveAround,
-				OPTIMIZATION_SELECTION_MOVE_AROUND);
-    	APPLY_AND_TIME_OPT("pull up duplicate remove operators",
-    			pullUpDuplicateRemoval,
-				OPTIMIZATION_PULL_UP_DUPLICATE_REMOVE_OPERATORS);
-    	APPLY_AND_TIME_OPT("remove unnecessary columns",
-    			removeUnnecessaryColumns,
-				OPTIMIZATION_REMOVE_UNNECESSARY_COLUMNS);
-    	APPLY_AND_TIME_OPT("remove unnecessary window operators",
-    			removeUnnecessaryWindowOperator,
-				OPTIMIZATION_REMOVE_UNNECESSARY_WINDOW_OPERATORS);
-    	APPLY_AND_TIME_OPT("merge adjacent projections and selections",
-    			mergeAdjacentOperators,
-				OPTIMIZATION_MERGE_OPERATORS);
-//    	APPLY_AND_TIME_OPT("selection pushdown",
-//    			pushDownSelectionOperatorOnProv,
-//				OPTIMIZATION_SELECTION_PUSHING);
-//    	APPLY_AND_TIME_OPT("merge adjacent projections and selections",
-//    			mergeAdjacentOperators,
-//				OPTIMIZATION_MERGE_OPERATORS);
-//    	APPLY_AND_TIME_OPT("pushdown selections through joins",
-//    			pushDownSelectionThroughJoinsOperatorOnProv,
-//				OPTIMIZATION_SELECTION_PUSHING_THROUGH_JOINS);
-    	APPLY_AND_TIME_OPT("factor attributes in conditions",
-    			factorAttrsInExpressions,
-				OPTIMIZATION_FACTOR_ATTR_IN_PROJ_EXPR);
-    	APPLY_AND_TIME_OPT("merge adjacent projections and selections",
-    			mergeAdjacentOperators,
-				OPTIMIZATION_MERGE_OPERATORS);
-    	if (getBoolOption(OPTIMIZATION_REMOVE_REDUNDANT_DUPLICATE_OPERATOR))
-    	{
-    	    START_TIMER("PropertyInference - Keys");
-    		computeKeyProp(rewrittenTree);
-    		STOP_TIMER("PropertyInference - Keys");
-
-    		//exit(-1);
-    		// Set TRUE for each Operator
-    		START_TIMER("PropertyInference - Set");
-    		initializeSetProp(rewrittenTree);
-    		// Set FALSE for root
-    		setStringProperty((QueryOperator *) rewrittenTree, PROP_STORE_BOOL_SET, (Node *) createConstBool(FALSE));
-    		computeSetProp(rewrittenTree);
-            STOP_TIMER("PropertyInference - Set");
-
-    		List *icols =  getAttrNames(GET_OPSCHEMA(root));
-    		//char *a = (char *)getHeadOfListP(icols);
-    		Set *seticols = MAKE_STR_SET(strdup((char *)getHeadOfListP(icols)));
-    		FOREACH(char, a, icols)
-    		addToSet (seticols, a);
-    	}
-//    	/*    APPLY_AND_TIME_OPT("remove redundant duplicate removal operators by set",
-//            removeRedundantDuplicateOperatorBySet,
-//            OPTIMIZATION_REMOVE_REDUNDANT_DUPLICATE_OPERATOR);*/
-    	APPLY_AND_TIME_OPT("remove redundant duplicate removal operators by set",
-    			removeRedundantDuplicateOperatorBySetWithInit,
-				OPTIMIZATION_REMOVE_REDUNDANT_DUPLICATE_OPERATOR);
-    	APPLY_AND_TIME_OPT("remove redundant duplicate removal operators by key",
-    			removeRedundantDuplicateOperatorByKey,
-				OPTIMIZATION_REMOVE_REDUNDANT_DUPLICATE_OPERATOR);
-    	APPLY_AND_TIME_OPT("remove redundant projection operators",
-    			removeRedundantProjections,
-				OPTIMIZATION_REMOVE_REDUNDANT_PROJECTIONS);
-    	APPLY_AND_TIME_OPT("pull up provenance projections",
-    			pullingUpProvenanceProjections,
-				OPTIMIZATION_PULLING_UP_PROVENANCE_PROJ);
-    	APPLY_AND_TIME_OPT("merge adjacent projections and selections",
-    			mergeAdjacentOperators,
-				OPTIMIZATION_MERGE_OPERATORS);
-    	APPLY_AND_TIME_OPT("materialize projections that are unsafe to be merged",
-    			materializeProjectionSequences,
-				OPTIMIZATION_MATERIALIZE_MERGE_UNSAFE_PROJ);
-
-    	APPLY_AND_TIME_OPT("push down aggregation through join",
-    			pushDownAggregationThroughJoin,
-				OPTIMIZATION_PUSH_DOWN_AGGREGATION_THROUGH_JOIN);
+        rewrittenTree = applyHeuristicRules(rewrittenTree);
 
     	DEBUG_LOG("callback = %d in loop %d",res,c);
     	c++;
@@ -219,10 +246,216 @@ optimizeOneGraph (QueryOperator *root)
     	emptyProperty(rewrittenTree);
     	STOP_TIMER("OptimizeModel - RemoveProperties");
     }
+    APPLY_AND_TIME_OPT("share common subplans",
+            shareCommonSubplans,
+            OPTIMIZATION_SHARE_COMMON_SUBPLANS);
     FREE_MEM_CONTEXT_AND_RETURN_COPY(QueryOperator,rewrittenTree);
     return rewrittenTree;
 }
 
+/*
+ * Apply the heuristic optimization rules to inputs of unions that do not
+ * share any operators with the rest of the graph (typically the many branches
+ * of unions created by uncertainty, temporal, and why-not provenance
+ * rewrites) using numThreads worker threads. Each subgraph is optimized as if
+ * it would be a query of its own, so optimizations that cross the boundary of
+ * the subgraph are left to the optimization of the whole graph afterwards.
+ */
+static void
+optimizeIndependentSubgraphs (List *graphs, int numThreads)
+{
+    List *tasks = NIL;
+    void **args;
+    int i = 0;
+
+    FOREACH(QueryOperator,g,graphs)
+        findIndependentSubgraphs(g, PSET(), &tasks);
+
+    if (LIST_LENGTH(tasks) < 2)
+        return;
+
+    INFO_LOG("optimize %d independent subgraphs using %d threads",
+            LIST_LENGTH(tasks), numThreads);
+
+    // detach subgraphs from their unions
+    args = CNEW(void *, LIST_LENGTH(tasks));
+    FOREACH(SubgraphTask,t,tasks)
+    {
+        t->attrNames = getQueryOperatorAttrNames(t->op);
+        t->op->parents = NIL;
+        args[i++] = t;
+    }
+
+    runTasksInParallel(numThreads, LIST_LENGTH(tasks), optimizeSubgraph,
+            replaceSubgraph, args);
+
+    // exceptions of workers are rethrown once all workers are done
+    FOREACH(SubgraphTask,t,tasks)
+        if (t->failed)
+            THROW(t->severity, "optimizing independent subgraph failed: %s",
+                    t->errorMessage);
+}
+
+static void
+findIndependentSubgraphs (QueryOperator *op, Set *visited, List **tasks)
+{
+    int pos = 0;
+
+    if (hasSetElem(visited, op))
+        return;
+    addToSet(visited, op);
+
+    FOREACH(QueryOperator,child,op->inputs)
+    {
+        // inputs of unions that are not unions themselves are candidates
+        if (isA(op, SetOperator) && ((SetOperator *) op)->setOpType == SETOP_UNION
+                && !(isA(child, SetOperator) && ((SetOperator *) child)->setOpType == SETOP_UNION)
+                && isIndependentSubgraph(child))
+        {
+            SubgraphTask *t = NEW(SubgraphTask);
+
+            t->parent = op;
+            t->pos = pos;
+            t->op = child;
+            *tasks = appendToTailOfList(*tasks, t);
+        }
+        else
+            findIndependentSubgraphs(child, visited, tasks);
+        pos++;
+    }
+}
+
+/*
+ * A subgraph is independent if its root has a single parent and all parents
+ * of its other operators belong to the subgraph.
+ */
+static boolean
+isIndependentSubgraph (QueryOperator *root)
+{
+    Set *ops = PSET();
+
+    if (LIST_LENGTH(root->parents) != 1)
+        return FALSE;
+
+    collectSubgraph(root, ops);
+    if (setSize(ops) < MIN_PARALLEL_SUBGRAPH_OPS)
+        return FALSE;
+
+    FOREACH_SET(QueryOperator,op,ops)
+    {
+        if (op == root)
+            continue;
+        FOREACH(QueryOperator,p,op->parents)
+            if (!hasSetElem(ops, p))
+                return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void
+collectSubgraph (QueryOperator *op, Set *ops)
+{
+    if (hasSetElem(ops, op))
+        return;
+    addToSet(ops, op);
+
+    FOREACH(QueryOperator,child,op->inputs)
+        collectSubgraph(child, ops);
+}
+
+/*
+ * Run by a worker thread. An exception is recorded in the task and rethrown
+ * on the calling thread, because the worker has no try block of the caller to
+ * jump to.
+ */
+static void
+optimizeSubgraph (void *arg)
+{
+    SubgraphTask *t = (SubgraphTask *) arg;
+
+    TRY
+    {
+        t->op = applyHeuristicRules(t->op);
+        emptyProperty(t->op);
+    }
+    ON_EXCEPTION
+    {
+        // the exception may have been thrown while calling into the plugin
+        releasePluginLock();
+        t->failed = TRUE;
+        t->severity = currentExceptionSeverity();
+        t->errorMessage = currentExceptionToString();
+    }
+    END_ON_EXCEPTION_NO_PROCESSING
+}
+
+/*
+ * Copy an optimized subgraph out of the memory context of the worker that
+ * optimized it and replace the original input of the union with it.
+ */
+static void
+replaceSubgraph (void *arg)
+{
+    SubgraphTask *t = (SubgraphTask *) arg;
+    QueryOperator *op;
+
+    // the message is freed together with the worker's context
+    if (t->failed)
+    {
+        t->errorMessage = strdup(t->errorMessage);
+        return;
+    }
+
+    op = (QueryOperator *) copyObject(t->op);
+
+    // the union may refer to the subgraph's attributes by name
+    if (!equalStringList(getQueryOperatorAttrNames(op), t->attrNames))
+    {
+        QueryOperator *proj = createProjOnAllAttrs(op);
+
+        addChildOperator(proj, op);
+        FORBOTH_LC(aLc,nameLc,proj->schema->attrDefs,t->attrNames)
+            ((AttributeDef *) LC_P_VAL(aLc))->attrName = strdup(LC_P_VAL(nameLc));
+        op = proj;
+    }
+
+    LC_P_VAL(getNthOfList(t->parent->inputs, t->pos)) = op;
+    op->parents = singleton(t->parent);
+}
+
+/*
+ * Apply the heuristic optimization rules once.
+ */
+static QueryOperator *
+applyHeuristicRules (QueryOperator *rewrittenTree)
+{
+    int numRules = sizeof(heuristicRules) / sizeof(OptimizationRule);
+
+    if (getBoolOption(OPTION_OPTIMIZER_RULE_FIXPOINT))
+        return applyOptimizationRulesUntilFixpoint(rewrittenTree, heuristicRules, numRules);
+
+    return applyOptimizationRules(rewrittenTree, heuristicRules, numRules);
+}
+
+static QueryOperator *
+inferDuplicateRemovalProperties (QueryOperator *root)
+{
+    START_TIMER("PropertyInference - Keys");
+    computeKeyProp(root);
+    STOP_TIMER("PropertyInference - Keys");
+
+    // Set TRUE for each Operator
+    START_TIMER("PropertyInference - Set");
+    initializeSetProp(root);
+    // Set FALSE for root
+    setStringProperty(root, PROP_STORE_BOOL_SET, (Node *) createConstBool(FALSE));
+    computeSetProp(root);
+    STOP_TIMER("PropertyInference - Set");
+
+    return root;
+}
+
 QueryOperator *
 materializeProjectionSequences (QueryOperator *root)
 {
@@ -284,19 +517,49 @@ mergeAdjacentOperatorInternal (QueryOperator *root)
     return root;
 }
 
+/*
+ * Merge op with its child if both are selections or both are projections.
+ * Returns TRUE if op or one of the projections below it has been merged.
+ * Merging projections starts at the bottom of a sequence of projections,
+ * so lower projections may be merged even if op is not merged with its
+ * child.
+ */
+static boolean
+mergeAdjacentOperatorsAt (QueryOperator *op)
+{
+    QueryOperator *child = OP_LCHILD(op);
+    int numProj;
 
-QueryOperator *
-pushDownSelectionOperatorOnProv(QueryOperator *root)
+    if (LIST_LENGTH(child->parents) != 1)
+        return FALSE;
+
+    if (isA(op, SelectionOperator) && isA(child, SelectionOperator))
+        mergeSelection((SelectionOperator *) op);
+    else if (isA(op, ProjectionOperator) && isA(child, ProjectionOperator))
+    {
+        numProj = numProjectionsBelow(op);
+        mergeProjection((ProjectionOperator *) op);
+        return numProjectionsBelow(op) != numProj;
+    }
+
+    return OP_LCHILD(op) != child;
+}
+
+static int
+numProjectionsBelow (QueryOperator *op)
 {
-    QueryOperator *newRoot = root;
+    int result = 0;
 
-	if (isA(root, SelectionOperator) && isA(OP_LCHILD(root), ProjectionOperator))
-		newRoot = pushDownSelectionWithProjection((SelectionOperator *) root);
+    for(op = OP_LCHILD(op); isA(op, ProjectionOperator); op = OP_LCHILD(op))
+        result++;
 
-	FOREACH(QueryOperator, o, newRoot->inputs)
-		pushDownSelectionOperatorOnProv(o);
+    return result;
+}
 
-	return newRoot;
+QueryOperator *
+pushDownSelectionOperatorOnProv(QueryOperator *root)
+{
+    return pushDownSelections(root, FALSE);
 }
 
 QueryOperator *
@@ -313,6 +576,25 @@ factorAttrsInExpressions(QueryOperator *root)
     return root;
 }
 
+/*
+ * Factor attribute references in the expressions of a projection. Returns
+ * TRUE if an expression has been changed.
+ */
+static boolean
+factorAttrsInExpressionsAt (QueryOperator *op)
+{
+    List *before;
+
+    if (!isA(op, ProjectionOperator))
+        return FALSE;
+
+    // factoring rewrites nested expressions in place
+    before = (List *) copyObject(((ProjectionOperator *) op)->projExprs);
+    projectionFactorAttrReferences((ProjectionOperator *) op);
+
+    return !equal(before, ((ProjectionOperator *) op)->projExprs);
+}
+
 /*
  * Used in removeUnnecessaryWindowOperator to
  * reset pos in every operator above this operator
@@ -1720,92 +2002,7 @@ pullup(QueryOperator *op, List *duplicateattrs, List *normalAttrNames)
 QueryOperator *
 pushDownSelectionThroughJoinsOperatorOnProv(QueryOperator *root)
 {
-	QueryOperator *newRoot = root;
-	QueryOperator *child = OP_LCHILD(root);
-	List *opList = NIL;
-
-	if(isA(root, SelectionOperator) && isA(child, JoinOperator))
-	{
-//		Operator *c = (Operator *)((SelectionOperator *)newRoot)->cond;
-		opList = NIL;
-		getSelectionCondOperatorList(((SelectionOperator *)newRoot)->cond, &opList);
-
-		if(opList != NIL)
-			pushDownSelection(child, opList, newRoot, child);
-	}
-
-	FOREACH(QueryOperator, o, newRoot->inputs)
-     	pushDownSelectionThroughJoinsOperatorOnProv(o);
-
-	return newRoot;
-}
-
-void
-pushDownSelection(QueryOperator *root, List *opList, QueryOperator *r, QueryOperator *child)
-{
-
-    JoinOperator *newRoot = (JoinOperator *)root;
-
-    List *l1 = NIL;
-    List *l2 = NIL;
-    List *l3 = NIL;
-
-    QueryOperator *o1 = getHeadOfListP(newRoot->op.inputs);
-    QueryOperator *o2 = getTailOfListP(newRoot->op.inputs);
-
-    l1 = getCondOpList(o1->schema->attrDefs, opList);
-    l2 = getCondOpList(o2->schema->attrDefs, opList);
-
-    l3 = removeListElementsFromAnotherList(l1, opList);
-    l3 = removeListElementsFromAnotherList(l2, l3);
-
-    if(l3 != NIL)
-    {
-    		Node *opNode3 = changeListOpToAnOpNode(l3);
-    		((SelectionOperator *)r)->cond = (Node *)opNode3;
-    }
-    else
-    {
-        switchSubtrees((QueryOperator *) r, (QueryOperator *) child);
-    }
-
-    if(l1 != NIL)
-    {
-    	Node *opNode1 = changeListOpToAnOpNode(l1);
-    	SelectionOperator *newSo1 = createSelectionOp(opNode1, NULL, NIL,
-    			getAttrNames(o1->schema));
-
-    	// Switch the subtree with this newly created Selection operator.
-    	switchSubtrees((QueryOperator *) o1, (QueryOperator *) newSo1);
-
-    	// Add child to the newly created Selection operator.
-    	addChildOperator((QueryOperator *) newSo1, (QueryOperator *) o1);
-
-    	//set the data type
-    	setAttrDefDataTypeBasedOnBelowOp((QueryOperator *)newSo1, (QueryOperator *)o1);
-
-    	//reset the attr_ref position
-    	resetPosOfAttrRefBaseOnBelowLayerSchema((QueryOperator *)newSo1,(QueryOperator *)o1);
-    }
-
-    if(l2 != NIL)
-    {
-    	Node *opNode2 = changeListOpToAnOpNode(l2);
-    	SelectionOperator *newSo2 = createSelectionOp(opNode2, NULL, NIL,
-    			getAttrNames(o2->schema));
-
-    	// Switch the subtree with this newly created Selection operator.
-    	switchSubtrees((QueryOperator *) o2, (QueryOperator *) newSo2);
-
-    	// Add child to the newly created Selection operator.
-    	addChildOperator((QueryOperator *) newSo2, (QueryOperator *) o2);
-
-    	//set the data type
-    	setAttrDefDataTypeBasedOnBelowOp((QueryOperator *)newSo2, (QueryOperator *)o2);
-
-    	//reset the attr_ref position
-    	resetPosOfAttrRefBaseOnBelowLayerSchema((QueryOperator *)newSo2,(QueryOperator *)o2);
-    }
+    return pushDownSelections(root, TRUE);
 }
 
 QueryOperator *
@@ -0,0 +1,383 @@
+/*-----------------------------------------------------------------------------
+ *
+ * rule_scheduler.c
+ *		Apply a sequence of optimization rules to an operator graph.
+ *
+ *		The fixpoint scheduler keeps a work list of operators for each local
+ *		rule. Initially the work lists contain all operators of the graph.
+ *		Applying a local rule removes operators from its work list. Whenever
+ *		an operator is changed, the operator and its parents and inputs are
+ *		added to the work lists of all local rules. Rules that can only be
+ *		applied to the whole graph do not report what they have changed.
+ *		Instead the scheduler stores a fingerprint for each operator (a hash
+ *		of the operator ignoring its inputs, but including which operators
+ *		are its inputs and parents) and compares fingerprints before and
+ *		after applying such a rule. Fingerprints are only computed if a local
+ *		rule is applied afterwards.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "common.h"
+#include "log/logger.h"
+#include "mem_manager/mem_mgr.h"
+#include "configuration/option.h"
+#include "instrumentation/timing_instrumentation.h"
+#include "instrumentation/query_profile.h"
+#include "model/node/nodetype.h"
+#include "model/list/list.h"
+#include "model/set/set.h"
+#include "model/set/hashmap.h"
+#include "model/query_operator/query_operator.h"
+#include "model/query_operator/query_operator_model_checker.h"
+#include "operator_optimizer/rule_scheduler.h"
+
+#define OPTIMIZER_LOG_PREFIX "\n**********************************************" \
+		    "**************\n\tOPTIMIZATION STEP: "
+#define OPTIMIZER_LOG_POSTFIX "\n*********************************************" \
+		    "***************\n\n"
+#define LOG_RULE(rule,root) \
+    INFO_LOG(OPTIMIZER_LOG_PREFIX "%s" OPTIMIZER_LOG_POSTFIX "%s" \
+            OPTIMIZER_LOG_POSTFIX, (rule)->name, \
+            operatorToOverviewString((Node *) (root)))
+
+#define IS_LOCAL_RULE(s,i) ((s)->rules[i].applyToOp != NULL)
+
+typedef struct RuleSchedulerState
+{
+    OptimizationRule *rules;
+    int numRules;
+    int *ruleId;            // position of the first occurrence of a local rule
+    List **work;            // operators a local rule has to be applied to
+    Set **inWork;           // operators in the work list of a local rule
+    HashMap *fingerprints;  // operator -> fingerprint
+    List *ops;              // operators of the graph in pre-order
+    int *numApplications;
+    int *numChanges;
+    int *numChangedOps;
+} RuleSchedulerState;
+
+static QueryOperator *applyRuleToGraph (OptimizationRule *r, QueryOperator *root);
+static QueryOperator *applyLocalRule (RuleSchedulerState *s, int i, QueryOperator *root);
+static boolean hasLaterLocalRule (RuleSchedulerState *s, int i);
+static void detectChanges (RuleSchedulerState *s, int i, QueryOperator *root);
+static void computeFingerprints (RuleSchedulerState *s, QueryOperator *root);
+static void computeFingerprintsInternal (RuleSchedulerState *s, QueryOperator *op);
+static uint64_t fingerprintOperator (QueryOperator *op);
+static void refreshFingerprints (RuleSchedulerState *s, QueryOperator *op);
+static void addChangedOp (RuleSchedulerState *s, QueryOperator *op);
+static void addToWorkLists (RuleSchedulerState *s, QueryOperator *op);
+static void removeDeletedOps (RuleSchedulerState *s);
+static void reportRuleStatistics (RuleSchedulerState *s);
+
+/*
+ * Apply each active rule once to the whole graph.
+ */
+QueryOperator *
+applyOptimizationRules (QueryOperator *root, OptimizationRule *rules, int numRules)
+{
+    for(int i = 0; i < numRules; i++)
+        if (getBoolOption(rules[i].option))
+            root = applyRuleToGraph(rules + i, root);
+
+    return root;
+}
+
+/*
+ * Apply rules in order, local rules are only applied to operators changed
+ * since they have been applied the last time and are reapplied to operators
+ * around operators they have changed until no more changes occur.
+ */
+QueryOperator *
+applyOptimizationRulesUntilFixpoint (QueryOperator *root, OptimizationRule *rules,
+        int numRules)
+{
+    RuleSchedulerState *s = NEW(RuleSchedulerState);
+
+    s->rules = rules;
+    s->numRules = numRules;
+    s->ruleId = CNEW(int, numRules);
+    s->work = CNEW(List *, numRules);
+    s->inWork = CNEW(Set *, numRules);
+    s->numApplications = CNEW(int, numRules);
+    s->numChanges = CNEW(int, numRules);
+    s->numChangedOps = CNEW(int, numRules);
+
+    computeFingerprints(s, root);
+
+    // all operators have to be visited by the first application of a local rule
+    for(int i = 0; i < numRules; i++)
+    {
+        s->ruleId[i] = i;
+        if (!IS_LOCAL_RULE(s,i))
+            continue;
+
+        for(int j = 0; j < i; j++)
+            if (rules[j].applyToOp == rules[i].applyToOp)
+            {
+                s->ruleId[i] = j;
+                break;
+            }
+
+        if (s->ruleId[i] == i)
+        {
+            s->work[i] = copyList(s->ops);
+            s->inWork[i] = PSET();
+            FOREACH(QueryOperator,op,s->ops)
+                addToSet(s->inWork[i], op);
+        }
+    }
+
+    for(int i = 0; i < numRules; i++)
+    {
+        if (!getBoolOption(rules[i].option))
+            continue;
+
+        if (IS_LOCAL_RULE(s,i))
+            root = applyLocalRule(s, i, root);
+        else
+        {
+            root = applyRuleToGraph(rules + i, root);
+            s->numApplications[i]++;
+            if (hasLaterLocalRule(s, i))
+                detectChanges(s, i, root);
+        }
+    }
+
+    reportRuleStatistics(s);
+
+    return root;
+}
+
+static QueryOperator *
+applyRuleToGraph (OptimizationRule *r, QueryOperator *root)
+{
+    INFO_LOG("START: %s", r->name);
+    START_TIMER(r->timerName);
+    root = r->applyToGraph(root);
+    TIME_ASSERT(checkModel(root));
+    LOG_RULE(r, root);
+    DOT_TO_CONSOLE_WITH_MESSAGE(r->name, root);
+    STOP_TIMER(r->timerName);
+
+    return root;
+}
+
+/*
+ * Apply a local rule to all operators on its work list. If the rule changes
+ * an operator, then the operator and its neighbours are added to the work
+ * lists of all local rules (including this rule).
+ */
+static QueryOperator *
+applyLocalRule (RuleSchedulerState *s, int i, QueryOperator *root)
+{
+    OptimizationRule *r = s->rules + i;
+    int id = s->ruleId[i];
+
+    INFO_LOG("START: %s on %d operators", r->name, LIST_LENGTH(s->work[id]));
+    START_TIMER(r->timerName);
+    while(!MY_LIST_EMPTY(s->work[id]))
+    {
+        QueryOperator *op = (QueryOperator *) popHeadOfListP(s->work[id]);
+
+        removeSetElem(s->inWork[id], op);
+
+        // operators that have been merged into their parent have no inputs
+        if (op->inputs == NIL)
+            continue;
+
+        s->numApplications[i]++;
+        if (r->applyToOp(op))
+        {
+            s->numChanges[i]++;
+            s->numChangedOps[i]++;
+            refreshFingerprints(s, op);
+            addChangedOp(s, op);
+        }
+    }
+    TIME_ASSERT(checkModel(root));
+    LOG_RULE(r, root);
+    DOT_TO_CONSOLE_WITH_MESSAGE(r->name, root);
+    STOP_TIMER(r->timerName);
+
+    return root;
+}
+
+static boolean
+hasLaterLocalRule (RuleSchedulerState *s, int i)
+{
+    for(int j = i + 1; j < s->numRules; j++)
+        if (IS_LOCAL_RULE(s,j) && getBoolOption(s->rules[j].option))
+            return TRUE;
+
+    return FALSE;
+}
+
+/*
+ * Determine the operators changed by a rule that has been applied to the
+ * whole graph by comparing their fingerprints.
+ */
+static void
+detectChanges (RuleSchedulerState *s, int i, QueryOperator *root)
+{
+    HashMap *before = s->fingerprints;
+    int numChanged = 0;
+
+    START_TIMER("OptimizeModel - detect changed operators");
+    computeFingerprints(s, root);
+    FOREACH(QueryOperator,op,s->ops)
+    {
+        Constant *h = (Constant *) MAP_GET_POINTER(before, op);
+
+        if (h == NULL || LONG_VALUE(h) != LONG_VALUE(MAP_GET_POINTER(s->fingerprints, op)))
+        {
+            numChanged++;
+            addChangedOp(s, op);
+        }
+    }
+    removeDeletedOps(s);
+    STOP_TIMER("OptimizeModel - detect changed operators");
+
+    DEBUG_LOG("%s changed %d operators", s->rules[i].name, numChanged);
+    if (numChanged > 0)
+        s->numChanges[i]++;
+    s->numChangedOps[i] += numChanged;
+}
+
+static void
+computeFingerprints (RuleSchedulerState *s, QueryOperator *root)
+{
+    s->fingerprints = NEW_MAP(Constant,Constant);
+    s->ops = NIL;
+    computeFingerprintsInternal(s, root);
+}
+
+static void
+computeFingerprintsInternal (RuleSchedulerState *s, QueryOperator *op)
+{
+    if (MAP_HAS_POINTER(s->fingerprints, op))
+        return;
+
+    MAP_ADD_POINTER(s->fingerprints, op, createConstLong((gprom_long_t) fingerprintOperator(op)));
+    s->ops = appendToTailOfList(s->ops, op);
+
+    FOREACH(QueryOperator,child,op->inputs)
+        computeFingerprintsInternal(s, child);
+}
+
+/*
+ * Hash an operator without traversing into its inputs. Inputs and parents
+ * are represented by their addresses. Properties are ignored, because rules
+ * use them to store intermediate results.
+ */
+static uint64_t
+fingerprintOperator (QueryOperator *op)
+{
+    List *inputs = op->inputs;
+    List *parents = op->parents;
+    Node *properties = op->properties;
+    uint64_t h;
+
+    op->inputs = NIL;
+    op->parents = NIL;
+    op->properties = NULL;
+    h = hashValue(op);
+    op->inputs = inputs;
+    op->parents = parents;
+    op->properties = properties;
+
+    FOREACH(void,i,inputs)
+        h = h * 31 + (uint64_t) (gprom_long_t) i;
+    FOREACH(void,p,parents)
+        h = h * 37 + (uint64_t) (gprom_long_t) p;
+
+    return h;
+}
+
+/*
+ * Update the fingerprints of an operator changed by a local rule and of its
+ * neighbours, so the next rule applied to the whole graph is not blamed for
+ * these changes.
+ */
+static void
+refreshFingerprints (RuleSchedulerState *s, QueryOperator *op)
+{
+    MAP_ADD_POINTER(s->fingerprints, op, createConstLong((gprom_long_t) fingerprintOperator(op)));
+    FOREACH(QueryOperator,p,op->parents)
+        MAP_ADD_POINTER(s->fingerprints, p, createConstLong((gprom_long_t) fingerprintOperator(p)));
+    FOREACH(QueryOperator,c,op->inputs)
+        MAP_ADD_POINTER(s->fingerprints, c, createConstLong((gprom_long_t) fingerprintOperator(c)));
+}
+
+/*
+ * An operator has been changed: add it and its neighbours to the work lists
+ * of all local rules.
+ */
+static void
+addChangedOp (RuleSchedulerState *s, QueryOperator *op)
+{
+    addToWorkLists(s, op);
+    FOREACH(QueryOperator,p,op->parents)
+        addToWorkLists(s, p);
+    FOREACH(QueryOperator,c,op->inputs)
+        addToWorkLists(s, c);
+}
+
+static void
+addToWorkLists (RuleSchedulerState *s, QueryOperator *op)
+{
+    for(int i = 0; i < s->numRules; i++)
+    {
+        if (s->ruleId[i] != i || !IS_LOCAL_RULE(s,i))
+            continue;
+        if (!hasSetElem(s->inWork[i], op))
+        {
+            addToSet(s->inWork[i], op);
+            s->work[i] = appendToTailOfList(s->work[i], op);
+        }
+    }
+}
+
+/* remove operators that are no longer part of the graph from the work lists */
+static void
+removeDeletedOps (RuleSchedulerState *s)
+{
+    for(int i = 0; i < s->numRules; i++)
+    {
+        List *work = NIL;
+
+        if (s->ruleId[i] != i || !IS_LOCAL_RULE(s,i))
+            continue;
+
+        FOREACH(QueryOperator,op,s->work[i])
+        {
+            if (MAP_HAS_POINTER(s->fingerprints, op))
+                work = appendToTailOfList(work, op);
+            else
+                removeSetElem(s->inWork[i], op);
+        }
+        s->work[i] = work;
+    }
+}
+
+/* log and record how often each rule was applied and changed the graph */
+static void
+reportRuleStatistics (RuleSchedulerState *s)
+{
+    for(int i = 0; i < s->numRules; i++)
+    {
+        OptimizationRule *r = s->rules + i;
+
+        if (!getBoolOption(r->option))
+            continue;
+
+        INFO_LOG("rule %s: %d applications, %d changes, %d changed operators",
+                r->name, s->numApplications[i], s->numChanges[i], s->numChangedOps[i]);
+        PROFILE_INCR_COUNTER(CONCAT_STRINGS("rule ", r->name, " applications"),
+                s->numApplications[i]);
+        PROFILE_INCR_COUNTER(CONCAT_STRINGS("rule ", r->name, " changes"),
+                s->numChanges[i]);
+        PROFILE_INCR_COUNTER(CONCAT_STRINGS("rule ", r->name, " changed operators"),
+                s->numChangedOps[i]);
+    }
+}
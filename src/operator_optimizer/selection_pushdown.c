@@ -0,0 +1,360 @@
+/*-----------------------------------------------------------------------------
+ *
+ * selection_pushdown.c
+ *		Push conjuncts of selection conditions towards the leaves of a query.
+ *
+ *		The condition of a selection is split into conjuncts. Each conjunct
+ *		is pushed through the child of the selection if this does not change
+ *		the result of the query:
+ *
+ *		- projection: attribute references are replaced with the projection
+ *		  expressions they refer to
+ *		- aggregation: only conjuncts that reference group-by attributes are
+ *		  pushed (replaced with the group-by expressions)
+ *		- set operation and duplicate removal: the conjunct is pushed into
+ *		  every input (attributes are renamed by position)
+ *		- inner join and cross product: conjuncts that reference only one
+ *		  input are pushed into this input, conjuncts that reference both
+ *		  inputs become part of the join condition
+ *		- left (right) outer join: only conjuncts that reference the left
+ *		  (right) input are pushed
+ *		- selection: the conjunct is added to the condition of the child
+ *
+ *		Conjuncts that reference attributes of outer queries or no attributes
+ *		at all stay in place. Operators with more than one parent are never
+ *		changed, but a selection is added on the edge between an operator and
+ *		an input that is shared with other operators. Pushed conjuncts are
+ *		pushed further down recursively. Conjuncts that selection move-around
+ *		infers from equivalence classes (e.g., B = 1 for A = B and A = 1) are
+ *		pushed like any other conjunct if move-around is applied first.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "common.h"
+#include "log/logger.h"
+#include "mem_manager/mem_mgr.h"
+#include "model/node/nodetype.h"
+#include "model/list/list.h"
+#include "model/set/set.h"
+#include "model/expression/expression.h"
+#include "model/query_operator/query_operator.h"
+#include "operator_optimizer/selection_pushdown.h"
+#include "provenance_rewriter/prov_utility.h"
+#include "utility/string_utils.h"
+
+typedef struct PushdownState
+{
+    boolean throughJoins;       // push selections through joins
+    Set *visited;
+} PushdownState;
+
+// rewrite a conjunct of a selection into a conjunct over the inputs of the selection's child
+typedef struct RewriteAttrsContext
+{
+    List *inputs;               // inputs the rewritten conjunct references
+    int offset;                 // position of the first attribute of the first input
+    List *exprs;                // expressions replacing attribute references (NIL to rename them)
+} RewriteAttrsContext;
+
+static QueryOperator *pushDownSelectionsInternal (QueryOperator *op, PushdownState *state);
+static QueryOperator *pushDownSelectionAt (SelectionOperator *sel, PushdownState *state);
+static boolean pushConjunct (Node *c, QueryOperator *child, List **pushed, List **joinConds,
+        PushdownState *state);
+static SelectionOperator *addSelectionOnInput (QueryOperator *op, int pos, List *conds);
+static Node *rewriteAttrs (Node *c, List *inputs, int offset, List *exprs);
+static Node *rewriteAttrsMutator (Node *node, RewriteAttrsContext *context);
+
+/*
+ * Push down all selections of the graph rooted at root. Returns the new root
+ * of the graph which differs from root if root was a selection whose
+ * conjuncts have all been pushed down.
+ */
+QueryOperator *
+pushDownSelections (QueryOperator *root, boolean throughJoins)
+{
+    PushdownState *state = NEW(PushdownState);
+
+    state->throughJoins = throughJoins;
+    state->visited = PSET();
+
+    return pushDownSelectionsInternal(root, state);
+}
+
+static QueryOperator *
+pushDownSelectionsInternal (QueryOperator *op, PushdownState *state)
+{
+    if (hasSetElem(state->visited, op))
+        return op;
+
+    if (isA(op, SelectionOperator))
+        op = pushDownSelectionAt((SelectionOperator *) op, state);
+    addToSet(state->visited, op);
+
+    FOREACH(QueryOperator,child,op->inputs)
+        pushDownSelectionsInternal(child, state);
+
+    return op;
+}
+
+/*
+ * Push the conjuncts of the condition of a selection through its child.
+ * Returns the operator that replaces the selection in the graph, i.e., the
+ * child if all conjuncts have been pushed.
+ */
+static QueryOperator *
+pushDownSelectionAt (SelectionOperator *sel, PushdownState *state)
+{
+    QueryOperator *child = OP_LCHILD(sel);
+    QueryOperator *result = (QueryOperator *) sel;
+    int numInputs = LIST_LENGTH(child->inputs);
+    List **pushed;
+    List *conjuncts = NIL;
+    List *keep = NIL;
+    List *joinConds = NIL;
+    List *newSels = NIL;
+    boolean changed = FALSE;
+
+    // the child may be used by other operators
+    if (LIST_LENGTH(child->parents) != 1 || numInputs == 0)
+        return result;
+
+    pushed = (List **) CALLOC(sizeof(List *), numInputs);
+    splitConjuncts(sel->cond, &conjuncts);
+
+    FOREACH(Node,c,conjuncts)
+    {
+        if (pushConjunct(c, child, pushed, &joinConds, state))
+            changed = TRUE;
+        else
+            keep = appendToTailOfList(keep, c);
+    }
+
+    if (!changed)
+        return result;
+
+    DEBUG_LOG("push %d of %d conjuncts through %s",
+            LIST_LENGTH(conjuncts) - LIST_LENGTH(keep), LIST_LENGTH(conjuncts),
+            NodeTagToString(child->type));
+
+    // add pushed conjuncts to the child or to selections over its inputs
+    if (isA(child, SelectionOperator))
+    {
+        SelectionOperator *childSel = (SelectionOperator *) child;
+
+        childSel->cond = andExprList(CONCAT_LISTS(singleton(childSel->cond), pushed[0]));
+        newSels = singleton(childSel);
+    }
+    else
+    {
+        for(int i = 0; i < numInputs; i++)
+            if (pushed[i] != NIL)
+                newSels = appendToTailOfList(newSels,
+                        addSelectionOnInput(child, i, pushed[i]));
+    }
+
+    if (joinConds != NIL)
+    {
+        JoinOperator *j = (JoinOperator *) child;
+
+        if (j->cond != NULL)
+            joinConds = CONCAT_LISTS(singleton(j->cond), joinConds);
+        j->cond = andExprList(joinConds);
+        if (j->joinType == JOIN_CROSS)
+            j->joinType = JOIN_INNER;
+    }
+
+    // remove the selection if all conjuncts have been pushed
+    if (keep == NIL)
+    {
+        switchSubtrees((QueryOperator *) sel, child);
+        result = child;
+    }
+    else
+        sel->cond = andExprList(keep);
+
+    // the child may have been a selection that is removed in turn
+    FOREACH(SelectionOperator,s,newSels)
+    {
+        QueryOperator *replacement = pushDownSelectionAt(s, state);
+
+        if (result == (QueryOperator *) s)
+            result = replacement;
+    }
+
+    return result;
+}
+
+/*
+ * Determine where conjunct c of a selection over child is evaluated. The
+ * rewritten conjunct is added to pushed (one list per input of child) or to
+ * joinConds if it becomes part of the join condition. Returns FALSE if the
+ * conjunct cannot be pushed.
+ */
+static boolean
+pushConjunct (Node *c, QueryOperator *child, List **pushed, List **joinConds,
+        PushdownState *state)
+{
+    List *refs = getAttrReferences(c);
+    int numAttrs = getNumAttrs(child);
+    int minPos = numAttrs;
+    int maxPos = -1;
+
+    if (refs == NIL)
+        return FALSE;
+
+    FOREACH(AttributeReference,a,refs)
+    {
+        if (a->outerLevelsUp > 0 || a->fromClauseItem != 0
+                || a->attrPosition < 0 || a->attrPosition >= numAttrs)
+            return FALSE;
+        minPos = MIN(minPos, a->attrPosition);
+        maxPos = MAX(maxPos, a->attrPosition);
+    }
+
+    switch(child->type)
+    {
+        case T_SelectionOperator:
+        case T_DuplicateRemoval:
+            pushed[0] = appendToTailOfList(pushed[0],
+                    rewriteAttrs(c, child->inputs, 0, NIL));
+            return TRUE;
+        case T_ProjectionOperator:
+            pushed[0] = appendToTailOfList(pushed[0], rewriteAttrs(c, child->inputs, 0,
+                    ((ProjectionOperator *) child)->projExprs));
+            return TRUE;
+        case T_AggregationOperator:
+        {
+            AggregationOperator *agg = (AggregationOperator *) child;
+            int numAggrs = LIST_LENGTH(agg->aggrs);
+
+            // the conjunct has to reference only group-by attributes
+            if (minPos < numAggrs)
+                return FALSE;
+            pushed[0] = appendToTailOfList(pushed[0],
+                    rewriteAttrs(c, child->inputs, numAggrs, agg->groupBy));
+            return TRUE;
+        }
+        case T_SetOperator:
+        {
+            int i = 0;
+
+            FOREACH(QueryOperator,in,child->inputs)
+                if (getNumAttrs(in) != numAttrs)
+                    return FALSE;
+            FOREACH(QueryOperator,in,child->inputs)
+            {
+                pushed[i] = appendToTailOfList(pushed[i],
+                        rewriteAttrs(c, singleton(in), 0, NIL));
+                i++;
+            }
+            return TRUE;
+        }
+        case T_JoinOperator:
+        {
+            JoinType type = ((JoinOperator *) child)->joinType;
+            int numLeft = getNumAttrs(OP_LCHILD(child));
+            boolean left = (maxPos < numLeft);
+            boolean right = (minPos >= numLeft);
+
+            if (!state->throughJoins || numLeft + getNumAttrs(OP_RCHILD(child)) != numAttrs)
+                return FALSE;
+
+            if (left && (type == JOIN_INNER || type == JOIN_CROSS || type == JOIN_LEFT_OUTER))
+            {
+                pushed[0] = appendToTailOfList(pushed[0],
+                        rewriteAttrs(c, singleton(OP_LCHILD(child)), 0, NIL));
+                return TRUE;
+            }
+            if (right && (type == JOIN_INNER || type == JOIN_CROSS || type == JOIN_RIGHT_OUTER))
+            {
+                pushed[1] = appendToTailOfList(pushed[1],
+                        rewriteAttrs(c, singleton(OP_RCHILD(child)), numLeft, NIL));
+                return TRUE;
+            }
+            if (!left && !right && (type == JOIN_INNER || type == JOIN_CROSS))
+            {
+                *joinConds = appendToTailOfList(*joinConds,
+                        rewriteAttrs(c, child->inputs, 0, NIL));
+                return TRUE;
+            }
+            return FALSE;
+        }
+        default:
+            return FALSE;
+    }
+}
+
+/*
+ * Add a selection with condition conds between op and its input at position
+ * pos. Only this edge is changed if the input has other parents.
+ */
+static SelectionOperator *
+addSelectionOnInput (QueryOperator *op, int pos, List *conds)
+{
+    ListCell *lc = getNthOfList(op->inputs, pos);
+    QueryOperator *in = (QueryOperator *) LC_P_VAL(lc);
+    SelectionOperator *sel = createSelectionOp(andExprList(conds), in, singleton(op),
+            getQueryOperatorAttrNames(in));
+
+    sel->op.provAttrs = copyObject(in->provAttrs);
+    LC_P_VAL(lc) = sel;
+
+    // the input may be used twice by op (e.g., a self-join)
+    if (!searchList(op->inputs, in))
+        removeParent(in, op);
+    addParent(in, (QueryOperator *) sel);
+
+    return sel;
+}
+
+/*
+ * Copy of conjunct c where each reference to the attribute at position p
+ * (counting from offset) is replaced with the p-th expression of exprs or,
+ * if exprs is NIL, with a reference to the p-th attribute of the
+ * concatenation of inputs.
+ */
+static Node *
+rewriteAttrs (Node *c, List *inputs, int offset, List *exprs)
+{
+    RewriteAttrsContext *context = NEW(RewriteAttrsContext);
+
+    context->inputs = inputs;
+    context->offset = offset;
+    context->exprs = exprs;
+
+    return rewriteAttrsMutator(copyObject(c), context);
+}
+
+static Node *
+rewriteAttrsMutator (Node *node, RewriteAttrsContext *context)
+{
+    if (node == NULL)
+        return NULL;
+
+    if (isA(node, AttributeReference))
+    {
+        AttributeReference *a = (AttributeReference *) node;
+        int pos = a->attrPosition - context->offset;
+        int from = 0;
+
+        if (context->exprs != NIL)
+            return (Node *) copyObject(getNthOfListP(context->exprs, pos));
+
+        FOREACH(QueryOperator,in,context->inputs)
+        {
+            if (pos < getNumAttrs(in))
+                break;
+            pos -= getNumAttrs(in);
+            from++;
+        }
+        a->fromClauseItem = from;
+        a->attrPosition = pos;
+        a->name = strdup(getAttrNameByPos(
+                (QueryOperator *) getNthOfListP(context->inputs, from), pos));
+
+        return node;
+    }
+
+    return mutate(node, rewriteAttrsMutator, context);
+}
@@ -22,11 +22,15 @@
 #include "model/query_block/query_block.h"
 #include "model/query_operator/query_operator.h"
 #include "model/set/hashmap.h"
+#include "configuration/option.h"
+#include "instrumentation/timing_instrumentation.h"
 #include "parameterized_query/parameterized_queries.h"
 #include "sql_serializer/sql_serializer.h"
 #include "sql_serializer/sql_serializer_postgres.h"
+#include "utility/string_utils.h"
 
 #define PARAM_MAP_CONTEXT_NAME "parameterized_queries"
+#define PREPARED_REWRITE_PARAM_MARKER "_gprom_bind_"
 
 #define ENSURE_PARAM_EXISTS \
 	do { \
@@ -43,9 +47,13 @@ typedef struct QueryToTemplateContext {
 } QueryToTemplateContext;
 
 static HashMap *paramQueries = NULL;
+static HashMap *preparedRewrites = NULL;
 static MemContext *paramContext = NULL;
 static boolean queryToTemplateVisitor(Node *node, QueryToTemplateContext *state);
 static Node *queryToTemplateMutator(Node *n, QueryToTemplateContext *state);
+static List *splitSqlOnParameterMarkers(char *sql, List *params);
+static void checkBinds(char *name, ParameterizedQuery *pq, List *binds);
+static int compareParamPositions(const void **a, const void **b);
 
 void
 setupParameterizedQueryMap()
@@ -53,6 +61,7 @@ setupParameterizedQueryMap()
 	paramContext = NEW_LONGLIVED_MEMCONTEXT(PARAM_MAP_CONTEXT_NAME);
 	ACQUIRE_MEM_CONTEXT(paramContext);
 	paramQueries = NEW_MAP(Constant,ParameterizedQuery);
+	preparedRewrites = NEW_MAP(Constant,ParameterizedQuery);
 	RELEASE_MEM_CONTEXT();
 }
 
@@ -61,6 +70,7 @@ shutdownParameterizedQueryMap()
 {
 	FREE_MEM_CONTEXT(paramContext);
 	paramQueries = NULL;
+	preparedRewrites = NULL;
 	paramContext = NULL;
 }
 
@@ -119,6 +129,228 @@ queryToSqlTemplate(QueryOperator * op)
 	return sql;
 }
 
+/*
+ * Store the rewritten (and optimized) operator model of a query with
+ * parameters as a prepared rewrite. Besides the model we cache the SQL code
+ * generated for the model split at the parameters (sqlTemplate), e.g.,
+ * ["SELECT ... WHERE a = ", :1, " AND ..."], so binds can be applied by
+ * concatenating strings without rerunning any part of the rewrite pipeline.
+ */
+void
+createPreparedRewrite(char *name, Node *rewrittenQ, List *params)
+{
+	ParameterizedQuery *pq = makeNode(ParameterizedQuery);
+	List *markedParams;
+	Node *markedQ;
+	char *sql;
+
+	ENSURE_PARAM_EXISTS;
+
+	// parameters ordered by position, one per position
+	params = unique(params, compareParamPositions);
+	pq->q = copyObject(rewrittenQ);
+	pq->parameters = params;
+
+	// serialize copy of model with unique names for parameters to be able to find them in the SQL code
+	markedQ = copyObject(rewrittenQ);
+	markedParams = findParameters(markedQ);
+	FOREACH(SQLParameter,p,markedParams)
+	{
+		p->name = CONCAT_STRINGS(PREPARED_REWRITE_PARAM_MARKER, gprom_itoa(p->position), "_");
+	}
+	sql = serializeOperatorModel(markedQ);
+	pq->sqlTemplate = splitSqlOnParameterMarkers(sql, params);
+
+	DEBUG_NODE_BEATIFY_LOG("prepared rewrite is", pq);
+
+	// store in long lived context
+	ACQUIRE_MEM_CONTEXT(paramContext);
+	if (MAP_HAS_STRING_KEY(preparedRewrites, name))
+	{
+		removeMapStringElem(preparedRewrites, name);
+	}
+	MAP_ADD_STRING_KEY(preparedRewrites, name, copyObject(pq));
+	RELEASE_MEM_CONTEXT();
+}
+
+ParameterizedQuery *
+getPreparedRewrite(char *name)
+{
+	ENSURE_PARAM_EXISTS;
+	return (ParameterizedQuery *) getMapString(preparedRewrites, name);
+}
+
+boolean
+preparedRewriteExists(char *name)
+{
+	ENSURE_PARAM_EXISTS;
+	return MAP_HAS_STRING_KEY(preparedRewrites, name);
+}
+
+void
+removePreparedRewrite(char *name)
+{
+	ENSURE_PARAM_EXISTS;
+	ACQUIRE_MEM_CONTEXT(paramContext);
+	removeMapStringElem(preparedRewrites, name);
+	RELEASE_MEM_CONTEXT();
+}
+
+/*
+ * Instantiate a prepared rewrite for a list of binds (constants). Unless the
+ * user asked for substituting into the cached model, we just concatenate the
+ * cached SQL fragments and the SQL code for the binds.
+ */
+char *
+preparedRewriteApplyBinds(char *name, List *binds)
+{
+	ParameterizedQuery *pq;
+	char *result;
+
+	if (!preparedRewriteExists(name))
+	{
+		FATAL_LOG("no prepared rewrite with name %s exists", name);
+	}
+
+	pq = getPreparedRewrite(name);
+	checkBinds(name, pq, binds);
+
+	START_TIMER("PreparedRewrite - apply binds");
+	if (getBoolOption(OPTION_PREPARED_REWRITE_USE_MODEL))
+	{
+		Node *q = copyObject(pq->q);
+
+		q = setParameterValues(q, binds);
+		result = CONCAT_STRINGS(serializeOperatorModel(q), "\n");
+	}
+	else
+	{
+		StringInfo str = makeStringInfo();
+
+		FOREACH(Node,n,pq->sqlTemplate)
+		{
+			if (isA(n, SQLParameter))
+			{
+				SQLParameter *p = (SQLParameter *) n;
+				appendStringInfoString(str, CONST_TO_STRING(getNthOfListP(binds, p->position - 1)));
+			}
+			else
+			{
+				appendStringInfoString(str, STRING_VALUE(n));
+			}
+		}
+		appendStringInfoChar(str, '\n');
+
+		result = str->data;
+	}
+	STOP_TIMER("PreparedRewrite - apply binds");
+
+	DEBUG_LOG("instantiated prepared rewrite %s is:\n%s", name, result);
+
+	return result;
+}
+
+static void
+checkBinds(char *name, ParameterizedQuery *pq, List *binds)
+{
+	int numParams = 0;
+
+	FOREACH(SQLParameter,p,pq->parameters)
+	{
+		numParams = MAX(numParams, p->position);
+	}
+
+	if (LIST_LENGTH(binds) != numParams)
+	{
+		FATAL_LOG("prepared rewrite %s expects %u binds, but %u were provided",
+				  name,
+				  numParams,
+				  LIST_LENGTH(binds));
+	}
+
+	FOREACH(Node,b,binds)
+	{
+		if (!isA(b, Constant))
+		{
+			FATAL_LOG("binds for prepared rewrite %s have to be constants, but found: %s",
+					  name,
+					  beatify(nodeToString(b)));
+		}
+	}
+}
+
+/*
+ * Split SQL code into a list of string constants and SQL parameters. The SQL
+ * code was generated from a model where each parameter was renamed to
+ * PREPARED_REWRITE_PARAM_MARKER<position>_.
+ */
+static List *
+splitSqlOnParameterMarkers(char *sql, List *params)
+{
+	List *result = NIL;
+	char *marker = ":" PREPARED_REWRITE_PARAM_MARKER;
+	int markerLen = strlen(marker);
+	char *start = sql;
+	char *pos;
+
+	while((pos = strstr(start, marker)) != NULL)
+	{
+		SQLParameter *p = NULL;
+		int position;
+		int read = -1;
+
+		// read stays -1 if the position is not followed by _
+		if (sscanf(pos + markerLen, "%d_%n", &position, &read) != 1 || read < 0)
+		{
+			FATAL_LOG("malformed parameter marker in SQL template: %s", pos);
+		}
+
+		FOREACH(SQLParameter,par,params)
+		{
+			if (par->position == position)
+			{
+				p = copyObject(par);
+			}
+		}
+		if (p == NULL)
+		{
+			FATAL_LOG("SQL template refers to unknown parameter %d", position);
+		}
+
+		if (pos > start)
+		{
+			result = appendToTailOfList(result,
+										createConstString(substr(start, 0, pos - start - 1)));
+		}
+		result = appendToTailOfList(result, p);
+		start = pos + markerLen + read;
+	}
+
+	// remainder of the SQL code after the last parameter
+	if (*start != '\0')
+	{
+		result = appendToTailOfList(result, createConstString(start));
+	}
+
+	return result;
+}
+
+static int
+compareParamPositions(const void **a, const void **b)
+{
+	SQLParameter *p1 = (SQLParameter *) *a;
+	SQLParameter *p2 = (SQLParameter *) *b;
+
+	if (p1 == NULL || p2 == NULL)
+		return (p1 == p2) ? 0 : ((p1 == NULL) ? -1 : 1);
+	if (p1->position < p2->position)
+		return -1;
+	if (p1->position > p2->position)
+		return 1;
+
+	return 0;
+}
+
 static boolean
 queryToTemplateVisitor(Node *node, QueryToTemplateContext *state)
 {
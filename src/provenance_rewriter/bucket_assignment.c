@@ -0,0 +1,307 @@
+/*-----------------------------------------------------------------------------
+ *
+ * bucket_assignment.c
+ *		Expressions assigning values to buckets used by rewrites that map
+ *		tuples to ranges (provenance sketch capture, range compression).
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "common.h"
+
+#include "configuration/option.h"
+#include "log/logger.h"
+#include "mem_manager/mem_mgr.h"
+#include "model/expression/expression.h"
+#include "model/list/list.h"
+#include "model/node/nodetype.h"
+#include "provenance_rewriter/bucket_assignment.h"
+#include "provenance_sketches/sketch_functions.h"
+
+#define WIDTH_BUCKET_FUNC "width_bucket"
+
+static boolean allConstantBounds (List *bounds);
+static List *boundsOfType (List *bounds, DataType dt);
+static Node *caseTree (Node *value, Node **bounds, Node **results, int low, int high);
+
+/*
+ * Determine how to compute bucket numbers based on option bucket_assignment.
+ * For "auto" we use width_bucket on Postgres, the array search function on
+ * backends that register it natively (see sketch_functions.h), and CASE trees
+ * everywhere else. On other backends the array search function is only used
+ * if requested explicitly, since it has to be installed in the database.
+ */
+BucketAssignmentMethod
+getBucketAssignmentMethod(void)
+{
+    char *method = getStringOption(OPTION_BUCKET_ASSIGNMENT);
+
+    if (method == NULL || streq(method, BUCKET_ASSIGNMENT_AUTO))
+    {
+        if (getBackend() == BACKEND_POSTGRES)
+            return BUCKET_METHOD_WIDTH_BUCKET;
+        if (HAS_NATIVE_SKETCH_FUNCTIONS(getBackend()))
+            return BUCKET_METHOD_ARRAY_SEARCH;
+        return BUCKET_METHOD_CASE_TREE;
+    }
+    if (streq(method, BUCKET_ASSIGNMENT_WIDTH_BUCKET))
+        return BUCKET_METHOD_WIDTH_BUCKET;
+    if (streq(method, BUCKET_ASSIGNMENT_ARRAY_SEARCH))
+        return BUCKET_METHOD_ARRAY_SEARCH;
+    if (streq(method, BUCKET_ASSIGNMENT_CASE_TREE))
+        return BUCKET_METHOD_CASE_TREE;
+
+    FATAL_LOG("unknown bucket assignment method <%s>, expected one of %s, %s, %s, or %s",
+            method, BUCKET_ASSIGNMENT_AUTO, BUCKET_ASSIGNMENT_WIDTH_BUCKET,
+            BUCKET_ASSIGNMENT_ARRAY_SEARCH, BUCKET_ASSIGNMENT_CASE_TREE);
+    return BUCKET_METHOD_CASE_TREE;
+}
+
+Node *
+createBucketNumberExpr(Node *value, List *bounds)
+{
+    return createBucketNumberExprWithMethod(value, bounds, getBucketAssignmentMethod());
+}
+
+/*
+ * Create an expression that computes the bucket number of value. Methods that
+ * pass the bounds as an array literal fall back to a CASE tree if some bounds
+ * are not constants.
+ */
+Node *
+createBucketNumberExprWithMethod(Node *value, List *bounds, BucketAssignmentMethod method)
+{
+    int n = LIST_LENGTH(bounds);
+
+    bounds = boundsOfType(bounds, typeOf(value));
+    if (method != BUCKET_METHOD_CASE_TREE && !allConstantBounds(bounds))
+        method = BUCKET_METHOD_CASE_TREE;
+
+    switch(method)
+    {
+        // width_bucket returns the number of bounds <= value
+        case BUCKET_METHOD_WIDTH_BUCKET:
+        {
+            FunctionCall *f = createFunctionCall(WIDTH_BUCKET_FUNC,
+                    LIST_MAKE(copyObject(value),
+                            createConstString(boundsToArrayLiteral(bounds))));
+            return (Node *) createOpExpr("-", LIST_MAKE(f, createConstInt(1)));
+        }
+        // the SQL code generator subtracts 1 from the result of this function
+        case BUCKET_METHOD_ARRAY_SEARCH:
+            return (Node *) createFunctionCall(BINARY_SEARCH_ARRAY_POS_FUNC,
+                    LIST_MAKE(createConstString(boundsToArrayLiteral(bounds)),
+                            copyObject(value)));
+        case BUCKET_METHOD_CASE_TREE:
+        {
+            List *results = NIL;
+            Node *tree;
+
+            for(int i = -1; i < n; i++)
+                results = appendToTailOfList(results, createConstInt(i));
+            tree = createBucketLookupExpr(value, bounds, results);
+
+            // make sure NULL values are not assigned to a bucket
+            if (n > 0)
+                tree = (Node *) createCaseExpr(NULL,
+                        singleton(createCaseWhen(
+                                (Node *) createIsNullExpr(copyObject(value)),
+                                (Node *) createNullConst(DT_INT))),
+                        tree);
+            return tree;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Create a balanced tree of CASE expressions that returns results[i + 1] for
+ * values in bucket i, i.e., results has to have one more element than bounds.
+ * Elements of results that are NULL pointers become NULL constants. Each
+ * value is compared with O(log n) bounds.
+ */
+Node *
+createBucketLookupExpr(Node *value, List *bounds, List *results)
+{
+    int n = LIST_LENGTH(bounds);
+    Node **boundsA;
+    Node **resultsA;
+    DataType resultDT = DT_STRING;
+    int i;
+
+    ASSERT(LIST_LENGTH(results) == n + 1);
+
+    bounds = boundsOfType(bounds, typeOf(value));
+
+    FOREACH_LC(lc,results)
+    {
+        if (LC_P_VAL(lc) != NULL)
+        {
+            resultDT = typeOf(LC_P_VAL(lc));
+            break;
+        }
+    }
+
+    boundsA = MALLOC(sizeof(Node *) * (n + 1));
+    resultsA = MALLOC(sizeof(Node *) * (n + 1));
+
+    i = 0;
+    FOREACH(Node,b,bounds)
+        boundsA[i++] = b;
+
+    i = 0;
+    FOREACH_LC(lc,results)
+    {
+        Node *r = LC_P_VAL(lc);
+        resultsA[i++] = (r == NULL) ? (Node *) createNullConst(resultDT) : r;
+    }
+
+    return caseTree(value, boundsA, resultsA, 0, n);
+}
+
+/*
+ * Create a call of the native function that tests whether value belongs to a
+ * fragment whose bit is set in sketch (a bit string). Returns NULL if some
+ * bounds are not constants.
+ */
+Node *
+createSketchContainsExpr(Node *value, List *bounds, char *sketch)
+{
+    if (!allConstantBounds(bounds))
+        return NULL;
+
+    bounds = boundsOfType(bounds, typeOf(value));
+    return (Node *) createFunctionCall(SKETCH_FUN_CONTAINS,
+            LIST_MAKE(createConstString(sketch),
+                    createConstString(boundsToArrayLiteral(bounds)),
+                    copyObject(value)));
+}
+
+/*
+ * Translate a list of constant bounds into an array literal, e.g.,
+ * '{1,5,10}'. String values are quoted.
+ */
+char *
+boundsToArrayLiteral(List *bounds)
+{
+    StringInfo str = makeStringInfo();
+    int i = 0;
+
+    appendStringInfoChar(str, '{');
+    FOREACH(Constant,c,bounds)
+    {
+        if (i++ > 0)
+            appendStringInfoChar(str, ',');
+
+        switch(c->constType)
+        {
+            case DT_INT:
+                appendStringInfo(str, "%d", INT_VALUE(c));
+                break;
+            case DT_LONG:
+                appendStringInfo(str, "%ld", LONG_VALUE(c));
+                break;
+            case DT_FLOAT:
+                appendStringInfo(str, "%.17g", FLOAT_VALUE(c));
+                break;
+            case DT_BOOL:
+                appendStringInfoString(str, BOOL_VALUE(c) ? "true" : "false");
+                break;
+            case DT_STRING:
+            case DT_VARCHAR2:
+            {
+                appendStringInfoChar(str, '"');
+                for(char *s = STRING_VALUE(c); *s != '\0'; s++)
+                {
+                    if (*s == '"' || *s == '\\')
+                        appendStringInfoChar(str, '\\');
+                    appendStringInfoChar(str, *s);
+                }
+                appendStringInfoChar(str, '"');
+            }
+            break;
+        }
+    }
+    appendStringInfoChar(str, '}');
+
+    return str->data;
+}
+
+static boolean
+allConstantBounds (List *bounds)
+{
+    FOREACH(Node,b,bounds)
+    {
+        if (!isA(b, Constant) || CONST_IS_NULL(b))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+ * Bounds are often strings, e.g., histogram bounds read from the catalog.
+ * Convert string bounds of values of numeric type dt into numbers, otherwise
+ * '10' < '5' and values would be assigned to buckets in lexicographical
+ * order. Bounds that are not numbers are kept.
+ */
+static List *
+boundsOfType (List *bounds, DataType dt)
+{
+    List *result = NIL;
+
+    if (dt != DT_INT && dt != DT_LONG && dt != DT_FLOAT)
+        return bounds;
+
+    FOREACH(Node,b,bounds)
+    {
+        Constant *c = (Constant *) b;
+        char *end;
+
+        if (isA(b, Constant) && !CONST_IS_NULL(c)
+                && (c->constType == DT_STRING || c->constType == DT_VARCHAR2))
+        {
+            char *str = STRING_VALUE(c);
+            gprom_long_t l = strtoll(str, &end, 10);
+
+            // integer bounds of integer attributes stay integers
+            if (*str != '\0' && *end == '\0' && dt != DT_FLOAT)
+                b = (Node *) ((dt == DT_INT && l >= INT_MIN && l <= INT_MAX)
+                        ? createConstInt((int) l)
+                        : createConstLong(l));
+            else
+            {
+                double d = strtod(str, &end);
+
+                if (*str != '\0' && *end == '\0')
+                    b = (Node *) createConstFloat(d);
+            }
+        }
+        result = appendToTailOfList(result, b);
+    }
+
+    return result;
+}
+
+/*
+ * results[low] ... results[high] are the results for the buckets between
+ * bounds[low - 1] and bounds[high]. Split them at the bound in the middle.
+ */
+static Node *
+caseTree (Node *value, Node **bounds, Node **results, int low, int high)
+{
+    int mid;
+    Node *cond;
+
+    if (low == high)
+        return copyObject(results[low]);
+
+    mid = (low + high) / 2;
+    cond = (Node *) createOpExpr(OPNAME_LT, LIST_MAKE(copyObject(value),
+            copyObject(bounds[mid])));
+
+    return (Node *) createCaseExpr(NULL,
+            singleton(createCaseWhen(cond, caseTree(value, bounds, results, low, mid))),
+            caseTree(value, bounds, results, mid + 1, high));
+}
@@ -24,6 +24,7 @@
 #include "provenance_rewriter/coarse_grained/gc_prop_inference.h"
 #include "provenance_rewriter/coarse_grained/ge_prop_inference.h"
 #include "provenance_rewriter/coarse_grained/prop_inference.h"
+#include "provenance_sketches/sketch_functions.h"
 #include "model/list/list.h"
 #include "model/set/hashmap.h"
 #include "metadata_lookup/metadata_lookup.h"
@@ -31,6 +32,9 @@
 #include "parameterized_query/parameterized_queries.h"
 #include "sql_serializer/sql_serializer.h"
 #include "sql_serializer/sql_serializer_postgres.h"
+#include "instrumentation/query_profile.h"
+#include "instrumentation/timing_instrumentation.h"
+#include "model/set/set.h"
 
 
 
@@ -55,6 +59,9 @@ static HashMap *tempNoMap = NULL;
 static HashMap *psCellMap = NULL;
 static HashMap *histMap = NULL;
 
+/* capture queries of the ps info cached in this session: template Number -> (cparas -> capture query) */
+static HashMap *capPlanMap = NULL;
+
 typedef struct AggLevelContext
 {
 	HashMap *opCnts;
@@ -75,7 +82,6 @@ static void storePSInfoToTable();
 static void storeHist();
 static void initStoredTable();
 static int getTemplateNo();
-static List *getPSIfExists(QueryOperator *op);
 static List *getPSBasedOnTemplate(HashMap *map,HashMap *tnomap, char *pqSql, char *cparas);
 static boolean isExistTemplate(HashMap *map, char *pqSql);
 static boolean isExistTemplateNo(HashMap *cellMap, int tNo);
@@ -83,6 +89,15 @@ static HashMap *getParasMap(HashMap *tmap, HashMap* tnomap, char *pqSql);
 static List *charToParameters(char *cparas);
 static boolean removePSPropsVisitor(QueryOperator *op, void *context);
 static List *reuseCheckCachedPS(HashMap *tmap, HashMap *tnomap, char *pqSql, QueryOperator *q, HashMap *rmap);
+static boolean isMaintainableCapture(QueryOperator *op, boolean *hasAgg);
+static List *getTableAccessOps(QueryOperator *op, char *tableName);
+static void collectTableAccessOps(QueryOperator *op, char *tableName, Set *seen, List **result);
+static QueryOperator *renameToTableSchema(QueryOperator *delta, TableAccessOperator *t);
+static TableAccessOperator *getModifiedTable(QueryOperator *update, PSDeltaType *type);
+static QueryOperator *getInsertedRows(QueryOperator *update, TableAccessOperator *t);
+static void addDeltaPS(List *cells, QueryOperator *capOp, char *tableName, QueryOperator *delta);
+static void invalidateLoadedPS(char *tableName);
+static boolean sqlMentionsTable(char *sql, char *tableName);
 
 // Mem context
 #define PS_MEM_CONTEXT_NAME "PSMemContext"
@@ -199,7 +214,7 @@ getParasMap(HashMap *tmap, HashMap* tnomap, char *pqSql)
 	return map;
 }
 
-static List *
+List *
 getPSIfExists(QueryOperator *op)
 {
 	List *l = NIL;
@@ -543,6 +558,15 @@ addTopAggForCoarse(QueryOperator *op)
 				projExpr = appendToTailOfList(projExpr, f);
 			}
         }
+        // native sketch functions produce bit strings of the right length
+        else if(HAS_NATIVE_SKETCH_FUNCTIONS(getBackend()))
+        {
+			if(level == 0)
+				f = createFunctionCall(SKETCH_FUN_SET_BITS, LIST_MAKE(a, createConstInt(numFrags)));
+			else
+				f = createFunctionCall(SKETCH_FUN_BITOR_AGG, singleton(a));
+			projExpr = appendToTailOfList(projExpr, f);
+        }
 
         //FunctionCall *f = createFunctionCall ("BITORAGG", singleton(a));
         //projExpr = appendToTailOfList(projExpr, f);
@@ -1036,7 +1060,7 @@ getRangeList(int numRanges, char* attrName, char *tableName)
 	DEBUG_LOG("subRangeString : %s", subRangeString); //2,3,4,5,...,9999
 
 	StringInfo newRangeString = makeStringInfo();
-	appendStringInfo(newRangeString, "%s,%s,%s", minValue, subRangeString, maxV);
+	appendStringInfo(newRangeString, "%s,%s,%d", minValue, subRangeString, maxV);
 	DEBUG_LOG("newRangeString : %s", newRangeString->data);
 
 	char *p =  strtok(strdup(newRangeString->data),",");
@@ -1273,7 +1297,7 @@ getTemplateNo()
 		 char *t = STRING_VALUE(kv->key);
 
 		 //check the loaded templates
-		 if(!MAP_HAS_STRING_KEY(ltempNoMap, t))
+		 if(!isExistTemplate(ltempNoMap, t))
 			 tno++;
 	 }
 
@@ -1281,8 +1305,12 @@ getTemplateNo()
 }
 
 void
-cachePsInfo(QueryOperator *op, psInfo *psPara, HashMap *psMap)
+cachePsInfo(QueryOperator *op, psInfo *psPara, HashMap *psMap, QueryOperator *capOp)
 {
+	// no sketches have been loaded from the ps table
+	if(psMemContext == NULL)
+		psMemContext = NEW_LONGLIVED_MEMCONTEXT(PS_MEM_CONTEXT_NAME);
+
 	ACQUIRE_MEM_CONTEXT(psMemContext);
 	// get template SQL and parameters separated by comma (string)
 	ParameterizedQuery *pq = queryToTemplate((QueryOperator *) op);
@@ -1316,7 +1344,7 @@ cachePsInfo(QueryOperator *op, psInfo *psPara, HashMap *psMap)
 	}
 
 	//update tempNo if this query template is already loaded, we should use the same template number
-	if(MAP_HAS_STRING_KEY(ltempNoMap,pqSql))
+	if(isExistTemplate(ltempNoMap,pqSql))
 		tempNo = INT_VALUE(MAP_GET_STRING(ltempNoMap,pqSql));
 
 	//psCellMap: template Number -> paraMap (HashMap) : cparas -> psCell
@@ -1382,6 +1410,23 @@ cachePsInfo(QueryOperator *op, psInfo *psPara, HashMap *psMap)
 		}
 
 		MAP_ADD_STRING_KEY(paraMap,cparas,psCellList);
+
+		// keep the capture query to be able to maintain the ps when tables are modified
+		if(capOp != NULL)
+		{
+			HashMap *planMap = NULL;
+
+			if(capPlanMap == NULL)
+				capPlanMap = NEW_MAP(Constant, Node);
+			if(MAP_HAS_INT_KEY(capPlanMap, tempNo))
+				planMap = (HashMap *) MAP_GET_INT(capPlanMap, tempNo);
+			else
+			{
+				planMap = NEW_MAP(Constant, Node);
+				MAP_ADD_INT_KEY(capPlanMap, tempNo, planMap);
+			}
+			MAP_ADD_STRING_KEY(planMap, cparas, copyObject(capOp));
+		}
 	}
 
 	RELEASE_MEM_CONTEXT();
@@ -1402,3 +1447,472 @@ getPsSize(BitSet* psBitVector)
 
 	return psSize;
 }
+
+/*
+ * Maintain the cached provenance sketches for a modification of table
+ * tableName after the modification has been executed. For inserts, delta is
+ * a query returning the inserted rows which is evaluated over the modified
+ * database. The provenance sketch of a query Q(R) over the new database
+ * Q(R + delta) is the union of the sketch of Q(R) and the sketch of the rows of the result which are
+ * derived from the inserted rows as long as Q is monotone in the fragments
+ * of its inputs, i.e., for SPJ queries, unions, and aggregation that does not
+ * filter on aggregation results. For each access to R in the capture query we
+ * run the capture query with the access to R replaced with delta (all other
+ * accesses read the modified R) and add the result to the cached sketch. If
+ * delta is NULL for an insert, the inserted rows are unknown.
+ * Deletes keep sketches of such queries valid (they may become
+ * over-approximations). Sketches of all other queries that access the table
+ * are dropped and recaptured when the query is run again. Stored sketches
+ * loaded from the ps table are dropped too, since we do not know their
+ * capture queries.
+ */
+void
+maintainPSForDelta(char *tableName, QueryOperator *delta, PSDeltaType type)
+{
+	int numMaintained = 0;
+	int numDropped = 0;
+
+	if(!getBoolOption(OPTION_PS_MAINTAIN) || psMemContext == NULL)
+		return;
+
+	START_TIMER("PS - maintain provenance sketches");
+	DEBUG_LOG("maintain provenance sketches for %s on table %s",
+			PSDeltaTypeToString(type), tableName);
+
+	if(psCellMap == NULL)
+	{
+		ACQUIRE_MEM_CONTEXT(psMemContext);
+		psCellMap = NEW_MAP(Constant, Node);
+		RELEASE_MEM_CONTEXT();
+	}
+
+	FOREACH_HASH_ENTRY(tKv, psCellMap)
+	{
+		int tNo = INT_VALUE(tKv->key);
+		HashMap *paraMap = (HashMap *) tKv->value;
+		HashMap *planMap = NULL;
+		List *dropParas = NIL;
+
+		if(capPlanMap != NULL && MAP_HAS_INT_KEY(capPlanMap, tNo))
+			planMap = (HashMap *) MAP_GET_INT(capPlanMap, tNo);
+
+		FOREACH_HASH_ENTRY(kv, paraMap)
+		{
+			char *paras = STRING_VALUE(kv->key);
+			List *cells = (List *) kv->value;
+			QueryOperator *capOp = NULL;
+			boolean hasAgg = FALSE;
+
+			if(planMap != NULL && MAP_HAS_STRING_KEY(planMap, paras))
+				capOp = (QueryOperator *) MAP_GET_STRING(planMap, paras);
+
+			// capture query does not access the table
+			if(capOp != NULL && getTableAccessOps(capOp, tableName) == NIL)
+				continue;
+
+			if(capOp == NULL || (type == PS_DELTA_INSERT && delta == NULL)
+					|| !isMaintainableCapture(capOp, &hasAgg))
+			{
+				dropParas = appendToTailOfList(dropParas, paras);
+				continue;
+			}
+
+			if(type == PS_DELTA_INSERT)
+			{
+				addDeltaPS(cells, capOp, tableName, delta);
+				numMaintained++;
+			}
+		}
+
+		ACQUIRE_MEM_CONTEXT(psMemContext);
+		FOREACH(char,paras,dropParas)
+		{
+			DEBUG_LOG("drop cached ps for template %d with parameters %s", tNo, paras);
+			removeMapStringElem(paraMap, paras);
+			if(planMap != NULL)
+				removeMapStringElem(planMap, paras);
+			numDropped++;
+		}
+		RELEASE_MEM_CONTEXT();
+	}
+
+	invalidateLoadedPS(tableName);
+
+	PROFILE_INCR_COUNTER("ps_maintain.maintained", numMaintained);
+	PROFILE_INCR_COUNTER("ps_maintain.dropped", numDropped);
+	STOP_TIMER("PS - maintain provenance sketches");
+}
+
+/*
+ * Maintain the cached provenance sketches for rows of table tableName that are
+ * inserted or deleted. The delta table contains these rows and has the same
+ * attributes as the table.
+ */
+void
+maintainPSForDeltaTable(char *tableName, char *deltaTable, PSDeltaType type)
+{
+	List *attrs = getAttributes(tableName);
+	TableAccessOperator *delta;
+
+	delta = createTableAccessOp(strdup(deltaTable), NULL, NULL, NIL,
+			getAttrDefNames(attrs), getAttrDataTypes(attrs));
+
+	invalidateHistograms(tableName);
+	maintainPSForDelta(tableName, (QueryOperator *) delta, type);
+}
+
+/*
+ * Maintain the cached provenance sketches for a translated DML statement
+ * (see translate_update.c) after the statement has been executed
+ * successfully. The rows inserted by an INSERT are the second input of the
+ * union. An UPDATE is maintained as a delete of the old and an insert of the
+ * new versions of the updated rows. Cached histograms of the table are
+ * dropped. Returns FALSE if update is not a DML statement.
+ */
+boolean
+maintainPSForUpdate(QueryOperator *update)
+{
+	PSDeltaType type = PS_DELTA_INSERT;
+	TableAccessOperator *t = getModifiedTable(update, &type);
+	QueryOperator *delta = NULL;
+
+	if(t == NULL)
+		return FALSE;
+
+	// histograms used to compute range partitions are recomputed on next use
+	invalidateHistograms(t->tableName);
+	if(getStringOption(OPTION_PS_STORE_TABLE) == NULL)
+		return TRUE;
+
+	if(type == PS_DELTA_INSERT)
+		delta = getInsertedRows(update, t);
+
+	// if the new versions of updated rows are unknown, sketches are dropped
+	maintainPSForDelta(t->tableName,
+			(delta == NULL) ? NULL : renameToTableSchema(delta, t), type);
+
+	return TRUE;
+}
+
+/*
+ * Returns TRUE if op is a translated INSERT, UPDATE, or DELETE statement.
+ */
+boolean
+isTableModification(QueryOperator *op)
+{
+	PSDeltaType type;
+
+	return getModifiedTable(op, &type) != NULL;
+}
+
+/*
+ * Return the access to the table modified by a translated DML statement (or
+ * NULL if update is not a DML statement) and whether rows are inserted
+ * (INSERT and UPDATE) or only deleted.
+ */
+static TableAccessOperator *
+getModifiedTable(QueryOperator *update, PSDeltaType *type)
+{
+	*type = PS_DELTA_INSERT;
+
+	// INSERT: R UNION delta
+	if(isA(update, SetOperator) && LIST_LENGTH(update->inputs) == 2
+			&& isA(OP_LCHILD(update), TableAccessOperator)
+			&& HAS_STRING_PROP(OP_LCHILD(update), PROP_TABLE_IS_UPDATED))
+		return (TableAccessOperator *) OP_LCHILD(update);
+	// UPDATE with WHERE clause: PROJECTION(SELECTION(R)) UNION SELECTION(R)
+	if(isA(update, SetOperator) && LIST_LENGTH(update->inputs) == 2
+			&& isA(OP_LCHILD(update), ProjectionOperator)
+			&& isA(OP_LCHILD(OP_LCHILD(update)), SelectionOperator)
+			&& isA(OP_LCHILD(OP_LCHILD(OP_LCHILD(update))), TableAccessOperator)
+			&& HAS_STRING_PROP(OP_LCHILD(OP_LCHILD(OP_LCHILD(update))), PROP_TABLE_IS_UPDATED))
+		return (TableAccessOperator *) OP_LCHILD(OP_LCHILD(OP_LCHILD(update)));
+	// DELETE: SELECTION(R)
+	if(isA(update, SelectionOperator)
+			&& isA(OP_LCHILD(update), TableAccessOperator)
+			&& HAS_STRING_PROP(OP_LCHILD(update), PROP_TABLE_IS_UPDATED))
+	{
+		*type = PS_DELTA_DELETE;
+		return (TableAccessOperator *) OP_LCHILD(update);
+	}
+	// UPDATE without WHERE clause or with CASE: PROJECTION(R)
+	if(isA(update, ProjectionOperator)
+			&& isA(OP_LCHILD(update), TableAccessOperator)
+			&& HAS_STRING_PROP(OP_LCHILD(update), PROP_TABLE_IS_UPDATED))
+		return (TableAccessOperator *) OP_LCHILD(update);
+
+	return NULL;
+}
+
+/*
+ * Return a query over the modified database that returns the rows inserted
+ * by an INSERT or the new versions of the rows updated by an UPDATE. The
+ * updated rows are the rows fulfilling the WHERE clause (which is shared by
+ * all CASE expressions if the update is translated with CASE). This only
+ * holds after the update if the WHERE clause does not reference attributes
+ * assigned by the update, otherwise NULL is returned.
+ */
+static QueryOperator *
+getInsertedRows(QueryOperator *update, TableAccessOperator *t)
+{
+	ProjectionOperator *p;
+	Node *cond = NULL;
+	QueryOperator *r;
+	SelectionOperator *s;
+
+	// INSERT
+	if(isA(update, SetOperator) && isA(OP_LCHILD(update), TableAccessOperator))
+		return OP_RCHILD(update);
+
+	if(isA(update, SetOperator))
+	{
+		p = (ProjectionOperator *) OP_LCHILD(update);
+		cond = ((SelectionOperator *) OP_LCHILD(p))->cond;
+	}
+	else
+	{
+		p = (ProjectionOperator *) update;
+		FOREACH(Node,e,p->projExprs)
+		{
+			if(isA(e, CaseExpr))
+			{
+				CaseWhen *w = (CaseWhen *) getHeadOfListP(((CaseExpr *) e)->whenClauses);
+				cond = w->when;
+				break;
+			}
+		}
+	}
+
+	r = (QueryOperator *) createTableAccessOp(strdup(t->tableName), NULL,
+			strdup(t->tableName), NIL, getQueryOperatorAttrNames((QueryOperator *) t),
+			getDataTypes(((QueryOperator *) t)->schema));
+
+	// all rows are updated
+	if(cond == NULL)
+		return r;
+
+	FOREACH(AttributeReference,a,getAttrReferences(cond))
+	{
+		Node *e = (Node *) getNthOfListP(p->projExprs, a->attrPosition);
+
+		if(!isA(e, AttributeReference) || ((AttributeReference *) e)->attrPosition != a->attrPosition)
+		{
+			DEBUG_LOG("WHERE clause of update references updated attribute %s", a->name);
+			return NULL;
+		}
+	}
+
+	s = createSelectionOp(copyObject(cond), r, NIL, getQueryOperatorAttrNames(r));
+	addParent(r, (QueryOperator *) s);
+
+	return (QueryOperator *) s;
+}
+
+/*
+ * A capture query can be maintained incrementally if it is monotone in the
+ * fragments of its inputs. We do not allow selections and joins on top of
+ * aggregations (they may filter on aggregation results, e.g., HAVING),
+ * set difference, nesting, window functions, and LIMIT. hasAgg is set to
+ * TRUE if op contains an aggregation.
+ */
+static boolean
+isMaintainableCapture(QueryOperator *op, boolean *hasAgg)
+{
+	boolean childHasAgg = FALSE;
+
+	*hasAgg = FALSE;
+
+	FOREACH(QueryOperator,c,op->inputs)
+	{
+		boolean cHasAgg = FALSE;
+
+		if(!isMaintainableCapture(c, &cHasAgg))
+			return FALSE;
+		childHasAgg = childHasAgg || cHasAgg;
+	}
+
+	switch(op->type)
+	{
+		case T_TableAccessOperator:
+		case T_ConstRelOperator:
+		case T_ProjectionOperator:
+		case T_DuplicateRemoval:
+		case T_OrderOperator:
+			break;
+		case T_AggregationOperator:
+			childHasAgg = TRUE;
+			break;
+		case T_SelectionOperator:
+		case T_JoinOperator:
+			if(childHasAgg)
+				return FALSE;
+			break;
+		case T_SetOperator:
+			if(((SetOperator *) op)->setOpType != SETOP_UNION)
+				return FALSE;
+			break;
+		default:
+			return FALSE;
+	}
+
+	*hasAgg = childHasAgg;
+	return TRUE;
+}
+
+static List *
+getTableAccessOps(QueryOperator *op, char *tableName)
+{
+	List *result = NIL;
+	Set *seen = PSET();
+
+	collectTableAccessOps(op, tableName, seen, &result);
+
+	return result;
+}
+
+static void
+collectTableAccessOps(QueryOperator *op, char *tableName, Set *seen, List **result)
+{
+	if(hasSetElem(seen, op))
+		return;
+	addToSet(seen, op);
+
+	if(isA(op, TableAccessOperator) && streq(((TableAccessOperator *) op)->tableName, tableName))
+		*result = appendToTailOfList(*result, op);
+
+	FOREACH(QueryOperator,c,op->inputs)
+		collectTableAccessOps(c, tableName, seen, result);
+}
+
+/*
+ * Return a copy of delta with a projection on top that renames the attributes
+ * to the attributes of the table access t.
+ */
+static QueryOperator *
+renameToTableSchema(QueryOperator *delta, TableAccessOperator *t)
+{
+	QueryOperator *d = (QueryOperator *) copyObject(delta);
+	List *projExprs = NIL;
+	ProjectionOperator *p;
+	int i = 0;
+
+	FOREACH(AttributeDef,a,d->schema->attrDefs)
+	{
+		projExprs = appendToTailOfList(projExprs,
+				createFullAttrReference(strdup(a->attrName), 0, i++, 0, a->dataType));
+	}
+
+	p = createProjectionOp(projExprs, d, NIL, getQueryOperatorAttrNames((QueryOperator *) t));
+	addParent(d, (QueryOperator *) p);
+
+	return (QueryOperator *) p;
+}
+
+/*
+ * Capture the sketch of the result rows derived from the inserted rows
+ * delta and add it to the cached ps cells.
+ */
+static void
+addDeltaPS(List *cells, QueryOperator *capOp, char *tableName, QueryOperator *delta)
+{
+	int numAccess = LIST_LENGTH(getTableAccessOps(capOp, tableName));
+	List *attrNames = getAttrNames(capOp->schema);
+
+	for(int i = 0; i < numAccess; i++)
+	{
+		QueryOperator *q = (QueryOperator *) copyObject(capOp);
+		QueryOperator *t = (QueryOperator *) getNthOfListP(getTableAccessOps(q, tableName), i);
+		HashMap *psMap;
+
+		// i-th access reads delta, all other accesses read the modified R
+		switchSubtrees(t, (QueryOperator *) copyObject(delta));
+
+		psMap = getPS(serializeOperatorModel((Node *) q), attrNames);
+
+		ACQUIRE_MEM_CONTEXT(psMemContext);
+		FOREACH(psInfoCell,c,cells)
+		{
+			char *ps;
+
+			if(!MAP_HAS_STRING_KEY(psMap, c->provTableAttr))
+				continue;
+
+			// no result row is derived from the inserted rows
+			ps = STRING_VALUE(MAP_GET_STRING(psMap, c->provTableAttr));
+			if(ps == NULL || strlen(ps) == 0)
+				continue;
+
+			c->ps = bitOr(c->ps, stringToBitset(ps));
+			c->psSize = getPsSize(c->ps);
+		}
+		RELEASE_MEM_CONTEXT();
+	}
+}
+
+/*
+ * Drop the stored provenance sketches of templates that access table
+ * tableName. We do not know the capture queries of stored sketches and,
+ * thus, cannot maintain them.
+ */
+static void
+invalidateLoadedPS(char *tableName)
+{
+	int numDropped = 0;
+
+	if(ltempNoMap == NULL || lpsCellMap == NULL)
+		return;
+
+	FOREACH_HASH_ENTRY(tKv, ltempNoMap)
+	{
+		char *pqSql = STRING_VALUE(tKv->key);
+		int tNo = INT_VALUE(tKv->value);
+		HashMap *paraMap;
+		List *paras;
+
+		if(!isExistTemplateNo(lpsCellMap, tNo) || !sqlMentionsTable(pqSql, tableName))
+			continue;
+
+		paraMap = (HashMap *) MAP_GET_INT(lpsCellMap, tNo);
+		paras = getKeys(paraMap);
+
+		ACQUIRE_MEM_CONTEXT(psMemContext);
+		FOREACH(Constant,p,paras)
+		{
+			DEBUG_LOG("drop stored ps for template %d with parameters %s", tNo, STRING_VALUE(p));
+			deletePsInfo(tNo, STRING_VALUE(p));
+			removeMapStringElem(paraMap, STRING_VALUE(p));
+			ASSERT(!MAP_HAS_STRING_KEY(paraMap, STRING_VALUE(p)));
+			numDropped++;
+		}
+		RELEASE_MEM_CONTEXT();
+	}
+
+	PROFILE_INCR_COUNTER("ps_maintain.dropped_stored", numDropped);
+}
+
+/*
+ * Does the SQL code contain an identifier that is equal (case insensitive) to
+ * the table name.
+ */
+static boolean
+sqlMentionsTable(char *sql, char *tableName)
+{
+	int len = strlen(tableName);
+	char *s = sql;
+
+	while(*s != '\0')
+	{
+		char *start = s;
+
+		while(isalnum((unsigned char) *s) || *s == '_' || *s == '$')
+			s++;
+
+		if(s - start == len && strncasecmp(start, tableName, len) == 0)
+			return TRUE;
+
+		if(s == start)
+			s++;
+	}
+
+	return FALSE;
+}
@@ -20,6 +20,7 @@
 #include "model/set/hashmap.h"
 #include "model/set/set.h"
 #include "model/datalog/datalog_model.h"
+#include "analysis_and_translate/analyze_dl.h"
 #include "provenance_rewriter/game_provenance/gp_bottom_up_program.h"
 #include "utility/string_utils.h"
 
@@ -61,6 +62,9 @@ static DLProgram *createInputDBprogram (DLProgram *p, DLAtom *question);
 
 static void enumerateRules (DLProgram *p);
 static List *removeVars (List *vars, List *remVars);
+static List *rulesMinus (List *rules, List *remRules);
+static HashMap *createRelToRulePosMap (List *rules, DLRule ***ruleArr);
+static DLRule *getNextRuleForRel (HashMap *relToRulePos, DLRule **ruleArr, char *rel, int *pos);
 boolean searchVars (List *vars, List *searVars);
 //static List *makeUniqueVarList (List *vars);
 static void setIDBBody (DLRule *r);
@@ -694,8 +698,9 @@ static List*createHeadRuleEdbGraphMoveRules(int getMatched, List* negedbRules, L
 
 		// remove over generated move rules
 		boolean goalChk = FALSE;
+		DLArgIndex *headArgs = createArgIndex(r->head->args);
 		List *newRuleHeadArgs = NIL;
-		List *boolArgs = removeVars(r->head->args, ruleArgs);
+		List *boolArgs = argIndexMinus(headArgs, ruleArgs);
 
 		// create a list for collecting rule id
 		int ruleId = INT_VALUE(getDLProp((DLNode *) r,DL_RULE_ID));
@@ -735,8 +740,8 @@ static List*createHeadRuleEdbGraphMoveRules(int getMatched, List* negedbRules, L
 						getNthOfListP(replaceBoolArgs, checkPos),
 						getNthOfListP(boolArgs, checkPos));
 
-				newRuleHeadArgs = removeVars(r->head->args,
-						removeVars(r->head->args, ruleArgs));
+				newRuleHeadArgs = argIndexMinus(headArgs,
+						argIndexMinus(headArgs, ruleArgs));
 				for (int k = 0; k < LIST_LENGTH(replaceBoolArgs); k++)
 					newRuleHeadArgs = appendToTailOfList(newRuleHeadArgs,
 							getNthOfListP(replaceBoolArgs, k));
@@ -748,8 +753,8 @@ static List*createHeadRuleEdbGraphMoveRules(int getMatched, List* negedbRules, L
 						copyObject(origAtom->args));
 				rExpr = createSkolemExpr(GP_NODE_RULE, ruleRel,
 						copyObject(
-								removeVars(r->head->args,
-										removeVars(r->head->args, ruleArgs))));
+								argIndexMinus(headArgs,
+										argIndexMinus(headArgs, ruleArgs))));
 				moveRule = createMoveRule(lExpr, rExpr, linkedHeadName,
 						copyObject(newRuleHeadArgs));
 				moveRules = appendToTailOfList(moveRules, moveRule);
@@ -804,8 +809,8 @@ static List*createHeadRuleEdbGraphMoveRules(int getMatched, List* negedbRules, L
 							// is goal won?
 							if (!ruleWon)
 							{
-	                            DEBUG_LOG("Only Boolean Args:%s", exprToSQL((Node * ) removeVars(r->head->args,ruleArgs), NULL, FALSE));
-	                            goalWon = BOOL_VALUE(getNthOfListP(removeVars(r->head->args,ruleArgs),goalPos));
+	                            DEBUG_LOG("Only Boolean Args:%s", exprToSQL((Node * ) argIndexMinus(headArgs, ruleArgs), NULL, FALSE));
+	                            goalWon = BOOL_VALUE(getNthOfListP(argIndexMinus(headArgs, ruleArgs),goalPos));
 
 	//							if (INT_VALUE(getDLProp((DLNode *) r,DL_RULE_ID))
 	//									== getMatched)
@@ -846,9 +851,9 @@ static List*createHeadRuleEdbGraphMoveRules(int getMatched, List* negedbRules, L
 									Node *lExpr = createSkolemExpr(GP_NODE_RULE,
 											ruleRel,
 											copyObject(
-													removeVars(r->head->args,
-															removeVars(
-																	r->head->args,
+													argIndexMinus(headArgs,
+															argIndexMinus(
+																	headArgs,
 																	ruleArgs))));
 	//								Node *rExpr = createSkolemExpr(GP_NODE_GOAL,
 	//										goalRel, copyObject(a->args));
@@ -892,10 +897,10 @@ static List*createHeadRuleEdbGraphMoveRules(int getMatched, List* negedbRules, L
 												createSkolemExpr(GP_NODE_RULE,
 														ruleRel,
 														copyObject(
-																removeVars(
-																		r->head->args,
-																		removeVars(
-																				r->head->args,
+																argIndexMinus(
+																		headArgs,
+																		argIndexMinus(
+																				headArgs,
 																				ruleArgs))));
 									else
 										lExpr = createSkolemExpr(GP_NODE_RULE,
@@ -1005,9 +1010,10 @@ static List*createTupleRuleGoalTupleGraphMoveRules(int getMatched, List* negedbR
                 strlen(NON_LINKED_POSTFIX));
 
         // remove over generated move rules
+        DLArgIndex *headArgs = createArgIndex(r->head->args);
         boolean goalChk = FALSE;
         List *newRuleHeadArgs = NIL;
-        List *boolArgs = removeVars(r->head->args, ruleArgs);
+        List *boolArgs = argIndexMinus(headArgs, ruleArgs);
 
         // create a list for collecting rule id
         int ruleId = INT_VALUE(getDLProp((DLNode *) r,DL_RULE_ID));
@@ -1047,8 +1053,8 @@ static List*createTupleRuleGoalTupleGraphMoveRules(int getMatched, List* negedbR
                         getNthOfListP(replaceBoolArgs, checkPos),
                         getNthOfListP(boolArgs, checkPos));
 
-                newRuleHeadArgs = removeVars(r->head->args,
-                        removeVars(r->head->args, ruleArgs));
+                newRuleHeadArgs = argIndexMinus(headArgs,
+                        argIndexMinus(headArgs, ruleArgs));
                 for (int k = 0; k < LIST_LENGTH(replaceBoolArgs); k++)
                     newRuleHeadArgs = appendToTailOfList(newRuleHeadArgs,
                             getNthOfListP(replaceBoolArgs, k));
@@ -1057,8 +1063,8 @@ static List*createTupleRuleGoalTupleGraphMoveRules(int getMatched, List* negedbR
 						copyObject(origAtom->args));
 				Node *rExpr = createSkolemExpr(GP_NODE_RULEHYPER, ruleRel,
 						copyObject(
-								removeVars(r->head->args,
-										removeVars(r->head->args, ruleArgs))));
+								argIndexMinus(headArgs,
+										argIndexMinus(headArgs, ruleArgs))));
 				DLRule *moveRule = createMoveRule(lExpr, rExpr, linkedHeadName,
 						copyObject(newRuleHeadArgs));
 				moveRules = appendToTailOfList(moveRules, moveRule);
@@ -1113,8 +1119,8 @@ static List*createTupleRuleGoalTupleGraphMoveRules(int getMatched, List* negedbR
 	                        // is goal won?
 	                        if (!ruleWon)
 	                        {
-	                            DEBUG_LOG("Only Boolean Args:%s", exprToSQL((Node * ) removeVars(r->head->args,ruleArgs), NULL, FALSE));
-	                            goalWon = BOOL_VALUE(getNthOfListP(removeVars(r->head->args,ruleArgs),goalPos));
+	                            DEBUG_LOG("Only Boolean Args:%s", exprToSQL((Node * ) argIndexMinus(headArgs, ruleArgs), NULL, FALSE));
+	                            goalWon = BOOL_VALUE(getNthOfListP(argIndexMinus(headArgs, ruleArgs),goalPos));
 
 	//                            if (INT_VALUE(getDLProp((DLNode *) r,DL_RULE_ID))
 	//                                    == getMatched)
@@ -1155,9 +1161,9 @@ static List*createTupleRuleGoalTupleGraphMoveRules(int getMatched, List* negedbR
 	                                Node *lExpr = createSkolemExpr(GP_NODE_RULEHYPER,
 	                                        ruleRel,
 	                                        copyObject(
-	                                                removeVars(r->head->args,
-	                                                        removeVars(
-	                                                                r->head->args,
+	                                                argIndexMinus(headArgs,
+	                                                        argIndexMinus(
+	                                                                headArgs,
 	                                                                ruleArgs))));
 	                                Node *rExpr = createSkolemExpr(GP_NODE_GOALHYPER,
 	                                        goalRel, copyObject(a->args));
@@ -1200,10 +1206,10 @@ static List*createTupleRuleGoalTupleGraphMoveRules(int getMatched, List* negedbR
 	                                            createSkolemExpr(GP_NODE_RULEHYPER,
 	                                                    ruleRel,
 	                                                    copyObject(
-	                                                            removeVars(
-	                                                                    r->head->args,
-	                                                                    removeVars(
-	                                                                            r->head->args,
+	                                                            argIndexMinus(
+	                                                                    headArgs,
+	                                                                    argIndexMinus(
+	                                                                            headArgs,
 	                                                                            ruleArgs))));
 	                                else
 	                                    lExpr = createSkolemExpr(GP_NODE_RULEHYPER,
@@ -1315,10 +1321,11 @@ static List*createTupleRuleTupleGraphMoveRules(int getMatched, List* negedbRules
         Node *rExpr = NULL;
         DLRule *moveRule;
         int goalPos = -1;
+        DLArgIndex *headArgs = createArgIndex(r->head->args);
 
         boolean goalChk = FALSE;
         List *newRuleHeadArgs = NIL;
-        List *boolArgs = removeVars(r->head->args, ruleArgs);
+        List *boolArgs = argIndexMinus(headArgs, ruleArgs);
 
         // create a list for collecting rule id
         int ruleId = INT_VALUE(getDLProp((DLNode *) r,DL_RULE_ID));
@@ -1357,8 +1364,8 @@ static List*createTupleRuleTupleGraphMoveRules(int getMatched, List* negedbRules
                         getNthOfListP(replaceBoolArgs, checkPos),
                         getNthOfListP(boolArgs, checkPos));
 
-            	newRuleHeadArgs = removeVars(r->head->args,
-                        removeVars(r->head->args, ruleArgs));
+            	newRuleHeadArgs = argIndexMinus(headArgs,
+                        argIndexMinus(headArgs, ruleArgs));
                 for (int k = 0; k < LIST_LENGTH(replaceBoolArgs); k++)
                     newRuleHeadArgs = appendToTailOfList(newRuleHeadArgs,
                             getNthOfListP(replaceBoolArgs, k));
@@ -1368,8 +1375,8 @@ static List*createTupleRuleTupleGraphMoveRules(int getMatched, List* negedbRules
 									   copyObject(origAtom->args));
 				rExpr = createSkolemExpr(GP_NODE_RULEHYPER, ruleRel,
 						copyObject(
-								removeVars(r->head->args,
-										removeVars(r->head->args, ruleArgs))));
+								argIndexMinus(headArgs,
+										argIndexMinus(headArgs, ruleArgs))));
 				moveRule = createMoveRule(lExpr, rExpr, linkedHeadName,
 						copyObject(newRuleHeadArgs));
 				moveRules = appendToTailOfList(moveRules, moveRule);
@@ -1382,8 +1389,8 @@ static List*createTupleRuleTupleGraphMoveRules(int getMatched, List* negedbRules
                                    copyObject(origAtom->args));
             rExpr = createSkolemExpr(GP_NODE_RULEHYPER, ruleRel,
                     copyObject(
-                            removeVars(r->head->args,
-                                    removeVars(r->head->args, ruleArgs))));
+                            argIndexMinus(headArgs,
+                                    argIndexMinus(headArgs, ruleArgs))));
            	moveRule = createMoveRule(lExpr, rExpr, linkedHeadName,
            			r->head->args);
             moveRules = appendToTailOfList(moveRules, moveRule);
@@ -1427,8 +1434,8 @@ static List*createTupleRuleTupleGraphMoveRules(int getMatched, List* negedbRules
 
                             if (!ruleWon)
                             {
-                                DEBUG_LOG("Only Boolean Args:%s", exprToSQL((Node * ) removeVars(r->head->args,ruleArgs), NULL, FALSE));
-                                goalWon = BOOL_VALUE(getNthOfListP(removeVars(r->head->args,ruleArgs),goalPos));
+                                DEBUG_LOG("Only Boolean Args:%s", exprToSQL((Node * ) argIndexMinus(headArgs, ruleArgs), NULL, FALSE));
+                                goalWon = BOOL_VALUE(getNthOfListP(argIndexMinus(headArgs, ruleArgs),goalPos));
 
     //                            if (INT_VALUE(getDLProp((DLNode *) r,DL_RULE_ID))
     //                                    == getMatched)
@@ -1554,11 +1561,12 @@ createTupleOnlyGraphMoveRules(int getMatched, List* negedbRules,
                 strlen(NON_LINKED_POSTFIX));
         Node *lExpr;
         Node *rExpr;
+        DLArgIndex *headArgs = createArgIndex(r->head->args);
         DLRule *moveRule;
         int goalPos = -1;
         boolean goalChk = FALSE;
         List *newRuleHeadArgs = NIL;
-        List *boolArgs = removeVars(r->head->args, ruleArgs);
+        List *boolArgs = argIndexMinus(headArgs, ruleArgs);
 
         // head atom
         lExpr = createSkolemExpr(GP_NODE_TUPLE, headRel,
@@ -1605,8 +1613,8 @@ createTupleOnlyGraphMoveRules(int getMatched, List* negedbRules,
                         getNthOfListP(replaceBoolArgs, checkPos),
                         getNthOfListP(boolArgs, checkPos));
 
-                newRuleHeadArgs = removeVars(r->head->args,
-                        removeVars(r->head->args, ruleArgs));
+                newRuleHeadArgs = argIndexMinus(headArgs,
+                        argIndexMinus(headArgs, ruleArgs));
                 for (int k = 0; k < LIST_LENGTH(replaceBoolArgs); k++)
                     newRuleHeadArgs = appendToTailOfList(newRuleHeadArgs,
                             getNthOfListP(replaceBoolArgs, k));
@@ -1644,8 +1652,8 @@ createTupleOnlyGraphMoveRules(int getMatched, List* negedbRules,
 
                             if (!ruleWon)
                             {
-                                DEBUG_LOG("Only Boolean Args:%s", exprToSQL((Node * ) removeVars(r->head->args,ruleArgs), NULL, FALSE));
-                                goalWon = BOOL_VALUE(getNthOfListP(removeVars(r->head->args,ruleArgs),goalPos));
+                                DEBUG_LOG("Only Boolean Args:%s", exprToSQL((Node * ) argIndexMinus(headArgs, ruleArgs), NULL, FALSE));
+                                goalWon = BOOL_VALUE(getNthOfListP(argIndexMinus(headArgs, ruleArgs),goalPos));
 
     //                            if (INT_VALUE(getDLProp((DLNode *) r,DL_RULE_ID))
     //                                    == getMatched)
@@ -1781,12 +1789,13 @@ static List*createGPReducedMoveRules(int getMatched, List* negedbRules, List* ed
 			char *ruleRel = CONCAT_STRINGS(
 					CONST_TO_STRING(DL_GET_PROP(r,DL_RULE_ID)),
 					ruleWon ? "_WON" : "_LOST");
+			DLArgIndex *headArgs = createArgIndex(r->head->args);
 			int i = INT_VALUE(DL_GET_PROP(r,DL_RULE_ID));
 			int j = 1;
 			char *linkedHeadName = strRemPostfix(strdup(r->head->rel),
 					strlen(NON_LINKED_POSTFIX));
 
-			List *boolArgs = removeVars(r->head->args,ruleArgs);
+			List *boolArgs = argIndexMinus(headArgs, ruleArgs);
 			DEBUG_LOG("boolArgs for rule:%s", exprToSQL((Node * ) boolArgs, NULL, FALSE));
 
 			for(int boolPos = 0; boolPos < LIST_LENGTH(boolArgs); boolPos++)
@@ -1995,13 +2004,14 @@ static List*createGPReducedMoveRules(int getMatched, List* negedbRules, List* ed
 	                ruleWon ? "_WON" : "_LOST");
 	        int i = INT_VALUE(DL_GET_PROP(r,DL_RULE_ID));
 	        int j = 0;
+	        DLArgIndex *headArgs = createArgIndex(r->head->args);
 	        char *linkedHeadName = strRemPostfix(strdup(r->head->rel),
 	                strlen(NON_LINKED_POSTFIX));
 
 	        // remove over generated move rules
 	        boolean goalChk = FALSE;
 	        List *newRuleHeadArgs = NIL;
-	        List *boolArgs = removeVars(r->head->args, ruleArgs);
+	        List *boolArgs = argIndexMinus(headArgs, ruleArgs);
 
 	        // create a list for collecting rule id
 	        int ruleId = INT_VALUE(getDLProp((DLNode *) r,DL_RULE_ID));
@@ -2041,7 +2051,7 @@ static List*createGPReducedMoveRules(int getMatched, List* negedbRules, List* ed
 	                        getNthOfListP(replaceBoolArgs, checkPos),
 	                        getNthOfListP(boolArgs, checkPos));
 
-	                newRuleHeadArgs = removeVars(r->head->args, removeVars(r->head->args, ruleArgs));
+	                newRuleHeadArgs = argIndexMinus(headArgs, argIndexMinus(headArgs, ruleArgs));
 	                for (int k = 0; k < LIST_LENGTH(replaceBoolArgs); k++)
 	                    newRuleHeadArgs = appendToTailOfList(newRuleHeadArgs,
 	                            getNthOfListP(replaceBoolArgs, k));
@@ -2053,8 +2063,8 @@ static List*createGPReducedMoveRules(int getMatched, List* negedbRules, List* ed
 		                        copyObject(origAtom->args));
 		                Node *rExpr = createSkolemExpr(GP_NODE_RULE, ruleRel,
 		                        copyObject(
-		                                removeVars(r->head->args,
-		                                        removeVars(r->head->args, ruleArgs))));
+		                                argIndexMinus(headArgs,
+		                                        argIndexMinus(headArgs, ruleArgs))));
 		                DLRule *moveRule = createMoveRule(lExpr, rExpr, linkedHeadName,
 		                		copyObject(newRuleHeadArgs));
 		                moveRules = appendToTailOfList(moveRules, moveRule);
@@ -2069,8 +2079,8 @@ static List*createGPReducedMoveRules(int getMatched, List* negedbRules, List* ed
 
 		            Node *lExpr = createSkolemExpr(GP_NODE_TUPLE, posHeadRel, copyObject(origAtom->args));
 		            Node *rExpr = createSkolemExpr(GP_NODE_RULE, posRuleRel, copyObject(
-                            removeVars(r->head->args,
-                                    removeVars(r->head->args, ruleArgs))));
+                            argIndexMinus(headArgs,
+                                    argIndexMinus(headArgs, ruleArgs))));
 		            DLRule *moveRule = createMoveRule(lExpr, rExpr, linkedHeadName, r->head->args);
 
 		            moveRules = appendToTailOfList(moveRules, moveRule);
@@ -2125,8 +2135,8 @@ static List*createGPReducedMoveRules(int getMatched, List* negedbRules, List* ed
 	                            // is goal won?
 	                            if (!ruleWon)
 	                            {
-	                                DEBUG_LOG("Only Boolean Args:%s", exprToSQL((Node * ) removeVars(r->head->args,ruleArgs), NULL, FALSE));
-	                                goalWon = BOOL_VALUE(getNthOfListP(removeVars(r->head->args,ruleArgs),goalPos));
+	                                DEBUG_LOG("Only Boolean Args:%s", exprToSQL((Node * ) argIndexMinus(headArgs, ruleArgs), NULL, FALSE));
+	                                goalWon = BOOL_VALUE(getNthOfListP(argIndexMinus(headArgs, ruleArgs),goalPos));
 	                            }
 	                            else
 	                                goalWon = TRUE;
@@ -2155,9 +2165,9 @@ static List*createGPReducedMoveRules(int getMatched, List* negedbRules, List* ed
 	                                    Node *lExpr = createSkolemExpr(GP_NODE_RULE,
 	                                            ruleRel,
 	                                            copyObject(
-	                                                    removeVars(r->head->args,
-	                                                            removeVars(
-	                                                                    r->head->args,
+	                                                    argIndexMinus(headArgs,
+	                                                            argIndexMinus(
+	                                                                    headArgs,
 	                                                                    ruleArgs))));
 	                                    Node *rExpr = createSkolemExpr(GP_NODE_GOAL,
 	                                            goalRel, copyObject(a->args));
@@ -2209,10 +2219,10 @@ static List*createGPReducedMoveRules(int getMatched, List* negedbRules, List* ed
 	                                                createSkolemExpr(GP_NODE_RULE,
 	                                                        ruleRel,
 	                                                        copyObject(
-	                                                                removeVars(
-	                                                                        r->head->args,
-	                                                                        removeVars(
-	                                                                                r->head->args,
+	                                                                argIndexMinus(
+	                                                                        headArgs,
+	                                                                        argIndexMinus(
+	                                                                                headArgs,
 	                                                                                ruleArgs))));
 	                                    else
 	                                        lExpr = createSkolemExpr(GP_NODE_RULE,
@@ -2285,7 +2295,7 @@ static List*createGPReducedMoveRules(int getMatched, List* negedbRules, List* ed
 			        	char *posGoalRel = CONCAT_STRINGS(gprom_itoa(i), "_", gprom_itoa(g), "_WON");
 
 		                Node *lExpr = createSkolemExpr(GP_NODE_RULE,posRuleRel,
-		                		copyObject(removeVars(r->head->args,removeVars(r->head->args,ruleArgs))));
+		                		copyObject(argIndexMinus(headArgs, argIndexMinus(headArgs, ruleArgs))));
 		                Node *rExpr = createSkolemExpr(GP_NODE_GOAL,posGoalRel,copyObject(a->args));
 
 		                DLRule *moveRule = createMoveRule(lExpr, rExpr, linkedHeadName, copyObject(r->head->args));
@@ -2441,6 +2451,7 @@ createGPMoveRules(int getMatched, List* negedbRules,
                 CONST_TO_STRING(DL_GET_PROP(r,DL_RULE_ID)),
                 !ruleWon ? "_WON" : "_LOST");
         int i = INT_VALUE(DL_GET_PROP(r,DL_RULE_ID));
+        DLArgIndex *headArgs = createArgIndex(r->head->args);
         int j = 0;
         char *linkedHeadName = strRemPostfix(strdup(r->head->rel),
                 strlen(NON_LINKED_POSTFIX));
@@ -2448,7 +2459,7 @@ createGPMoveRules(int getMatched, List* negedbRules,
         // remove over generated move rules
         boolean goalChk = FALSE;
         List *newRuleHeadArgs = NIL;
-        List *boolArgs = removeVars(r->head->args, ruleArgs);
+        List *boolArgs = argIndexMinus(headArgs, ruleArgs);
 
         // create a list for collecting rule id
         int ruleId = INT_VALUE(getDLProp((DLNode *) r,DL_RULE_ID));
@@ -2488,8 +2499,8 @@ createGPMoveRules(int getMatched, List* negedbRules,
                         getNthOfListP(replaceBoolArgs, checkPos),
                         getNthOfListP(boolArgs, checkPos));
 
-                newRuleHeadArgs = removeVars(r->head->args,
-                        removeVars(r->head->args, ruleArgs));
+                newRuleHeadArgs = argIndexMinus(headArgs,
+                        argIndexMinus(headArgs, ruleArgs));
                 for (int k = 0; k < LIST_LENGTH(replaceBoolArgs); k++)
                     newRuleHeadArgs = appendToTailOfList(newRuleHeadArgs,
                             getNthOfListP(replaceBoolArgs, k));
@@ -2513,8 +2524,8 @@ createGPMoveRules(int getMatched, List* negedbRules,
 						copyObject(origAtom->args));
 				rExpr = createSkolemExpr(GP_NODE_RULE, ruleRel,
 						copyObject(
-								removeVars(r->head->args,
-										removeVars(r->head->args, ruleArgs))));
+								argIndexMinus(headArgs,
+										argIndexMinus(headArgs, ruleArgs))));
 				moveRule = createMoveRule(lExpr, rExpr, linkedHeadName,
 						copyObject(newRuleHeadArgs));
 				moveRules = appendToTailOfList(moveRules, moveRule);
@@ -2607,8 +2618,8 @@ createGPMoveRules(int getMatched, List* negedbRules,
 
 							if (!ruleWon)
 							{
-								DEBUG_LOG("Only Boolean Args:%s", exprToSQL((Node * ) removeVars(r->head->args,ruleArgs), NULL, FALSE));
-								goalWon = BOOL_VALUE(getNthOfListP(removeVars(r->head->args,ruleArgs),goalPos));
+								DEBUG_LOG("Only Boolean Args:%s", exprToSQL((Node * ) argIndexMinus(headArgs, ruleArgs), NULL, FALSE));
+								goalWon = BOOL_VALUE(getNthOfListP(argIndexMinus(headArgs, ruleArgs),goalPos));
 
 	//                        	if (INT_VALUE(getDLProp((DLNode *) r,DL_RULE_ID)) == getMatched)
 	//                            {
@@ -2629,9 +2640,9 @@ createGPMoveRules(int getMatched, List* negedbRules,
 									Node *lExpr = createSkolemExpr(GP_NODE_RULE,
 											ruleRel,
 											copyObject(
-													removeVars(r->head->args,
-															removeVars(
-																	r->head->args,
+													argIndexMinus(headArgs,
+															argIndexMinus(
+																	headArgs,
 																	ruleArgs))));
 									Node *rExpr = createSkolemExpr(GP_NODE_GOAL,
 											goalRel, copyObject(a->args));
@@ -2692,10 +2703,10 @@ createGPMoveRules(int getMatched, List* negedbRules,
 												createSkolemExpr(GP_NODE_RULE,
 														ruleRel,
 														copyObject(
-																removeVars(
-																		r->head->args,
-																		removeVars(
-																				r->head->args,
+																argIndexMinus(
+																		headArgs,
+																		argIndexMinus(
+																				headArgs,
 																				ruleArgs))));
 									else
 										lExpr = createSkolemExpr(GP_NODE_RULE,
@@ -2779,6 +2790,8 @@ rewriteSolvedProgram (DLProgram *solvedProgram)
     List *moveRules = NIL;
     List *newRuleArg = NIL;
     List *origProg = NIL;
+    HashMap *origRelToRulePos = NULL;
+    DLRule **origProgRules = NULL;
 	Set *adornedEDBAtoms = NODESET();
 	Set *adornedEDBHelpAtoms = NODESET();
     HashMap *idbAdToRules = NEW_MAP(Node,Node);
@@ -2801,6 +2814,7 @@ rewriteSolvedProgram (DLProgram *solvedProgram)
 	if(!MY_LIST_EMPTY(solvedProgram->doms))
 	{
 		origProg = solvedProgram->rules;
+		origRelToRulePos = createRelToRulePosMap(origProg, &origProgRules);
 		FOREACH(DLRule,a,origProg)
 			DL_SET_BOOL_PROP(a,DL_ORIGINAL_RULE);
 	}
@@ -4103,7 +4117,7 @@ rewriteSolvedProgram (DLProgram *solvedProgram)
 					removeRules = appendToTailOfList(removeRules,nRule);
 		}
 	}
-	newRules = removeVars(newRules,removeRules);
+	newRules = rulesMinus(newRules,removeRules);
 	DEBUG_LOG("newRules after removing:\n%s", datalogToOverviewString((Node *) newRules));
 
 	FOREACH(DLRule,r,unLinkedRules)
@@ -4392,26 +4406,27 @@ rewriteSolvedProgram (DLProgram *solvedProgram)
 							if (isA(arg,DLVar))
 							{
 								// check the head predicate and variable associated with which edb predicate and variable, respectively
-								FOREACH(DLRule,or,origProg)
+								// rules are visited in program order, but only rules for the current relation are probed
+								int rulePos = -1;
+								DLRule *or;
+
+								while((or = getNextRuleForRel(origRelToRulePos, origProgRules, bodyAtomRel, &rulePos)) != NULL)
 								{
-									if(streq(or->head->rel,bodyAtomRel))
+									FOREACH(Node,n,or->body)
 									{
-										FOREACH(Node,n,or->body)
+										if(isA(n,DLAtom))
 										{
-											if(isA(n,DLAtom))
-											{
-												int i = 0;
-												DLAtom *atom = (DLAtom *) n;
+											int i = 0;
+											DLAtom *atom = (DLAtom *) n;
 
-												FOREACH(Node,arg,atom->args)
+											FOREACH(Node,arg,atom->args)
+											{
+												if(isA(arg,DLVar) && searchListNode(or->head->args, arg))
 												{
-													if(isA(arg,DLVar) && searchListNode(or->head->args, arg))
-													{
-														bodyAtomRel = atom->rel;
-														varPosition = i;
-													}
-													i++;
+													bodyAtomRel = atom->rel;
+													varPosition = i;
 												}
+												i++;
 											}
 										}
 									}
@@ -5039,18 +5054,81 @@ setIDBBody (DLRule *r)
     }
 }
 
+/*
+ * Index rules by the predicate of their head. For each predicate we store the
+ * positions of its rules in the program, rules are returned through an array
+ * to allow constant time access by position.
+ */
+static HashMap *
+createRelToRulePosMap (List *rules, DLRule ***ruleArr)
+{
+    HashMap *result = NEW_MAP(Constant,List);
+    int pos = 0;
+
+    *ruleArr = (DLRule **) MALLOC(sizeof(DLRule *) * (LIST_LENGTH(rules) + 1));
+
+    FOREACH(DLRule,r,rules)
+    {
+        (*ruleArr)[pos] = r;
+        addToMapValueList(result,
+                          (Node *) createConstString(r->head->rel),
+                          (Node *) createConstInt(pos),
+                          FALSE);
+        pos++;
+    }
+
+    return result;
+}
+
+/*
+ * Return the first rule with head predicate rel that occurs after position
+ * pos in the program (pos is updated to the position of the returned rule).
+ * Returns NULL if there is no such rule.
+ */
+static DLRule *
+getNextRuleForRel (HashMap *relToRulePos, DLRule **ruleArr, char *rel, int *pos)
+{
+    List *positions;
+
+    if (relToRulePos == NULL)
+        return NULL;
+
+    positions = (List *) MAP_GET_STRING(relToRulePos, rel);
+
+    FOREACH(Constant,p,positions)
+    {
+        if (INT_VALUE(p) > *pos)
+        {
+            *pos = INT_VALUE(p);
+            return ruleArr[*pos];
+        }
+    }
+
+    return NULL;
+}
+
 static List *
 removeVars (List *vars, List *remVars)
 {
-    Set *rVars = NODESET();
+    return argsMinus(vars, remVars);
+}
+
+/*
+ * Remove rules from a list of rules. The argument index used by removeVars is
+ * meant for the arguments of a rule head, rules are compared using a set.
+ */
+static List *
+rulesMinus (List *rules, List *remRules)
+{
+    Set *rRules = NODESET();
     List *result = NIL;
 
-    FOREACH(Node,r,remVars)
-        addToSet(rVars,r);
+    FOREACH(Node,r,remRules)
+        addToSet(rRules,r);
 
-    FOREACH(Node,v,vars)
-        if(!hasSetElem(rVars,v))
-            result = appendToTailOfList(result, v);
+    FOREACH(Node,r,rules)
+        if(!hasSetElem(rRules,r))
+            result = appendToTailOfList(result, r);
 
     return result;
 }
@@ -5058,20 +5136,7 @@ removeVars (List *vars, List *remVars)
 boolean
 searchVars (List *vars, List *searVars)
 {
-    Set *sVars = NODESET();
-    List *result = NIL;
-
-    FOREACH(Node,r,vars)
-        addToSet(sVars,r);
-
-    FOREACH(Node,v,searVars)
-        if(hasSetElem(sVars,v))
-            result = appendToTailOfList(result, v);
-
-    if (LIST_LENGTH(result) == 0)
-    	return FALSE;
-    else
-    	return TRUE;
+    return argsOverlap(vars, searVars);
 }
 
 //static List *
@@ -5216,13 +5281,17 @@ enumerateRules (DLProgram *p)
 static DLProgram *
 unifyProgram (DLProgram *p, DLAtom *question)
 {
-    HashMap *predToRules = (HashMap *) getDLProp((DLNode *) p, DL_MAP_RELNAME_TO_RULES);
+    HashMap *predToRules;
     HashMap *predToUnRules = NEW_MAP(DLAtom, List);
     HashMap *newPredToRules = NEW_MAP(Constant,List);
 //    List *predRules;
     List *newRules = NIL;
     DLProgram *newP = makeNode(DLProgram);
 
+    // unification probes rules by the predicate of the atom to unify
+    ENSURE_REL_TO_RULE_MAP(p);
+    predToRules = (HashMap *) getDLProp((DLNode *) p, DL_MAP_RELNAME_TO_RULES);
+
 //    predRules = (List *) MAP_GET_STRING(predToRules, question->rel);
     DEBUG_LOG("using %s to unify program:\n%s",
             datalogToOverviewString((Node *) question),
@@ -16,6 +16,8 @@
 #include "provenance_rewriter/pi_cs_rewrites/pi_cs_main.h"
 #include "provenance_rewriter/prov_rewriter.h"
 #include "provenance_rewriter/prov_utility.h"
+#include "provenance_rewriter/bucket_assignment.h"
+#include "instrumentation/query_profile.h"
 #include "model/query_operator/query_operator.h"
 #include "model/query_operator/query_operator_model_checker.h"
 #include "model/query_operator/operator_property.h"
@@ -32,6 +34,7 @@
 #include "provenance_rewriter/transformation_rewrites/transformation_prov_main.h"
 #include "provenance_rewriter/semiring_combiner/sc_main.h"
 #include "provenance_rewriter/coarse_grained/coarse_grained_rewrite.h"
+#include "provenance_sketches/sketch_functions.h"
 #include "metadata_lookup/metadata_lookup.h"
 #include "temporal_queries/temporal_rewriter.h"
 
@@ -96,12 +99,7 @@ static QueryOperator *rewriteCoarseGrainedWindow(WindowOperator *op, PICSRewrite
 static QueryOperator *rewriteUseCoarseGrainedWindow(WindowOperator *op, PICSRewriteState *state);
 
 /* provenance sketch */
-static List* getCondList(AttributeReference *attr, List *rangeList);
-static List* getWhenList(List *condList);
-static List* getWhenListOracle(List *condList);
-static char* getBinarySearchArryList(List *rangeList);
-static Node* bsCaseWhen(AttributeReference *attr, List *l, int low, int high, char *s);
-static Node* baCaseWhenBar(AttributeReference *attr, List *l, int low, int high);
+static List* getFragmentValues(int numFrags);
 
 /* static Node *asOf; */
 /* static RelCount *nameState; */
@@ -1844,109 +1842,32 @@ rewritePI_CSJsonTableOp(JsonTableOperator *op, PICSRewriteState *state)
 	return (QueryOperator *) proj;
 }
 
-static char*
-getBinarySearchArryList(List *rangeList)
-{
-	//case -> binary search
-	StringInfo binary_element = makeStringInfo();
-	appendStringInfoString(binary_element,"{");
-
-	for(int i=0; i<=LIST_LENGTH(rangeList)-1; i++)
-	{
-		Constant *rangePoint = (Constant *)getNthOfListP(rangeList, i);
-		if(typeOf((Node *) rangePoint) == DT_INT)
-			appendStringInfo(binary_element, "%d", INT_VALUE(rangePoint));
-		else
-			appendStringInfo(binary_element, "%s", STRING_VALUE(rangePoint));
-
-		if(i != LIST_LENGTH(rangeList)-1)
-			appendStringInfoString(binary_element,",");
-	}
-	appendStringInfoString(binary_element,"}");
-	DEBUG_LOG("binary search array element: %s", binary_element->data);
-
-	return binary_element->data;
-}
-
-static List*
-getCondList(AttributeReference *attr, List *rangeList)
-{
-	List *condList = NIL;
-	for(int i=0; i<LIST_LENGTH(rangeList)-1; i++)
-	{
-		Operator *leftOperator = createOpExpr(">=", LIST_MAKE(copyObject(attr), copyObject(getNthOfListP(rangeList, i)) ));
-	 	Operator *rightOperator = createOpExpr("<", LIST_MAKE(copyObject(attr), copyObject(getNthOfListP(rangeList, i+1)) ));
-	 	Node *cond = AND_EXPRS((Node *) leftOperator, (Node *) rightOperator);
-	 	condList = appendToTailOfList(condList, cond);
-	}
-
-	return condList;
-}
-
-static List*
-getWhenListOracle(List *condList)
-{
-	List *whenList = NIL;
-	unsigned long long int power = 0;
-	for(int i=0; i<LIST_LENGTH(condList); i++)
-	{
-		Node *cond = (Node *) getNthOfListP(condList, i);
-		power = 1L << i;
-		DEBUG_LOG("power: %llu", power);
-		CaseWhen *when = createCaseWhen(cond, (Node *) createConstLong(power));
-		whenList = appendToTailOfList(whenList, when);
-	}
-
-	return whenList;
-}
-
-
+/*
+ * Value recorded for tuples that belong to a fragment: a number with only the
+ * bit for the fragment set for Oracle and a bit string for other backends.
+ */
 static List*
-getWhenList(List *condList)
+getFragmentValues(int numFrags)
 {
-	List *whenList = NIL;
-	for(int i=0; i<LIST_LENGTH(condList); i++)
-	{
-		Node *cond = (Node *) getNthOfListP(condList, i);
-		BitSet *bset = newBitSet(LIST_LENGTH(condList));
-		setBit(bset, i, TRUE);
-		char *cbset = bitSetToString(bset);
-
-		CaseWhen *when = createCaseWhen(cond, (Node *) createConstString(cbset));
-		whenList = appendToTailOfList(whenList, when);
-	}
-
-	return whenList;
-}
-
-static Node*
-baCaseWhenBar(AttributeReference *attr, List *l, int low, int high)
-{
-	StringInfo s1 = makeStringInfo();
-	int len = (high+8-1)/8; //ceil
+	List *values = NIL;
 
-	for(int i=0; i<len; i++)
+	for(int i=0; i<numFrags; i++)
 	{
-		appendStringInfo(s1, "-");
+		if(getBackend() == BACKEND_ORACLE)
+		{
+			unsigned long long int power = 1L << i;
+			DEBUG_LOG("power: %llu", power);
+			values = appendToTailOfList(values, createConstLong(power));
+		}
+		else
+		{
+			BitSet *bset = newBitSet(numFrags);
+			setBit(bset, i, TRUE);
+			values = appendToTailOfList(values, createConstString(bitSetToString(bset)));
+		}
 	}
-	return bsCaseWhen(attr,l,low,high, s1->data);
-}
 
-
-static Node*
-bsCaseWhen(AttributeReference *attr, List *l, int low, int high, char *s)
-{
-	if(low < high)
-	{
-		int mid = (low + high)/2;
-		Operator *oper = createOpExpr("<", LIST_MAKE(copyObject(attr), copyObject(getNthOfListP(l, mid)) ));
-		CaseWhen *when = createCaseWhen((Node *) oper, bsCaseWhen(attr,l,low,mid,s));
-		return (Node *) createCaseExpr(NULL, singleton(when), bsCaseWhen(attr,l,mid+1,high,s));
-	}
-	else
-	{
-		return (Node *) createConstString(s);
-	}
+	return values;
 }
 
 static QueryOperator *
@@ -2052,6 +1973,13 @@ rewriteCoarseGrainedWindow(WindowOperator *op, PICSRewriteState *state)
 				f = createFunctionCall(POSTGRES_FAST_BITOR_FUN, singleton(a));
 			}
     	}
+    	else if(HAS_NATIVE_SKETCH_FUNCTIONS(getBackend()))
+    	{
+			if(level == 1)
+				f = createFunctionCall(SKETCH_FUN_SET_BITS, LIST_MAKE(a, createConstInt(numFrags)));
+			else
+				f = createFunctionCall(SKETCH_FUN_BITOR_AGG, singleton(a));
+    	}
 
         tempWin->f = (Node *) f;
 
@@ -2198,7 +2126,6 @@ rewriteCoarseGrainedTableAccess(TableAccessOperator *op, PICSRewriteState *state
 
     //three cases: fragment or range or page
     List *newProvPosList = NIL;
-    FunctionCall *bsfc = NULL;
     List *psAttrList = (List *) getMapString(map, op->tableName);
 
     if(streq(psPara->psType, COARSE_GRAINED_RANGEB))
@@ -2217,39 +2144,27 @@ rewriteCoarseGrainedTableAccess(TableAccessOperator *op, PICSRewriteState *state
 			provAttrsOnly = singleton(createConstString(strdup(curPSAI->attrName)));
 			if(getBoolOption(OPTION_PS_BINARY_SEARCH))
 			{
-				//case -> binary search
-				char *bsArray = getBinarySearchArryList(curPSAI->rangeList);
-				DEBUG_LOG("bsArray: %s", bsArray);
-				bsfc = createFunctionCall ("binary_search_array_pos", LIST_MAKE(createConstString(bsArray),copyObject(pAttr)));
-//    				if(getBoolOption(OPTION_PS_SET_BITS))
-//    				{
-				projExpr = appendToTailOfList(projExpr, bsfc);
-//    				}
-//    				else
-//    				{
-//    					CastExpr *c = createCastExprOtherDT((Node *) createConstString("0"), "bit", LIST_LENGTH(curPSAI->rangeList)-1);
-//    					FunctionCall *setBit = createFunctionCall("set_bit", LIST_MAKE(c, bsfc));
-//    					projExpr = appendToTailOfList(projExpr, setBit);
-				//   				}
+				// fragment number, method depends on the backend (width_bucket, array search, CASE tree)
+				projExpr = appendToTailOfList(projExpr,
+						createBucketNumberExpr((Node *) pAttr, curPSAI->rangeList));
 			}
 			else if(getBoolOption(OPTION_PS_BINARY_SEARCH_CASE_WHEN))
 			{
-				CaseExpr *caseExpr = (CaseExpr *) baCaseWhenBar(pAttr,curPSAI->rangeList, 0, LIST_LENGTH(curPSAI->rangeList)-1);
-				projExpr = appendToTailOfList(projExpr, caseExpr);
+				projExpr = appendToTailOfList(projExpr,
+						createBucketNumberExprWithMethod((Node *) pAttr, curPSAI->rangeList,
+								BUCKET_METHOD_CASE_TREE));
 			}
 			else
 			{
-				List *condList = getCondList(pAttr, curPSAI->rangeList);
-				List *whenList = NIL;
-
-				if(getBackend() == BACKEND_ORACLE)
-					whenList = getWhenListOracle(condList);
-				else if(getBackend() == BACKEND_POSTGRES)
-					whenList = getWhenList(condList);
+				// one bit per fragment, values outside of all fragments are mapped to NULL
+				List *fragValues = getFragmentValues(LIST_LENGTH(curPSAI->rangeList) - 1);
+				Node *lookup;
 
-				CaseExpr *caseExpr = createCaseExpr(NULL, whenList, NULL);
+				fragValues = appendToHeadOfList(fragValues, NULL);
+				fragValues = appendToTailOfList(fragValues, NULL);
+				lookup = createBucketLookupExpr((Node *) pAttr, curPSAI->rangeList, fragValues);
 
-				projExpr = appendToTailOfList(projExpr, caseExpr);
+				projExpr = appendToTailOfList(projExpr, lookup);
 			}
 		}
     }
@@ -2350,6 +2265,14 @@ rewriteCoarseGrainedAggregation(AggregationOperator *op, PICSRewriteState *state
 				agg = appendToTailOfList(agg, f);
 			}
         }
+        else if(HAS_NATIVE_SKETCH_FUNCTIONS(getBackend()))
+        {
+			if(level == 1)
+				f = createFunctionCall(SKETCH_FUN_SET_BITS, LIST_MAKE(a, createConstInt(numFrags)));
+			else
+				f = createFunctionCall(SKETCH_FUN_BITOR_AGG, singleton(a));
+			agg = appendToTailOfList(agg, f);
+        }
     }
     //finish adapt schema (adapt provattrs)
     rewr->provAttrs = newProvAttrs;
@@ -2499,6 +2422,168 @@ rewriteUseCoarseGrainedAggregation (AggregationOperator *op, PICSRewriteState *s
 
 
 
+/*
+ * Choose how to filter a table with a provenance sketch on attribute attr.
+ * Few ranges of adjacent fragments are tested directly. If the sketch
+ * consists of many scattered fragments, then we compute the fragment of each
+ * tuple (O(log n) see bucket_assignment.h) and test it against an IN list of
+ * the fragments of the sketch, which the backend evaluates with a single hash
+ * lookup instead of a long disjunction. BRIN friendly containment predicates
+ * are used if requested.
+ */
+SketchUsePredicate
+chooseSketchUsePredicate(int numFrags, int numSelected, int numRanges)
+{
+	char *pred = getStringOption(OPTION_PS_USE_PREDICATE);
+
+	if(getBoolOption(OPTION_PS_USE_BRIN_OP) || (pred != NULL && streq(pred, PS_USE_PREDICATE_BRIN)))
+		return SKETCH_USE_BRIN;
+	if(pred != NULL && streq(pred, PS_USE_PREDICATE_RANGES))
+		return SKETCH_USE_RANGES;
+	if(pred != NULL && streq(pred, PS_USE_PREDICATE_IN_LIST))
+		return SKETCH_USE_IN_LIST;
+	if(pred != NULL && !streq(pred, PS_USE_PREDICATE_AUTO))
+		FATAL_LOG("unknown sketch use predicate <%s>, expected one of %s, %s, %s, or %s",
+				pred, PS_USE_PREDICATE_AUTO, PS_USE_PREDICATE_RANGES,
+				PS_USE_PREDICATE_IN_LIST, PS_USE_PREDICATE_BRIN);
+
+	// all fragments are needed
+	if(numSelected == numFrags && numFrags > 0)
+		return SKETCH_USE_NONE;
+	if(numRanges <= getIntOption(OPTION_PS_USE_MAX_RANGES))
+		return SKETCH_USE_RANGES;
+
+	return SKETCH_USE_IN_LIST;
+}
+
+/*
+ * Create the condition that filters a table with the sketch of curPSAI on
+ * attribute pAttr. Returns NULL if the sketch contains all fragments.
+ */
+Node *
+getSketchUseCond(AttributeReference *pAttr, psAttrInfo *curPSAI, char *sketchAttr)
+{
+	BitSet *bv = curPSAI->BitVector;
+	int numFrags = LIST_LENGTH(curPSAI->rangeList) - 1;
+	int numSelected = 0;
+	int numRanges = 0;
+	List *fragIds = NIL;
+	SketchUsePredicate pred;
+	Node *cond = NULL;
+
+	for(int i=0; i<bv->length; i++)
+	{
+		if(isBitSet(bv, i))
+		{
+			numSelected++;
+			fragIds = appendToTailOfList(fragIds, createConstInt(i));
+			if(!isBitSet(bv, i+1))
+				numRanges++;
+		}
+	}
+
+	pred = chooseSketchUsePredicate(numFrags, numSelected, numRanges);
+	DEBUG_LOG("sketch on %s: %d of %d fragments in %d ranges use %s",
+			sketchAttr, numSelected, numFrags, numRanges, SketchUsePredicateToString(pred));
+	PROFILE_INCR_COUNTER(CONCAT_STRINGS("ps_use_predicate.", SketchUsePredicateToString(pred)), 1);
+	PROFILE_INCR_COUNTER("ps_use_fragments", numSelected);
+
+	switch(pred)
+	{
+		case SKETCH_USE_NONE:
+			break;
+		case SKETCH_USE_RANGES:
+		case SKETCH_USE_BRIN:
+		{
+			// generate and combine each condition, e.g.,  33, 32, 31, 28, 27, 25 ->  31<=x<34 or 27<=x<29 or 25<=x<26
+			List *operatorList = NIL;
+			int ll=0, hh=1;
+			StringInfo brins = makeStringInfo();
+			appendStringInfoString(brins,"{");
+
+			for(int i=0; i<bv->length; i++)
+			{
+				if(isBitSet(bv, i))
+				{
+					if(isBitSet(bv, i+1))
+					{
+						hh++;
+						continue;
+					}
+
+					if(pred == SKETCH_USE_BRIN)
+					{
+						Constant *cur_brinl = (Constant *)getNthOfListP(curPSAI->rangeList, ll);
+						Constant *cur_brinh = (Constant *)getNthOfListP(curPSAI->rangeList, hh);
+						if(cur_brinl->constType == DT_INT)
+						{
+							appendStringInfo(brins, "%d,", INT_VALUE(cur_brinl));
+							appendStringInfo(brins, "%d,", INT_VALUE(cur_brinh));
+						}
+						else if(cur_brinl->constType == DT_STRING)
+						{
+							appendStringInfo(brins, "%s,", STRING_VALUE(cur_brinl));
+							appendStringInfo(brins, "%s,", STRING_VALUE(cur_brinh));
+						}
+					}
+					else
+					{
+						Operator *lOpr =  createOpExpr(">=", LIST_MAKE(copyObject(pAttr), copyObject(getNthOfListP(curPSAI->rangeList, ll))));
+						Operator *rOpr =  createOpExpr("<", LIST_MAKE(copyObject(pAttr), copyObject(getNthOfListP(curPSAI->rangeList, hh))));
+						Node *elOp = andExprList(LIST_MAKE(lOpr, rOpr));
+						operatorList = appendToTailOfList(operatorList, elOp);
+					}
+				}
+				ll = i+1;
+				hh = i+2;
+			}
+
+			if(pred == SKETCH_USE_BRIN)
+			{
+				if(!streq(brins->data,"{")) //used for the case if the query result is empty
+				{
+					removeTailingStringInfo(brins,1);
+					appendStringInfoString(brins,"}");
+					Constant *bsArray = createConstString(brins->data);
+					cond = (Node *) createOpExpr("<@", LIST_MAKE(copyObject(pAttr), bsArray));
+					DEBUG_LOG("brins cond: %s", brins->data);
+				}
+			}
+			else if(operatorList != NIL)
+				cond = orExprList(operatorList);
+			else
+				cond = (Node *) createConstBool(FALSE);
+		}
+		break;
+		case SKETCH_USE_IN_LIST:
+		{
+			// an empty IN list is not valid SQL, the empty sketch filters all rows
+			if(fragIds == NIL)
+			{
+				cond = (Node *) createConstBool(FALSE);
+				break;
+			}
+
+			// pass the whole sketch to the native membership test
+			if(HAS_NATIVE_SKETCH_FUNCTIONS(getBackend()))
+				cond = createSketchContainsExpr((Node *) pAttr, curPSAI->rangeList,
+						bitSetToString(bv));
+			if(cond != NULL)
+			{
+				DEBUG_NODE_BEATIFY_LOG("native sketch membership cond", cond);
+				break;
+			}
+
+			Node *frag = createBucketNumberExpr((Node *) pAttr, curPSAI->rangeList);
+			cond = (Node *) createQuantifiedComparison("ANY", frag, OPNAME_EQ, fragIds);
+			DEBUG_NODE_BEATIFY_LOG("fragment IN list cond", cond);
+		}
+		break;
+	}
+
+	return cond;
+}
+
 static QueryOperator *
 rewriteUseCoarseGrainedTableAccess(TableAccessOperator *op, PICSRewriteState *state)
 {
@@ -2610,8 +2695,8 @@ rewriteUseCoarseGrainedTableAccess(TableAccessOperator *op, PICSRewriteState *st
 			    newCond = orExprList(elList);
 			    DEBUG_NODE_BEATIFY_LOG("newCond ", newCond);
 			}
-			// Postgres backend
-			else if(getBackend() == BACKEND_POSTGRES)
+			// Postgres and backends with native sketch functions
+			else if(getBackend() == BACKEND_POSTGRES || HAS_NATIVE_SKETCH_FUNCTIONS(getBackend()))
 			{
 				if(HAS_STRING_PROP(op, AUTO_USE_PROV_COARSE_GRAINED_TABLEACCESS_MARK)) //or curPSAI->BitVector == NULL
 				{
@@ -2638,68 +2723,9 @@ rewriteUseCoarseGrainedTableAccess(TableAccessOperator *op, PICSRewriteState *st
 					}
 				}
 
-				// generate and combine each condition, e.g.,  33, 32, 31, 28, 27, 25 ->  31<=x<34 or 27<=x<29 or 25<=x<26
-				List *operatorList = NIL;
-				int ll=0, hh=1;
-				StringInfo brins = makeStringInfo();
-				appendStringInfoString(brins,"{");
-
-				int psSize = 0;
-				for(int i=0; i<curPSAI->BitVector->length; i++)
-				{
-					if(isBitSet(curPSAI->BitVector, i))
-					{
-						psSize ++;
-						if(isBitSet(curPSAI->BitVector, i+1))
-						{
-							hh++;
-							continue;
-						}
-
-						if(getBoolOption(OPTION_PS_USE_BRIN_OP))
-						{
-							Constant *cur_brinl = (Constant *)getNthOfListP(curPSAI->rangeList, ll);
-							Constant *cur_brinh = (Constant *)getNthOfListP(curPSAI->rangeList, hh);
-							if(cur_brinl->constType == DT_INT)
-							{
-								appendStringInfo(brins, "%d,", INT_VALUE(cur_brinl));
-								appendStringInfo(brins, "%d,", INT_VALUE(cur_brinh));
-							}
-							else if(cur_brinl->constType == DT_STRING)
-							{
-								appendStringInfo(brins, "%s,", STRING_VALUE(cur_brinl));
-								appendStringInfo(brins, "%s,", STRING_VALUE(cur_brinh));
-							}
-						}
-						else
-						{
-							Operator *lOpr =  createOpExpr(">=", LIST_MAKE(copyObject(pAttr), copyObject(getNthOfListP(curPSAI->rangeList, ll))));
-							Operator *rOpr =  createOpExpr("<", LIST_MAKE(copyObject(pAttr), copyObject(getNthOfListP(curPSAI->rangeList, hh))));
-							Node *elOp = andExprList(LIST_MAKE(lOpr, rOpr));
-							operatorList = appendToTailOfList(operatorList, elOp);
-						}
-					}
-					ll = i+1;
-					hh = i+2;
-				}
-
-				WARN_LOG("psSize %s: %d", newAttrName, psSize);
-
-				Node *curCond = NULL;
-				if(getBoolOption(OPTION_PS_USE_BRIN_OP))
-				{
-					if(!streq(brins->data,"{")) //used for the case if the query result is empty
-					{
-						removeTailingStringInfo(brins,1);
-						appendStringInfoString(brins,"}");
-						Constant *bsArray = createConstString(brins->data);
-						curCond = (Node *) createOpExpr("<@", LIST_MAKE(copyObject(pAttr), bsArray));
-						DEBUG_LOG("brins cond: %s", brins->data);
-					}
-				}
-				else
-					curCond = orExprList(operatorList);
-
+				Node *curCond = getSketchUseCond(pAttr, curPSAI, newAttrName);
+				if(curCond == NULL)
+					continue;
 				if(newCond == NULL)
 					newCond = curCond;
 				else
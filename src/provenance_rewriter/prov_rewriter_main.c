@@ -278,7 +278,7 @@ rewriteProvenanceComputation(ProvenanceComputation *op)
 					/* run capture sql and return a hashmap: (attrName, ps bit vector) key: PROV_nation1  value: "11111111111111" */
 					psMap = getPS(capSql,attrNames);
 					/* only cache ps after capture */
-					cachePsInfo(rootParaSql,psPara,psMap);
+					cachePsInfo(rootParaSql,psPara,psMap,capOp);
 				}
 				else
 					DEBUG_LOG("Find ps. ");
@@ -12,6 +12,7 @@
 #include "model/query_operator/query_operator_model_checker.h"
 #include "analysis_and_translate/translator_oracle.h"
 #include "provenance_rewriter/prov_utility.h"
+#include "provenance_rewriter/bucket_assignment.h"
 #include "provenance_rewriter/uncertainty_rewrites/uncert_rewriter.h"
 #include "utility/enum_magic.h"
 #include "utility/string_utils.h"
@@ -778,28 +779,20 @@ compressPosRow(QueryOperator *op, int n, char *attr)
 	List *projl = NIL;
 	FOREACH(char, n, attrnames){
 		if(strcmp(n,attr)==0 && range->length >=3){
-			List *cwhens = NIL;
 			range = sublist(range, 1, range->length-1);
 			INFO_LOG("divider range for %s is: %s", attr, nodeToString(range));
 			AttributeReference *tattr = getAttrRefByName(op, n);
-			Node *last = NULL;
-			FOREACH(Node, nd, range){
-				if(!last){
-					last = nd;
-					Node *whenexpr = (Node *)createOpExpr(OPNAME_GE, LIST_MAKE(tattr, nd));
-					cwhens = appendToTailOfList(cwhens, createCaseWhen(whenexpr, nd));
-				}
-				else{
-					Node *lbexpr = (Node *)createOpExpr(OPNAME_LT, LIST_MAKE(tattr, last));
-					INFO_LOG("lbexpr: %s",nodeToString(lbexpr));
-					Node *ubexpr = (Node *)createOpExpr(OPNAME_GE, LIST_MAKE(tattr, nd));
-					INFO_LOG("ubexpr: %s",nodeToString(lbexpr));
-					Node *whenexpr = (Node *)AND_EXPRS(lbexpr, ubexpr);
-					cwhens = appendToTailOfList(cwhens, createCaseWhen(whenexpr, nd));
-					last = nd;
-				}
-			}
-			projl = appendToTailOfList(projl, (Node *)createCaseExpr(NULL, cwhens, last));
+			// dividers are sorted descending, map values to the closest divider below them
+			// (values below the smallest divider and NULL values are mapped to the smallest divider)
+			List *lowerBounds = copyList(range);
+			reverseList(lowerBounds);
+			List *bounds = sublist(copyList(lowerBounds), 1, lowerBounds->length-1);
+			Node *lookup = createBucketLookupExpr((Node *) tattr, bounds, lowerBounds);
+			projl = appendToTailOfList(projl,
+					createCaseExpr(NULL,
+							singleton(createCaseWhen((Node *) createIsNullExpr(copyObject(tattr)),
+									copyObject(getHeadOfListP(lowerBounds)))),
+							lookup));
 		}
 		else {
 			projl = appendToTailOfList(projl, getAttrRefByName(op, n));
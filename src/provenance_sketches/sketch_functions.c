@@ -0,0 +1,286 @@
+/*
+ *------------------------------------------------------------------------------
+ *
+ * sketch_functions.c - Backend independent parts of native sketch functions
+ *
+ *     Parsing of fragment bounds, bucket search, and bit operations on
+ *     sketches used by the native sketch functions that the SQLite and
+ *     DuckDB plugins register.
+ *
+ *        AUTHOR: lord_pretzel
+ *        SUBDIR: src/provenance_sketches/
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "common.h"
+#include "provenance_sketches/sketch_functions.h"
+
+#define ALIGN_SIZE(_s) (((_s) + sizeof(double) - 1) & ~(sizeof(double) - 1))
+
+static int countElements (const char *literal);
+static const char *parseElement (const char *pos, char *out, boolean *quoted);
+
+/*
+ * Size of the memory block needed to store the bounds of an array literal:
+ * the struct, the numeric and string values, and a copy of the characters.
+ */
+size_t
+sketchBoundsSize(const char *literal)
+{
+    int n = countElements(literal);
+
+    return ALIGN_SIZE(sizeof(SketchBounds))
+            + n * (sizeof(double) + sizeof(char *))
+            + strlen(literal) + 1;
+}
+
+SketchBounds *
+parseSketchBounds(const char *literal, void *mem)
+{
+    SketchBounds *b = (SketchBounds *) mem;
+    int n = countElements(literal);
+    char *chars;
+    const char *pos = literal;
+
+    b->numBounds = n;
+    b->numeric = TRUE;
+    b->quoted = FALSE;
+    b->nums = (double *) (((char *) mem) + ALIGN_SIZE(sizeof(SketchBounds)));
+    b->strs = (char **) (b->nums + n);
+    chars = (char *) (b->strs + n);
+
+    while(*pos != '\0' && *pos != '{')
+        pos++;
+    if (*pos == '{')
+        pos++;
+
+    for(int i = 0; i < n; i++)
+    {
+        boolean quoted;
+        char *end;
+
+        pos = parseElement(pos, chars, &quoted);
+        b->strs[i] = chars;
+        chars += strlen(chars) + 1;
+
+        // quoted numbers are numbers too, e.g., bounds returned as text
+        b->quoted = b->quoted || quoted;
+        b->nums[i] = 0.0;
+        if (*b->strs[i] == '\0')
+            b->numeric = FALSE;
+        else
+        {
+            b->nums[i] = strtod(b->strs[i], &end);
+            if (*end != '\0')
+                b->numeric = FALSE;
+        }
+    }
+
+    return b;
+}
+
+/*
+ * Number of bounds that are <= v (binary search). Note that this is one
+ * larger than the fragment number of v.
+ */
+int
+sketchBucketPosNum(SketchBounds *b, double v)
+{
+    int low = 0;
+    int high = b->numBounds;
+
+    if (!b->numeric)
+    {
+        char buf[64];
+
+        snprintf(buf, 64, "%.17g", v);
+        return sketchBucketPosString(b, buf);
+    }
+
+    while(low < high)
+    {
+        int mid = (low + high) / 2;
+
+        if (b->nums[mid] <= v)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+int
+sketchBucketPosString(SketchBounds *b, const char *v)
+{
+    int low = 0;
+    int high = b->numBounds;
+
+    if (b->numeric && !b->quoted)
+    {
+        char *end;
+        double d = strtod(v, &end);
+
+        if (*v != '\0' && *end == '\0')
+            return sketchBucketPosNum(b, d);
+    }
+
+    while(low < high)
+    {
+        int mid = (low + high) / 2;
+
+        if (strcmp(b->strs[mid], v) <= 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+/*
+ * Add delta to the count of each fragment whose bit is set in the sketch.
+ */
+void
+sketchAddBits(gprom_long_t *counts, const char *sketch, int len, int delta)
+{
+    for(int i = 0; i < len; i++)
+    {
+        if (sketch[i] == '1')
+            counts[i] += delta;
+    }
+}
+
+void
+sketchCountsToBits(char *sketch, const gprom_long_t *counts, int len)
+{
+    for(int i = 0; i < len; i++)
+        sketch[i] = (counts[i] > 0) ? '1' : '0';
+    sketch[len] = '\0';
+}
+
+/*
+ * Compute the union or intersection of two sketches. The shorter sketch is
+ * treated as if padded with zeros. Result has to have space for
+ * max(aLen, bLen) + 1 characters, returns the length of the result.
+ */
+int
+sketchBitOp(char *result, const char *a, int aLen, const char *b, int bLen,
+        boolean isAnd)
+{
+    int len = MAX(aLen, bLen);
+
+    for(int i = 0; i < len; i++)
+    {
+        boolean aBit = (i < aLen && a[i] == '1');
+        boolean bBit = (i < bLen && b[i] == '1');
+
+        result[i] = (isAnd ? (aBit && bBit) : (aBit || bBit)) ? '1' : '0';
+    }
+    result[len] = '\0';
+
+    return len;
+}
+
+int
+sketchBitCount(const char *sketch, int len)
+{
+    int cnt = 0;
+
+    for(int i = 0; i < len; i++)
+    {
+        if (sketch[i] == '1')
+            cnt++;
+    }
+
+    return cnt;
+}
+
+boolean
+sketchHasBit(const char *sketch, int len, int pos)
+{
+    return pos >= 0 && pos < len && sketch[pos] == '1';
+}
+
+static int
+countElements (const char *literal)
+{
+    boolean inQuotes = FALSE;
+    boolean empty = TRUE;
+    int n = 1;
+
+    for(const char *c = literal; *c != '\0'; c++)
+    {
+        if (inQuotes)
+        {
+            if (*c == '\\' && c[1] != '\0')
+                c++;
+            else if (*c == '"')
+                inQuotes = FALSE;
+            continue;
+        }
+        switch(*c)
+        {
+            case '"':
+                inQuotes = TRUE;
+                empty = FALSE;
+                break;
+            case ',':
+                n++;
+                break;
+            case '{':
+            case '}':
+            case ' ':
+                break;
+            default:
+                empty = FALSE;
+        }
+    }
+
+    return empty ? 0 : n;
+}
+
+/*
+ * Copy the element starting at pos into out removing quotes and escapes.
+ * Returns the position after the element's delimiter.
+ */
+static const char *
+parseElement (const char *pos, char *out, boolean *quoted)
+{
+    *quoted = FALSE;
+
+    while(*pos == ' ')
+        pos++;
+
+    if (*pos == '"')
+    {
+        *quoted = TRUE;
+        pos++;
+        while(*pos != '\0' && *pos != '"')
+        {
+            if (*pos == '\\' && pos[1] != '\0')
+                pos++;
+            *out++ = *pos++;
+        }
+        if (*pos == '"')
+            pos++;
+    }
+    else
+    {
+        char *start = out;
+
+        while(*pos != '\0' && *pos != ',' && *pos != '}')
+            *out++ = *pos++;
+        while(out > start && out[-1] == ' ')
+            out--;
+    }
+    *out = '\0';
+
+    while(*pos == ' ')
+        pos++;
+    if (*pos == ',' || *pos == '}')
+        pos++;
+
+    return pos;
+}
@@ -37,6 +37,8 @@
 
 #include "instrumentation/timing_instrumentation.h"
 #include "instrumentation/memory_instrumentation.h"
+#include "instrumentation/query_profile.h"
+#include "instrumentation/backend_instrumentation.h"
 
 #include "provenance_rewriter/transformation_rewrites/transformation_prov_main.h"
 //#include "provenance_rewriter/summarization_rewrites/summarize_main.h"
@@ -44,11 +46,19 @@
 #include "provenance_rewriter/unnest_rewrites/unnest_main.h"
 
 #include "provenance_rewriter/coarse_grained/ps_safety_check.h"
+#include "provenance_rewriter/coarse_grained/coarse_grained_rewrite.h"
+#include "analysis_and_translate/parameter.h"
+#include "parameterized_query/parameterized_queries.h"
 
 static char *rewriteParserOutput (Node *parse, boolean applyOptimizations);
 static char *rewriteQueryInternal (char *input, boolean rethrowExceptions);
 static void treeifyAll(Node *rewrittenPlan);
 static void setupPlugin(const char *pluginType);
+static void processBatch (List *stmts);
+static void maintainPSAfterUpdates (void);
+
+// DML statements of the last rewritten input
+static List *pendingPSUpdates = NIL;
 //static void summarizationPlan(Node *parse);
 //static List *summOpts = NIL;
 //static char *qType = NULL;
@@ -367,6 +377,10 @@ shutdownApplication(void)
         outputMemstats(FALSE);
         shutdownMemInstrumentation();
     }
+    if (opt_backend_instrumentation)
+        outputBackendStats();
+    shutdownBackendInstrumentation();
+    shutdownQueryProfiling();
     shutdownMetadataLookupPlugins();
 
     freeOptions();
@@ -384,6 +398,11 @@ processInput(char *input, FILE *stream)
     TRY
     {
         NEW_AND_ACQUIRE_MEMCONTEXT(QUERY_MEM_CONTEXT);
+        if (!getBoolOption(OPTION_BATCH_MODE))
+        {
+            backendInstrumentationStartQuery();
+            profileStartQuery(input);
+        }
 		if(stream == NULL)
 		{
 			parse = parseFromString(input);
@@ -392,8 +411,17 @@ processInput(char *input, FILE *stream)
 		{
 			parse = parseStream(stream);
 		}
-        q = rewriteParserOutput(parse, isRewriteOptionActivated(OPTION_OPTIMIZE_OPERATOR_MODEL));
-        execute(q);
+        if (getBoolOption(OPTION_BATCH_MODE) && isA(parse, List))
+        {
+            processBatch((List *) parse);
+        }
+        else
+        {
+            q = rewriteParserOutput(parse, isRewriteOptionActivated(OPTION_OPTIMIZE_OPERATOR_MODEL));
+            execute(q);
+            maintainPSAfterUpdates();
+            profileEndQuery();
+        }
         FREE_AND_RELEASE_CUR_MEM_CONTEXT();
     }
     ON_EXCEPTION
@@ -404,6 +432,73 @@ processInput(char *input, FILE *stream)
     END_ON_EXCEPTION
 }
 
+/*
+ * Process a parsed script one statement at a time. Each statement is
+ * rewritten in its own memory context and then handed to the executor which
+ * may still be running the statement when we start rewriting the next one.
+ * Catalog information and prepared statements are shared across statements
+ * through the metadata lookup cache.
+ */
+static void
+processBatch (List *stmts)
+{
+    int stmtNum = 0;
+
+    TRY
+    {
+        FOREACH(Node,stmt,stmts)
+        {
+            char *q;
+            MemContext *stmtContext;
+
+            NEW_AND_ACQUIRE_MEMCONTEXT(BATCH_STMT_MEM_CONTEXT);
+            DEBUG_LOG("process statement %u of batch", stmtNum);
+            backendInstrumentationStartQuery();
+            profileStartQuery(CONCAT_STRINGS("statement ", gprom_itoa(stmtNum++)));
+            q = rewriteParserOutput((Node *) singleton(stmt),
+                    isRewriteOptionActivated(OPTION_OPTIMIZE_OPERATOR_MODEL));
+            // the statement may still be running after we freed the context
+            stmtContext = RELEASE_MEM_CONTEXT();
+            q = strdup(q);
+            // DML statements have to finish before we maintain sketches
+            if (pendingPSUpdates != NIL)
+            {
+                executeBatchStatement(q);
+                finishBatchExecution();
+                ACQUIRE_MEM_CONTEXT(stmtContext);
+                maintainPSAfterUpdates();
+                RELEASE_MEM_CONTEXT();
+            }
+            else
+                executeBatchStatement(q);
+            FREE_MEM_CONTEXT(stmtContext);
+            profileEndQuery();
+        }
+        finishBatchExecution();
+    }
+    ON_EXCEPTION
+    {
+        // fetch result of the outstanding statement if any
+        finishBatchExecution();
+        RETHROW();
+    }
+    END_ON_EXCEPTION
+}
+
+/*
+ * Maintain cached provenance sketches and histograms for the DML statements
+ * of the last rewritten input after they have been executed successfully.
+ */
+static void
+maintainPSAfterUpdates (void)
+{
+    List *updates = pendingPSUpdates;
+
+    pendingPSUpdates = NIL;
+    FOREACH(QueryOperator,o,updates)
+        maintainPSForUpdate(o);
+}
+
 static char *
 rewriteQueryInternal (char *input, boolean rethrowExceptions)
 {
@@ -414,12 +509,15 @@ rewriteQueryInternal (char *input, boolean rethrowExceptions)
 
     TRY
     {
+        backendInstrumentationStartQuery();
+        profileStartQuery(input);
         parse = parseFromString(input);
 
         DEBUG_LOG("parser returned:\n\n<%s>", nodeToString(parse));
 
         result = rewriteParserOutput(parse, isRewriteOptionActivated(OPTION_OPTIMIZE_OPERATOR_MODEL));
         INFO_LOG("Rewritten SQL text from <%s>\n\n is <%s>", input, result);
+        profileEndQuery();
         FREE_MEM_CONTEXT_AND_RETURN_STRING_COPY(result);
     }
     ON_EXCEPTION
@@ -482,12 +580,74 @@ rewriteQueryWithOptimization(char *input)
     return result;
 }
 
+/*
+ * Run the pipeline (parse, analyze, translate, rewrite, optimize) once for a
+ * query with parameters (e.g., :1) and cache the result under the given name.
+ * The cost-based optimizer is not applied since plan choices may depend on the
+ * parameter values.
+ */
+void
+prepareRewrite(char *name, char *input)
+{
+    Node *parse;
+    Node *oModel;
+    Node *rewrittenTree;
+    List *params;
+
+    NEW_AND_ACQUIRE_MEMCONTEXT(QUERY_MEM_CONTEXT);
+
+    parse = parseFromString(input);
+    DEBUG_LOG("parser returned:\n\n<%s>", nodeToString(parse));
+
+    START_TIMER("translation");
+    oModel = translateParse(parse);
+    DEBUG_NODE_BEATIFY_LOG("translator returned:", oModel);
+    STOP_TIMER("translation");
+
+    if (!IS_OP(oModel))
+    {
+        FATAL_LOG("only queries can be prepared for rewriting, but was:\n%s", input);
+    }
+
+    params = findParameters(oModel);
+    rewrittenTree = generateOptimizedModel(oModel,
+            isRewriteOptionActivated(OPTION_OPTIMIZE_OPERATOR_MODEL));
+
+    createPreparedRewrite(name, rewrittenTree, params);
+    INFO_LOG("prepared rewrite %s for <%s> with %u parameters", name, input, LIST_LENGTH(params));
+
+    FREE_AND_RELEASE_CUR_MEM_CONTEXT();
+}
+
+char *
+rewritePrepared(char *name, List *binds)
+{
+    return preparedRewriteApplyBinds(name, binds);
+}
+
 char *
 generatePlan(Node *oModel, boolean applyOptimizations)
 {
 	StringInfo result = makeStringInfo();
 	Node *rewrittenTree;
 	char *rewrittenSQL = NULL;
+
+	rewrittenTree = generateOptimizedModel(oModel, applyOptimizations);
+
+	START_TIMER("SQLcodeGen");
+	appendStringInfo(result, "%s\n", serializeOperatorModel(rewrittenTree));
+	STOP_TIMER("SQLcodeGen");
+
+	rewrittenSQL = result->data;
+	FREE(result);
+
+	return rewrittenSQL;
+}
+
+Node *
+generateOptimizedModel(Node *oModel, boolean applyOptimizations)
+{
+	Node *rewrittenTree;
 	START_TIMER("rewrite");
 
     if(isRewriteOptionActivated(OPTION_LATERAL_REWRITE) && !hasProvComputation(oModel))
@@ -577,15 +737,16 @@ generatePlan(Node *oModel, boolean applyOptimizations)
 	// turn operator graph into a tree if the users asked for it
 	treeifyAll(rewrittenTree);
 
-	START_TIMER("SQLcodeGen");
-	appendStringInfo(result, "%s\n", serializeOperatorModel(rewrittenTree));
-	STOP_TIMER("SQLcodeGen");
-
-	rewrittenSQL = result->data;
-	FREE(result);
-
-	return rewrittenSQL;
+	if (isProfilingQuery() && IS_QB(rewrittenTree))
+	{
+	    if (isA(rewrittenTree, List))
+	        FOREACH(QueryOperator,o,(List *) rewrittenTree)
+	            profileIncrCounter(PROFILE_COUNTER_OPERATORS, numOpsInGraph(o));
+	    else
+	        profileIncrCounter(PROFILE_COUNTER_OPERATORS, numOpsInGraph((QueryOperator *) rewrittenTree));
+	}
 
+	return rewrittenTree;
 }
 
 static char *
@@ -611,6 +772,18 @@ rewriteParserOutput(Node *parse, boolean applyOptimizations)
     }
     STOP_TIMER("translation");
 
+    // remember DML statements to maintain cached provenance sketches and
+    // histograms once they have been executed (optimization modifies the model)
+    pendingPSUpdates = NIL;
+    if (isA(oModel, List))
+    {
+        FOREACH(Node,o,(List *) oModel)
+            if (IS_OP(o) && isTableModification((QueryOperator *) o))
+                pendingPSUpdates = appendToTailOfList(pendingPSUpdates, copyObject(o));
+    }
+    else if (IS_OP(oModel) && isTableModification((QueryOperator *) oModel))
+        pendingPSUpdates = singleton(copyObject(oModel));
+
     ASSERT_BARRIER(
         if (IS_OP(oModel))
         {
@@ -45,7 +45,7 @@ static boolean quoteAttributeNamesVisitQO (QueryOperator *op, void *context);
 static boolean quoteAttributeNames (Node *node, void *context);
 static char *createViewName (SerializeClausesAPI *api);
 static boolean renameAttrsVisitor (Node *node, JoinAttrRenameState *state);
-static char *createAttrName (char *name, int fItem, FromAttrsContext *fac);
+static FromAttrsLookup *getFromAttrsLookup (FromAttrsContext *fac, List *fromItems, int level);
 static HashMap *getNestAttrMap(QueryOperator *op, FromAttrsContext *fac, SerializeClausesAPI *api);
 static void setNestAttrMap(QueryOperator *op, HashMap **map, FromAttrsContext *fac, SerializeClausesAPI *api);
 static void findNestedSubqueryUsage(QueryOperator *op, char *a, boolean *inMatchSel, boolean *inNonMatchSel, QueryBlockMatch *m, boolean outOfFrom);
@@ -1158,42 +1158,89 @@ updateAttributeNames(Node *node, FromAttrsContext *fac)
     {
         AttributeReference *a = (AttributeReference *) node;
         DEBUG_LOG("a: %s",a->name);
-        char *newName;
-        List *outer = NIL;
-        int fromItem = -1;
-        int attrPos = 0;
 
 		if(!fac->nestAttrMap || !MAP_HAS_STRING_KEY(fac->nestAttrMap, a->name))
 		{
+			FromAttrsLookup *l;
 			List *attrsList = NIL;
+			int level;
+
 			if(a->outerLevelsUp > 0) // outer query correlated attributes
 				attrsList = (List *) getNthOfListP(fac->fromAttrsList, a->outerLevelsUp - 1);
 			else // attribute from current query block
 				attrsList = (List *) fac->fromAttrs;
 
-			FOREACH(List, attrs, attrsList)
-			{
-				attrPos += LIST_LENGTH(attrs);
-				fromItem++;
-				if (attrPos > a->attrPosition)
-				{
-					outer = attrs;
-					break;
-				}
-			}
-			attrPos = a->attrPosition - attrPos + LIST_LENGTH(outer);
-			newName = getNthOfListP(outer, attrPos);
-
 			if(a->outerLevelsUp == -1)  //deal with nesting_eval_1 attribute which with outerLevelsUp = -1
-				a->name = CONCAT_STRINGS("F", gprom_itoa(fromItem), "_", gprom_itoa(LIST_LENGTH(fac->fromAttrsList)), ".", newName);
+				level = LIST_LENGTH(fac->fromAttrsList);
 			else
-				a->name = CONCAT_STRINGS("F", gprom_itoa(fromItem), "_", gprom_itoa(LIST_LENGTH(fac->fromAttrsList)-(a->outerLevelsUp)) , ".", newName);
+				level = LIST_LENGTH(fac->fromAttrsList) - a->outerLevelsUp;
+
+			l = getFromAttrsLookup(fac, attrsList, level);
+			ASSERT(a->attrPosition >= 0 && a->attrPosition < l->numAttrs);
+			a->name = l->qualifiedNames[a->attrPosition];
 		}
     }
 
     return visit(node, updateAttributeNames, fac);
 }
 
+/*
+ * Return the position to name lookup table for a from clause. Tables are
+ * cached in the context. A cached table is reused if it was built for the
+ * same from clause with the same from items and nesting level.
+ */
+static FromAttrsLookup *
+getFromAttrsLookup (FromAttrsContext *fac, List *fromItems, int level)
+{
+    FromAttrsLookup *l = NULL;
+    int fromItem = 0;
+    int pos = 0;
+
+    FOREACH(FromAttrsLookup, c, fac->lookups)
+    {
+        if (c->fromItems == fromItems && c->level == level)
+        {
+            l = c;
+            break;
+        }
+    }
+
+    if (l != NULL && l->numFromItems == LIST_LENGTH(fromItems))
+        return l;
+
+    if (l == NULL)
+    {
+        l = NEW(FromAttrsLookup);
+        l->fromItems = fromItems;
+        l->level = level;
+        fac->lookups = appendToTailOfList(fac->lookups, l);
+    }
+
+    l->numFromItems = LIST_LENGTH(fromItems);
+    l->numAttrs = 0;
+    FOREACH(List, attrs, fromItems)
+        l->numAttrs += LIST_LENGTH(attrs);
+
+    l->firstAttrOfFromItem = MALLOC(sizeof(int) * (l->numFromItems + 1));
+    l->qualifiedNames = MALLOC(sizeof(char *) * (l->numAttrs + 1));
+
+    FOREACH(List, attrs, fromItems)
+    {
+        char *prefix = CONCAT_STRINGS("F", gprom_itoa(fromItem), "_", gprom_itoa(level), ".");
+
+        l->firstAttrOfFromItem[fromItem] = pos;
+        FOREACH(char, name, attrs)
+        {
+            l->qualifiedNames[pos] = CONCAT_STRINGS(prefix, name);
+            pos++;
+        }
+        fromItem++;
+    }
+    l->firstAttrOfFromItem[fromItem] = pos;
+
+    return l;
+}
+
 /*
  * Main entry point for serialization.
  */
@@ -1247,7 +1294,8 @@ genCreateTempView (QueryOperator *q, StringInfo str, QueryOperator *parent, From
     }
 
     // create sql code to create view
-    appendStringInfo(viewDef, "%s AS (", viewName);
+    appendStringInfo(viewDef, "%s AS %s(", viewName,
+            api->materializeTempViews ? "MATERIALIZED " : "");
     if (isA(q, SetOperator))
         resultAttrs = api->serializeSetOperator(q, viewDef, fac, api);
     else
@@ -1305,37 +1353,17 @@ renameAttrsVisitor (Node *node, JoinAttrRenameState *state)
     if (isA(node, AttributeReference))
     {
         AttributeReference *a = (AttributeReference *) node;
-        boolean isRight = (a->fromClauseItem == 0) ? FALSE : TRUE;
-        int pos = 0, fPos = 0;
-        int rOffset = state->rightFromOffsets;
-        ListCell *lc;
-        char *name;
-        List *from = NIL;
-
-        // if right join input find first from item from right input
-        if (isRight)
-            for(lc = getHeadOfList(state->fac->fromAttrs); fPos < rOffset; lc = lc->next, fPos++)
-                ;
-        else
-            lc = getHeadOfList(state->fac->fromAttrs);
-
-        // find from position and attr name
-        for(; lc != NULL; lc = lc->next)
-        {
-            List *attrs = (List *) LC_P_VAL(lc);
-            pos += LIST_LENGTH(attrs);
-            if (pos > a->attrPosition)
-            {
-                from = attrs;
-                break;
-            }
-            fPos++;
-        }
+        FromAttrsContext *fac = state->fac;
+        FromAttrsLookup *l = getFromAttrsLookup(fac, fac->fromAttrs,
+                LIST_LENGTH(fac->fromAttrsList));
+        int pos = a->attrPosition;
 
-        pos = a->attrPosition - pos + LIST_LENGTH(from);
-        name = getNthOfListP(from, pos);
+        // positions of right join input attributes start at its first from item
+        if (a->fromClauseItem != 0)
+            pos += l->firstAttrOfFromItem[state->rightFromOffsets];
 
-        a->name = createAttrName(name, fPos, state->fac);
+        ASSERT(pos >= 0 && pos < l->numAttrs);
+        a->name = l->qualifiedNames[pos];
 
         return TRUE;
     }
@@ -1343,19 +1371,6 @@ renameAttrsVisitor (Node *node, JoinAttrRenameState *state)
     return visit(node, renameAttrsVisitor, state);
 }
 
-static char *
-createAttrName (char *name, int fItem, FromAttrsContext *fac)
-{
-   StringInfo str = makeStringInfo();
-   char *result = NULL;
-
-   appendStringInfo(str, "F%u_%u.%s", fItem, LIST_LENGTH(fac->fromAttrsList), name);
-   result = str->data;
-   FREE(str);
-
-   return result;
-}
-
 boolean
 updateAggsAndGroupByAttrs(Node *node, UpdateAggAndGroupByAttrState *state)
 {
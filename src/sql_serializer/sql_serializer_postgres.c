@@ -127,6 +127,7 @@ serializeQueryPostgres(QueryOperator *q)
     // initialize basic structures and then call the worker
     api->tempViewMap = NEW_MAP(Constant, Node);
     api->viewCounter = 0;
+    api->materializeTempViews = getBoolOption(OPTION_MATERIALIZE_SHARED_VIEWS);
 
     // initialize FromAttrsContext structure
   	FromAttrsContext *fac = initializeFromAttrsContext();
@@ -71,6 +71,8 @@ static void markTemporalAttrsAsProv (QueryOperator *op);
 #define IS_S_NAME backendifyIdentifier("is_s")
 #define IS_E_NAME backendifyIdentifier("is_e")
 #define NUMOPEN backendifyIdentifier("numopen")
+#define PREV_END_NAME backendifyIdentifier("prev_end")
+#define ISLAND_NAME backendifyIdentifier("island")
 
 #define TNTAB_DUMMY_TABLE_NAME "__TNTAB_PLACEHOLDER"
 
@@ -1300,7 +1302,12 @@ addCoalesceForAllOp(QueryOperator *op)
 		if(GET_STRING_PROP(op, PROP_TEMP_DO_COALESCE))
 			result = addCoalesce(op);
 		else if (GET_STRING_PROP(op, PROP_TEMP_DO_SET_COALESCE))
-		    result = addSetCoalesce(op);
+		{
+		    if (getBoolOption(TEMPORAL_USE_COALESCE_WINDOW))
+		        result = addSetCoalesceUsingWindow(op);
+		    else
+		        result = addSetCoalesce(op);
+		}
 	}
 
 	return result;
@@ -1493,6 +1500,125 @@ addSetCoalesce (QueryOperator *input)
     return finalProj;
 }
 
+/*
+ * adds algebra expressions to set-coalesce the output of an operator in a
+ * single sorted pass (gaps and islands). Tuples are sorted on their interval
+ * within each group of tuples with the same values for the normal attributes.
+ * A tuple starts a new island unless its interval overlaps with or is
+ * adjacent to an interval of a previous tuple in the sorted order. Numbering
+ * islands with a running sum over the island starts, coalesced intervals are
+ * the min begin and max end of each island.
+ *
+ * WITH T1 AS (
+ *   SELECT NORMAL_ATTRS, T_B, T_E,
+ *          MAX(T_E) OVER (PARTITION BY NORMAL_ATTRS ORDER BY T_B, T_E
+ *                         ROWS BETWEEN UNBOUNDED PRECEDING AND 1 PRECEDING) AS prev_end
+ *   FROM INPUT
+ * ),
+ * T2 AS (
+ *   SELECT NORMAL_ATTRS, T_B, T_E,
+ *          SUM(CASE WHEN prev_end >= T_B THEN 0 ELSE 1 END)
+ *              OVER (PARTITION BY NORMAL_ATTRS ORDER BY T_B, T_E ROWS UNBOUNDED PRECEDING) AS island
+ *   FROM T1
+ * )
+ * SELECT NORMAL_ATTRS, MIN(T_B) AS T_B, MAX(T_E) AS T_E
+ * FROM T2
+ * GROUP BY NORMAL_ATTRS, island
+ *
+ * Like addSetCoalesce this is only applicable if the output of the operator
+ * does not contain any duplicates.
+ */
+QueryOperator *
+addSetCoalesceUsingWindow (QueryOperator *input)
+{
+    QueryOperator *op = input;
+    List *parents = op->parents;
+    List *norAttrnames = getNormalAttrNames(op);
+
+    //****************************************
+    // Construct T1: maximal end point of intervals sorted before the current one
+    WindowBound *prevLower = createWindowBound(WINBOUND_UNBOUND_PREC, NULL);
+    WindowBound *prevUpper = createWindowBound(WINBOUND_EXPR_PREC, (Node *) createConstInt(ONE));
+    WindowFrame *prevFrame = createWindowFrame(WINFRAME_ROWS, prevLower, prevUpper);
+
+    List *partBy = getAttrRefsByNames(op, norAttrnames);
+    List *orderBy = LIST_MAKE(getAttrRefByName(op, TBEGIN_NAME),
+            getAttrRefByName(op, TEND_NAME));
+
+    FunctionCall *maxEnd = createFunctionCall(AGGNAME_MAX,
+            singleton(getAttrRefByName(op, TEND_NAME)));
+
+    WindowOperator *winPrevEnd = createWindowOp((Node *) maxEnd,
+            partBy,
+            orderBy,
+            prevFrame,
+            strdup(PREV_END_NAME),
+            op,
+            NIL);
+    op->parents = singleton(winPrevEnd);
+
+    // the island window reads prev_end, window functions cannot be nested
+    QueryOperator *t1 = createProjOnAllAttrs((QueryOperator *) winPrevEnd);
+    addChildOperator(t1, (QueryOperator *) winPrevEnd);
+
+    //****************************************
+    // Construct T2: number islands of overlapping or adjacent intervals
+    WindowBound *islandBound = createWindowBound(WINBOUND_UNBOUND_PREC, NULL);
+    WindowFrame *islandFrame = createWindowFrame(WINFRAME_ROWS, islandBound, NULL);
+
+    Node *overlaps = (Node *) createOpExpr(OPNAME_GE,
+            LIST_MAKE(getAttrRefByName(t1, PREV_END_NAME),
+                    getAttrRefByName(t1, TBEGIN_NAME)));
+    Node *isStart = (Node *) createCaseExpr(NULL,
+            singleton(createCaseWhen(overlaps, (Node *) createConstInt(ZERO))),
+            (Node *) createConstInt(ONE));
+    FunctionCall *sumStarts = createFunctionCall(AGGNAME_SUM, singleton(isStart));
+
+    WindowOperator *winIsland = createWindowOp((Node *) sumStarts,
+            getAttrRefsByNames(t1, norAttrnames),
+            LIST_MAKE(getAttrRefByName(t1, TBEGIN_NAME),
+                    getAttrRefByName(t1, TEND_NAME)),
+            islandFrame,
+            strdup(ISLAND_NAME),
+            t1,
+            NIL);
+    t1->parents = singleton(winIsland);
+    QueryOperator *t2 = (QueryOperator *) winIsland;
+
+    //****************************************
+    // Construct T3: one tuple per island with its min begin and max end
+    List *aggrs = LIST_MAKE(
+            createFunctionCall(AGGNAME_MIN, singleton(getAttrRefByName(t2, TBEGIN_NAME))),
+            createFunctionCall(AGGNAME_MAX, singleton(getAttrRefByName(t2, TEND_NAME))));
+    List *groupBy = getAttrRefsByNames(t2, norAttrnames);
+    groupBy = appendToTailOfList(groupBy, getAttrRefByName(t2, ISLAND_NAME));
+
+    List *aggNames = LIST_MAKE(strdup(TBEGIN_NAME), strdup(TEND_NAME));
+    aggNames = CONCAT_LISTS(aggNames, deepCopyStringList(norAttrnames));
+    aggNames = appendToTailOfList(aggNames, strdup(ISLAND_NAME));
+
+    QueryOperator *t3 = (QueryOperator *) createAggregationOp(aggrs, groupBy, t2, NIL, aggNames);
+    t2->parents = singleton(t3);
+
+    // construct final projection
+    QueryOperator *finalProj;
+    List *inAttrs = deepCopyStringList(norAttrnames);
+
+    inAttrs = appendToTailOfList(inAttrs, strdup(TBEGIN_NAME));
+    inAttrs = appendToTailOfList(inAttrs, strdup(TEND_NAME));
+
+    finalProj = createProjOnAttrsByName(t3, inAttrs, deepCopyStringList(inAttrs));
+    finalProj->inputs = singleton(t3);
+    t3->parents = singleton(finalProj);
+
+    // replace with original operator and mark temporal attributes
+    substOpInParents(parents, op, finalProj);
+    setTempAttrProps(finalProj);
+    markTemporalAttrsAsProv(finalProj);
+
+    return finalProj;
+}
+
 static List *
 getAttrRefsByNames (QueryOperator *op, List *attrNames)
 {
@@ -0,0 +1,182 @@
+/*-----------------------------------------------------------------------------
+ *
+ * thread_pool.c
+ *		- Run independent tasks on a pool of worker threads
+ *
+ *		AUTHOR: lord_pretzel
+ *
+ *		Workers take the next task from a shared counter until all tasks are
+ *		done. Each worker gets a memory context of its own that serves as the
+ *		bottom of the worker's memory context stack (see
+ *		initMemManagerThread). Without pthreads or if threads cannot be
+ *		created the tasks are run one after the other on the calling thread.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "common.h"
+#include "log/logger.h"
+#include "mem_manager/mem_mgr.h"
+#include "utility/thread_pool.h"
+
+#define WORKER_CONTEXT_NAME "THREAD_POOL_WORKER_CONTEXT"
+
+#if defined(HAVE_LIBPTHREAD) && ! defined(OS_WINDOWS)
+#define USE_THREADS 1
+#endif
+
+typedef struct ThreadPool
+{
+    ThreadPoolTaskFunc task;
+    void **args;
+    int numTasks;
+    int nextTask;
+#ifdef USE_THREADS
+    pthread_mutex_t lock;
+#endif
+} ThreadPool;
+
+typedef struct ThreadPoolWorker
+{
+    ThreadPool *pool;
+    MemContext *context;
+#ifdef USE_THREADS
+    pthread_t thread;
+#endif
+} ThreadPoolWorker;
+
+// is the current thread a worker of a thread pool
+static THREAD_LOCAL boolean workerThread = FALSE;
+
+#ifdef USE_THREADS
+static void *workerMain (void *arg);
+static int takeNextTask (ThreadPool *pool);
+#endif
+static void runTasksSequentially (int numTasks, ThreadPoolTaskFunc task,
+        ThreadPoolTaskFunc collect, void **args);
+
+/*
+ * Run task(args[i]) for all tasks using up to numThreads worker threads.
+ * Afterwards collect(args[i]) is called for each task on the calling thread
+ * (collect may be NULL).
+ */
+void
+runTasksInParallel (int numThreads, int numTasks, ThreadPoolTaskFunc task,
+        ThreadPoolTaskFunc collect, void **args)
+{
+#ifdef USE_THREADS
+    ThreadPool pool;
+    ThreadPoolWorker *workers;
+    int numStarted = 0;
+
+    numThreads = MIN(numThreads, numTasks);
+    if (numThreads <= 1 || workerThread)
+    {
+        runTasksSequentially(numTasks, task, collect, args);
+        return;
+    }
+
+    pool.task = task;
+    pool.args = args;
+    pool.numTasks = numTasks;
+    pool.nextTask = 0;
+    pthread_mutex_init(&pool.lock, NULL);
+
+    workers = CNEW(ThreadPoolWorker, numThreads);
+    for(int i = 0; i < numThreads; i++)
+    {
+        ThreadPoolWorker *w = workers + i;
+
+        w->pool = &pool;
+        w->context = NEW_MEM_CONTEXT(WORKER_CONTEXT_NAME);
+        if (pthread_create(&(w->thread), NULL, workerMain, w) != 0)
+        {
+            ERROR_LOG("could not create worker thread %d, continue with %d threads",
+                    i, numStarted);
+            ACQUIRE_MEM_CONTEXT(w->context);
+            FREE_AND_RELEASE_CUR_MEM_CONTEXT();
+            break;
+        }
+        numStarted++;
+    }
+
+    // no thread could be started
+    if (numStarted == 0)
+    {
+        pthread_mutex_destroy(&pool.lock);
+        runTasksSequentially(numTasks, task, collect, args);
+        return;
+    }
+
+    for(int i = 0; i < numStarted; i++)
+        pthread_join(workers[i].thread, NULL);
+    pthread_mutex_destroy(&pool.lock);
+    DEBUG_LOG("ran %d tasks on %d threads", numTasks, numStarted);
+
+    // results are copied before the worker contexts are freed
+    if (collect != NULL)
+        for(int i = 0; i < numTasks; i++)
+            collect(args[i]);
+
+    for(int i = 0; i < numStarted; i++)
+    {
+        ACQUIRE_MEM_CONTEXT(workers[i].context);
+        FREE_AND_RELEASE_CUR_MEM_CONTEXT();
+    }
+    FREE(workers);
+#else
+    runTasksSequentially(numTasks, task, collect, args);
+#endif
+}
+
+boolean
+isWorkerThread (void)
+{
+    return workerThread;
+}
+
+#ifdef USE_THREADS
+static void *
+workerMain (void *arg)
+{
+    ThreadPoolWorker *w = (ThreadPoolWorker *) arg;
+    ThreadPool *pool = w->pool;
+    int t;
+
+    workerThread = TRUE;
+    initMemManagerThread(w->context);
+
+    while((t = takeNextTask(pool)) != -1)
+        pool->task(pool->args[t]);
+
+    shutdownMemManagerThread();
+    workerThread = FALSE;
+
+    return NULL;
+}
+
+static int
+takeNextTask (ThreadPool *pool)
+{
+    int t = -1;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->nextTask < pool->numTasks)
+        t = pool->nextTask++;
+    pthread_mutex_unlock(&pool->lock);
+
+    return t;
+}
+#endif
+
+static void
+runTasksSequentially (int numTasks, ThreadPoolTaskFunc task,
+        ThreadPoolTaskFunc collect, void **args)
+{
+    for(int i = 0; i < numTasks; i++)
+    {
+        task(args[i]);
+        if (collect != NULL)
+            collect(args[i]);
+    }
+}
@@ -0,0 +1,172 @@
+/*-----------------------------------------------------------------------------
+ *
+ * test_bucket_assignment.c
+ *		Test expressions that assign values to buckets.
+ *
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "test_main.h"
+#include "log/logger.h"
+#include "model/node/nodetype.h"
+#include "model/list/list.h"
+#include "model/expression/expression.h"
+#include "provenance_rewriter/bucket_assignment.h"
+
+#define NUM_BUCKETS 1000
+
+static rc testArrayLiteral(void);
+static rc testCaseTree(void);
+static rc testMethodFallback(void);
+static rc testNumericStringBounds(void);
+static int caseDepth (Node *n);
+static List *createIntBounds (int num);
+
+rc
+testBucketAssignment(void)
+{
+    RUN_TEST(testArrayLiteral(), "test translation of bounds into array literals");
+    RUN_TEST(testCaseTree(), "test balanced CASE trees");
+    RUN_TEST(testMethodFallback(), "test fallback to CASE trees for non-constant bounds");
+    RUN_TEST(testNumericStringBounds(), "test string bounds of numeric attributes");
+
+    return PASS;
+}
+
+static rc
+testArrayLiteral(void)
+{
+    ASSERT_EQUALS_STRING("{0,10,20}", boundsToArrayLiteral(createIntBounds(3)),
+            "integer bounds");
+    ASSERT_EQUALS_STRING("{\"a\",\"b\\\"c\"}",
+            boundsToArrayLiteral(LIST_MAKE(createConstString("a"), createConstString("b\"c"))),
+            "string bounds are quoted");
+
+    return PASS;
+}
+
+static rc
+testCaseTree(void)
+{
+    AttributeReference *a = createFullAttrReference(strdup("A"), 0, 0, INVALID_ATTR, DT_INT);
+    List *bounds = createIntBounds(NUM_BUCKETS);
+    List *results = NIL;
+    Node *tree;
+    int depth;
+
+    for(int i = 0; i <= NUM_BUCKETS; i++)
+        results = appendToTailOfList(results, createConstInt(i));
+
+    tree = createBucketLookupExpr((Node *) a, bounds, results);
+    depth = caseDepth(tree);
+    ASSERT_TRUE(depth >= 10 && depth <= 11, "depth of CASE tree is logarithmic in the number of buckets");
+
+    tree = createBucketLookupExpr((Node *) a, createIntBounds(1),
+            LIST_MAKE(createConstInt(1), createConstInt(2)));
+    ASSERT_EQUALS_INT(1, caseDepth(tree), "single bound needs one comparison");
+    ASSERT_EQUALS_NODE(createConstInt(2), ((CaseExpr *) tree)->elseRes,
+            "values above the bound are in the last bucket");
+
+    tree = createBucketNumberExprWithMethod((Node *) a, bounds, BUCKET_METHOD_CASE_TREE);
+    ASSERT_TRUE(isA(tree, CaseExpr), "bucket number as CASE tree");
+    ASSERT_TRUE(isA(getHeadOfListP(((CaseExpr *) tree)->whenClauses), CaseWhen), "NULL check");
+    ASSERT_TRUE(isA(((CaseWhen *) getHeadOfListP(((CaseExpr *) tree)->whenClauses))->when, IsNullExpr),
+            "NULL values are mapped to NULL");
+
+    return PASS;
+}
+
+static rc
+testMethodFallback(void)
+{
+    AttributeReference *a = createFullAttrReference(strdup("A"), 0, 0, INVALID_ATTR, DT_INT);
+    AttributeReference *b = createFullAttrReference(strdup("B"), 0, 1, INVALID_ATTR, DT_INT);
+    Node *e;
+
+    e = createBucketNumberExprWithMethod((Node *) a, createIntBounds(10), BUCKET_METHOD_WIDTH_BUCKET);
+    ASSERT_TRUE(isA(e, Operator), "width_bucket result is adjusted");
+    ASSERT_EQUALS_STRING("width_bucket",
+            ((FunctionCall *) getHeadOfListP(((Operator *) e)->args))->functionname,
+            "width_bucket is used");
+
+    e = createBucketNumberExprWithMethod((Node *) a, createIntBounds(10), BUCKET_METHOD_ARRAY_SEARCH);
+    ASSERT_TRUE(isA(e, FunctionCall), "array search function");
+
+    e = createBucketNumberExprWithMethod((Node *) a,
+            LIST_MAKE(createConstInt(1), b), BUCKET_METHOD_WIDTH_BUCKET);
+    ASSERT_TRUE(isA(e, CaseExpr), "non-constant bounds use CASE tree");
+
+    return PASS;
+}
+
+/*
+ * Histogram bounds are read as strings. They have to be compared as numbers
+ * with numeric attributes, otherwise 7, 9, and 50 would all be above "100".
+ */
+static rc
+testNumericStringBounds(void)
+{
+    AttributeReference *a = createFullAttrReference(strdup("A"), 0, 0, INVALID_ATTR, DT_INT);
+    AttributeReference *f = createFullAttrReference(strdup("F"), 0, 0, INVALID_ATTR, DT_FLOAT);
+    AttributeReference *s = createFullAttrReference(strdup("S"), 0, 0, INVALID_ATTR, DT_STRING);
+    List *bounds = LIST_MAKE(createConstString("1"), createConstString("5"),
+            createConstString("10"), createConstString("100"));
+    FunctionCall *fc;
+    CaseExpr *tree;
+
+    fc = (FunctionCall *) createBucketNumberExprWithMethod((Node *) a, bounds, BUCKET_METHOD_ARRAY_SEARCH);
+    ASSERT_EQUALS_STRING("{1,5,10,100}", STRING_VALUE(getHeadOfListP(fc->args)),
+            "bounds of integer attribute are not quoted");
+
+    fc = (FunctionCall *) createBucketNumberExprWithMethod((Node *) f,
+            LIST_MAKE(createConstString("1.5"), createConstString("10")), BUCKET_METHOD_ARRAY_SEARCH);
+    ASSERT_EQUALS_STRING("{1.5,10}", STRING_VALUE(getHeadOfListP(fc->args)),
+            "bounds of float attribute are not quoted");
+
+    fc = (FunctionCall *) createBucketNumberExprWithMethod((Node *) s, bounds, BUCKET_METHOD_ARRAY_SEARCH);
+    ASSERT_EQUALS_STRING("{\"1\",\"5\",\"10\",\"100\"}", STRING_VALUE(getHeadOfListP(fc->args)),
+            "bounds of string attribute are quoted");
+
+    fc = (FunctionCall *) createSketchContainsExpr((Node *) a, bounds, "0110");
+    ASSERT_EQUALS_STRING("{1,5,10,100}", STRING_VALUE(getNthOfListP(fc->args, 1)),
+            "bounds of sketch membership test are not quoted");
+
+    tree = (CaseExpr *) createBucketLookupExpr((Node *) a, bounds,
+            LIST_MAKE(createConstInt(0), createConstInt(1), createConstInt(2),
+                    createConstInt(3), createConstInt(4)));
+    ASSERT_EQUALS_NODE(createConstInt(10),
+            getNthOfListP(((Operator *) ((CaseWhen *) getHeadOfListP(tree->whenClauses))->when)->args, 1),
+            "CASE tree compares with integer bounds");
+
+    return PASS;
+}
+
+static int
+caseDepth (Node *n)
+{
+    CaseExpr *c;
+    CaseWhen *w;
+    int thenDepth, elseDepth;
+
+    if (!isA(n, CaseExpr))
+        return 0;
+
+    c = (CaseExpr *) n;
+    w = (CaseWhen *) getHeadOfListP(c->whenClauses);
+    thenDepth = caseDepth(w->then);
+    elseDepth = caseDepth(c->elseRes);
+
+    return 1 + ((thenDepth > elseDepth) ? thenDepth : elseDepth);
+}
+
+static List *
+createIntBounds (int num)
+{
+    List *bounds = NIL;
+
+    for(int i = 0; i < num; i++)
+        bounds = appendToTailOfList(bounds, createConstInt(i * 10));
+
+    return bounds;
+}
@@ -0,0 +1,109 @@
+/*
+ *------------------------------------------------------------------------------
+ *
+ * test_common_subplans.c - Testing detection and sharing of common subplans.
+ *
+ *
+ *
+ *        SUBDIR: test/
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "test_main.h"
+#include "log/logger.h"
+#include "model/node/nodetype.h"
+#include "model/list/list.h"
+#include "model/expression/expression.h"
+#include "model/query_operator/query_operator.h"
+#include "model/query_operator/operator_property.h"
+#include "operator_optimizer/common_subplans.h"
+#include "provenance_rewriter/prov_utility.h"
+
+static rc testShareCopies(void);
+static rc testKeepDifferentSubplans(void);
+static QueryOperator *createSelOnR (int constant);
+
+rc
+testCommonSubplans(void)
+{
+    RUN_TEST(testShareCopies(), "test sharing copies of a subplan");
+    RUN_TEST(testKeepDifferentSubplans(), "test keeping subplans that differ");
+
+    return PASS;
+}
+
+static rc
+testShareCopies(void)
+{
+    QueryOperator *s1, *s2, *u, *p1, *p2, *j;
+
+    // union of two copies of the same selection
+    s1 = createSelOnR(1);
+    s2 = createSelOnR(1);
+    u = (QueryOperator *) createSetOperator(SETOP_UNION, LIST_MAKE(s1,s2), NIL,
+            LIST_MAKE(strdup("A"), strdup("B")));
+    addParent(s1, u);
+    addParent(s2, u);
+
+    u = shareCommonSubplans(u);
+    ASSERT_EQUALS_P(OP_LCHILD(u), OP_RCHILD(u), "union inputs are shared");
+    ASSERT_EQUALS_INT(1, LIST_LENGTH(OP_LCHILD(u)->parents), "shared selection has one parent");
+    ASSERT_TRUE(HAS_STRING_PROP(OP_LCHILD(u), PROP_MATERIALIZE), "shared selection used twice by one parent is materialized");
+    ASSERT_EQUALS_INT(1, LIST_LENGTH(OP_LCHILD(OP_LCHILD(u))->parents), "table access has only the shared selection as parent");
+
+    // copies used by different parents
+    s1 = createSelOnR(1);
+    s2 = createSelOnR(1);
+    p1 = (QueryOperator *) createProjOnAllAttrs(s1);
+    addChildOperator(p1, s1);
+    p2 = (QueryOperator *) createProjOnAllAttrs(s2);
+    addChildOperator(p2, s2);
+    j = (QueryOperator *) createJoinOp(JOIN_CROSS, NULL, LIST_MAKE(p1,p2), NIL,
+            LIST_MAKE(strdup("A"), strdup("B"), strdup("C"), strdup("D")));
+    addParent(p1, j);
+    addParent(p2, j);
+
+    j = shareCommonSubplans(j);
+    ASSERT_EQUALS_P(OP_LCHILD(j), OP_RCHILD(j), "join inputs are shared");
+    ASSERT_TRUE(HAS_STRING_PROP(OP_LCHILD(j), PROP_MATERIALIZE), "shared projection is materialized");
+
+    return PASS;
+}
+
+static rc
+testKeepDifferentSubplans(void)
+{
+    QueryOperator *s1, *s2, *u;
+
+    s1 = createSelOnR(1);
+    s2 = createSelOnR(2);
+    u = (QueryOperator *) createSetOperator(SETOP_UNION, LIST_MAKE(s1,s2), NIL,
+            LIST_MAKE(strdup("A"), strdup("B")));
+    addParent(s1, u);
+    addParent(s2, u);
+
+    u = shareCommonSubplans(u);
+    ASSERT_EQUALS_P(s1, OP_LCHILD(u), "left input unchanged");
+    ASSERT_EQUALS_P(s2, OP_RCHILD(u), "right input unchanged");
+    ASSERT_FALSE(OP_LCHILD(OP_LCHILD(u)) == OP_LCHILD(OP_RCHILD(u)), "table accesses are not shared");
+
+    return PASS;
+}
+
+static QueryOperator *
+createSelOnR (int constant)
+{
+    QueryOperator *t, *s;
+
+    t = (QueryOperator *) createTableAccessOp(strdup("R"), NULL, strdup("R"), NIL,
+            LIST_MAKE(strdup("A"), strdup("B")), LIST_MAKE_INT(DT_INT, DT_INT));
+    s = (QueryOperator *) createSelectionOp(
+            (Node *) createOpExpr(strdup("="),
+                    LIST_MAKE(createFullAttrReference(strdup("A"), 0, 0, INVALID_ATTR, DT_INT),
+                            createConstInt(constant))),
+            t, NIL, NIL);
+    addParent(t, s);
+
+    return s;
+}
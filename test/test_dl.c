@@ -21,6 +21,7 @@
 static rc testMakeVarsUnique(void);
 static rc testRuleMerging(void);
 static rc testRuleGraph(void);
+static rc testArgSets(void);
 
 rc
 testDatalogModel(void)
@@ -28,6 +29,7 @@ testDatalogModel(void)
     RUN_TEST(testMakeVarsUnique(), "test replacing vars with unique vars");
 	RUN_TEST(testRuleMerging(), "test merging of subqueries");
 	RUN_TEST(testRuleGraph(), "test creation of rule graph");
+	RUN_TEST(testArgSets(), "test bitset based argument sets");
 
     return PASS;
 }
@@ -234,3 +236,42 @@ testRuleGraph(void)
 
 	return PASS;
 }
+
+static rc
+testArgSets(void)
+{
+	List *u, *a, *e;
+	DLArgIndex *idx;
+
+	u = LIST_MAKE(VAR("A"), VAR("B"), createConstInt(1), VAR("C"));
+
+	a = argsMinus(u, LIST_MAKE(VAR("B"), VAR("D")));
+	e = LIST_MAKE(VAR("A"), createConstInt(1), VAR("C"));
+	ASSERT_EQUALS_NODE(e, a, "(A,B,1,C) - (B,D) = (A,1,C)");
+
+	a = argsIntersect(u, LIST_MAKE(VAR("C"), createConstInt(1), VAR("A")));
+	e = LIST_MAKE(VAR("A"), createConstInt(1), VAR("C"));
+	ASSERT_EQUALS_NODE(e, a, "(A,B,1,C) intersect (C,1,A) = (A,1,C)");
+
+	a = argsMinus(u, NIL);
+	ASSERT_EQUALS_NODE(u, a, "(A,B,1,C) - () = (A,B,1,C)");
+
+	ASSERT_TRUE(argsOverlap(u, LIST_MAKE(VAR("E"), VAR("B"))), "(A,B,1,C) overlaps with (E,B)");
+	ASSERT_FALSE(argsOverlap(u, LIST_MAKE(VAR("E"), createConstInt(2))), "(A,B,1,C) does not overlap with (E,2)");
+	ASSERT_FALSE(argsOverlap(NIL, LIST_MAKE(VAR("E"))), "() does not overlap with (E)");
+
+	// one index is reused for several sets over the same universe
+	idx = createArgIndex(u);
+	a = argIndexMinus(idx, LIST_MAKE(VAR("C"), VAR("A")));
+	e = LIST_MAKE(VAR("B"), createConstInt(1));
+	ASSERT_EQUALS_NODE(e, a, "indexed (A,B,1,C) - (C,A) = (B,1)");
+
+	a = argIndexMinus(idx, argIndexMinus(idx, LIST_MAKE(VAR("C"), VAR("E"))));
+	e = LIST_MAKE(VAR("C"));
+	ASSERT_EQUALS_NODE(e, a, "indexed (A,B,1,C) - ((A,B,1,C) - (C,E)) = (C)");
+
+	ASSERT_TRUE(argIndexOverlap(idx, LIST_MAKE(createConstInt(1))), "indexed (A,B,1,C) overlaps with (1)");
+	ASSERT_FALSE(argIndexOverlap(idx, NIL), "indexed (A,B,1,C) does not overlap with ()");
+
+	return PASS;
+}
@@ -16,14 +16,18 @@
 #include "model/list/list.h"
 #include "model/node/nodetype.h"
 #include "model/expression/expression.h"
+#include "model/set/set.h"
+#include "model/set/hashmap.h"
 
 
 static rc testHashImpliesEquals(void);
+static rc testCollectionHash(void);
 
 rc
 testHash()
 {
     RUN_TEST(testHashImpliesEquals(), "test that equal nodes have same hash");
+    RUN_TEST(testCollectionHash(), "test hashes of sets and maps based on stored element hashes");
 
     return PASS;
 }
@@ -43,3 +47,46 @@ testHashImpliesEquals(void)
 
     return PASS;
 }
+
+static rc
+testCollectionHash(void)
+{
+    Set *s1, *s2, *s3;
+    HashMap *m1, *m2, *m3;
+
+    // same elements added in different order
+    s1 = MAKE_NODE_SET(CS("A"), CS("B"), CS("C"));
+    s2 = MAKE_NODE_SET(CS("C"), CS("A"), CS("B"));
+    s3 = MAKE_NODE_SET(CS("A"), CS("B"), CS("D"));
+
+    ASSERT_EQUALS_LONG(hashValue(s1), hashValue(s2), "same hash for s1 and s2");
+    ASSERT_EQUALS_NODE(s1, s2, "s1 and s2 are equal");
+    ASSERT_FALSE(equal(s1, s3), "s1 and s3 are not equal");
+    ASSERT_TRUE(hasSetElemByHashValue(s1, CS("A"), (unsigned) hashValue(CS("A"))),
+            "lookup with known hash value");
+    ASSERT_EQUALS_INT(2, setSize(intersectSets(s1, s3)), "intersection of s1 and s3");
+    ASSERT_EQUALS_INT(4, setSize(unionSets(s1, s3)), "union of s1 and s3");
+
+    m1 = NEW_MAP(Constant,Constant);
+    m2 = NEW_MAP(Constant,Constant);
+    MAP_ADD_STRING_KEY(m1, "a", createConstInt(1));
+    MAP_ADD_STRING_KEY(m1, "b", createConstInt(2));
+    MAP_ADD_STRING_KEY(m2, "b", createConstInt(2));
+    MAP_ADD_STRING_KEY(m2, "a", createConstInt(1));
+
+    ASSERT_EQUALS_LONG(hashValue(m1), hashValue(m2), "same hash for m1 and m2");
+    ASSERT_EQUALS_NODE(m1, m2, "m1 and m2 are equal");
+
+    MAP_ADD_STRING_KEY(m2, "a", createConstInt(3));
+    ASSERT_FALSE(equal(m1, m2), "m1 and m2 differ in value of a");
+
+    m3 = NEW_MAP(Constant,Constant);
+    MAP_ADD_STRING_KEY(m3, "c", createConstInt(4));
+    unionMap(m3, m1);
+    ASSERT_EQUALS_INT(3, mapSize(m3), "union of m3 and m1");
+    diffMap(m3, m2);
+    ASSERT_EQUALS_INT(1, mapSize(m3), "difference of m3 and m2");
+    ASSERT_TRUE(MAP_HAS_STRING_KEY(m3, "c"), "c is left in m3");
+
+    return PASS;
+}
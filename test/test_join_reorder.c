@@ -0,0 +1,168 @@
+/*
+ *------------------------------------------------------------------------------
+ *
+ * test_join_reorder.c - Testing reordering of join trees.
+ *
+ *
+ *        SUBDIR: test/
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "test_main.h"
+#include "log/logger.h"
+#include "configuration/option.h"
+#include "model/node/nodetype.h"
+#include "model/list/list.h"
+#include "model/expression/expression.h"
+#include "model/query_operator/query_operator.h"
+#include "model/query_operator/query_operator_model_checker.h"
+#include "operator_optimizer/join_reorder.h"
+#include "provenance_rewriter/prov_utility.h"
+
+static rc testAvoidCrossProducts(void);
+static rc testStableJoinOrder(void);
+static rc testOuterJoins(void);
+static QueryOperator *createChainQuery (void);
+static QueryOperator *createTable (char *name, char *a, char *b);
+static QueryOperator *createJoin (JoinType type, QueryOperator *l, QueryOperator *r,
+        char *lAttr, char *rAttr);
+static Node *createEq (QueryOperator *in, char *lAttr, char *rAttr);
+static boolean countJoins (QueryOperator *op, void *context);
+
+rc
+testJoinReorder(void)
+{
+    boolean check = getBoolOption(OPTION_AGGRESSIVE_MODEL_CHECKING);
+
+    setBoolOption(OPTION_AGGRESSIVE_MODEL_CHECKING, TRUE);
+
+    RUN_TEST(testAvoidCrossProducts(), "test reordering joins to avoid cross products");
+    RUN_TEST(testStableJoinOrder(), "test best join order is not changed");
+    RUN_TEST(testOuterJoins(), "test outer joins are not reordered");
+
+    setBoolOption(OPTION_AGGRESSIVE_MODEL_CHECKING, check);
+
+    return PASS;
+}
+
+static rc
+testAvoidCrossProducts(void)
+{
+    QueryOperator *q = createChainQuery();
+    List *attrNames = getQueryOperatorAttrNames(q);
+    int joins[2] = { 0, 0 };
+
+    q = reorderJoins(q);
+
+    ASSERT_TRUE(checkModel(q), "reordered plan is consistent");
+    ASSERT_TRUE(equalStringList(attrNames, getQueryOperatorAttrNames(q)), "same attributes");
+    visitQOGraph(q, TRAVERSAL_PRE, countJoins, joins);
+    ASSERT_EQUALS_INT(3, joins[0], "three joins");
+    ASSERT_EQUALS_INT(0, joins[1], "no cross products");
+
+    return PASS;
+}
+
+static rc
+testStableJoinOrder(void)
+{
+    QueryOperator *q = reorderJoins(createChainQuery());
+    int numOps = numOpsInGraph(q);
+
+    ASSERT_TRUE(reorderJoins(q) == q, "same root");
+    ASSERT_EQUALS_INT(numOps, numOpsInGraph(q), "plan has not been changed");
+
+    return PASS;
+}
+
+static rc
+testOuterJoins(void)
+{
+    QueryOperator *r = createTable("R", "A", "B");
+    QueryOperator *s = createTable("s", "c", "d");
+    QueryOperator *t = createTable("T", "e", "f");
+    QueryOperator *q, *orig;
+
+    q = createJoin(JOIN_LEFT_OUTER, createJoin(JOIN_LEFT_OUTER, r, t, "B", "e"),
+            s, "A", "c");
+    orig = (QueryOperator *) copyObject(q);
+
+    q = reorderJoins(q);
+
+    ASSERT_EQUALS_INT(numOpsInGraph(orig), numOpsInGraph(q), "same number of operators");
+    ASSERT_EQUALS_INT(JOIN_LEFT_OUTER, ((JoinOperator *) OP_LCHILD(q))->joinType,
+            "outer joins have not been reordered");
+
+    return PASS;
+}
+
+/*
+ * Selection over cross products of R, T, U, and s for the chain of join
+ * conditions A = c, d = e, and f = g
+ */
+static QueryOperator *
+createChainQuery (void)
+{
+    QueryOperator *r = createTable("R", "A", "B");
+    QueryOperator *s = createTable("s", "c", "d");
+    QueryOperator *t = createTable("T", "e", "f");
+    QueryOperator *u = createTable("U", "g", "h");
+    QueryOperator *j, *sel;
+
+    j = createJoin(JOIN_CROSS, createJoin(JOIN_CROSS, createJoin(JOIN_CROSS, r, t,
+            NULL, NULL), u, NULL, NULL), s, NULL, NULL);
+    sel = (QueryOperator *) createSelectionOp(
+            AND_EXPRS(createEq(j, "A", "c"), createEq(j, "d", "e"), createEq(j, "f", "g")),
+            j, NIL, getQueryOperatorAttrNames(j));
+    addParent(j, sel);
+
+    return sel;
+}
+
+static QueryOperator *
+createTable (char *name, char *a, char *b)
+{
+    return (QueryOperator *) createTableAccessOp(strdup(name), NULL, strdup(name), NIL,
+            LIST_MAKE(strdup(a), strdup(b)), LIST_MAKE_INT(DT_INT, DT_INT));
+}
+
+static QueryOperator *
+createJoin (JoinType type, QueryOperator *l, QueryOperator *r, char *lAttr, char *rAttr)
+{
+    Node *cond = NULL;
+    QueryOperator *j;
+
+    if (lAttr != NULL)
+        cond = (Node *) createOpExpr(strdup("="), LIST_MAKE(
+                createFullAttrReference(strdup(lAttr), 0, getAttrPos(l, lAttr), INVALID_ATTR, DT_INT),
+                createFullAttrReference(strdup(rAttr), 1, getAttrPos(r, rAttr), INVALID_ATTR, DT_INT)));
+    j = (QueryOperator *) createJoinOp(type, cond, LIST_MAKE(l, r), NIL, NIL);
+    addParent(l, j);
+    addParent(r, j);
+
+    return j;
+}
+
+static Node *
+createEq (QueryOperator *in, char *lAttr, char *rAttr)
+{
+    return (Node *) createOpExpr(strdup("="), LIST_MAKE(
+            createFullAttrReference(strdup(lAttr), 0, getAttrPos(in, lAttr), INVALID_ATTR, DT_INT),
+            createFullAttrReference(strdup(rAttr), 0, getAttrPos(in, rAttr), INVALID_ATTR, DT_INT)));
+}
+
+static boolean
+countJoins (QueryOperator *op, void *context)
+{
+    int *joins = (int *) context;
+
+    if (isA(op, JoinOperator))
+    {
+        joins[0]++;
+        if (((JoinOperator *) op)->joinType == JOIN_CROSS)
+            joins[1]++;
+    }
+
+    return TRUE;
+}
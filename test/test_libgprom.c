@@ -25,6 +25,7 @@ static HashMap *options = NULL;
 
 static rc testConfiguration();
 static rc testRewrite(void);
+static rc testQueryProfile(void);
 static rc testLoopBackMetadata(void);
 static rc testExceptionCatching(void);
 
@@ -95,6 +96,7 @@ testLibGProM(int argc, char *argv[])
     INFO_LOG("Start tests");
     RUN_TEST(testConfiguration(), "test configuration interface");
     RUN_TEST(testRewrite(), "test rewrite function");
+    RUN_TEST(testQueryProfile(), "test query profiles");
     RUN_TEST(testLoopBackMetadata(), "test loop back metadata lookup");
     RUN_TEST(testExceptionCatching(), "test exception mechanism");
 
@@ -172,6 +174,38 @@ testRewrite(void)
     return PASS;
 }
 
+static rc
+testQueryProfile(void)
+{
+    const char *profile;
+
+    setOpts();
+    gprom_configFromOptions();
+
+    // profiling is not active by default
+    gprom_rewriteQuery("SELECT * FROM r;");
+    ASSERT_EQUALS_STRINGP(NULL, gprom_getLastProfile(), "no profile without profile_format");
+
+    gprom_setOption(OPTION_PROFILE_FORMAT, "json");
+    gprom_rewriteQuery("SELECT * FROM r;");
+    profile = gprom_getLastProfile();
+    ASSERT_TRUE(profile != NULL, "have json profile");
+    ASSERT_TRUE(isPrefix((char *) profile, "{\"query\": \"SELECT * FROM r;\""), "json profile starts with query");
+    ASSERT_TRUE(isSubstr((char *) profile, "\"phases\": ["), "json profile has phases");
+    ASSERT_TRUE(isSubstr((char *) profile, "\"operators\": "), "json profile counts operators");
+
+    gprom_setOption(OPTION_PROFILE_FORMAT, "chrome");
+    gprom_rewriteQuery("SELECT * FROM r;");
+    profile = gprom_getLastProfile();
+    ASSERT_TRUE(profile != NULL, "have chrome trace profile");
+    ASSERT_TRUE(isPrefix((char *) profile, "{\"traceEvents\": ["), "chrome trace profile");
+    ASSERT_TRUE(isSubstr((char *) profile, "\"ph\": \"X\""), "chrome trace profile has complete events");
+
+    setStringOption(OPTION_PROFILE_FORMAT, NULL);
+
+    return PASS;
+}
+
 static rc
 testLoopBackMetadata(void)
 {
@@ -36,6 +36,12 @@ typedef struct TestNameToFunc {
 static TestNameToFunc testFuncs [] = {
         { "autocast", testAutocast },
 		{ "bitset", testBitset },
+        { "bucket_assignment", testBucketAssignment },
+        { "common_subplans", testCommonSubplans },
+        { "parallel_optimizer", testParallelOptimizer },
+        { "rule_scheduler", testRuleScheduler },
+        { "join_reorder", testJoinReorder },
+        { "selection_pushdown", testSelectionPushdown },
         { "copy", testCopy },
         { "datalog_model", testDatalogModel },
         { "dynstring", testString },
@@ -50,6 +56,7 @@ static TestNameToFunc testFuncs [] = {
         { "list", testList },
         { "set", testSet },
         { "vector", testVector },
+        { "relation", testRelation },
 		{ "bitset", testBitset },
         { "hashmap", testHashMap },
 		{ "graph", testGraph },
@@ -59,10 +66,16 @@ static TestNameToFunc testFuncs [] = {
         { "equal", testEqual },
         { "stringutils", testStringUtils },
         { "tostring", testToString },
+        { "tobinary", testToBinary },
         { "dynstring", testString },
         { "parse", testParse },
         { "metadatalookup", testMetadataLookup },
         { "metadatalookup_postgres", testMetadataLookupPostgres },
+        { "metadatalookup_duckdb", testMetadataLookupDuckDB },
+        { "metadatalookup_sqlite", testMetadataLookupSQLite },
+        { "sketchfunctions", testSketchFunctions },
+        { "ps_maintenance", testPSMaintenance },
+        { "sketch_use_predicate", testSketchUsePredicate },
         { "parameter", testParameter },
         { "parse", testParse },
         { "rpq", testRPQ },
@@ -85,6 +98,7 @@ testSuites(void)
     RUN_TEST(testList(), "List model");
     RUN_TEST(testSet(), "Set");
     RUN_TEST(testVector(), "Vector");
+    RUN_TEST(testRelation(), "Relation");
 	RUN_TEST(testBitset(), "Bitset");
     RUN_TEST(testHashMap(), "HashMap");
 	RUN_TEST(testGraph(), "Graph");
@@ -92,13 +106,25 @@ testSuites(void)
 	RUN_TEST(testIntegrityConstraints(), "Integrity constraints.");
     RUN_TEST(testCopy(), "Test generic copy function");
     RUN_TEST(testEqual(), "Test generic equality function");
+    RUN_TEST(testCommonSubplans(), "Test sharing of common subplans");
+    RUN_TEST(testParallelOptimizer(), "Test optimizing independent subgraphs in parallel");
+    RUN_TEST(testRuleScheduler(), "Test fixpoint scheduler for optimization rules");
+    RUN_TEST(testJoinReorder(), "Test reordering of join trees");
+    RUN_TEST(testSelectionPushdown(), "Test pushing down selections");
+    RUN_TEST(testBucketAssignment(), "Test bucket assignment expressions");
     RUN_TEST(testStringUtils(), "Test String utilities");
     RUN_TEST(testToString(), "Test generic toString function");
+    RUN_TEST(testToBinary(), "Test binary node format");
     RUN_TEST(testString(), "Test stringinfo");
     RUN_TEST(testException(), "Exception handling");
     RUN_TEST(testParse(), "Test parser");
     RUN_TEST(testMetadataLookup(), "Test metadata lookup");
     RUN_TEST(testMetadataLookupPostgres(), "Test metadata lookup - Postgres");
+    RUN_TEST(testMetadataLookupDuckDB(), "Test metadata lookup - DuckDB");
+    RUN_TEST(testMetadataLookupSQLite(), "Test metadata lookup - SQLite");
+    RUN_TEST(testSketchFunctions(), "Test native provenance sketch functions");
+    RUN_TEST(testPSMaintenance(), "Test maintenance of cached provenance sketches");
+    RUN_TEST(testSketchUsePredicate(), "Test predicates for filtering with provenance sketches");
     RUN_TEST(testParameter(), "Test SQL parameter functions");
     RUN_TEST(testDatalogModel(), "Test datalog model features");
     RUN_TEST(testHash(), "Test hash computation for nodes");
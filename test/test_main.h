@@ -160,6 +160,12 @@ extern boolean fileExists (char *file);
 //extern rc testLibGProM(void);
 extern rc testAutocast(void);
 extern rc testBitset(void);
+extern rc testCommonSubplans(void);
+extern rc testParallelOptimizer(void);
+extern rc testRuleScheduler(void);
+extern rc testJoinReorder(void);
+extern rc testSelectionPushdown(void);
+extern rc testBucketAssignment(void);
 extern rc testCopy(void);
 extern rc testDatalogModel(void);
 extern rc testEqual(void);
@@ -173,9 +179,12 @@ extern rc testList(void);
 extern rc testLogger(void);
 extern rc testMemManager(void);
 extern rc testMetadataLookup(void);
+extern rc testMetadataLookupDuckDB(void);
 extern rc testMetadataLookupPostgres(void);
+extern rc testMetadataLookupSQLite(void);
 extern rc testParameter(void);
 extern rc testParse(void);
+extern rc testRelation(void);
 extern rc testRPQ(void);
 extern rc testSemanticOptimization(void);
 extern rc testSet(void);
@@ -190,6 +199,10 @@ extern rc testAutocast(void);
 extern rc testTemporal(void);
 extern rc testZ3(void);
 extern rc testToString(void);
+extern rc testToBinary(void);
+extern rc testSketchFunctions(void);
+extern rc testPSMaintenance(void);
+extern rc testSketchUsePredicate(void);
 extern rc testVector(void);
 
 #endif
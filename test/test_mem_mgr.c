@@ -15,8 +15,16 @@
 #include <stdio.h>
 
 #include "mem_manager/mem_mgr.h"
+#include "model/expression/expression.h"
+#include "model/list/list.h"
+#include "model/node/nodetype.h"
+#include "model/set/hashmap.h"
+#include "utility/thread_pool.h"
 #include "test_main.h"
 
+#define NUM_WORKER_TASKS 16
+#define NUM_WORKER_VALUES 1000
+
 typedef struct TestStruct
 {
     int a;
@@ -24,6 +32,14 @@ typedef struct TestStruct
     float c;
 } TestStruct;
 
+typedef struct WorkerTestTask
+{
+    int id;
+    List *result;           // created by a worker in the worker's context
+    List *copy;             // copied to the test's context
+    MemContext *context;    // context the worker created the result in
+} WorkerTestTask;
+
 static MemContext *context1;
 
 static rc allocStructs(void);
@@ -31,12 +47,16 @@ static rc switchContexts(void);
 
 static rc testCreationAndSize(void);
 static rc testFreeContextAndChildren(void);
+static rc testWorkerThreads(void);
+static void buildWorkerResult(void *arg);
+static void copyWorkerResult(void *arg);
 
 rc
 testMemManager(void)
 {
     RUN_TEST(testCreationAndSize(), "creation and memory context size");
     RUN_TEST(testFreeContextAndChildren(), "free a context and its children");
+    RUN_TEST(testWorkerThreads(), "allocate memory in worker threads");
 
     return PASS;
 }
@@ -108,6 +128,61 @@ testFreeContextAndChildren(void)
     return PASS;
 }
 
+static rc
+testWorkerThreads(void)
+{
+    MemContext *c = getCurMemContext();
+    WorkerTestTask *tasks = CNEW(WorkerTestTask, NUM_WORKER_TASKS);
+    void *args[NUM_WORKER_TASKS];
+
+    for(int i = 0; i < NUM_WORKER_TASKS; i++)
+    {
+        tasks[i].id = i;
+        args[i] = tasks + i;
+    }
+
+    runTasksInParallel(4, NUM_WORKER_TASKS, buildWorkerResult, copyWorkerResult, args);
+
+    ASSERT_EQUALS_P(c, getCurMemContext(), "still in the same memory context");
+    ASSERT_FALSE(isWorkerThread(), "not a worker thread");
+    for(int i = 0; i < NUM_WORKER_TASKS; i++)
+    {
+        List *r = tasks[i].copy;
+
+        ASSERT_FALSE(tasks[i].context == c, "worker allocated in its own context");
+        ASSERT_EQUALS_INT(NUM_WORKER_VALUES, LIST_LENGTH(r), "all values are copied");
+        ASSERT_EQUALS_INT(i, INT_VALUE(getHeadOfListP(r)), "first value of task");
+        ASSERT_EQUALS_INT(i + NUM_WORKER_VALUES - 1, INT_VALUE(getTailOfListP(r)),
+                "last value of task");
+    }
+
+    return PASS;
+}
+
+/* run by workers: create and look up values in a map with string keys */
+static void
+buildWorkerResult(void *arg)
+{
+    WorkerTestTask *t = (WorkerTestTask *) arg;
+    HashMap *m = NEW_MAP(Constant,Constant);
+
+    t->context = getCurMemContext();
+    for(int i = 0; i < NUM_WORKER_VALUES; i++)
+        MAP_ADD_STRING_KEY(m, gprom_itoa(i), createConstInt(t->id + i));
+
+    t->result = NIL;
+    for(int i = 0; i < NUM_WORKER_VALUES; i++)
+        t->result = appendToTailOfList(t->result,
+                copyObject(MAP_GET_STRING(m, gprom_itoa(i))));
+}
+
+static void
+copyWorkerResult(void *arg)
+{
+    WorkerTestTask *t = (WorkerTestTask *) arg;
+
+    t->copy = copyObject(t->result);
+}
 
 static int
 allocStructs(void)
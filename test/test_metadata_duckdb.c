@@ -0,0 +1,186 @@
+/*-----------------------------------------------------------------------------
+ *
+ * test_metadata_duckdb.c
+ *		Test the DuckDB metadata lookup plugin (run with -backend duckdb).
+ *
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "test_main.h"
+#include "common.h"
+
+#include "mem_manager/mem_mgr.h"
+#include "configuration/option.h"
+#include "log/logger.h"
+
+#include "metadata_lookup/metadata_lookup.h"
+#include "model/expression/expression.h"
+#include "model/list/list.h"
+#include "model/node/nodetype.h"
+#include "model/relation/relation.h"
+#include "model/set/hashmap.h"
+#include "model/set/vector.h"
+#include "operator_optimizer/optimizer_prop_inference.h"
+
+#include <time.h>
+
+/* number of rows of the result read by the benchmark */
+#define BENCHMARK_ROWS 10000000
+
+/* internal tests */
+static rc setupMetadataLookup(void);
+static rc testCatalogTableExists(void);
+static rc testGetAttributes(void);
+static rc testExecuteQuery(void);
+static rc testGetMinAndMax(void);
+static rc testReadLargeResult(void);
+
+#define RESULT_VALUE(_r,_row,_col) \
+    getVecString((Vector *) getVecNode((_r)->tuples, _row), _col)
+
+rc
+testMetadataLookupDuckDB(void)
+{
+    if (strpleq(getStringOption("backend"),"duckdb"))
+    {
+        RUN_TEST(setupMetadataLookup(),"setup tables");
+        RUN_TEST(testCatalogTableExists(), "test catalog table exists");
+        RUN_TEST(testGetAttributes(), "test get attributes");
+        RUN_TEST(testExecuteQuery(), "test reading query results");
+        RUN_TEST(testGetMinAndMax(), "test min and max of attributes");
+        RUN_TEST(testReadLargeResult(), "test reading a large provenance result");
+    }
+
+    return PASS;
+}
+
+static rc
+setupMetadataLookup(void)
+{
+    initMetadataLookupPlugins();
+    chooseMetadataLookupPlugin(METADATA_LOOKUP_PLUGIN_DUCKDB);
+    initMetadataLookupPlugin();
+
+    executeQueryIgnoreResult("DROP TABLE IF EXISTS metadatalookup_test1");
+    executeQueryIgnoreResult("CREATE TABLE metadatalookup_test1 "
+            "(a int, b double, c varchar, d decimal(10,2), e date)");
+    executeQueryIgnoreResult("INSERT INTO metadatalookup_test1 VALUES "
+            "(1, 1.5, 'x', 12.34, DATE '2024-02-29'), "
+            "(2, NULL, NULL, -0.05, NULL), "
+            "(3, 0.1, 'a longer string value', 7, DATE '1999-12-31')");
+    executeQueryIgnoreResult("DROP TABLE IF EXISTS metadatalookup_test2");
+    executeQueryIgnoreResult("CREATE TABLE metadatalookup_test2 (a int, b varchar)");
+    executeQueryIgnoreResult("INSERT INTO metadatalookup_test2 VALUES (3, 'b'), (1, 'c'), (2, 'a')");
+
+    DEBUG_LOG("Created test tables");
+
+    return PASS;
+}
+
+static rc
+testCatalogTableExists(void)
+{
+    ASSERT_TRUE(catalogTableExists("metadatalookup_test1"), "has table <metadatalookup_test1>");
+    ASSERT_FALSE(catalogTableExists("metadatalookup_test3"), "does not have table <metadatalookup_test3>");
+
+    return PASS;
+}
+
+static rc
+testGetAttributes(void)
+{
+    List *attrs = getAttributes("metadatalookup_test1");
+
+    ASSERT_EQUALS_INT(5, LIST_LENGTH(attrs), "five attributes");
+    ASSERT_EQUALS_STRING("A", ((AttributeDef *) getHeadOfListP(attrs))->attrName, "first attribute");
+    ASSERT_EQUALS_INT(DT_INT, ((AttributeDef *) getHeadOfListP(attrs))->dataType, "first attribute is int");
+
+    return PASS;
+}
+
+static rc
+testExecuteQuery(void)
+{
+    Relation *r = executeQuery("SELECT * FROM metadatalookup_test1 ORDER BY a");
+
+    ASSERT_EQUALS_INT(3, VEC_LENGTH(r->tuples), "three rows");
+    ASSERT_EQUALS_INT(5, LIST_LENGTH(r->schema), "five columns");
+    ASSERT_EQUALS_STRING("1", RESULT_VALUE(r,0,0), "integer");
+    ASSERT_EQUALS_STRING("1.5", RESULT_VALUE(r,0,1), "double");
+    ASSERT_EQUALS_STRING("0.1", RESULT_VALUE(r,2,1), "double without rounding noise");
+    ASSERT_EQUALS_STRING("x", RESULT_VALUE(r,0,2), "inlined string");
+    ASSERT_EQUALS_STRING("a longer string value", RESULT_VALUE(r,2,2), "string");
+    ASSERT_EQUALS_STRING("12.34", RESULT_VALUE(r,0,3), "decimal");
+    ASSERT_EQUALS_STRING("-0.05", RESULT_VALUE(r,1,3), "negative decimal");
+    ASSERT_EQUALS_STRING("2024-02-29", RESULT_VALUE(r,0,4), "date");
+    ASSERT_EQUALS_STRING("NULL", RESULT_VALUE(r,1,1), "NULL double");
+    ASSERT_EQUALS_STRING("NULL", RESULT_VALUE(r,1,2), "NULL string");
+
+    // results spanning several chunks
+    r = executeQuery("SELECT i, CASE WHEN i % 2 = 0 THEN NULL ELSE i END FROM range(5000) t(i)");
+    ASSERT_EQUALS_INT(5000, VEC_LENGTH(r->tuples), "rows of all chunks are read");
+    ASSERT_EQUALS_STRING("4999", RESULT_VALUE(r,4999,0), "last row");
+    ASSERT_EQUALS_STRING("NULL", RESULT_VALUE(r,4998,1), "validity mask of later chunk");
+    ASSERT_EQUALS_STRING("4097", RESULT_VALUE(r,4097,1), "valid value of later chunk");
+
+    // 128 bit integers and decimals are formatted exactly
+    r = executeQuery("SELECT 170141183460469231731687303715884105727::HUGEINT, "
+            "(-9007199254740993)::HUGEINT, 12345678901234567890.123::DECIMAL(38,3)");
+    ASSERT_EQUALS_STRING("170141183460469231731687303715884105727", RESULT_VALUE(r,0,0),
+            "maximal hugeint");
+    ASSERT_EQUALS_STRING("-9007199254740993", RESULT_VALUE(r,0,1),
+            "hugeint that is not representable as double");
+    ASSERT_EQUALS_STRING("12345678901234567890.123", RESULT_VALUE(r,0,2), "wide decimal");
+
+    // other types are converted to strings by DuckDB
+    r = executeQuery("SELECT INTERVAL 1 DAY, [1, 2], NULL::INTERVAL");
+    ASSERT_EQUALS_STRING("1 day", RESULT_VALUE(r,0,0), "interval");
+    ASSERT_EQUALS_STRING("[1, 2]", RESULT_VALUE(r,0,1), "list");
+    ASSERT_EQUALS_STRING("NULL", RESULT_VALUE(r,0,2), "NULL interval");
+
+    return PASS;
+}
+
+static rc
+testGetMinAndMax(void)
+{
+    HashMap *minMax = getMinAndMax("metadatalookup_test2", "A");
+
+    ASSERT_EQUALS_INT(1, INT_VALUE(MAP_GET_STRING(minMax, MIN_KEY)), "min of A");
+    ASSERT_EQUALS_INT(3, INT_VALUE(MAP_GET_STRING(minMax, MAX_KEY)), "max of A");
+
+    minMax = getMinAndMax("metadatalookup_test2", "B");
+    ASSERT_EQUALS_STRING("a", STRING_VALUE(MAP_GET_STRING(minMax, MIN_KEY)), "min of B");
+    ASSERT_EQUALS_STRING("c", STRING_VALUE(MAP_GET_STRING(minMax, MAX_KEY)), "max of B");
+
+    return PASS;
+}
+
+/*
+ * Read a result with BENCHMARK_ROWS rows shaped like the result of a
+ * provenance capture query (normal attribute and provenance attributes).
+ */
+static rc
+testReadLargeResult(void)
+{
+    StringInfo q = makeStringInfo();
+    Relation *r;
+    clock_t start;
+    double secs;
+
+    appendStringInfo(q, "SELECT i AS a, i %% 1000 AS prov_r_a, 'r' || (i %% 7) AS prov_r_b"
+            " FROM range(%d) t(i)", BENCHMARK_ROWS);
+
+    start = clock();
+    r = executeQuery(q->data);
+    secs = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+    DEBUG_LOG("read %d rows in %f sec (%f rows/sec)", BENCHMARK_ROWS, secs,
+            BENCHMARK_ROWS / (secs > 0 ? secs : 1));
+
+    ASSERT_EQUALS_INT(BENCHMARK_ROWS, VEC_LENGTH(r->tuples), "all rows are read");
+    ASSERT_EQUALS_STRING("999", RESULT_VALUE(r,BENCHMARK_ROWS - 1,1), "provenance of last row");
+
+    return PASS;
+}
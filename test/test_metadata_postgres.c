@@ -24,6 +24,8 @@
 #include "model/list/list.h"
 #include "model/node/nodetype.h"
 #include "model/query_block/query_block.h"
+#include "model/set/hashmap.h"
+#include "model/set/set.h"
 
 
 /* internal tests */
@@ -31,10 +33,14 @@ static rc testCatalogTableExists(void);
 static rc testViewExists(void);
 static rc testGetAttributes(void);
 static rc testIsAgg(void);
+static rc testPrefetchCatalog(void);
 static rc testGetTableDefinition(void);
 static rc testTransactionSQLAndSCNs(void);
 static rc testGetViewDefinition(void);
 static rc testRunTransactionAndGetXid(void);
+static rc testExecuteQuery(void);
+static rc testResultStream(void);
+static rc testPooledAsyncQuery(void);
 static rc setupMetadataLookup(void);
 static rc testDatabaseConnectionClose(void);
 
@@ -48,10 +54,14 @@ testMetadataLookupPostgres(void)
         RUN_TEST(testViewExists(), "test view exists");
         RUN_TEST(testGetAttributes(), "test get attributes");
         RUN_TEST(testIsAgg(), "test is aggregation functions");
+        RUN_TEST(testPrefetchCatalog(), "test prefetching catalog information");
         RUN_TEST(testGetTableDefinition(), "test get table definition");
         RUN_TEST(testTransactionSQLAndSCNs(), "test transaction SQL and SCN");
         RUN_TEST(testGetViewDefinition(), "test get view definition");
         RUN_TEST(testRunTransactionAndGetXid(), "test transaction execution and XID retrieval");
+        RUN_TEST(testExecuteQuery(), "test executing queries");
+        RUN_TEST(testResultStream(), "test streaming query results");
+        RUN_TEST(testPooledAsyncQuery(), "test running async queries on pooled connections");
         RUN_TEST(testDatabaseConnectionClose(), "test close database connection");
     }
 
@@ -88,6 +98,7 @@ setupMetadataLookup(void)
     EXEC_CHECK(c,"DROP TABLE IF EXISTS metadatalookup_test1 CASCADE;", "drop test1");
     EXEC_CHECK(c,"DROP TABLE IF EXISTS metadatalookup_test2 CASCADE;", "drop test2");
     EXEC_CHECK(c,"DROP VIEW IF EXISTS metadatalookup_view1 CASCADE;", "drop view1");
+    EXEC_CHECK(c,"DROP TABLE IF EXISTS metadatalookup_prefetch CASCADE;", "drop prefetch");
 
     EXEC_CHECK(c, "CREATE TABLE metadatalookup_test1"
             " (a int, b int, c int)", "Create table 1");
@@ -96,6 +107,11 @@ setupMetadataLookup(void)
     EXEC_CHECK(c, "CREATE VIEW "
             "metadatalookup_view1 as select * from metadatalookup_test1",
             "Create view 1");
+    EXEC_CHECK(c, "CREATE TABLE "
+            "metadatalookup_prefetch (x int PRIMARY KEY, y text)", "Create prefetch table");
+    EXEC_CHECK(c, "CREATE VIEW "
+            "metadatalookup_prefetch_view as select x from metadatalookup_prefetch",
+            "Create prefetch view");
 
     DEBUG_LOG("Created test tables");
 
@@ -168,6 +184,54 @@ testIsAgg(void)
     return PASS;
 }
 
+static rc
+testPrefetchCatalog(void)
+{
+    CatalogCache *cache = activePlugin->cache;
+    PGconn *c = getPostgresConnection();
+    List *keys;
+
+    setBoolOption(OPTION_PREFETCH_CATALOG, TRUE);
+    prefetchCatalog(LIST_MAKE("metadatalookup_prefetch", "metadatalookup_prefetch_view",
+                    "metadatalookup_missing"),
+            LIST_MAKE("count", "UPPER", "row_number", "metadatalookup_nofunc"));
+
+    ASSERT_TRUE(hasSetElem(cache->tableNames, "metadatalookup_prefetch"), "table is cached");
+    ASSERT_EQUALS_INT(2, LIST_LENGTH((List *) MAP_GET_STRING(cache->tableAttrs,
+            "metadatalookup_prefetch")), "attributes are cached");
+    ASSERT_EQUALS_STRING("x", ((AttributeDef *) getHeadOfListP((List *)
+            MAP_GET_STRING(cache->tableAttrDefs, "metadatalookup_prefetch")))->attrName,
+            "attribute definitions are cached");
+    ASSERT_TRUE(hasSetElem(cache->viewNames, "metadatalookup_prefetch_view"), "view is cached");
+    ASSERT_TRUE(MAP_HAS_STRING_KEY(cache->viewDefs, "metadatalookup_prefetch_view"),
+            "view definition is cached");
+    ASSERT_FALSE(catalogTableExists("metadatalookup_missing"), "missing table");
+    ASSERT_TRUE(hasSetElem(cache->aggFuncNames, "count"), "aggregate function is cached");
+    ASSERT_FALSE(isAgg("upper"), "upper is not an aggregate");
+    ASSERT_TRUE(isWindowFunction("row_number"), "row_number is a window function");
+    ASSERT_FALSE(isWindowFunction("metadatalookup_nofunc"), "missing function");
+
+    keys = getKeyInformation("metadatalookup_prefetch");
+    ASSERT_EQUALS_INT(1, LIST_LENGTH(keys), "table has a key");
+    ASSERT_TRUE(hasSetElem((Set *) getHeadOfListP(keys), "x"), "key is x");
+    ASSERT_EQUALS_INT(0, LIST_LENGTH(getKeyInformation("metadatalookup_test1")),
+            "table without key");
+
+    // keys are fetched again for the next statement
+    prefetchCatalog(singleton("metadatalookup_test2"), NIL);
+    ASSERT_EQUALS_INT(0, LIST_LENGTH(getKeyInformation("metadatalookup_test2")),
+            "table without key");
+    EXEC_CHECK(c, "ALTER TABLE metadatalookup_test2 ADD PRIMARY KEY (d)", "add key");
+    prefetchCatalog(singleton("metadatalookup_test2"), NIL);
+    keys = getKeyInformation("metadatalookup_test2");
+    ASSERT_EQUALS_INT(1, LIST_LENGTH(keys), "added key is found");
+    EXEC_CHECK(c, "ALTER TABLE metadatalookup_test2 DROP CONSTRAINT metadatalookup_test2_pkey",
+            "drop key");
+    setBoolOption(OPTION_PREFETCH_CATALOG, FALSE);
+
+    return PASS;
+}
+
 static rc
 testGetTableDefinition()
 {
@@ -228,6 +292,87 @@ testRunTransactionAndGetXid()
     return PASS;
 }
 
+static rc
+testExecuteQuery()
+{
+    Relation *r;
+
+    executeQueryIgnoreResult("INSERT INTO metadatalookup_test2 VALUES (1,NULL), (2,3)");
+    r = executeQuery("SELECT d, e FROM metadatalookup_test2 ORDER BY d");
+
+    ASSERT_EQUALS_INT(2, VEC_LENGTH(r->tuples), "two rows");
+    ASSERT_EQUALS_STRING("NULL", getVecString((Vector *) getVecNode(r->tuples, 0), 1), "NULL value");
+    ASSERT_EQUALS_STRING("3", getVecString((Vector *) getVecNode(r->tuples, 1), 1), "value of second row");
+    ASSERT_TRUE(catalogTableExists("metadatalookup_test2"), "catalog lookup after query");
+
+    return PASS;
+}
+
+static rc
+testResultStream()
+{
+    List *schema;
+    Vector *t;
+    int numRows = 0;
+
+    ASSERT_TRUE(supportsResultStreaming(), "postgres streams results");
+
+    schema = openResultStream("SELECT i AS a, i % 7 AS b FROM generate_series(1,10000) i");
+    ASSERT_EQUALS_INT(2, LIST_LENGTH(schema), "two attributes");
+    ASSERT_EQUALS_STRING("b", (char *) getNthOfListP(schema, 1), "schema of streamed result");
+    while((t = nextStreamTuple()) != NULL)
+    {
+        numRows++;
+        ASSERT_EQUALS_STRING(gprom_itoa(numRows), getVecString(t, 0), "rows are streamed in order");
+        deepFreeVec(t);
+    }
+    closeResultStream();
+    ASSERT_EQUALS_INT(10000, numRows, "all rows are streamed");
+
+    // closing a stream before reading all rows leaves the connection usable
+    openResultStream("SELECT i FROM generate_series(1,10000) i");
+    t = nextStreamTuple();
+    ASSERT_EQUALS_STRING("1", getVecString(t, 0), "first row");
+    closeResultStream();
+    ASSERT_TRUE(catalogTableExists("metadatalookup_test1"), "catalog lookup after closing stream");
+
+    return PASS;
+}
+
+/*
+ * A read-only query sent asynchronously runs on a pooled connection, so
+ * catalog lookups do not have to wait for it.
+ */
+static rc
+testPooledAsyncQuery()
+{
+    int oldSize = getIntOption(OPTION_CONN_POOL_SIZE);
+    struct timeval st, et;
+    Relation *r;
+
+    setIntOption(OPTION_CONN_POOL_SIZE, 2);
+    sendQuery("SELECT 1 FROM pg_sleep(1)");
+    gettimeofday(&st, NULL);
+    ASSERT_TRUE(catalogTableExists("metadatalookup_test1"), "catalog lookup while query is running");
+    ASSERT_EQUALS_INT(2, LIST_LENGTH(getAttributes("metadatalookup_test2")), "attributes while query is running");
+    gettimeofday(&et, NULL);
+    ASSERT_TRUE(et.tv_sec - st.tv_sec < 1, "catalog lookups do not wait for the query");
+
+    r = getQueryResult(FALSE);
+    ASSERT_EQUALS_STRING("1", getVecString((Vector *) getVecNode(r->tuples, 0), 0), "result of pooled query");
+
+    // statements that modify the database run on the plugin's connection
+    sendQuery("INSERT INTO metadatalookup_test2 VALUES (3,4)");
+    getQueryResult(TRUE);
+    r = executeQuery("SELECT count(*) FROM metadatalookup_test2");
+    ASSERT_EQUALS_STRING("3", getVecString((Vector *) getVecNode(r->tuples, 0), 0), "insert is visible");
+
+    closeConnectionPool();
+    setIntOption(OPTION_CONN_POOL_SIZE, oldSize);
+
+    return PASS;
+}
+
 static rc
 testDatabaseConnectionClose()
 {
@@ -262,6 +407,12 @@ testIsAgg(void)
     return PASS;
 }
 
+static rc
+testPrefetchCatalog(void)
+{
+    return PASS;
+}
+
 static rc
 testGetTableDefinition()
 {
@@ -298,4 +449,22 @@ testRunTransactionAndGetXid()
     return PASS;
 }
 
+static rc
+testExecuteQuery()
+{
+    return PASS;
+}
+
+static rc
+testResultStream()
+{
+    return PASS;
+}
+
+static rc
+testPooledAsyncQuery()
+{
+    return PASS;
+}
+
 #endif
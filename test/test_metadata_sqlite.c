@@ -0,0 +1,478 @@
+/*-----------------------------------------------------------------------------
+ *
+ * test_metadata_sqlite.c
+ *		Test the SQLite metadata lookup plugin and its statement cache.
+ *
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "test_main.h"
+#include "common.h"
+
+#include "mem_manager/mem_mgr.h"
+#include "configuration/option.h"
+#include "log/logger.h"
+#include "exception/exception.h"
+#include "rewriter.h"
+#include "instrumentation/backend_instrumentation.h"
+
+#include "metadata_lookup/metadata_lookup.h"
+#include "metadata_lookup/metadata_lookup_sqlite.h"
+#include "model/expression/expression.h"
+#include "model/list/list.h"
+#include "model/node/nodetype.h"
+#include "model/relation/relation.h"
+#include "model/set/set.h"
+#include "model/set/vector.h"
+
+#include <time.h>
+
+/* number of tables and repetitions of the catalog lookup benchmark */
+#define BENCHMARK_TABLES 50
+#define BENCHMARK_ROUNDS 20
+
+/* internal tests */
+static rc setupMetadataLookup(void);
+static rc testGetAttributes(void);
+static rc testGetKeyInformation(void);
+static rc testCachedQueries(void);
+static rc testCacheEviction(void);
+static rc testFailedCachedQueries(void);
+static ExceptionHandler abortOnException (const char *message, const char *file, int line, ExceptionSeverity s);
+static boolean queryFails (char *q, boolean ignoreResult);
+static rc testSampleHistogram(void);
+static rc testDictEncodedResults(void);
+static rc testBackendStats(void);
+static long statsValue (char *json, char *entryPoint, char *field);
+static rc testConnectionPool(void);
+static rc testCatalogLookupTime(void);
+static double lookupTables(int cacheSize);
+
+#define RESULT_VALUE(_r,_row,_col) \
+    getVecString((Vector *) getVecNode((_r)->tuples, _row), _col)
+
+rc
+testMetadataLookupSQLite(void)
+{
+    if (strpeq(getStringOption(OPTION_PLUGIN_METADATA), "sqlite") && isInitialized())
+    {
+        RUN_TEST(setupMetadataLookup(),"setup tables");
+        RUN_TEST(testGetAttributes(), "test get attributes");
+        RUN_TEST(testGetKeyInformation(), "test get key information");
+        RUN_TEST(testCachedQueries(), "test rerunning cached queries");
+        RUN_TEST(testCacheEviction(), "test evicting statements from the cache");
+        RUN_TEST(testFailedCachedQueries(), "test cached statements of failed queries are released");
+        RUN_TEST(testSampleHistogram(), "test histograms computed from a sample");
+        RUN_TEST(testDictEncodedResults(), "test catalog lookups with dictionary encoded results");
+        RUN_TEST(testBackendStats(), "test backend call statistics");
+        RUN_TEST(testConnectionPool(), "test pooled connections");
+        RUN_TEST(testCatalogLookupTime(), "test catalog lookup time for many tables");
+    }
+
+    return PASS;
+}
+
+/*
+ * Test tables are temporary tables to not modify the test database.
+ */
+static rc
+setupMetadataLookup(void)
+{
+    executeQueryIgnoreResult("CREATE TEMP TABLE IF NOT EXISTS metadatalookup_test1 "
+            "(a INT PRIMARY KEY, b TEXT, c DOUBLE)");
+    executeQueryIgnoreResult("DELETE FROM metadatalookup_test1");
+    executeQueryIgnoreResult("INSERT INTO metadatalookup_test1 VALUES (1,'x',1.5), (2,NULL,2.5)");
+
+    executeQueryIgnoreResult("CREATE TEMP TABLE IF NOT EXISTS metadatalookup_hist (a INT, b TEXT)");
+    executeQueryIgnoreResult("DELETE FROM metadatalookup_hist");
+    executeQueryIgnoreResult("WITH RECURSIVE r(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM r WHERE i < 1000) "
+            "INSERT INTO metadatalookup_hist SELECT i, 'v' || i FROM r");
+    executeQueryIgnoreResult("INSERT INTO metadatalookup_hist VALUES (NULL, 'x,y')");
+
+    for (int i = 0; i < BENCHMARK_TABLES; i++)
+    {
+        StringInfo q = makeStringInfo();
+        appendStringInfo(q, "CREATE TEMP TABLE IF NOT EXISTS metadatalookup_bench%d "
+                "(id INT PRIMARY KEY, a%d INT, b%d TEXT)", i, i, i);
+        executeQueryIgnoreResult(q->data);
+    }
+
+    return PASS;
+}
+
+static rc
+testGetAttributes(void)
+{
+    List *attrs;
+
+    // the cached statement is rerun with a different parameter
+    attrs = getAttributes("metadatalookup_test1");
+    ASSERT_EQUALS_INT(3, LIST_LENGTH(attrs), "three attributes");
+    ASSERT_EQUALS_STRING("B", ((AttributeDef *) getNthOfListP(attrs, 1))->attrName, "second attribute");
+    ASSERT_EQUALS_INT(DT_FLOAT, ((AttributeDef *) getNthOfListP(attrs, 2))->dataType, "third attribute is float");
+
+    attrs = getAttributes("metadatalookup_bench3");
+    ASSERT_EQUALS_STRING("A3", ((AttributeDef *) getNthOfListP(attrs, 1))->attrName, "attribute of other table");
+
+    return PASS;
+}
+
+static rc
+testGetKeyInformation(void)
+{
+    List *keys = getKeyInformation("metadatalookup_test1");
+
+    ASSERT_EQUALS_INT(1, LIST_LENGTH(keys), "one key");
+    ASSERT_TRUE(hasSetElem((Set *) getHeadOfListP(keys), "A"), "A is the key");
+
+    return PASS;
+}
+
+static rc
+testCachedQueries(void)
+{
+    char *q = "SELECT a, b FROM metadatalookup_test1 ORDER BY a";
+    Relation *r;
+
+    r = executeQuery(q);
+    ASSERT_EQUALS_INT(2, VEC_LENGTH(r->tuples), "two rows");
+
+    // cached statement sees changes of data and schema
+    executeQueryIgnoreResult("INSERT INTO metadatalookup_test1 VALUES (3,'z',3.5)");
+    r = executeQuery(q);
+    ASSERT_EQUALS_INT(3, VEC_LENGTH(r->tuples), "three rows after insert");
+    ASSERT_EQUALS_STRING("NULL", RESULT_VALUE(r,1,1), "NULL value");
+    ASSERT_EQUALS_STRING("z", RESULT_VALUE(r,2,1), "inserted value");
+
+    // statements of queries with trailing whitespace are released too
+    for (int i = 0; i < 2; i++)
+    {
+        r = executeQuery("SELECT a FROM metadatalookup_test1 WHERE a = 1;\n");
+        ASSERT_EQUALS_STRING("1", RESULT_VALUE(r,0,0), "query with trailing newline");
+        ASSERT_EQUALS_INT(0, sqliteGetNumCachedStmtsInUse(), "statement of query with trailing newline released");
+    }
+
+    executeQueryIgnoreResult("ALTER TABLE metadatalookup_test1 ADD COLUMN d INT");
+    ASSERT_EQUALS_INT(4, LIST_LENGTH(getAttributes("metadatalookup_test1")), "attributes after schema change");
+
+    return PASS;
+}
+
+static rc
+testCacheEviction(void)
+{
+    int oldSize = getIntOption(OPTION_SQLITE_STMT_CACHE_SIZE);
+    Relation *r;
+
+    setIntOption(OPTION_SQLITE_STMT_CACHE_SIZE, 2);
+    for (int i = 0; i < 5; i++)
+    {
+        StringInfo q = makeStringInfo();
+        appendStringInfo(q, "SELECT %d + a FROM metadatalookup_test1 WHERE a = 1", i);
+        r = executeQuery(q->data);
+        ASSERT_EQUALS_STRING(gprom_itoa(i + 1), RESULT_VALUE(r,0,0), "result with small cache");
+    }
+    r = executeQuery("SELECT 0 + a FROM metadatalookup_test1 WHERE a = 1");
+    ASSERT_EQUALS_STRING("1", RESULT_VALUE(r,0,0), "rerun evicted statement");
+
+    setIntOption(OPTION_SQLITE_STMT_CACHE_SIZE, 0);
+    r = executeQuery("SELECT 0 + a FROM metadatalookup_test1 WHERE a = 1");
+    ASSERT_EQUALS_STRING("1", RESULT_VALUE(r,0,0), "no caching");
+
+    setIntOption(OPTION_SQLITE_STMT_CACHE_SIZE, oldSize);
+
+    return PASS;
+}
+
+/*
+ * Queries that fail while being stepped through release their cached
+ * statement, so the statement is reused by the next execution.
+ */
+static rc
+testFailedCachedQueries(void)
+{
+    char *q = "SELECT abs(a - 9223372036854775807 - 2) FROM metadatalookup_test1 WHERE a = 1";
+    char *ins = "INSERT INTO metadatalookup_test1 (a, b, c) VALUES (1,'dup',0.5)";
+    Relation *r;
+
+    registerExceptionCallback(abortOnException);
+
+    for (int i = 0; i < 2; i++)
+    {
+        ASSERT_TRUE(queryFails(q, FALSE), "query overflows");
+        ASSERT_EQUALS_INT(0, sqliteGetNumCachedStmtsInUse(), "statement of failed query released");
+    }
+
+    ASSERT_TRUE(queryFails(ins, TRUE), "duplicate key violates constraint");
+    ASSERT_EQUALS_INT(0, sqliteGetNumCachedStmtsInUse(), "statement of failed update released");
+
+    registerExceptionCallback(NULL);
+
+    r = executeQuery("SELECT b FROM metadatalookup_test1 WHERE a = 1");
+    ASSERT_EQUALS_STRING("x", RESULT_VALUE(r,0,0), "queries run after failure");
+
+    return PASS;
+}
+
+static ExceptionHandler
+abortOnException (const char *message, const char *file, int line, ExceptionSeverity s)
+{
+    return EXCEPTION_ABORT;
+}
+
+static boolean
+queryFails (char *q, boolean ignoreResult)
+{
+    volatile boolean failed = FALSE;
+
+    NEW_AND_ACQUIRE_MEMCONTEXT(QUERY_MEM_CONTEXT);
+    TRY
+    {
+        if (ignoreResult)
+            executeQueryIgnoreResult(q);
+        else
+            executeQuery(q);
+        FREE_AND_RELEASE_CUR_MEM_CONTEXT();
+    }
+    ON_EXCEPTION
+    {
+        failed = TRUE;
+    }
+    END_ON_EXCEPTION
+
+    return failed;
+}
+
+/*
+ * SQLite has no statistics, histograms are computed from a sample.
+ */
+static rc
+testSampleHistogram(void)
+{
+    int oldSize = getIntOption(OPTION_PS_HISTOGRAM_SAMPLE_SIZE);
+    List *hist;
+
+    // the whole table fits into the sample
+    hist = getHist("metadatalookup_hist", "a", 4);
+    ASSERT_EQUALS_INT(3, LIST_LENGTH(hist), "histogram, min, and max");
+    ASSERT_EQUALS_STRING("{1,250,500,750,1000}", getHeadOfListP(hist), "equi-depth bounds");
+    ASSERT_EQUALS_STRING("1", getNthOfListP(hist, 1), "min");
+    ASSERT_EQUALS_STRING("1000", getNthOfListP(hist, 2), "max");
+
+    hist = getHist("metadatalookup_hist", "b", 2);
+    ASSERT_EQUALS_STRING("{v1,v549,\"x,y\"}", getHeadOfListP(hist), "string bounds are quoted if necessary");
+    ASSERT_EQUALS_STRING("v1", getNthOfListP(hist, 1), "min of strings");
+    ASSERT_EQUALS_STRING("x,y", getNthOfListP(hist, 2), "max of strings");
+
+    // cached until the table's histograms are invalidated
+    executeQueryIgnoreResult("INSERT INTO metadatalookup_hist VALUES (5000, 'v5000')");
+    hist = getHist("metadatalookup_hist", "a", 4);
+    ASSERT_EQUALS_STRING("1000", getNthOfListP(hist, 2), "cached max");
+    invalidateHistograms("metadatalookup_hist");
+    hist = getHist("metadatalookup_hist", "a", 4);
+    ASSERT_EQUALS_STRING("5000", getNthOfListP(hist, 2), "max after invalidation");
+
+    // min and max are exact even if only some values are sampled
+    setIntOption(OPTION_PS_HISTOGRAM_SAMPLE_SIZE, 50);
+    invalidateHistograms(NULL);
+    hist = getHist("metadatalookup_hist", "a", 10);
+    ASSERT_EQUALS_STRING("1", getNthOfListP(hist, 1), "min of sample");
+    ASSERT_EQUALS_STRING("5000", getNthOfListP(hist, 2), "max of sample");
+    setIntOption(OPTION_PS_HISTOGRAM_SAMPLE_SIZE, oldSize);
+
+    return PASS;
+}
+
+/*
+ * Calls of metadata lookup entry points are only recorded with
+ * -backend_instrumentation. Statistics of the current query are reset when
+ * the next query starts, session statistics are kept. A call that raised an
+ * exception is not recorded.
+ */
+static rc
+testBackendStats(void)
+{
+    char *q = "SELECT a FROM metadatalookup_test1";
+    char *json;
+
+    shutdownBackendInstrumentation();
+    executeQuery(q);
+    ASSERT_EQUALS_STRING("{\"entry_points\": []}", backendStatsToJSON(TRUE),
+            "no statistics without backend_instrumentation");
+
+    setBoolOption(OPTION_BACKEND_INSTRUMENTATION, TRUE);
+    backendInstrumentationStartQuery();
+    executeQuery(q);
+    executeQuery(q);
+    catalogTableExists("metadatalookup_test1");
+
+    json = backendStatsToJSON(TRUE);
+    ASSERT_EQUALS_LONG(2L, statsValue(json, "executeQuery", "calls"), "two queries");
+    ASSERT_EQUALS_LONG(1L, statsValue(json, "catalogTableExists", "calls"), "one catalog lookup");
+    ASSERT_TRUE(statsValue(json, "executeQuery", "bytes") > 0, "size of query results");
+
+    backendInstrumentationStartQuery();
+    registerExceptionCallback(abortOnException);
+    ASSERT_TRUE(queryFails("SELECT * FROM metadatalookup_no_such_table", FALSE), "query fails");
+    registerExceptionCallback(NULL);
+    executeQuery(q);
+
+    json = backendStatsToJSON(TRUE);
+    ASSERT_EQUALS_LONG(1L, statsValue(json, "executeQuery", "calls"), "query statistics are reset");
+    ASSERT_EQUALS_LONG(-1L, statsValue(json, "catalogTableExists", "calls"), "no catalog lookup in query");
+    json = backendStatsToJSON(FALSE);
+    ASSERT_EQUALS_LONG(3L, statsValue(json, "executeQuery", "calls"), "session statistics are kept");
+
+    setBoolOption(OPTION_BACKEND_INSTRUMENTATION, FALSE);
+    shutdownBackendInstrumentation();
+
+    return PASS;
+}
+
+/* value of a field for an entry point in the JSON statistics or -1 */
+static long
+statsValue (char *json, char *entryPoint, char *field)
+{
+    char *e = strstr(json, CONCAT_STRINGS("{\"name\": \"", entryPoint, "\""));
+    char *f;
+
+    if (e == NULL)
+        return -1;
+
+    f = strstr(e, CONCAT_STRINGS("\"", field, "\": "));
+    if (f == NULL)
+        return -1;
+
+    return atol(f + strlen(field) + 4);
+}
+
+/*
+ * Results of the plugin are dictionary encoded with -Bdict_encode_results,
+ * code reading query results must not access their tuples directly.
+ */
+static rc
+testDictEncodedResults(void)
+{
+    boolean oldEncode = getBoolOption(OPTION_DICT_ENCODE_RESULTS);
+    Relation *r;
+    Vector *t;
+    List *hist;
+    List *rowHist;
+    int numTuples = 0;
+
+    setBoolOption(OPTION_DICT_ENCODE_RESULTS, TRUE);
+
+    r = executeQuery("SELECT a, b FROM metadatalookup_test1 ORDER BY a");
+    ASSERT_TRUE(r->data != NULL, "result is dictionary encoded");
+    ASSERT_EQUALS_STRING("x", getRelationValue(r, 0, 1), "value of encoded result");
+
+    openResultStream("SELECT a, b FROM metadatalookup_test1 ORDER BY a");
+    while ((t = nextStreamTuple()) != NULL)
+    {
+        if (numTuples++ == 1)
+            ASSERT_EQUALS_STRING("NULL", getVecString(t, 1), "NULL value of streamed tuple");
+    }
+    closeResultStream();
+    ASSERT_EQUALS_INT(getRelationNumTuples(r), numTuples, "all tuples are streamed");
+
+    // same histogram as for results in row format
+    invalidateHistograms(NULL);
+    hist = getHist("metadatalookup_hist", "a", 4);
+    setBoolOption(OPTION_DICT_ENCODE_RESULTS, FALSE);
+    invalidateHistograms(NULL);
+    rowHist = getHist("metadatalookup_hist", "a", 4);
+    ASSERT_EQUALS_STRING(getHeadOfListP(rowHist), getHeadOfListP(hist), "histogram of encoded result");
+    ASSERT_EQUALS_STRING("1", getNthOfListP(hist, 1), "min of encoded result");
+    ASSERT_EQUALS_STRING("5000", getNthOfListP(hist, 2), "max of encoded result");
+
+    setBoolOption(OPTION_DICT_ENCODE_RESULTS, oldEncode);
+
+    return PASS;
+}
+
+/*
+ * Pooled connections are separate connections to the database file, so they
+ * do not see the temporary tables of the plugin's connection.
+ */
+static rc
+testConnectionPool(void)
+{
+    int oldSize = getIntOption(OPTION_CONN_POOL_SIZE);
+    char *q = "SELECT count(*) FROM sqlite_temp_master WHERE name = 'metadatalookup_test1'";
+    void *c1, *c2, *mainConn;
+    Relation *r;
+
+    ASSERT_TRUE(supportsConnectionPool(), "SQLite supports pooled connections");
+
+    setIntOption(OPTION_CONN_POOL_SIZE, 1);
+    ASSERT_TRUE(checkoutConnection() == NULL, "no additional connections");
+
+    setIntOption(OPTION_CONN_POOL_SIZE, 3);
+    c1 = checkoutConnection();
+    c2 = checkoutConnection();
+    ASSERT_TRUE(c1 != NULL && c2 != NULL && c1 != c2, "two additional connections");
+    ASSERT_TRUE(checkoutConnection() == NULL, "pool is exhausted");
+
+    mainConn = useConnection(c1);
+    r = executeQuery(q);
+    ASSERT_EQUALS_STRING("0", RESULT_VALUE(r,0,0), "temp table is not visible on pooled connection");
+    r = executeQuery(q);
+    ASSERT_EQUALS_STRING("0", RESULT_VALUE(r,0,0), "cached statement of pooled connection");
+    ASSERT_TRUE(useConnection(c2) == c1, "switch between pooled connections");
+    useConnection(mainConn);
+    r = executeQuery(q);
+    ASSERT_EQUALS_STRING("1", RESULT_VALUE(r,0,0), "temp table is visible on main connection");
+
+    // returned connections are reused
+    checkinConnection(c1);
+    ASSERT_TRUE(checkoutConnection() == c1, "reuse idle connection");
+    checkinConnection(c1);
+    checkinConnection(c2);
+    closeConnectionPool();
+    ASSERT_TRUE(executeQuery(q) != NULL, "main connection is open after closing the pool");
+
+    setIntOption(OPTION_CONN_POOL_SIZE, oldSize);
+
+    return PASS;
+}
+
+/*
+ * Run the catalog lookups done during analysis of a query over
+ * BENCHMARK_TABLES tables with and without the statement cache.
+ */
+static rc
+testCatalogLookupTime(void)
+{
+    int oldSize = getIntOption(OPTION_SQLITE_STMT_CACHE_SIZE);
+    double uncached = lookupTables(0);
+    double cached = lookupTables(oldSize);
+
+    DEBUG_LOG("catalog lookups for %d tables (%d rounds): %f sec without, %f sec with statement cache",
+            BENCHMARK_TABLES, BENCHMARK_ROUNDS, uncached, cached);
+    setIntOption(OPTION_SQLITE_STMT_CACHE_SIZE, oldSize);
+
+    return PASS;
+}
+
+static double
+lookupTables(int cacheSize)
+{
+    clock_t start;
+
+    setIntOption(OPTION_SQLITE_STMT_CACHE_SIZE, cacheSize);
+    start = clock();
+    for (int r = 0; r < BENCHMARK_ROUNDS; r++)
+    {
+        for (int i = 0; i < BENCHMARK_TABLES; i++)
+        {
+            char *t = CONCAT_STRINGS("metadatalookup_bench", gprom_itoa(i));
+
+            catalogTableExists(t);
+            getAttributes(t);
+            getKeyInformation(t);
+        }
+    }
+
+    return ((double) (clock() - start)) / CLOCKS_PER_SEC;
+}
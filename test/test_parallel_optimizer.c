@@ -0,0 +1,171 @@
+/*
+ *------------------------------------------------------------------------------
+ *
+ * test_parallel_optimizer.c - Testing optimization of independent subgraphs
+ *      with several threads.
+ *
+ *
+ *        SUBDIR: test/
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "test_main.h"
+#include "log/logger.h"
+#include "configuration/option.h"
+#include "model/node/nodetype.h"
+#include "model/list/list.h"
+#include "model/expression/expression.h"
+#include "model/query_operator/query_operator.h"
+#include "operator_optimizer/operator_optimizer.h"
+#include "provenance_rewriter/prov_utility.h"
+
+#define NUM_BRANCHES 8
+
+static rc testIndependentBranches(void);
+static rc testSharedBranches(void);
+static QueryOperator *createUnion (boolean shareTable);
+static QueryOperator *createBranch (QueryOperator *table, int constant);
+static QueryOperator *createTableR (void);
+static QueryOperator *optimizeWithThreads (QueryOperator *q, int numThreads);
+
+rc
+testParallelOptimizer(void)
+{
+    // only merge adjacent operators (the last rule) to get comparable plans
+    char *rules[] = {
+            OPTIMIZATION_FACTOR_ATTR_IN_PROJ_EXPR,
+            OPTIMIZATION_SELECTION_MOVE_AROUND,
+            OPTIMIZATION_PULL_UP_DUPLICATE_REMOVE_OPERATORS,
+            OPTIMIZATION_REMOVE_UNNECESSARY_COLUMNS,
+            OPTIMIZATION_REMOVE_UNNECESSARY_WINDOW_OPERATORS,
+            OPTIMIZATION_REMOVE_REDUNDANT_DUPLICATE_OPERATOR,
+            OPTIMIZATION_PULLING_UP_PROVENANCE_PROJ,
+            OPTIMIZATION_MATERIALIZE_MERGE_UNSAFE_PROJ,
+            OPTIMIZATION_PUSH_DOWN_AGGREGATION_THROUGH_JOIN,
+            OPTIMIZATION_SHARE_COMMON_SUBPLANS,
+            OPTIMIZATION_REMOVE_REDUNDANT_PROJECTIONS,
+            OPTIMIZATION_MERGE_OPERATORS
+    };
+    int numRules = sizeof(rules) / sizeof(char *);
+    boolean active[sizeof(rules) / sizeof(char *)];
+
+    for(int i = 0; i < numRules; i++)
+    {
+        active[i] = getBoolOption(rules[i]);
+        setBoolOption(rules[i], i == numRules - 1);
+    }
+
+    RUN_TEST(testIndependentBranches(), "test optimizing independent union branches in parallel");
+    RUN_TEST(testSharedBranches(), "test union branches that share operators");
+
+    for(int i = 0; i < numRules; i++)
+        setBoolOption(rules[i], active[i]);
+
+    return PASS;
+}
+
+static rc
+testIndependentBranches(void)
+{
+    QueryOperator *q = createUnion(FALSE);
+    QueryOperator *seq, *par;
+
+    seq = optimizeWithThreads((QueryOperator *) copyObject(q), 1);
+    par = optimizeWithThreads((QueryOperator *) copyObject(q), 4);
+
+    ASSERT_TRUE(numOpsInGraph(seq) < numOpsInGraph(q), "projections have been merged");
+    ASSERT_EQUALS_INT(numOpsInGraph(seq), numOpsInGraph(par), "same number of operators");
+    ASSERT_TRUE(equal(seq, par), "same result with and without threads");
+
+    return PASS;
+}
+
+static rc
+testSharedBranches(void)
+{
+    QueryOperator *q = createUnion(TRUE);
+    QueryOperator *seq, *par;
+
+    seq = optimizeWithThreads((QueryOperator *) copyObject(q), 1);
+    par = optimizeWithThreads((QueryOperator *) copyObject(q), 4);
+
+    ASSERT_EQUALS_INT(numOpsInGraph(seq), numOpsInGraph(par), "same number of operators");
+    ASSERT_TRUE(equal(seq, par), "same result with and without threads");
+
+    return PASS;
+}
+
+/*
+ * Projection over a left-deep tree of unions of NUM_BRANCHES branches. The
+ * branches either have their own table access or all share one.
+ */
+static QueryOperator *
+createUnion (boolean shareTable)
+{
+    QueryOperator *table = createTableR();
+    QueryOperator *u = NULL;
+    QueryOperator *p;
+
+    for(int i = 0; i < NUM_BRANCHES; i++)
+    {
+        QueryOperator *b = createBranch(shareTable ? table : createTableR(), i);
+
+        if (u == NULL)
+            u = b;
+        else
+        {
+            QueryOperator *prev = u;
+
+            u = (QueryOperator *) createSetOperator(SETOP_UNION, LIST_MAKE(prev, b), NIL,
+                    LIST_MAKE(strdup("A"), strdup("B")));
+            addParent(prev, u);
+            addParent(b, u);
+        }
+    }
+
+    p = (QueryOperator *) createProjOnAllAttrs(u);
+    addChildOperator(p, u);
+
+    return p;
+}
+
+/* two projections over a selection */
+static QueryOperator *
+createBranch (QueryOperator *table, int constant)
+{
+    QueryOperator *s, *p1, *p2;
+
+    s = (QueryOperator *) createSelectionOp(
+            (Node *) createOpExpr(strdup("="),
+                    LIST_MAKE(createFullAttrReference(strdup("A"), 0, 0, INVALID_ATTR, DT_INT),
+                            createConstInt(constant))),
+            table, NIL, NIL);
+    addParent(table, s);
+    p1 = (QueryOperator *) createProjOnAllAttrs(s);
+    addChildOperator(p1, s);
+    p2 = (QueryOperator *) createProjOnAllAttrs(p1);
+    addChildOperator(p2, p1);
+
+    return p2;
+}
+
+static QueryOperator *
+createTableR (void)
+{
+    return (QueryOperator *) createTableAccessOp(strdup("R"), NULL, strdup("R"), NIL,
+            LIST_MAKE(strdup("A"), strdup("B")), LIST_MAKE_INT(DT_INT, DT_INT));
+}
+
+static QueryOperator *
+optimizeWithThreads (QueryOperator *q, int numThreads)
+{
+    int oldThreads = getIntOption(OPTION_OPTIMIZER_THREADS);
+    QueryOperator *result;
+
+    setIntOption(OPTION_OPTIMIZER_THREADS, numThreads);
+    result = (QueryOperator *) optimizeOperatorModel((Node *) q);
+    setIntOption(OPTION_OPTIMIZER_THREADS, oldThreads);
+
+    return result;
+}
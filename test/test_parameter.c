@@ -26,6 +26,11 @@
 #include "metadata_lookup/metadata_lookup.h"
 #include "metadata_lookup/metadata_lookup_oracle.h"
 #include "metadata_lookup/metadata_lookup_postgres.h"
+#include "model/query_operator/query_operator.h"
+#include "sql_serializer/sql_serializer.h"
+#include "exception/exception.h"
+#include "mem_manager/mem_mgr.h"
+#include "rewriter.h"
 
 #ifdef HAVE_POSTGRES_BACKEND
 #include "libpq-fe.h"
@@ -36,6 +41,11 @@ static rc shutdownPlugin(void);
 static rc testParseBinds (void);
 static rc testSetParameterValues (void);
 static rc testTemplatizeQuery (void);
+static rc testPreparedRewrite (void);
+static rc testPrepareRewriteFromSQL (void);
+static QueryOperator *createPreparedTestQuery (Node *val);
+static ExceptionHandler abortOnException (const char *message, const char *file, int line, ExceptionSeverity s);
+static boolean preparedRewriteFails (char *name, List *binds);
 
 rc
 testParameter(void)
@@ -44,6 +54,8 @@ testParameter(void)
     RUN_TEST(testParseBinds(), "test parse binds");
     RUN_TEST(testSetParameterValues(), "test setting values for parameters");
 	RUN_TEST(testTemplatizeQuery(), "test templetizing queries");
+    RUN_TEST(testPreparedRewrite(), "test instantiating prepared rewrites");
+    RUN_TEST(testPrepareRewriteFromSQL(), "test preparing rewrites for SQL queries");
 	RUN_TEST(shutdownPlugin(), "shutdown metadata lookup plugin");
 
     return PASS;
@@ -252,6 +264,116 @@ testTemplatizeQuery (void)
 	return PASS;
 }
 
+/*
+ * Prepare SELECT * FROM param_test1 WHERE a = :1 and instantiate it from the
+ * SQL template and from the operator model. Both have to return the SQL code
+ * of the query with the bind value.
+ */
+static rc
+testPreparedRewrite (void)
+{
+    SQLParameter *p = createSQLParameter("p");
+    QueryOperator *q;
+    char *expected;
+
+    p->position = 1;
+    p->parType = DT_INT;
+    q = createPreparedTestQuery((Node *) p);
+    createPreparedRewrite("param_prepared1", (Node *) q, findParameters((Node *) q));
+    ASSERT_TRUE(preparedRewriteExists("param_prepared1"), "query is prepared");
+
+    expected = CONCAT_STRINGS(serializeOperatorModel(
+            (Node *) createPreparedTestQuery((Node *) createConstInt(3))), "\n");
+    ASSERT_EQUALS_STRING(expected, rewritePrepared("param_prepared1", singleton(createConstInt(3))),
+            "a = 3 from SQL template");
+
+    setBoolOption(OPTION_PREPARED_REWRITE_USE_MODEL, TRUE);
+    ASSERT_EQUALS_STRING(expected, rewritePrepared("param_prepared1", singleton(createConstInt(3))),
+            "a = 3 from operator model");
+    setBoolOption(OPTION_PREPARED_REWRITE_USE_MODEL, FALSE);
+
+    registerExceptionCallback(abortOnException);
+    ASSERT_TRUE(preparedRewriteFails("param_prepared1", NIL), "instantiating without binds fails");
+    ASSERT_TRUE(preparedRewriteFails("param_prepared1", singleton(createSQLParameter("x"))),
+            "binds have to be constants");
+
+    removePreparedRewrite("param_prepared1");
+    ASSERT_FALSE(preparedRewriteExists("param_prepared1"), "prepared rewrite is dropped");
+    ASSERT_TRUE(preparedRewriteFails("param_prepared1", singleton(createConstInt(3))),
+            "dropped prepared rewrite cannot be instantiated");
+    registerExceptionCallback(NULL);
+
+    return PASS;
+}
+
+/*
+ * Run the whole pipeline once for a query with a parameter and check that the
+ * instantiated rewrite is the same as the rewrite of the query with the value.
+ */
+static rc
+testPrepareRewriteFromSQL (void)
+{
+    char *expected;
+
+    if (!strpeq(getStringOption(OPTION_PLUGIN_METADATA), "sqlite") || !isInitialized())
+        return PASS;
+
+    executeQueryIgnoreResult("CREATE TEMP TABLE IF NOT EXISTS param_prepared (a int, b int)");
+    prepareRewrite("param_prepared2", "SELECT * FROM param_prepared WHERE a = :p;");
+
+    expected = rewriteQuery("SELECT * FROM param_prepared WHERE a = 1;");
+    ASSERT_EQUALS_STRING(expected, rewritePrepared("param_prepared2", singleton(createConstInt(1))),
+            "a = 1");
+    expected = rewriteQuery("SELECT * FROM param_prepared WHERE a = 3;");
+    ASSERT_EQUALS_STRING(expected, rewritePrepared("param_prepared2", singleton(createConstInt(3))),
+            "a = 3");
+
+    removePreparedRewrite("param_prepared2");
+
+    return PASS;
+}
+
+static QueryOperator *
+createPreparedTestQuery (Node *val)
+{
+    List *attrs = LIST_MAKE(strdup("a"), strdup("b"));
+    QueryOperator *t = (QueryOperator *) createTableAccessOp(strdup("param_test1"), NULL,
+            strdup("param_test1"), NIL, attrs, LIST_MAKE_INT(DT_INT, DT_INT));
+    Node *cond = (Node *) createOpExpr(OPNAME_EQ, LIST_MAKE(
+            createFullAttrReference(strdup("a"), 0, 0, 0, DT_INT), val));
+    QueryOperator *s = (QueryOperator *) createSelectionOp(cond, t, NIL, deepCopyStringList(attrs));
+
+    addParent(t, s);
+
+    return s;
+}
+
+static ExceptionHandler
+abortOnException (const char *message, const char *file, int line, ExceptionSeverity s)
+{
+    return EXCEPTION_ABORT;
+}
+
+static boolean
+preparedRewriteFails (char *name, List *binds)
+{
+    volatile boolean failed = FALSE;
+
+    NEW_AND_ACQUIRE_MEMCONTEXT(QUERY_MEM_CONTEXT);
+    TRY
+    {
+        rewritePrepared(name, binds);
+        FREE_AND_RELEASE_CUR_MEM_CONTEXT();
+    }
+    ON_EXCEPTION
+    {
+        failed = TRUE;
+    }
+    END_ON_EXCEPTION
+
+    return failed;
+}
+
 static rc
 shutdownPlugin(void)
 {
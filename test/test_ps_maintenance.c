@@ -0,0 +1,231 @@
+/*-----------------------------------------------------------------------------
+ *
+ * test_ps_maintenance.c
+ *		Test incremental maintenance of cached provenance sketches.
+ *
+ *		A sketch is cached for a capture query over a temporary table. The
+ *		table is then modified and we check that the cached sketch is extended
+ *		for inserted rows, kept for deleted rows, and dropped if the capture
+ *		query cannot be maintained incrementally. Sketches are captured with
+ *		the native sketch functions, so these tests only run on SQLite.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "test_main.h"
+#include "mem_manager/mem_mgr.h"
+#include "configuration/option.h"
+#include "model/list/list.h"
+#include "model/set/hashmap.h"
+#include "model/node/nodetype.h"
+#include "model/query_operator/query_operator.h"
+#include "model/query_operator/operator_property.h"
+#include "model/expression/expression.h"
+#include "metadata_lookup/metadata_lookup.h"
+#include "sql_serializer/sql_serializer.h"
+#include "provenance_sketches/sketch_functions.h"
+#include "provenance_rewriter/coarse_grained/coarse_grained_rewrite.h"
+
+#define PS_TABLE "ps_maintain_r"
+#define PS_DELTA_TABLE "ps_maintain_delta"
+#define PS_ATTR "prov_ps_maintain_r_a"
+
+static rc testInsertDelta(void);
+static rc testDeleteDelta(void);
+static rc testUpdateDelta(void);
+static rc testNotMaintainable(void);
+static QueryOperator *setupCachedPS(int bound, QueryOperator *capInput);
+static char *cachedPS(QueryOperator *op);
+static QueryOperator *createTestTable(char *tableName);
+static QueryOperator *createCapture(QueryOperator *input);
+static QueryOperator *createUpdateOp(char *condAttr, int condVal, int newA);
+
+rc
+testPSMaintenance(void)
+{
+    if (!strpeq(getStringOption(OPTION_PLUGIN_METADATA), "sqlite") || !isInitialized())
+        return PASS;
+
+    setBoolOption(OPTION_PS_MAINTAIN, TRUE);
+    RUN_TEST(testInsertDelta(), "test maintaining sketches for inserts");
+    RUN_TEST(testDeleteDelta(), "test maintaining sketches for deletes");
+    RUN_TEST(testUpdateDelta(), "test maintaining sketches for updates");
+    RUN_TEST(testNotMaintainable(), "test dropping sketches that cannot be maintained");
+    setBoolOption(OPTION_PS_MAINTAIN, FALSE);
+
+    return PASS;
+}
+
+static rc
+testInsertDelta(void)
+{
+    QueryOperator *q = setupCachedPS(1, createTestTable(PS_TABLE));
+
+    ASSERT_EQUALS_STRING("100", cachedPS(q), "captured sketch");
+
+    executeQueryIgnoreResult("INSERT INTO " PS_DELTA_TABLE " VALUES (4,1), (5,1)");
+    maintainPSForDeltaTable(PS_TABLE, PS_DELTA_TABLE, PS_DELTA_INSERT);
+    ASSERT_EQUALS_STRING("110", cachedPS(q), "fragment of inserted rows is added");
+
+    return PASS;
+}
+
+static rc
+testDeleteDelta(void)
+{
+    QueryOperator *q = setupCachedPS(2, createTestTable(PS_TABLE));
+
+    executeQueryIgnoreResult("INSERT INTO " PS_DELTA_TABLE " VALUES (1,1)");
+    maintainPSForDeltaTable(PS_TABLE, PS_DELTA_TABLE, PS_DELTA_DELETE);
+    ASSERT_EQUALS_STRING("100", cachedPS(q), "deletes keep the sketch");
+
+    return PASS;
+}
+
+static rc
+testUpdateDelta(void)
+{
+    QueryOperator *q = setupCachedPS(3, createTestTable(PS_TABLE));
+
+    // updates are only maintained in self-tuning mode and after they were executed
+    setStringOption(OPTION_PS_STORE_TABLE, "ps_maintain_store");
+    executeQueryIgnoreResult("UPDATE " PS_TABLE " SET a = 7 WHERE b = 2");
+    ASSERT_TRUE(maintainPSForUpdate(createUpdateOp("b", 2, 7)), "update is a DML statement");
+    ASSERT_EQUALS_STRING("101", cachedPS(q), "fragment of new versions of updated rows is added");
+
+    // the new versions of rows updated by a = 7 cannot be found anymore
+    executeQueryIgnoreResult("UPDATE " PS_TABLE " SET a = 4 WHERE a = 7");
+    ASSERT_TRUE(maintainPSForUpdate(createUpdateOp("a", 7, 4)), "update is a DML statement");
+    ASSERT_TRUE(cachedPS(q) == NULL, "sketch is dropped if the condition references updated attributes");
+    setStringOption(OPTION_PS_STORE_TABLE, NULL);
+
+    ASSERT_FALSE(maintainPSForUpdate(q), "query is not a DML statement");
+
+    return PASS;
+}
+
+static rc
+testNotMaintainable(void)
+{
+    QueryOperator *r = createTestTable(PS_TABLE);
+    QueryOperator *d = createTestTable(PS_DELTA_TABLE);
+    QueryOperator *diff = (QueryOperator *) createSetOperator(SETOP_DIFFERENCE,
+            LIST_MAKE(r, d), NIL, getQueryOperatorAttrNames(r));
+    QueryOperator *q;
+
+    addParent(r, diff);
+    addParent(d, diff);
+    q = setupCachedPS(4, diff);
+    ASSERT_EQUALS_STRING("100", cachedPS(q), "captured sketch");
+
+    executeQueryIgnoreResult("INSERT INTO " PS_DELTA_TABLE " VALUES (4,1)");
+    maintainPSForDeltaTable(PS_TABLE, PS_DELTA_TABLE, PS_DELTA_INSERT);
+    ASSERT_TRUE(cachedPS(q) == NULL, "sketch of capture query with set difference is dropped");
+
+    return PASS;
+}
+
+/*
+ * Create the test tables with rows in the first fragment, capture the sketch
+ * over capInput and cache it for query SELECT * FROM R WHERE a < bound.
+ */
+static QueryOperator *
+setupCachedPS(int bound, QueryOperator *capInput)
+{
+    QueryOperator *r = createTestTable(PS_TABLE);
+    QueryOperator *q;
+    QueryOperator *capOp = createCapture(capInput);
+    Node *cond;
+    psInfo *psPara = makeNode(psInfo);
+    psAttrInfo *a = makeNode(psAttrInfo);
+    HashMap *psMap;
+
+    executeQueryIgnoreResult("CREATE TEMP TABLE IF NOT EXISTS " PS_TABLE " (a INT, b INT)");
+    executeQueryIgnoreResult("CREATE TEMP TABLE IF NOT EXISTS " PS_DELTA_TABLE " (a INT, b INT)");
+    executeQueryIgnoreResult("DELETE FROM " PS_TABLE);
+    executeQueryIgnoreResult("DELETE FROM " PS_DELTA_TABLE);
+    executeQueryIgnoreResult("INSERT INTO " PS_TABLE " VALUES (1,1), (2,2)");
+
+    cond = (Node *) createOpExpr(OPNAME_LT, LIST_MAKE(
+            createFullAttrReference(strdup("a"), 0, 0, 0, DT_INT), createConstInt(bound)));
+    q = (QueryOperator *) createSelectionOp(cond, r, NIL, getQueryOperatorAttrNames(r));
+    addParent(r, q);
+
+    a->attrName = strdup("a");
+    a->rangeList = LIST_MAKE(createConstInt(0), createConstInt(3),
+            createConstInt(6), createConstInt(9));
+    psPara->psType = strdup(COARSE_GRAINED_RANGEA);
+    psPara->tablePSAttrInfos = NEW_MAP(Constant, Node);
+    MAP_ADD_STRING_KEY(psPara->tablePSAttrInfos, PS_TABLE, singleton(a));
+
+    psMap = getPS(serializeOperatorModel((Node *) copyObject(capOp)),
+            getQueryOperatorAttrNames(capOp));
+    cachePsInfo(q, psPara, psMap, capOp);
+
+    return q;
+}
+
+/* cached sketch of the query (without checking whether other sketches can be reused) */
+static char *
+cachedPS(QueryOperator *op)
+{
+    FOREACH(psInfoCell,c,getPSIfExists(op))
+    {
+        if (streq(c->provTableAttr, PS_ATTR))
+            return bitSetToString(c->ps);
+    }
+
+    return NULL;
+}
+
+static QueryOperator *
+createTestTable(char *tableName)
+{
+    return (QueryOperator *) createTableAccessOp(strdup(tableName), NULL,
+            strdup(tableName), NIL, LIST_MAKE(strdup("a"), strdup("b")),
+            LIST_MAKE_INT(DT_INT, DT_INT));
+}
+
+/*
+ * Capture query for fragments [0,3), [3,6), [6,9) of attribute a. The
+ * serializer turns the bucket search into a 0-based fragment number.
+ */
+static QueryOperator *
+createCapture(QueryOperator *input)
+{
+    FunctionCall *pos = createFunctionCall(strdup(SKETCH_FUN_BUCKET_SEARCH),
+            LIST_MAKE(createConstString("{0,3,6,9}"),
+                    createFullAttrReference(strdup("a"), 0, 0, 0, DT_INT)));
+    FunctionCall *setBits = createFunctionCall(strdup(SKETCH_FUN_SET_BITS),
+            LIST_MAKE(pos, createConstInt(3)));
+    QueryOperator *agg;
+
+    setBits->isAgg = TRUE;
+    agg = (QueryOperator *) createAggregationOp(singleton(setBits), NIL, input, NIL,
+            singleton(strdup(PS_ATTR)));
+    addParent(input, agg);
+
+    return agg;
+}
+
+/* UPDATE R SET a = newA WHERE condAttr = condVal as translated with CASE */
+static QueryOperator *
+createUpdateOp(char *condAttr, int condVal, int newA)
+{
+    QueryOperator *r = createTestTable(PS_TABLE);
+    Node *cond = (Node *) createOpExpr(OPNAME_EQ, LIST_MAKE(
+            createFullAttrReference(strdup(condAttr), 0, streq(condAttr, "a") ? 0 : 1, 0, DT_INT),
+            createConstInt(condVal)));
+    CaseExpr *newAttrA = createCaseExpr(NULL,
+            singleton(createCaseWhen(cond, (Node *) createConstInt(newA))),
+            (Node *) createFullAttrReference(strdup("a"), 0, 0, 0, DT_INT));
+    QueryOperator *p;
+
+    SET_BOOL_STRING_PROP(r, PROP_TABLE_IS_UPDATED);
+    p = (QueryOperator *) createProjectionOp(LIST_MAKE(newAttrA,
+            createFullAttrReference(strdup("b"), 0, 1, 0, DT_INT)),
+            NULL, NIL, getQueryOperatorAttrNames(r));
+    addChildOperator(p, r);
+
+    return p;
+}
@@ -0,0 +1,156 @@
+/*-----------------------------------------------------------------------------
+ *
+ * test_relation.c
+ *		Test relations in row format and dictionary encoded relations.
+ *
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "test_main.h"
+#include "log/logger.h"
+#include "mem_manager/mem_mgr.h"
+#include "model/node/nodetype.h"
+#include "model/list/list.h"
+#include "model/relation/relation.h"
+
+/* number of tuples of the relations used to compare memory consumption */
+#define NUM_MEMORY_TUPLES 100000
+
+static rc testEncodedRelation(void);
+static rc testNullValues(void);
+static rc testEncodeRelation(void);
+static rc testMemoryConsumption(void);
+static Relation *fillGraphRelation (Relation *r, int numTuples);
+
+rc
+testRelation(void)
+{
+    RUN_TEST(testEncodedRelation(), "test adding and reading tuples of encoded relations");
+    RUN_TEST(testNullValues(), "test NULL values");
+    RUN_TEST(testEncodeRelation(), "test encoding relations in row format");
+    RUN_TEST(testMemoryConsumption(), "test memory consumption of encoded relations");
+
+    return PASS;
+}
+
+static rc
+testEncodedRelation(void)
+{
+    Relation *r = makeEncodedRelation(LIST_MAKE(strdup("a"), strdup("b")));
+    char *t1[2] = { "1", "x" };
+    char *t2[2] = { "2", "x" };
+    int numTuples = 0;
+
+    addRelationTuple(r, t1);
+    addRelationTuple(r, t2);
+    addRelationTuple(r, t1);
+
+    ASSERT_EQUALS_INT(3, getRelationNumTuples(r), "three tuples");
+    ASSERT_EQUALS_INT(2, getRelationNumColumns(r), "two columns");
+    ASSERT_EQUALS_STRING("2", getRelationValue(r, 1, 0), "value of second tuple");
+    ASSERT_EQUALS_STRING("x", getRelationValue(r, 2, 1), "value of third tuple");
+    ASSERT_EQUALS_INT(2, r->data->columns[0].dictLength, "two distinct values in column a");
+    ASSERT_EQUALS_INT(1, r->data->columns[1].dictLength, "one distinct value in column b");
+    ASSERT_TRUE(getRelationValue(r, 0, 1) == getRelationValue(r, 1, 1),
+            "equal values are stored once");
+
+    FOREACH_REL_TUPLE(it,r)
+    {
+        ASSERT_EQUALS_STRING("x", REL_ITER_VALUE(it,1), "iterate over tuples");
+        numTuples++;
+    }
+    ASSERT_EQUALS_INT(3, numTuples, "iterated over all tuples");
+    ASSERT_EQUALS_STRING("2", getVecString(getRelationTuple(r, 1), 0),
+            "tuple in row format");
+
+    // enough tuples and distinct values to grow all arrays
+    fillGraphRelation(r, 5000);
+    ASSERT_EQUALS_INT(5003, getRelationNumTuples(r), "tuples after growing");
+    ASSERT_EQUALS_STRING("1", getRelationValue(r, 2, 0), "values are kept when growing");
+    ASSERT_EQUALS_STRING("n4999", getRelationValue(r, 5002, 0), "last value");
+
+    return PASS;
+}
+
+static rc
+testNullValues(void)
+{
+    Relation *r = makeEncodedRelation(LIST_MAKE(strdup("a")));
+    Relation *rowR = makeRelation(LIST_MAKE(strdup("a")));
+    char *t1[1] = { NULL };
+    char *t2[1] = { "NULL" };
+
+    for(int i = 0; i < 100; i++)
+        addRelationTuple(r, (i % 3 == 0) ? t1 : t2);
+
+    ASSERT_TRUE(getRelationValue(r, 0, 0) == NULL, "NULL value");
+    ASSERT_EQUALS_STRING("NULL", getRelationValue(r, 1, 0), "string NULL is not a NULL value");
+    ASSERT_TRUE(getRelationValue(r, 99, 0) == NULL, "NULL value after growing");
+    ASSERT_EQUALS_STRING("NULL", getRelationValue(r, 98, 0), "string NULL after growing");
+
+    addRelationTuple(rowR, t1);
+    ASSERT_EQUALS_STRING("NULL", getVecString(getRelationTuple(rowR, 0), 0),
+            "NULL values are stored as NULL in row format");
+    ASSERT_TRUE(getRelationValue(rowR, 0, 0) == NULL, "NULL value in row format");
+
+    return PASS;
+}
+
+static rc
+testEncodeRelation(void)
+{
+    Relation *r = fillGraphRelation(makeRelation(LIST_MAKE(strdup("from"), strdup("to"))), 1000);
+    Relation *e = encodeRelation(r);
+
+    ASSERT_TRUE(e->data != NULL, "relation is encoded");
+    ASSERT_TRUE(encodeRelation(e) == e, "encoded relation is not encoded again");
+    ASSERT_EQUALS_INT(1000, getRelationNumTuples(e), "all tuples are encoded");
+    ASSERT_EQUALS_STRING(getRelationValue(r, 500, 1), getRelationValue(e, 500, 1), "same values");
+    ASSERT_EQUALS_INT(getRelationBytes(r), getRelationBytes(e), "same size of values");
+    ASSERT_TRUE(equal(r, e), "relations are equal");
+
+    return PASS;
+}
+
+/*
+ * Compare the memory used to store a relation shaped like the edges of a
+ * provenance graph (few distinct node identifiers) in both formats.
+ */
+static rc
+testMemoryConsumption(void)
+{
+    List *schema = LIST_MAKE(strdup("from"), strdup("to"));
+    unsigned long start, rowBytes, encodedBytes;
+
+    start = getTotalAllocatedBytes();
+    fillGraphRelation(makeRelation(schema), NUM_MEMORY_TUPLES);
+    rowBytes = getTotalAllocatedBytes() - start;
+
+    start = getTotalAllocatedBytes();
+    fillGraphRelation(makeEncodedRelation(schema), NUM_MEMORY_TUPLES);
+    encodedBytes = getTotalAllocatedBytes() - start;
+
+    DEBUG_LOG("%d tuples need %lu bytes in row format and %lu bytes dictionary encoded",
+            NUM_MEMORY_TUPLES, rowBytes, encodedBytes);
+    ASSERT_TRUE(encodedBytes * 3 < rowBytes, "encoded relation is at least three times smaller");
+
+    return PASS;
+}
+
+static Relation *
+fillGraphRelation (Relation *r, int numTuples)
+{
+    char from[32];
+    char to[64];
+    char *values[2] = { from, to };
+
+    for(int i = 0; i < numTuples; i++)
+    {
+        snprintf(from, sizeof(from), "n%d", i % 5000);
+        snprintf(to, sizeof(to), "REL_WON_hop(%d)", i % 100);
+        addRelationTuple(r, values);
+    }
+
+    return r;
+}
@@ -0,0 +1,288 @@
+/*
+ *------------------------------------------------------------------------------
+ *
+ * test_rule_scheduler.c - Testing the fixpoint scheduler for optimization
+ *      rules.
+ *
+ *
+ *        SUBDIR: test/
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "test_main.h"
+#include "log/logger.h"
+#include "configuration/option.h"
+#include "instrumentation/query_profile.h"
+#include "model/node/nodetype.h"
+#include "model/list/list.h"
+#include "model/expression/expression.h"
+#include "model/query_operator/query_operator.h"
+#include "operator_optimizer/operator_optimizer.h"
+#include "provenance_rewriter/prov_utility.h"
+
+#define NUM_BRANCHES 4
+#define MERGE_RULE "merge adjacent projections and selections"
+
+static rc testSameResult(void);
+static rc testOnlyChangedOperators(void);
+static rc testFactoringEnablesMerge(void);
+static QueryOperator *createChain (int constant);
+static QueryOperator *createFactorChain (void);
+static Node *createIntAttr (char *name, int pos);
+static QueryOperator *createUnion (void);
+static QueryOperator *optimizeWithScheduler (QueryOperator *q, boolean fixpoint);
+static long getProfileCounter (char *profile, char *name);
+static boolean clearProperties (QueryOperator *op, void *context);
+
+rc
+testRuleScheduler(void)
+{
+    char *rules[] = {
+            OPTIMIZATION_FACTOR_ATTR_IN_PROJ_EXPR,
+            OPTIMIZATION_SELECTION_MOVE_AROUND,
+            OPTIMIZATION_PULL_UP_DUPLICATE_REMOVE_OPERATORS,
+            OPTIMIZATION_REMOVE_UNNECESSARY_COLUMNS,
+            OPTIMIZATION_REMOVE_UNNECESSARY_WINDOW_OPERATORS,
+            OPTIMIZATION_REMOVE_REDUNDANT_DUPLICATE_OPERATOR,
+            OPTIMIZATION_PULLING_UP_PROVENANCE_PROJ,
+            OPTIMIZATION_MATERIALIZE_MERGE_UNSAFE_PROJ,
+            OPTIMIZATION_PUSH_DOWN_AGGREGATION_THROUGH_JOIN,
+            OPTIMIZATION_SHARE_COMMON_SUBPLANS,
+            OPTIMIZATION_REMOVE_REDUNDANT_PROJECTIONS,
+            OPTIMIZATION_MERGE_OPERATORS
+    };
+    int numRules = sizeof(rules) / sizeof(char *);
+    boolean active[sizeof(rules) / sizeof(char *)];
+
+    // only merge adjacent operators (the last rule)
+    for(int i = 0; i < numRules; i++)
+    {
+        active[i] = getBoolOption(rules[i]);
+        setBoolOption(rules[i], i == numRules - 1);
+    }
+
+    RUN_TEST(testSameResult(), "test fixpoint scheduler produces the same plan");
+    RUN_TEST(testOnlyChangedOperators(), "test local rules are only reapplied to changed operators");
+    RUN_TEST(testFactoringEnablesMerge(), "test factoring nested expressions triggers merging");
+
+    for(int i = 0; i < numRules; i++)
+        setBoolOption(rules[i], active[i]);
+
+    return PASS;
+}
+
+static rc
+testSameResult(void)
+{
+    QueryOperator *q = createUnion();
+    QueryOperator *seq, *fix;
+
+    seq = optimizeWithScheduler((QueryOperator *) copyObject(q), FALSE);
+    fix = optimizeWithScheduler((QueryOperator *) copyObject(q), TRUE);
+
+    ASSERT_TRUE(numOpsInGraph(fix) < numOpsInGraph(q), "operators have been merged");
+    ASSERT_EQUALS_INT(numOpsInGraph(seq), numOpsInGraph(fix), "same number of operators");
+    ASSERT_TRUE(equal(seq, fix), "same result with and without fixpoint scheduler");
+
+    // removing redundant projections in between creates new opportunities for merging
+    setBoolOption(OPTIMIZATION_REMOVE_REDUNDANT_PROJECTIONS, TRUE);
+    seq = optimizeWithScheduler((QueryOperator *) copyObject(q), FALSE);
+    fix = optimizeWithScheduler((QueryOperator *) copyObject(q), TRUE);
+    setBoolOption(OPTIMIZATION_REMOVE_REDUNDANT_PROJECTIONS, FALSE);
+
+    ASSERT_EQUALS_INT(numOpsInGraph(seq), numOpsInGraph(fix), "same number of operators");
+    ASSERT_TRUE(equal(seq, fix), "same result with rules applied to the whole graph");
+
+    return PASS;
+}
+
+/*
+ * The merge rule is applied three times. With the fixpoint scheduler only
+ * the first application visits all operators.
+ */
+static rc
+testOnlyChangedOperators(void)
+{
+    QueryOperator *q = createChain(1);
+    int numOps = numOpsInGraph(q);
+    char *oldFormat = getStringOption(OPTION_PROFILE_FORMAT);
+    char *profile;
+    long numApplications, numChanges;
+
+    setStringOption(OPTION_PROFILE_FORMAT, PROFILE_FORMAT_JSON);
+    profileStartQuery("chain");
+    optimizeWithScheduler(q, TRUE);
+    profileEndQuery();
+    profile = getLastQueryProfile();
+    setStringOption(OPTION_PROFILE_FORMAT, oldFormat);
+
+    numApplications = getProfileCounter(profile, "rule " MERGE_RULE " applications");
+    numChanges = getProfileCounter(profile, "rule " MERGE_RULE " changes");
+
+    ASSERT_EQUALS_INT(2, numChanges, "merged projections and selections");
+    ASSERT_TRUE(numApplications > 0 && numApplications < 3 * (numOps - 1),
+            "fewer applications than three passes over all operators");
+
+    return PASS;
+}
+
+/*
+ * Merging the two upper projections is unsafe until factoring has reduced
+ * the references to A in the expression for Z, which only becomes
+ * factorable after the two lower projections have been merged. Factoring
+ * rewrites the CASE nested in the multiplication and has to be reported as
+ * a change, so that merging is reapplied to the parent.
+ */
+static rc
+testFactoringEnablesMerge(void)
+{
+    QueryOperator *seq, *fix;
+
+    setBoolOption(OPTIMIZATION_FACTOR_ATTR_IN_PROJ_EXPR, TRUE);
+    seq = optimizeWithScheduler(createFactorChain(), FALSE);
+    fix = optimizeWithScheduler(createFactorChain(), TRUE);
+    setBoolOption(OPTIMIZATION_FACTOR_ATTR_IN_PROJ_EXPR, FALSE);
+
+    ASSERT_EQUALS_INT(2, numOpsInGraph(seq), "all projections merged");
+    ASSERT_EQUALS_INT(2, numOpsInGraph(fix), "all projections merged with fixpoint scheduler");
+    ASSERT_TRUE(equal(seq, fix), "same result with and without fixpoint scheduler");
+
+    return PASS;
+}
+
+/* projection over projection over selection over selection over R */
+static QueryOperator *
+createChain (int constant)
+{
+    QueryOperator *r, *s1, *s2, *p1, *p2;
+
+    r = (QueryOperator *) createTableAccessOp(strdup("R"), NULL, strdup("R"), NIL,
+            LIST_MAKE(strdup("A"), strdup("B")), LIST_MAKE_INT(DT_INT, DT_INT));
+    s1 = (QueryOperator *) createSelectionOp(
+            (Node *) createOpExpr(strdup("="),
+                    LIST_MAKE(createFullAttrReference(strdup("A"), 0, 0, INVALID_ATTR, DT_INT),
+                            createConstInt(constant))),
+            r, NIL, NIL);
+    addParent(r, s1);
+    s2 = (QueryOperator *) createSelectionOp(
+            (Node *) createOpExpr(strdup("="),
+                    LIST_MAKE(createFullAttrReference(strdup("B"), 0, 1, INVALID_ATTR, DT_INT),
+                            createConstInt(constant))),
+            s1, NIL, NIL);
+    addParent(s1, s2);
+    p1 = (QueryOperator *) createProjOnAllAttrs(s2);
+    addChildOperator(p1, s2);
+    p2 = (QueryOperator *) createProjOnAllAttrs(p1);
+    addChildOperator(p2, p1);
+
+    return p2;
+}
+
+/* projection over a union of chains */
+static QueryOperator *
+createUnion (void)
+{
+    QueryOperator *u = NULL;
+    QueryOperator *p;
+
+    for(int i = 0; i < NUM_BRANCHES; i++)
+    {
+        QueryOperator *b = createChain(i);
+
+        if (u == NULL)
+            u = b;
+        else
+        {
+            QueryOperator *prev = u;
+
+            u = (QueryOperator *) createSetOperator(SETOP_UNION, LIST_MAKE(prev, b), NIL,
+                    LIST_MAKE(strdup("A"), strdup("B")));
+            addParent(prev, u);
+            addParent(b, u);
+        }
+    }
+
+    p = (QueryOperator *) createProjOnAllAttrs(u);
+    addChildOperator(p, u);
+
+    return p;
+}
+
+/*
+ * Z + Z AS W over (CASE WHEN C > 1 THEN X ELSE Y END) * 2 AS Z over
+ * A + B AS X, A AS Y, C AS C over R(A,B,C)
+ */
+static QueryOperator *
+createFactorChain (void)
+{
+    QueryOperator *r, *p1, *p2, *p3;
+    CaseExpr *c;
+
+    r = (QueryOperator *) createTableAccessOp(strdup("R"), NULL, strdup("R"), NIL,
+            LIST_MAKE(strdup("A"), strdup("B"), strdup("C")),
+            LIST_MAKE_INT(DT_INT, DT_INT, DT_INT));
+    p1 = (QueryOperator *) createProjectionOp(
+            LIST_MAKE(createOpExpr(strdup("+"), LIST_MAKE(createIntAttr("A", 0),
+                            createIntAttr("B", 1))),
+                    createIntAttr("A", 0),
+                    createIntAttr("C", 2)),
+            r, NIL, LIST_MAKE(strdup("X"), strdup("Y"), strdup("C")));
+    addParent(r, p1);
+    c = createCaseExpr(NULL, singleton(createCaseWhen(
+            (Node *) createOpExpr(strdup(">"), LIST_MAKE(createIntAttr("C", 2),
+                    createConstInt(1))),
+            createIntAttr("X", 0))), createIntAttr("Y", 1));
+    p2 = (QueryOperator *) createProjectionOp(
+            singleton(createOpExpr(strdup("*"), LIST_MAKE(c, createConstInt(2)))),
+            p1, NIL, singleton(strdup("Z")));
+    addParent(p1, p2);
+    p3 = (QueryOperator *) createProjectionOp(
+            singleton(createOpExpr(strdup("+"), LIST_MAKE(createIntAttr("Z", 0),
+                    createIntAttr("Z", 0)))),
+            p2, NIL, singleton(strdup("W")));
+    addParent(p2, p3);
+
+    return p3;
+}
+
+static Node *
+createIntAttr (char *name, int pos)
+{
+    return (Node *) createFullAttrReference(strdup(name), 0, pos, INVALID_ATTR, DT_INT);
+}
+
+static QueryOperator *
+optimizeWithScheduler (QueryOperator *q, boolean fixpoint)
+{
+    boolean old = getBoolOption(OPTION_OPTIMIZER_RULE_FIXPOINT);
+    QueryOperator *result;
+
+    setBoolOption(OPTION_OPTIMIZER_RULE_FIXPOINT, fixpoint);
+    result = (QueryOperator *) optimizeOperatorModel((Node *) q);
+    setBoolOption(OPTION_OPTIMIZER_RULE_FIXPOINT, old);
+
+    // rules leave behind empty property maps
+    visitQOGraph(result, TRAVERSAL_PRE, clearProperties, NULL);
+
+    return result;
+}
+
+static long
+getProfileCounter (char *profile, char *name)
+{
+    char *key = CONCAT_STRINGS("\"", name, "\": ");
+    char *pos = strstr(profile, key);
+
+    if (pos == NULL)
+        return -1;
+
+    return atol(pos + strlen(key));
+}
+
+static boolean
+clearProperties (QueryOperator *op, void *context)
+{
+    op->properties = NULL;
+    return TRUE;
+}
@@ -0,0 +1,310 @@
+/*
+ *------------------------------------------------------------------------------
+ *
+ * test_selection_pushdown.c - Testing pushing down selections.
+ *
+ *
+ *        SUBDIR: test/
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "test_main.h"
+#include "log/logger.h"
+#include "configuration/option.h"
+#include "model/node/nodetype.h"
+#include "model/list/list.h"
+#include "model/expression/expression.h"
+#include "model/query_operator/query_operator.h"
+#include "model/query_operator/query_operator_model_checker.h"
+#include "model/relation/relation.h"
+#include "metadata_lookup/metadata_lookup.h"
+#include "operator_optimizer/selection_pushdown.h"
+#include "provenance_rewriter/prov_utility.h"
+#include "sql_serializer/sql_serializer.h"
+
+static rc testPushThroughJoins(void);
+static rc testPushThroughOuterJoins(void);
+static rc testPushThroughAggregation(void);
+static rc testPushThroughUnion(void);
+static rc testIntermediateResultSizes(void);
+static QueryOperator *createProvQuery (void);
+static QueryOperator *createTable (char *name, char *a, char *b);
+static QueryOperator *createJoin (JoinType type, QueryOperator *l, QueryOperator *r,
+        char *lAttr, char *rAttr);
+static QueryOperator *addSelection (QueryOperator *in, Node *cond);
+static Node *createCmp (char *op, QueryOperator *in, char *attr, Node *right);
+static Node *createAttr (QueryOperator *in, char *attr);
+static long sumOfJoinSizes (QueryOperator *q);
+static boolean countSelections (QueryOperator *op, void *context);
+
+rc
+testSelectionPushdown(void)
+{
+    boolean check = getBoolOption(OPTION_AGGRESSIVE_MODEL_CHECKING);
+
+    setBoolOption(OPTION_AGGRESSIVE_MODEL_CHECKING, TRUE);
+
+    RUN_TEST(testPushThroughJoins(), "test pushing selections through inner joins");
+    RUN_TEST(testPushThroughOuterJoins(), "test pushing selections through outer joins");
+    RUN_TEST(testPushThroughAggregation(), "test pushing selections through aggregations");
+    RUN_TEST(testPushThroughUnion(), "test pushing selections through unions");
+    RUN_TEST(testIntermediateResultSizes(), "test selection pushdown reduces intermediate results");
+
+    setBoolOption(OPTION_AGGRESSIVE_MODEL_CHECKING, check);
+
+    return PASS;
+}
+
+/* A = 1 AND B = e AND f > 1 over R x T */
+static rc
+testPushThroughJoins(void)
+{
+    QueryOperator *j = createJoin(JOIN_CROSS, createTable("R", "A", "B"),
+            createTable("T", "e", "f"), NULL, NULL);
+    QueryOperator *q = addSelection(j, AND_EXPRS(
+            createCmp("=", j, "A", (Node *) createConstInt(1)),
+            createCmp("=", j, "B", createAttr(j, "e")),
+            createCmp(">", j, "f", (Node *) createConstInt(1))));
+
+    q = pushDownSelections(q, FALSE);
+    ASSERT_TRUE(isA(q, SelectionOperator), "selections are not pushed through joins");
+
+    q = pushDownSelections(q, TRUE);
+    ASSERT_TRUE(checkModel(q), "plan is consistent");
+    ASSERT_TRUE(q == j, "selection has been removed");
+    ASSERT_EQUALS_INT(JOIN_INNER, ((JoinOperator *) j)->joinType, "join condition B = e");
+    ASSERT_TRUE(isA(OP_LCHILD(j), SelectionOperator), "A = 1 pushed into R");
+    ASSERT_TRUE(isA(OP_RCHILD(j), SelectionOperator), "f > 1 pushed into T");
+    ASSERT_EQUALS_STRING("e", ((AttributeReference *) getTailOfListP(
+            ((Operator *) ((JoinOperator *) j)->cond)->args))->name, "attribute of T");
+
+    return PASS;
+}
+
+/* A = 1 AND f = 5 over R left outer join T */
+static rc
+testPushThroughOuterJoins(void)
+{
+    QueryOperator *j = createJoin(JOIN_LEFT_OUTER, createTable("R", "A", "B"),
+            createTable("T", "e", "f"), "B", "e");
+    QueryOperator *q = addSelection(j, AND_EXPRS(
+            createCmp("=", j, "A", (Node *) createConstInt(1)),
+            createCmp("=", j, "f", (Node *) createConstInt(5))));
+    int numSels = 0;
+
+    q = pushDownSelections(q, TRUE);
+    visitQOGraph(q, TRAVERSAL_PRE, countSelections, &numSels);
+
+    ASSERT_TRUE(checkModel(q), "plan is consistent");
+    ASSERT_TRUE(isA(q, SelectionOperator) && OP_LCHILD(q) == j, "f = 5 is not pushed");
+    ASSERT_TRUE(isA(OP_LCHILD(j), SelectionOperator), "A = 1 pushed into R");
+    ASSERT_FALSE(isA(OP_RCHILD(j), SelectionOperator), "nothing pushed into T");
+    ASSERT_EQUALS_INT(2, numSels, "two selections");
+
+    return PASS;
+}
+
+/* B = 1 AND cnt > 1 over aggregation count(A) AS cnt group by B */
+static rc
+testPushThroughAggregation(void)
+{
+    QueryOperator *r = createTable("R", "A", "B");
+    FunctionCall *cnt = createFunctionCall(strdup("count"),
+            singleton(createAttr(r, "A")));
+    QueryOperator *agg, *q;
+
+    cnt->isAgg = TRUE;
+    agg = (QueryOperator *) createAggregationOp(singleton(cnt), singleton(createAttr(r, "B")),
+            r, NIL, LIST_MAKE(strdup("cnt"), strdup("B")));
+    addParent(r, agg);
+    q = addSelection(agg, AND_EXPRS(
+            createCmp("=", agg, "B", (Node *) createConstInt(1)),
+            createCmp(">", agg, "cnt", (Node *) createConstInt(1))));
+
+    q = pushDownSelections(q, FALSE);
+
+    ASSERT_TRUE(checkModel(q), "plan is consistent");
+    ASSERT_TRUE(isA(q, SelectionOperator) && OP_LCHILD(q) == agg, "cnt > 1 is not pushed");
+    ASSERT_TRUE(isA(OP_LCHILD(agg), SelectionOperator), "B = 1 pushed into R");
+    ASSERT_EQUALS_STRING("B", ((AttributeReference *) getHeadOfListP(((Operator *)
+            ((SelectionOperator *) OP_LCHILD(agg))->cond)->args))->name, "group-by attribute");
+
+    return PASS;
+}
+
+/* A = 1 over R union s */
+static rc
+testPushThroughUnion(void)
+{
+    QueryOperator *r = createTable("R", "A", "B");
+    QueryOperator *s = createTable("s", "c", "d");
+    QueryOperator *u = (QueryOperator *) createSetOperator(SETOP_UNION, LIST_MAKE(r, s), NIL,
+            LIST_MAKE(strdup("A"), strdup("B")));
+    QueryOperator *q;
+
+    addParent(r, u);
+    addParent(s, u);
+    q = addSelection(u, createCmp("=", u, "A", (Node *) createConstInt(1)));
+
+    q = pushDownSelections(q, FALSE);
+
+    ASSERT_TRUE(checkModel(q), "plan is consistent");
+    ASSERT_TRUE(q == u, "selection has been removed");
+    ASSERT_TRUE(isA(OP_LCHILD(u), SelectionOperator), "pushed into R");
+    ASSERT_TRUE(isA(OP_RCHILD(u), SelectionOperator), "pushed into s");
+    ASSERT_EQUALS_STRING("c", ((AttributeReference *) getHeadOfListP(((Operator *)
+            ((SelectionOperator *) OP_RCHILD(u))->cond)->args))->name, "attribute of s");
+
+    return PASS;
+}
+
+/*
+ * Compare the number of rows produced by the joins of a provenance query
+ * with a selection on a provenance attribute before and after pushing down
+ * the selection.
+ */
+static rc
+testIntermediateResultSizes(void)
+{
+    QueryOperator *q = createProvQuery();
+    long before, after;
+    char *sql;
+    Relation *r1, *r2;
+
+    // the serializer changes attribute names, so serialize copies
+    before = sumOfJoinSizes(q);
+    sql = serializeOperatorModel(copyObject(q));
+    r1 = executeQuery(sql);
+
+    q = pushDownSelections(q, TRUE);
+    after = sumOfJoinSizes(q);
+    sql = serializeOperatorModel(copyObject(q));
+    r2 = executeQuery(sql);
+
+    DEBUG_LOG("rows produced by joins: %ld without and %ld with selection pushdown",
+            before, after);
+
+    ASSERT_TRUE(checkModel(q), "plan is consistent");
+    ASSERT_EQUALS_INT(getRelationNumTuples(r1), getRelationNumTuples(r2), "same result");
+    ASSERT_TRUE(after < before, "fewer rows produced by joins");
+
+    return PASS;
+}
+
+/*
+ * PROV_A = 2 over a projection that duplicates the attributes of
+ * (R x T) join U on f = g as provenance attributes
+ */
+static QueryOperator *
+createProvQuery (void)
+{
+    QueryOperator *j = createJoin(JOIN_INNER,
+            createJoin(JOIN_CROSS, createTable("R", "A", "B"), createTable("T", "e", "f"),
+                    NULL, NULL),
+            createTable("U", "g", "h"), "f", "g");
+    List *names = getQueryOperatorAttrNames(j);
+    List *exprs = NIL;
+    List *attrNames = NIL;
+    QueryOperator *p;
+
+    FOREACH(char,a,names)
+    {
+        exprs = appendToTailOfList(exprs, createAttr(j, a));
+        attrNames = appendToTailOfList(attrNames, strdup(a));
+    }
+    FOREACH(char,a,names)
+    {
+        exprs = appendToTailOfList(exprs, createAttr(j, a));
+        attrNames = appendToTailOfList(attrNames, CONCAT_STRINGS("PROV_", a));
+    }
+    p = (QueryOperator *) createProjectionOp(exprs, j, NIL, attrNames);
+    addParent(j, p);
+
+    return addSelection(p, createCmp("=", p, "PROV_A", (Node *) createConstInt(2)));
+}
+
+static QueryOperator *
+createTable (char *name, char *a, char *b)
+{
+    return (QueryOperator *) createTableAccessOp(strdup(name), NULL, strdup(name), NIL,
+            LIST_MAKE(strdup(a), strdup(b)), LIST_MAKE_INT(DT_INT, DT_INT));
+}
+
+static QueryOperator *
+createJoin (JoinType type, QueryOperator *l, QueryOperator *r, char *lAttr, char *rAttr)
+{
+    Node *cond = NULL;
+    QueryOperator *j;
+
+    if (lAttr != NULL)
+        cond = (Node *) createOpExpr(strdup("="), LIST_MAKE(
+                createFullAttrReference(strdup(lAttr), 0, getAttrPos(l, lAttr), INVALID_ATTR, DT_INT),
+                createFullAttrReference(strdup(rAttr), 1, getAttrPos(r, rAttr), INVALID_ATTR, DT_INT)));
+    j = (QueryOperator *) createJoinOp(type, cond, LIST_MAKE(l, r), NIL,
+            CONCAT_LISTS(getQueryOperatorAttrNames(l), getQueryOperatorAttrNames(r)));
+    addParent(l, j);
+    addParent(r, j);
+
+    return j;
+}
+
+static QueryOperator *
+addSelection (QueryOperator *in, Node *cond)
+{
+    QueryOperator *sel = (QueryOperator *) createSelectionOp(cond, in, NIL,
+            getQueryOperatorAttrNames(in));
+
+    addParent(in, sel);
+
+    return sel;
+}
+
+static Node *
+createCmp (char *op, QueryOperator *in, char *attr, Node *right)
+{
+    return (Node *) createOpExpr(strdup(op), LIST_MAKE(createAttr(in, attr), right));
+}
+
+static Node *
+createAttr (QueryOperator *in, char *attr)
+{
+    int pos = getAttrPos(in, attr);
+
+    return (Node *) createFullAttrReference(strdup(attr), 0, pos, INVALID_ATTR,
+            getAttrDefByPos(in, pos)->dataType);
+}
+
+/* sum of the number of rows produced by the joins of q */
+static long
+sumOfJoinSizes (QueryOperator *q)
+{
+    long result = 0;
+
+    if (isA(q, JoinOperator))
+    {
+        QueryOperator *sub = (QueryOperator *) copyObject(q);
+        char *sql = serializeOperatorModel((Node *) sub);
+        Relation *r;
+
+        sql = strdup(sql);
+        while (strlen(sql) > 0 && (sql[strlen(sql) - 1] == ';' || isspace(sql[strlen(sql) - 1])))
+            sql[strlen(sql) - 1] = '\0';
+        r = executeQuery(CONCAT_STRINGS("SELECT count(*) FROM (", sql, ") sub"));
+        result += atol(getRelationValue(r, 0, 0));
+    }
+
+    FOREACH(QueryOperator,child,q->inputs)
+        result += sumOfJoinSizes(child);
+
+    return result;
+}
+
+static boolean
+countSelections (QueryOperator *op, void *context)
+{
+    if (isA(op, SelectionOperator))
+        (*((int *) context))++;
+
+    return TRUE;
+}
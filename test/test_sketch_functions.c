@@ -0,0 +1,172 @@
+/*-----------------------------------------------------------------------------
+ *
+ * test_sketch_functions.c
+ *		Test native provenance sketch functions of embedded backends.
+ *
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "test_main.h"
+#include "configuration/option.h"
+#include "log/logger.h"
+#include "metadata_lookup/metadata_lookup.h"
+#include "model/node/nodetype.h"
+#include "model/relation/relation.h"
+#include "model/set/vector.h"
+#include "provenance_sketches/sketch_functions.h"
+
+static rc testParseBounds(void);
+static rc testBucketSearch(void);
+static rc testBitOperations(void);
+static rc testBackendFunctions(void);
+static char *queryValue (char *query);
+
+rc
+testSketchFunctions(void)
+{
+    RUN_TEST(testParseBounds(), "test parsing of fragment bounds");
+    RUN_TEST(testBucketSearch(), "test searching for the bucket of a value");
+    RUN_TEST(testBitOperations(), "test operations on sketches");
+    RUN_TEST(testBackendFunctions(), "test functions registered by the backend");
+
+    return PASS;
+}
+
+static rc
+testParseBounds(void)
+{
+    char *lit = "{1,5,10.5}";
+    SketchBounds *b = parseSketchBounds(lit, MALLOC(sketchBoundsSize(lit)));
+
+    ASSERT_EQUALS_INT(3, b->numBounds, "three bounds");
+    ASSERT_TRUE(b->numeric, "numeric bounds");
+    ASSERT_EQUALS_FLOAT(10.5, b->nums[2], "third bound");
+
+    lit = "{\"a\",\"b\\\"c\",\"d,e\"}";
+    b = parseSketchBounds(lit, MALLOC(sketchBoundsSize(lit)));
+    ASSERT_EQUALS_INT(3, b->numBounds, "three string bounds");
+    ASSERT_FALSE(b->numeric, "quoted bounds are strings");
+    ASSERT_EQUALS_STRING("b\"c", b->strs[1], "escapes are removed");
+    ASSERT_EQUALS_STRING("d,e", b->strs[2], "quoted delimiter");
+
+    lit = "{}";
+    b = parseSketchBounds(lit, MALLOC(sketchBoundsSize(lit)));
+    ASSERT_EQUALS_INT(0, b->numBounds, "no bounds");
+
+    return PASS;
+}
+
+static rc
+testBucketSearch(void)
+{
+    char *lit = "{0,10,20,30}";
+    SketchBounds *b = parseSketchBounds(lit, MALLOC(sketchBoundsSize(lit)));
+
+    ASSERT_EQUALS_INT(0, sketchBucketPosNum(b, -1), "below all bounds");
+    ASSERT_EQUALS_INT(1, sketchBucketPosNum(b, 0), "lower bound is included");
+    ASSERT_EQUALS_INT(2, sketchBucketPosNum(b, 19.9), "inside of range");
+    ASSERT_EQUALS_INT(4, sketchBucketPosNum(b, 100), "above all bounds");
+    ASSERT_EQUALS_INT(3, sketchBucketPosString(b, "25"), "numeric string");
+
+    // multi-digit bounds are compared as numbers even if they are quoted
+    lit = "{\"1\",\"5\",\"10\",\"100\"}";
+    b = parseSketchBounds(lit, MALLOC(sketchBoundsSize(lit)));
+    ASSERT_EQUALS_INT(2, sketchBucketPosNum(b, 7), "7 is between 5 and 10");
+    ASSERT_EQUALS_INT(2, sketchBucketPosNum(b, 9), "9 is between 5 and 10");
+    ASSERT_EQUALS_INT(3, sketchBucketPosNum(b, 50), "50 is between 10 and 100");
+    ASSERT_EQUALS_INT(4, sketchBucketPosString(b, "50"), "strings are compared as strings");
+
+    lit = "{1,5,10,100}";
+    b = parseSketchBounds(lit, MALLOC(sketchBoundsSize(lit)));
+    ASSERT_EQUALS_INT(3, sketchBucketPosString(b, "50"), "numeric string with numeric bounds");
+
+    lit = "{\"b\",\"d\",\"f\"}";
+    b = parseSketchBounds(lit, MALLOC(sketchBoundsSize(lit)));
+    ASSERT_EQUALS_INT(0, sketchBucketPosString(b, "a"), "string below all bounds");
+    ASSERT_EQUALS_INT(2, sketchBucketPosString(b, "e"), "string inside of range");
+    ASSERT_EQUALS_INT(3, sketchBucketPosString(b, "z"), "string above all bounds");
+
+    return PASS;
+}
+
+static rc
+testBitOperations(void)
+{
+    char result[8];
+    gprom_long_t counts[4] = { 0, 0, 0, 0 };
+
+    sketchBitOp(result, "0110", 4, "11", 2, FALSE);
+    ASSERT_EQUALS_STRING("1110", result, "union pads the shorter sketch");
+    sketchBitOp(result, "0110", 4, "11", 2, TRUE);
+    ASSERT_EQUALS_STRING("0100", result, "intersection");
+    ASSERT_EQUALS_INT(2, sketchBitCount("0110", 4), "bit count");
+    ASSERT_TRUE(sketchHasBit("0110", 4, 2), "bit 2 is set");
+    ASSERT_FALSE(sketchHasBit("0110", 4, 7), "bits outside of the sketch are not set");
+
+    sketchAddBits(counts, "0110", 4, 1);
+    sketchAddBits(counts, "0011", 4, 1);
+    sketchAddBits(counts, "0110", 4, -1);
+    sketchCountsToBits(result, counts, 4);
+    ASSERT_EQUALS_STRING("0011", result, "removed rows do not count");
+
+    return PASS;
+}
+
+/*
+ * Run the functions on the backend if it registers them natively (the
+ * default test setup uses SQLite).
+ */
+static rc
+testBackendFunctions(void)
+{
+    char *md = getStringOption(OPTION_PLUGIN_METADATA);
+
+#if HAVE_DUCKDB_SKETCH_FUNCTIONS
+    if (!(strpeq(md, "sqlite") || strpeq(md, "duckdb")) || !isInitialized())
+        return PASS;
+#else
+    if (!strpeq(md, "sqlite") || !isInitialized())
+        return PASS;
+#endif
+
+    ASSERT_EQUALS_STRING("2", queryValue("SELECT binary_search_array_pos('{1,5,10}', 7)"),
+            "bucket search");
+    ASSERT_EQUALS_STRING("3", queryValue("SELECT binary_search_array_pos('{1,5,10,100}', 50)"),
+            "bucket search with multi-digit bounds");
+    ASSERT_EQUALS_STRING("3", queryValue("SELECT binary_search_array_pos('{\"1\",\"5\",\"10\",\"100\"}', 50)"),
+            "bucket search with quoted multi-digit bounds");
+    ASSERT_EQUALS_STRING("0", queryValue("SELECT binary_search_array_pos('{1,5,10}', 0)"),
+            "bucket search below all bounds");
+    ASSERT_EQUALS_STRING("1", queryValue("SELECT binary_search_array_pos('{\"b\",\"d\"}', 'c')"),
+            "bucket search for strings");
+    ASSERT_EQUALS_STRING("01010",
+            queryValue("SELECT set_bits(f, 5) FROM (SELECT 1 AS f UNION ALL SELECT 3 UNION ALL SELECT 3)"),
+            "set bits of fragments");
+    ASSERT_EQUALS_STRING("0111",
+            queryValue("SELECT fast_bit_or(s) FROM (SELECT '0100' AS s UNION ALL SELECT '0011')"),
+            "union of sketches");
+    ASSERT_EQUALS_STRING("1100", queryValue("SELECT bitor('0100', '1')"), "bitor");
+    ASSERT_EQUALS_STRING("0001", queryValue("SELECT bitand('0101', '0011')"), "bitand");
+    ASSERT_EQUALS_STRING("2", queryValue("SELECT sketch_bit_count('0101')"), "bit count");
+    ASSERT_EQUALS_STRING("1", queryValue("SELECT sketch_contains('0101', '{0,10,20,30}', 15)"),
+            "value in fragment of sketch");
+    ASSERT_EQUALS_STRING("0", queryValue("SELECT sketch_contains('0101', '{0,10,20,30}', 25)"),
+            "value not in fragment of sketch");
+    ASSERT_EQUALS_STRING("011,001,001",
+            queryValue("SELECT group_concat(s) FROM (SELECT set_bits(f, 3) OVER "
+                    "(ORDER BY f ROWS BETWEEN CURRENT ROW AND 1 FOLLOWING) AS s "
+                    "FROM (SELECT 1 AS f UNION ALL SELECT 2 UNION ALL SELECT 2))"),
+            "set bits over sliding window");
+
+    return PASS;
+}
+
+static char *
+queryValue (char *query)
+{
+    Relation *r = executeQuery(query);
+    Vector *t = (Vector *) getVecNode(r->tuples, 0);
+
+    return getVecString(t, 0);
+}
@@ -0,0 +1,260 @@
+/*-----------------------------------------------------------------------------
+ *
+ * test_sketch_use_predicate.c
+ *		Test the predicates used to filter tables with provenance sketches.
+ *
+ *		Sketches with few ranges of adjacent fragments are tested with a
+ *		disjunction of ranges, other sketches with an IN list of fragment
+ *		numbers (or the native membership function on SQLite).
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include "test_main.h"
+#include "mem_manager/mem_mgr.h"
+#include "configuration/option.h"
+#include "exception/exception.h"
+#include "model/list/list.h"
+#include "model/bitset/bitset.h"
+#include "model/node/nodetype.h"
+#include "model/expression/expression.h"
+#include "model/query_operator/query_operator.h"
+#include "metadata_lookup/metadata_lookup.h"
+#include "sql_serializer/sql_serializer.h"
+#include "provenance_sketches/sketch_functions.h"
+#include "provenance_rewriter/coarse_grained/coarse_grained_rewrite.h"
+#include "provenance_rewriter/pi_cs_rewrites/pi_cs_main.h"
+#include "rewriter.h"
+
+#define PS_USE_TABLE "ps_use_r"
+
+static rc testChooseAuto(void);
+static rc testChooseForced(void);
+static rc testRangesCond(void);
+static rc testInListCond(void);
+static rc testFilterResults(void);
+static psAttrInfo *createSketch(char *bits);
+static AttributeReference *createAttr(void);
+static int countFiltered(char *pred, char *bits);
+static ExceptionHandler abortOnException (const char *message, const char *file, int line, ExceptionSeverity s);
+static boolean choosingFails (void);
+
+rc
+testSketchUsePredicate(void)
+{
+    RUN_TEST(testChooseAuto(), "test choosing predicates by number of ranges");
+    RUN_TEST(testChooseForced(), "test predicates requested by option");
+    RUN_TEST(testRangesCond(), "test range predicates");
+    RUN_TEST(testInListCond(), "test IN list predicates");
+    RUN_TEST(testFilterResults(), "test filtering tables with sketches");
+
+    setStringOption(OPTION_PS_USE_PREDICATE, PS_USE_PREDICATE_AUTO);
+    setIntOption(OPTION_PS_USE_MAX_RANGES, 32);
+
+    return PASS;
+}
+
+static rc
+testChooseAuto(void)
+{
+    setStringOption(OPTION_PS_USE_PREDICATE, PS_USE_PREDICATE_AUTO);
+    setIntOption(OPTION_PS_USE_MAX_RANGES, 2);
+
+    ASSERT_EQUALS_INT(SKETCH_USE_NONE, chooseSketchUsePredicate(10, 10, 1),
+            "no filter if all fragments are selected");
+    ASSERT_EQUALS_INT(SKETCH_USE_RANGES, chooseSketchUsePredicate(10, 3, 1),
+            "ranges below the threshold");
+    ASSERT_EQUALS_INT(SKETCH_USE_RANGES, chooseSketchUsePredicate(10, 3, 2),
+            "ranges at the threshold");
+    ASSERT_EQUALS_INT(SKETCH_USE_IN_LIST, chooseSketchUsePredicate(10, 3, 3),
+            "IN list above the threshold");
+    ASSERT_EQUALS_INT(SKETCH_USE_RANGES, chooseSketchUsePredicate(10, 0, 0),
+            "empty sketch uses ranges");
+
+    setIntOption(OPTION_PS_USE_MAX_RANGES, 0);
+    ASSERT_EQUALS_INT(SKETCH_USE_IN_LIST, chooseSketchUsePredicate(10, 1, 1),
+            "IN list for every non-empty sketch if no ranges are allowed");
+
+    return PASS;
+}
+
+static rc
+testChooseForced(void)
+{
+    setIntOption(OPTION_PS_USE_MAX_RANGES, 2);
+
+    setStringOption(OPTION_PS_USE_PREDICATE, PS_USE_PREDICATE_RANGES);
+    ASSERT_EQUALS_INT(SKETCH_USE_RANGES, chooseSketchUsePredicate(10, 5, 5),
+            "ranges above the threshold");
+    ASSERT_EQUALS_INT(SKETCH_USE_RANGES, chooseSketchUsePredicate(10, 10, 1),
+            "ranges for a sketch with all fragments");
+
+    setStringOption(OPTION_PS_USE_PREDICATE, PS_USE_PREDICATE_IN_LIST);
+    ASSERT_EQUALS_INT(SKETCH_USE_IN_LIST, chooseSketchUsePredicate(10, 1, 1),
+            "IN list below the threshold");
+
+    setStringOption(OPTION_PS_USE_PREDICATE, PS_USE_PREDICATE_BRIN);
+    ASSERT_EQUALS_INT(SKETCH_USE_BRIN, chooseSketchUsePredicate(10, 1, 1),
+            "BRIN predicate");
+
+    setStringOption(OPTION_PS_USE_PREDICATE, PS_USE_PREDICATE_AUTO);
+    setBoolOption(OPTION_PS_USE_BRIN_OP, TRUE);
+    ASSERT_EQUALS_INT(SKETCH_USE_BRIN, chooseSketchUsePredicate(10, 5, 5),
+            "BRIN predicate requested by us_brin_op");
+    setBoolOption(OPTION_PS_USE_BRIN_OP, FALSE);
+
+    setStringOption(OPTION_PS_USE_PREDICATE, "hash");
+    registerExceptionCallback(abortOnException);
+    ASSERT_TRUE(choosingFails(), "unknown predicate is rejected");
+    registerExceptionCallback(NULL);
+    setStringOption(OPTION_PS_USE_PREDICATE, PS_USE_PREDICATE_AUTO);
+
+    return PASS;
+}
+
+/* fragments [0,10) [10,20) [20,30) [30,40) */
+static rc
+testRangesCond(void)
+{
+    Node *cond;
+
+    setStringOption(OPTION_PS_USE_PREDICATE, PS_USE_PREDICATE_RANGES);
+
+    cond = getSketchUseCond(createAttr(), createSketch("1101"), "prov_a");
+    ASSERT_EQUALS_STRING("(((a >= 0) AND (a < 20)) OR ((a >= 30) AND (a < 40)))",
+            exprToSQL(cond, NULL, FALSE), "adjacent fragments are merged into one range");
+
+    cond = getSketchUseCond(createAttr(), createSketch("0000"), "prov_a");
+    ASSERT_EQUALS_NODE(createConstBool(FALSE), cond, "empty sketch filters all rows");
+
+    setStringOption(OPTION_PS_USE_PREDICATE, PS_USE_PREDICATE_AUTO);
+    cond = getSketchUseCond(createAttr(), createSketch("1111"), "prov_a");
+    ASSERT_TRUE(cond == NULL, "no filter if all fragments are selected");
+
+    return PASS;
+}
+
+static rc
+testInListCond(void)
+{
+    char *be = getStringOption(OPTION_BACKEND);
+    QuantifiedComparison *q;
+    FunctionCall *f;
+    Node *cond;
+
+    be = be ? strdup(be) : NULL;
+    setStringOption(OPTION_PS_USE_PREDICATE, PS_USE_PREDICATE_IN_LIST);
+
+    // backends without native sketch functions compare the fragment number with a list
+    setStringOption(OPTION_BACKEND, "postgres");
+    cond = getSketchUseCond(createAttr(), createSketch("1101"), "prov_a");
+    ASSERT_TRUE(isA(cond, QuantifiedComparison), "fragment IN list");
+    q = (QuantifiedComparison *) cond;
+    ASSERT_EQUALS_NODE(LIST_MAKE(createConstInt(0), createConstInt(1), createConstInt(3)),
+            q->exprList, "list contains each selected fragment");
+    ASSERT_EQUALS_STRING(OPNAME_EQ, q->opName, "fragment is compared for equality");
+    ASSERT_EQUALS_INT(QUANTIFIED_EXPR_ANY, q->qType, "any element of the list");
+
+    cond = getSketchUseCond(createAttr(), createSketch("0000"), "prov_a");
+    ASSERT_EQUALS_NODE(createConstBool(FALSE), cond, "empty sketch filters all rows");
+
+    // SQLite tests the fragment against the whole sketch
+    setStringOption(OPTION_BACKEND, "sqlite");
+    cond = getSketchUseCond(createAttr(), createSketch("1101"), "prov_a");
+    ASSERT_TRUE(isA(cond, FunctionCall), "native membership test");
+    f = (FunctionCall *) cond;
+    ASSERT_EQUALS_STRING(SKETCH_FUN_CONTAINS, f->functionname, "sketch_contains");
+    ASSERT_EQUALS_NODE(createConstString("1101"), getHeadOfListP(f->args), "whole sketch is passed");
+
+    setStringOption(OPTION_BACKEND, be);
+    setStringOption(OPTION_PS_USE_PREDICATE, PS_USE_PREDICATE_AUTO);
+
+    return PASS;
+}
+
+/* filter a table with rows in each fragment using the generated predicates */
+static rc
+testFilterResults(void)
+{
+    if (!strpeq(getStringOption(OPTION_PLUGIN_METADATA), "sqlite") || !isInitialized())
+        return PASS;
+
+    executeQueryIgnoreResult("CREATE TEMP TABLE IF NOT EXISTS " PS_USE_TABLE " (a INT)");
+    executeQueryIgnoreResult("DELETE FROM " PS_USE_TABLE);
+    executeQueryIgnoreResult("INSERT INTO " PS_USE_TABLE " VALUES (5), (15), (25), (35)");
+
+    ASSERT_EQUALS_INT(3, countFiltered(PS_USE_PREDICATE_RANGES, "1101"), "ranges");
+    ASSERT_EQUALS_INT(3, countFiltered(PS_USE_PREDICATE_IN_LIST, "1101"), "native membership test");
+    ASSERT_EQUALS_INT(2, countFiltered(PS_USE_PREDICATE_RANGES, "1010"), "ranges of single fragments");
+    ASSERT_EQUALS_INT(2, countFiltered(PS_USE_PREDICATE_IN_LIST, "1010"), "native membership test of single fragments");
+    ASSERT_EQUALS_INT(0, countFiltered(PS_USE_PREDICATE_RANGES, "0000"), "empty sketch");
+
+    setStringOption(OPTION_PS_USE_PREDICATE, PS_USE_PREDICATE_AUTO);
+
+    return PASS;
+}
+
+static psAttrInfo *
+createSketch(char *bits)
+{
+    psAttrInfo *a = makeNode(psAttrInfo);
+
+    a->attrName = strdup("a");
+    a->rangeList = LIST_MAKE(createConstInt(0), createConstInt(10),
+            createConstInt(20), createConstInt(30), createConstInt(40));
+    a->BitVector = stringToBitset(bits);
+
+    return a;
+}
+
+static AttributeReference *
+createAttr(void)
+{
+    return createFullAttrReference(strdup("a"), 0, 0, 0, DT_INT);
+}
+
+/* number of rows of the test table that pass the sketch filter */
+static int
+countFiltered(char *pred, char *bits)
+{
+    QueryOperator *r = (QueryOperator *) createTableAccessOp(strdup(PS_USE_TABLE), NULL,
+            strdup(PS_USE_TABLE), NIL, singleton(strdup("a")), singletonInt(DT_INT));
+    QueryOperator *sel;
+    Relation *res;
+    Node *cond;
+
+    setStringOption(OPTION_PS_USE_PREDICATE, pred);
+    cond = getSketchUseCond(createAttr(), createSketch(bits), "prov_a");
+    sel = (QueryOperator *) createSelectionOp(cond, r, NIL, getQueryOperatorAttrNames(r));
+    addParent(r, sel);
+
+    res = executeQuery(serializeOperatorModel((Node *) sel));
+
+    return getRelationNumTuples(res);
+}
+
+static ExceptionHandler
+abortOnException (const char *message, const char *file, int line, ExceptionSeverity s)
+{
+    return EXCEPTION_ABORT;
+}
+
+static boolean
+choosingFails (void)
+{
+    volatile boolean failed = FALSE;
+
+    NEW_AND_ACQUIRE_MEMCONTEXT(QUERY_MEM_CONTEXT);
+    TRY
+    {
+        chooseSketchUsePredicate(10, 1, 1);
+        FREE_AND_RELEASE_CUR_MEM_CONTEXT();
+    }
+    ON_EXCEPTION
+    {
+        failed = TRUE;
+    }
+    END_ON_EXCEPTION
+
+    return failed;
+}
@@ -16,10 +16,13 @@
 #include "configuration/option.h"
 #include "configuration/option_parser.h"
 #include "model/list/list.h"
+#include "model/relation/relation.h"
+#include "model/set/set.h"
 #include "model/node/nodetype.h"
 #include "parser/parser.h"
 #include "provenance_rewriter/prov_rewriter.h"
 #include "model/query_operator/query_operator.h"
+#include "model/expression/expression.h"
 #include "analysis_and_translate/translator.h"
 #include "temporal_queries/temporal_rewriter.h"
 #include "metadata_lookup/metadata_lookup.h"
@@ -27,11 +30,19 @@
 #include "rewriter.h"
 
 static rc testNormalization(void);
+static rc testCoalesceStrategies(void);
+static rc testSerializeCoalesceUsingWindow(void);
+static QueryOperator *createPeriodTable (void);
+static int planDepth (QueryOperator *op);
+static int planSize (QueryOperator *op);
+static void collectPlanOperators (QueryOperator *op, Set *seen);
 
 rc
 testTemporal()
 {
     RUN_TEST(testNormalization(), "test normalization");
+    RUN_TEST(testCoalesceStrategies(), "test coalesce strategies");
+    RUN_TEST(testSerializeCoalesceUsingWindow(), "test SQL code for window based coalescing");
 
     return PASS;
 }
@@ -52,3 +63,136 @@ testNormalization(void)
 
     return PASS;
 }
+
+/*
+ * Compare the plans generated by the two set coalescing strategies. The
+ * window based strategy has to produce the same schema with a shallower
+ * plan that has fewer operators.
+ */
+static rc
+testCoalesceStrategies(void)
+{
+    QueryOperator *countPlan = addSetCoalesce(createPeriodTable());
+    QueryOperator *windowPlan = addSetCoalesceUsingWindow(createPeriodTable());
+
+    INFO_LOG("coalesce plans: counting depth %d size %d, window depth %d size %d",
+            planDepth(countPlan), planSize(countPlan),
+            planDepth(windowPlan), planSize(windowPlan));
+
+    ASSERT_EQUALS_STRINGP(stringListToString(getQueryOperatorAttrNames(countPlan)),
+            stringListToString(getQueryOperatorAttrNames(windowPlan)),
+            "both strategies produce the same schema");
+    ASSERT_EQUALS_NODE(countPlan->provAttrs, windowPlan->provAttrs,
+            "both strategies mark the same temporal attributes");
+    ASSERT_TRUE(planDepth(windowPlan) < planDepth(countPlan),
+            "window based coalescing generates a shallower plan");
+    ASSERT_TRUE(planSize(windowPlan) < planSize(countPlan),
+            "window based coalescing generates fewer operators");
+
+    return PASS;
+}
+
+/*
+ * The island numbering window function reads the result of the window
+ * function computing the previous end point. The two window functions have to
+ * be computed in separate query blocks, because window functions cannot be
+ * nested. If the test database is available we also check the coalesced
+ * intervals.
+ */
+static rc
+testSerializeCoalesceUsingWindow(void)
+{
+    QueryOperator *t = createPeriodTable();
+    QueryOperator *plan;
+    QueryOperator *islandWin;
+    char *sql;
+    char *outerWin;
+    char *innerWin;
+    Relation *r;
+    Set *result;
+
+    ((TableAccessOperator *) t)->tableName = strdup("temporal_coalesce_test");
+    plan = addSetCoalesceUsingWindow(t);
+
+    islandWin = OP_LCHILD(OP_LCHILD(plan));
+    ASSERT_TRUE(isA(islandWin, WindowOperator), "island numbering window");
+    ASSERT_TRUE(isA(OP_LCHILD(islandWin), ProjectionOperator),
+            "projection between window operators");
+
+    sql = serializeOperatorModel((Node *) copyObject(plan));
+    INFO_LOG("window based coalescing:\n%s", sql);
+    outerWin = strstr(sql, "OVER");
+    innerWin = (outerWin == NULL) ? NULL : strstr(outerWin + 1, "OVER");
+    ASSERT_TRUE(innerWin != NULL, "two window functions");
+    ASSERT_TRUE(strstr(outerWin, "FROM (") < innerWin, "window functions are in different query blocks");
+
+    if (!strpeq(getStringOption(OPTION_PLUGIN_METADATA), "sqlite") || !isInitialized())
+        return PASS;
+
+    executeQueryIgnoreResult("CREATE TEMP TABLE IF NOT EXISTS temporal_coalesce_test "
+            "(A INT, T_B INT, T_E INT)");
+    executeQueryIgnoreResult("DELETE FROM temporal_coalesce_test");
+    executeQueryIgnoreResult("INSERT INTO temporal_coalesce_test VALUES "
+            "(1,1,3), (1,2,5), (1,5,7), (1,9,10), (2,1,2)");
+
+    r = executeQuery(sql);
+    result = STRSET();
+    FOREACH_REL_TUPLE(it,r)
+        addToSet(result, CONCAT_STRINGS(REL_ITER_VALUE(it,0), ":",
+                REL_ITER_VALUE(it,1), "-", REL_ITER_VALUE(it,2)));
+
+    ASSERT_EQUALS_INT(3, getRelationNumTuples(r), "three coalesced intervals");
+    ASSERT_TRUE(hasSetElem(result, "1:1-7"), "overlapping and adjacent intervals are merged");
+    ASSERT_TRUE(hasSetElem(result, "1:9-10"), "interval after gap");
+    ASSERT_TRUE(hasSetElem(result, "2:1-2"), "intervals of other group");
+
+    return PASS;
+}
+
+static QueryOperator *
+createPeriodTable (void)
+{
+    QueryOperator *t;
+
+    t = (QueryOperator *) createTableAccessOp(strdup("R"), NULL, strdup("R"), NIL,
+            LIST_MAKE(strdup("A"), strdup(TBEGIN_NAME), strdup(TEND_NAME)),
+            LIST_MAKE_INT(DT_INT, TEMPORAL_DT, TEMPORAL_DT));
+    t->provAttrs = LIST_MAKE_INT(1, 2);
+
+    return t;
+}
+
+static int
+planDepth (QueryOperator *op)
+{
+    int depth = 0;
+
+    FOREACH(QueryOperator,c,op->inputs)
+    {
+        int cDepth = planDepth(c);
+        depth = (cDepth > depth) ? cDepth : depth;
+    }
+
+    return depth + 1;
+}
+
+static int
+planSize (QueryOperator *op)
+{
+    Set *seen = PSET();
+
+    collectPlanOperators(op, seen);
+
+    return setSize(seen);
+}
+
+static void
+collectPlanOperators (QueryOperator *op, Set *seen)
+{
+    if (hasSetElem(seen, op))
+        return;
+
+    addToSet(seen, op);
+    FOREACH(QueryOperator,c,op->inputs)
+        collectPlanOperators(c, seen);
+}
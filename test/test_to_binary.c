@@ -0,0 +1,417 @@
+/*-----------------------------------------------------------------------------
+ *
+ * test_to_binary.c
+ *		Round trip tests for the binary node format.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include <time.h>
+
+#include "test_main.h"
+#include "common.h"
+
+#include "model/list/list.h"
+#include "model/node/nodetype.h"
+#include "model/expression/expression.h"
+#include "model/set/set.h"
+#include "model/set/hashmap.h"
+#include "model/set/vector.h"
+#include "model/bitset/bitset.h"
+#include "model/graph/graph.h"
+#include "model/query_block/query_block.h"
+#include "model/query_operator/query_operator.h"
+#include "model/datalog/datalog_model.h"
+#include "mem_manager/mem_mgr.h"
+#include "exception/exception.h"
+#include "provenance_rewriter/coarse_grained/coarse_grained_rewrite.h"
+#include "rewriter.h"
+
+static rc testExpressionRoundTrip(void);
+static rc testCollectionRoundTrip(void);
+static rc testQueryBlockRoundTrip(void);
+static rc testOperatorGraphRoundTrip(void);
+static rc testDatalogRoundTrip(void);
+static rc testSketchRoundTrip(void);
+static rc testBinaryVsTextFormat(void);
+static rc testCorruptOperatorInputs(void);
+
+static void *roundTrip(void *n);
+static QueryOperator *createLargePlan(int numJoins);
+static boolean readingFails(void *n);
+static ExceptionHandler abortOnException (const char *message, const char *file, int line, ExceptionSeverity s);
+
+#define ASSERT_ROUND_TRIP(_n,_message) \
+    do { \
+        void *_in = (void *) (_n); \
+        ASSERT_EQUALS_NODE(_in, roundTrip(_in), _message); \
+    } while (0)
+
+#define AR(_a) createAttributeReference(strdup(_a))
+
+rc
+testToBinary(void)
+{
+    RUN_TEST(testExpressionRoundTrip(), "test binary format for expressions");
+    RUN_TEST(testCollectionRoundTrip(), "test binary format for collections");
+    RUN_TEST(testQueryBlockRoundTrip(), "test binary format for query blocks");
+    RUN_TEST(testOperatorGraphRoundTrip(), "test binary format for operator graphs");
+    RUN_TEST(testDatalogRoundTrip(), "test binary format for datalog programs");
+    RUN_TEST(testSketchRoundTrip(), "test binary format for provenance sketches");
+    RUN_TEST(testBinaryVsTextFormat(), "compare binary format with nodeToString");
+    RUN_TEST(testCorruptOperatorInputs(), "test reading operators with corrupt inputs");
+
+    return PASS;
+}
+
+static void *
+roundTrip(void *n)
+{
+    size_t len;
+    char *data = nodeToBinary(n, &len);
+
+    return binaryToNode(data, len);
+}
+
+static rc
+testExpressionRoundTrip(void)
+{
+    FunctionCall *f = createFunctionCall("sum", singleton(AR("a")));
+    WindowDef *w = createWindowDef(singleton(AR("b")),
+            singleton(createOrderExpr((Node *) AR("c"), SORT_DESC, SORT_NULLS_FIRST)),
+            createWindowFrame(WINFRAME_ROWS,
+                    createWindowBound(WINBOUND_EXPR_PREC, (Node *) createConstInt(3)),
+                    createWindowBound(WINBOUND_CURRENT_ROW, NULL)));
+
+    ASSERT_ROUND_TRIP(NULL, "NULL");
+    ASSERT_ROUND_TRIP(createConstInt(42), "int constant");
+    ASSERT_ROUND_TRIP(createConstLong(1L << 40), "long constant");
+    ASSERT_ROUND_TRIP(createConstFloat(3.25), "float constant");
+    ASSERT_ROUND_TRIP(createConstBool(TRUE), "bool constant");
+    ASSERT_ROUND_TRIP(createConstString("hello"), "string constant");
+    ASSERT_ROUND_TRIP(createConstString(""), "empty string constant");
+    ASSERT_ROUND_TRIP(createNullConst(DT_STRING), "NULL constant");
+    ASSERT_ROUND_TRIP(createFullAttrReference("a", 1, 2, 0, DT_INT), "attribute reference");
+    ASSERT_ROUND_TRIP(f, "function call");
+    ASSERT_ROUND_TRIP(createOpExpr("+", LIST_MAKE(AR("a"), createConstInt(1))), "operator");
+    ASSERT_ROUND_TRIP(createSQLParameter("p"), "SQL parameter");
+    ASSERT_ROUND_TRIP(createCaseExpr(NULL,
+            singleton(createCaseWhen((Node *) createIsNullExpr((Node *) AR("a")),
+                    (Node *) createConstInt(1))),
+            (Node *) createConstInt(2)), "case expression");
+    ASSERT_ROUND_TRIP(createWindowFunction(f, w), "window function");
+    ASSERT_ROUND_TRIP(makeNode(RowNumExpr), "rownum");
+    ASSERT_ROUND_TRIP(createQuantifiedComparison("ANY", (Node *) AR("a"), "=",
+            LIST_MAKE(createConstInt(1), createConstInt(2))), "quantified comparison");
+    ASSERT_ROUND_TRIP(createCastExprOtherDT((Node *) AR("a"), "NUMERIC", 10, DT_FLOAT), "cast");
+    ASSERT_ROUND_TRIP(createNodeKeyValue((Node *) createConstString("k"),
+            (Node *) createConstInt(1)), "key value");
+    ASSERT_ROUND_TRIP(createSchema("R", LIST_MAKE(createAttributeDef("a", DT_INT),
+            createAttributeDef("b", DT_STRING))), "schema");
+
+    return PASS;
+}
+
+static rc
+testCollectionRoundTrip(void)
+{
+    Set *nodes = NODESET();
+    Set *strs = STRSET();
+    Set *ints = INTSET();
+    Set *longs = LONGSET();
+    HashMap *m = NEW_MAP(Constant,Node);
+    Vector *vi = makeVectorIntSeq(0, 100, 3);
+    Vector *vn = makeVector(VECTOR_NODE, T_Constant);
+    BitSet *b = newBitSet(130);
+    Graph *g;
+
+    addToSet(nodes, AR("a"));
+    addToSet(nodes, createConstInt(1));
+    addToSet(strs, "x");
+    addToSet(strs, "y");
+    addIntToSet(ints, 5);
+    addIntToSet(ints, -7);
+    addLongToSet(longs, 1L << 50);
+    MAP_ADD_STRING_KEY(m, "a", AR("a"));
+    MAP_ADD_INT_KEY(m, 3, createConstString("three"));
+    VEC_ADD_NODE(vn, createConstInt(1));
+    VEC_ADD_NODE(vn, createConstString("b"));
+    setBit(b, 0, TRUE);
+    setBit(b, 129, TRUE);
+    g = createGraph(nodes, NIL);
+
+    ASSERT_ROUND_TRIP(LIST_MAKE(AR("a"), NULL, createConstInt(1)), "node list");
+    ASSERT_ROUND_TRIP(LIST_MAKE_INT(1, -2, 300000), "int list");
+    ASSERT_ROUND_TRIP(nodes, "node set");
+    ASSERT_ROUND_TRIP(strs, "string set");
+    ASSERT_ROUND_TRIP(ints, "int set");
+    ASSERT_ROUND_TRIP(longs, "long set");
+    ASSERT_ROUND_TRIP(m, "hashmap");
+    ASSERT_ROUND_TRIP(vi, "int vector");
+    ASSERT_ROUND_TRIP(vn, "node vector");
+    ASSERT_ROUND_TRIP(b, "bitset");
+    ASSERT_ROUND_TRIP(g, "graph");
+
+    return PASS;
+}
+
+static rc
+testQueryBlockRoundTrip(void)
+{
+    QueryBlock *qb = createQueryBlock();
+    FromItem *r = createFromTableRef("r", LIST_MAKE("a", "b"), "R", NIL);
+    FromItem *s = createFromTableRef("s", LIST_MAKE("a", "c"), "S", NIL);
+    FromItem *j = createFromJoin(NULL, LIST_MAKE("a", "b", "c"), r, s, "JOIN_INNER",
+            "JOIN_COND_USING", (Node *) LIST_MAKE(strdup("a")));
+
+    qb->selectClause = LIST_MAKE(createSelectItem("a", (Node *) AR("a")));
+    qb->distinct = (Node *) createDistinctClause(NIL);
+    qb->fromClause = singleton(j);
+    qb->whereClause = (Node *) createNestedSubquery("EXISTS", NULL, NULL,
+            (Node *) createQueryBlock());
+    qb->orderByClause = singleton(createOrderExpr((Node *) AR("a"), SORT_ASC, SORT_NULLS_LAST));
+    qb->limitClause = (Node *) createConstInt(10);
+
+    ASSERT_ROUND_TRIP(qb, "query block with join using");
+    ASSERT_ROUND_TRIP(createSetQuery("UNION", TRUE, copyObject(qb), copyObject(qb)), "set query");
+    ASSERT_ROUND_TRIP(createProvenanceStmt((Node *) copyObject(qb)), "provenance statement");
+    ASSERT_ROUND_TRIP(createWithStmt(singleton(createNodeKeyValue(
+            (Node *) createConstString("v"), copyObject(qb))), copyObject(qb)), "with statement");
+    ASSERT_ROUND_TRIP(createInsert("R", (Node *) LIST_MAKE(createConstInt(1),
+            createConstInt(2)), LIST_MAKE("a", "b")), "insert");
+    ASSERT_ROUND_TRIP(createDelete("R", (Node *) createOpExpr("=",
+            LIST_MAKE(AR("a"), createConstInt(1)))), "delete");
+    ASSERT_ROUND_TRIP(createTransactionStmt("TRANSACTION_COMMIT"), "transaction statement");
+    ASSERT_ROUND_TRIP(createCreateTable("R", LIST_MAKE(createAttributeDef("a", DT_INT))),
+            "create table");
+    ASSERT_ROUND_TRIP(createAlterTableAddColumn("R", "c", "INT"), "alter table");
+    ASSERT_ROUND_TRIP(createPrepareQuery("q", (Node *) copyObject(qb), NIL, "SELECT a FROM R"),
+            "prepared query");
+
+    return PASS;
+}
+
+static rc
+testOperatorGraphRoundTrip(void)
+{
+    QueryOperator *r, *u, *sel, *result, *lChild, *rChild;
+    ConstRelOperator *c;
+
+    r = (QueryOperator *) createTableAccessOp("R", NULL, "R", NIL, LIST_MAKE("a", "b"),
+            LIST_MAKE_INT(DT_INT, DT_INT));
+    u = (QueryOperator *) createSetOperator(SETOP_UNION, LIST_MAKE(r, r), NIL,
+            LIST_MAKE("a", "b"));
+    r->parents = LIST_MAKE(u, u);
+    sel = (QueryOperator *) createSelectionOp((Node *) createOpExpr("<",
+            LIST_MAKE(createFullAttrReference("a", 0, 0, 0, DT_INT), createConstInt(3))),
+            u, NIL, LIST_MAKE("a", "b"));
+    u->parents = singleton(sel);
+    setStringProperty(sel, "PROP", (Node *) createConstString("x"));
+
+    result = roundTrip(sel);
+    ASSERT_EQUALS_NODE(sel, result, "operator graph");
+
+    // shared child is read once and parents are restored
+    lChild = OP_LCHILD(OP_LCHILD(result));
+    rChild = OP_RCHILD(OP_LCHILD(result));
+    ASSERT_EQUALS_P(lChild, rChild, "shared subgraph is preserved");
+    ASSERT_EQUALS_INT(2, LIST_LENGTH(lChild->parents), "parents of shared child");
+    ASSERT_EQUALS_P(OP_LCHILD(result), OP_FIRST_PARENT(lChild), "parent pointer");
+    ASSERT_EQUALS_INT(0, LIST_LENGTH(result->parents), "root has no parents");
+
+    c = createConstRelOp(LIST_MAKE(createConstInt(1)), NIL, singleton("a"), singletonInt(DT_INT));
+    ASSERT_ROUND_TRIP(c, "const rel operator");
+    ASSERT_ROUND_TRIP(createLargePlan(10), "larger plan");
+
+    return PASS;
+}
+
+static rc
+testDatalogRoundTrip(void)
+{
+    DLAtom *h = createDLAtom("Q", LIST_MAKE(createDLVar("X", DT_INT)), FALSE);
+    DLAtom *b = createDLAtom("R", LIST_MAKE(createDLVar("X", DT_INT),
+            createDLVar("Y", DT_INT)), FALSE);
+    DLComparison *cmp = createDLComparison("<", (Node *) createDLVar("X", DT_INT),
+            (Node *) createConstInt(5));
+    DLRule *r = createDLRule(h, LIST_MAKE(b, cmp));
+
+    ASSERT_ROUND_TRIP(r, "datalog rule");
+    ASSERT_ROUND_TRIP(createDLProgram(singleton(r), NIL, "Q",
+            singleton(createDLDomain("R", "A", "D")), NIL, NIL), "datalog program");
+
+    return PASS;
+}
+
+static rc
+testSketchRoundTrip(void)
+{
+    psAttrInfo *a = makeNode(psAttrInfo);
+    psInfo *p = makeNode(psInfo);
+    psInfoCell *c = makeNode(psInfoCell);
+    HashMap *m = NEW_MAP(Constant,List);
+
+    a->attrName = "a";
+    a->rangeList = LIST_MAKE(createConstInt(1), createConstInt(10), createConstInt(100));
+    a->BitVector = newSingletonBitSet(1);
+    MAP_ADD_STRING_KEY(m, "R", singleton(a));
+    p->psType = "RANGEB";
+    p->tablePSAttrInfos = m;
+
+    c->tableName = "R";
+    c->attrName = "a";
+    c->provTableAttr = "prov_r_a";
+    c->numRanges = 3;
+    c->psSize = 1;
+    c->ps = newSingletonBitSet(2);
+
+    ASSERT_ROUND_TRIP(p, "provenance sketch info");
+    ASSERT_ROUND_TRIP(c, "provenance sketch cell");
+
+    return PASS;
+}
+
+/*
+ * Compare size and speed of the binary format with nodeToString for a plan
+ * with many operators. We do not have a parser for the text format, so
+ * reading is compared with copyObject.
+ */
+static rc
+testBinaryVsTextFormat(void)
+{
+    QueryOperator *plan = createLargePlan(200);
+    int iterations = 20;
+    size_t binLen = 0;
+    size_t textLen = 0;
+    char *bin = NULL;
+    clock_t start;
+    double binWrite, textWrite, binRead, copy;
+
+    start = clock();
+    for(int i = 0; i < iterations; i++)
+        textLen = strlen(nodeToString(plan));
+    textWrite = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for(int i = 0; i < iterations; i++)
+        bin = nodeToBinary(plan, &binLen);
+    binWrite = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for(int i = 0; i < iterations; i++)
+        binaryToNode(bin, binLen);
+    binRead = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for(int i = 0; i < iterations; i++)
+        copyObject(plan);
+    copy = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+    DEBUG_LOG("plan with 200 joins: text %zu bytes, binary %zu bytes\n"
+            "nodeToString: %f sec, nodeToBinary: %f sec, binaryToNode: %f sec,"
+            " copyObject: %f sec", textLen, binLen, textWrite, binWrite, binRead, copy);
+
+    ASSERT_TRUE(binLen < textLen, "binary format is smaller than text format");
+    ASSERT_EQUALS_NODE(plan, binaryToNode(bin, binLen), "large plan round trip");
+
+    return PASS;
+}
+
+/*
+ * Left-deep join of numJoins + 1 tables where each table is also used in a
+ * selection on top of the join, i.e., each table access is shared.
+ */
+static QueryOperator *
+createLargePlan(int numJoins)
+{
+    List *attrs = LIST_MAKE("a", "b");
+    QueryOperator *cur;
+    List *tables = NIL;
+
+    cur = (QueryOperator *) createTableAccessOp("R0", NULL, "R0", NIL, attrs,
+            LIST_MAKE_INT(DT_INT, DT_INT));
+    tables = singleton(cur);
+
+    for(int i = 1; i <= numJoins; i++)
+    {
+        char *name = CONCAT_STRINGS("R", gprom_itoa(i));
+        QueryOperator *t = (QueryOperator *) createTableAccessOp(name, NULL, name, NIL,
+                attrs, LIST_MAKE_INT(DT_INT, DT_INT));
+        QueryOperator *j = (QueryOperator *) createJoinOp(JOIN_INNER,
+                (Node *) createOpExpr("=", LIST_MAKE(
+                        createFullAttrReference("a", 0, 0, 0, DT_INT),
+                        createFullAttrReference("a", 1, 0, 0, DT_INT))),
+                LIST_MAKE(cur, t), NIL, LIST_MAKE("a", "b", "a1", "b1"));
+        QueryOperator *p = (QueryOperator *) createProjectionOp(
+                LIST_MAKE(createFullAttrReference("a", 0, 0, 0, DT_INT),
+                        createFullAttrReference("b1", 0, 3, 0, DT_INT)),
+                j, NIL, attrs);
+
+        cur->parents = singleton(j);
+        t->parents = singleton(j);
+        j->parents = singleton(p);
+        tables = appendToTailOfList(tables, t);
+        cur = p;
+    }
+
+    // union of the join with all its base tables
+    FOREACH(QueryOperator,t,tables)
+    {
+        QueryOperator *u = (QueryOperator *) createSetOperator(SETOP_UNION,
+                LIST_MAKE(cur, t), NIL, attrs);
+
+        cur->parents = appendToTailOfList(cur->parents, u);
+        t->parents = appendToTailOfList(t->parents, u);
+        cur = u;
+    }
+
+    return cur;
+}
+
+/* inputs of operators that are not operators are rejected when reading */
+static rc
+testCorruptOperatorInputs(void)
+{
+    QueryOperator *r = (QueryOperator *) createTableAccessOp("R", NULL, "R", NIL,
+            LIST_MAKE("a"), singletonInt(DT_INT));
+    QueryOperator *sel = (QueryOperator *) createSelectionOp(
+            (Node *) createConstBool(TRUE), r, NIL, LIST_MAKE("a"));
+
+    sel->inputs = singleton(NULL);
+    ASSERT_TRUE(readingFails(sel), "NULL input");
+
+    sel->inputs = singleton(createConstInt(1));
+    ASSERT_TRUE(readingFails(sel), "input that is an expression");
+
+    return PASS;
+}
+
+static boolean
+readingFails(void *n)
+{
+    volatile boolean failed = FALSE;
+    size_t len;
+    char *data = nodeToBinary(n, &len);
+
+    registerExceptionCallback(abortOnException);
+    NEW_AND_ACQUIRE_MEMCONTEXT(QUERY_MEM_CONTEXT);
+    TRY
+    {
+        binaryToNode(data, len);
+        FREE_AND_RELEASE_CUR_MEM_CONTEXT();
+    }
+    ON_EXCEPTION
+    {
+        failed = TRUE;
+    }
+    END_ON_EXCEPTION
+    registerExceptionCallback(NULL);
+
+    return failed;
+}
+
+static ExceptionHandler
+abortOnException (const char *message, const char *file, int line, ExceptionSeverity s)
+{
+    return EXCEPTION_ABORT;
+}